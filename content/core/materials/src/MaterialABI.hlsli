@@ -20,6 +20,13 @@ cbuffer ObjectCB : register(b2) {
 	float4x4 gWorldInvTranspose;
 }
 
+// インスタンスごとのデータ(生成した VS が SV_InstanceID で引く)
+struct InstanceData {
+	float4x4 world;
+};
+
+StructuredBuffer<InstanceData> gInstances : register(t1);
+
 Texture2D    gTex : register(t0);
 SamplerState gLinearWrap : register(s0);
 
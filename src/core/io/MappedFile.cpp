@@ -0,0 +1,96 @@
+﻿#include "MappedFile.h"
+
+#include <utility>
+#include <Windows.h>
+
+MappedFile::~MappedFile() {
+	Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	if (this != &other) {
+		Close();
+		mFile    = std::exchange(other.mFile, nullptr);
+		mMapping = std::exchange(other.mMapping, nullptr);
+		mData    = std::exchange(other.mData, nullptr);
+		mSize    = std::exchange(other.mSize, 0);
+	}
+	return *this;
+}
+
+bool MappedFile::Open(const std::filesystem::path& path) {
+	Close();
+
+	const HANDLE file = CreateFileW(
+		path.c_str(),
+		GENERIC_READ,
+		// マップ中でも書き手が一時ファイルで置き換えられるように削除も共有する
+		FILE_SHARE_READ | FILE_SHARE_DELETE,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS,
+		nullptr
+	);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+
+	const HANDLE mapping = CreateFileMappingW(
+		file, nullptr, PAGE_READONLY, 0, 0, nullptr
+	);
+	if (!mapping) {
+		CloseHandle(file);
+		return false;
+	}
+
+	const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!view) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	mFile    = file;
+	mMapping = mapping;
+	mData    = static_cast<const std::byte*>(view);
+	mSize    = static_cast<size_t>(size.QuadPart);
+	return true;
+}
+
+void MappedFile::Close() {
+	if (mData) {
+		UnmapViewOfFile(mData);
+	}
+	if (mMapping) {
+		CloseHandle(mMapping);
+	}
+	if (mFile) {
+		CloseHandle(mFile);
+	}
+	mFile    = nullptr;
+	mMapping = nullptr;
+	mData    = nullptr;
+	mSize    = 0;
+}
+
+bool MappedFile::IsOpen() const {
+	return mData != nullptr;
+}
+
+const std::byte* MappedFile::Data() const {
+	return mData;
+}
+
+size_t MappedFile::Size() const {
+	return mSize;
+}
@@ -0,0 +1,33 @@
+﻿#pragma once
+#include <cstddef>
+#include <filesystem>
+
+//-----------------------------------------------------------------------------
+// Purpose: 読み取り専用のメモリマップドファイル
+//-----------------------------------------------------------------------------
+class MappedFile {
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&)            = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	/// @brief ファイル全体をマップします
+	/// @return 開けなかった(存在しない、空など)ときはfalse
+	bool Open(const std::filesystem::path& path);
+	void Close();
+
+	[[nodiscard]] bool             IsOpen() const;
+	[[nodiscard]] const std::byte* Data() const;
+	[[nodiscard]] size_t           Size() const;
+
+private:
+	void*            mFile    = nullptr; // HANDLE
+	void*            mMapping = nullptr; // HANDLE
+	const std::byte* mData    = nullptr;
+	size_t           mSize    = 0;
+};
@@ -0,0 +1,150 @@
+﻿#include "JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+JobSystem::JobSystem(uint32_t workerCount) {
+	if (workerCount == 0) {
+		const uint32_t hw = std::thread::hardware_concurrency();
+		workerCount       = hw > 1 ? hw - 1 : 1;
+	}
+
+	mWorkers.reserve(workerCount);
+	for (uint32_t i = 0; i < workerCount; ++i) {
+		mWorkers.emplace_back([this] { WorkerMain(); });
+	}
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard lock(mMutex);
+		mStop = true;
+	}
+	mWakeCv.notify_all();
+	for (auto& worker : mWorkers) {
+		if (worker.joinable()) {
+			worker.join();
+		}
+	}
+}
+
+void JobSystem::Submit(std::function<void()> job) {
+	{
+		std::lock_guard lock(mMutex);
+		mQueue.emplace_back(std::move(job));
+	}
+	mWakeCv.notify_one();
+}
+
+void JobSystem::WaitIdle() {
+	std::unique_lock lock(mMutex);
+	mIdleCv.wait(lock, [this] {
+		return mQueue.empty() && mActiveJobs == 0;
+	});
+}
+
+void JobSystem::ParallelFor(
+	const size_t   count,
+	size_t         grainSize,
+	const RangeFn& fn
+) {
+	if (count == 0) {
+		return;
+	}
+	grainSize = std::max<size_t>(grainSize, 1);
+
+	const size_t chunkCount = (count + grainSize - 1) / grainSize;
+	if (chunkCount == 1 || mWorkers.empty()) {
+		fn(0, count, 0);
+		return;
+	}
+
+	// ヘルパーは呼び出しから戻った後に起動することもあるので共有状態はヒープに置く
+	struct State {
+		std::atomic<size_t>   nextChunk = 0;
+		std::atomic<size_t>   doneChunk = 0;
+		std::atomic<uint32_t> nextLane  = 0;
+		size_t                chunkCount;
+		size_t                count;
+		size_t                grainSize;
+		const RangeFn*        fn;
+	};
+	const auto state  = std::make_shared<State>();
+	state->chunkCount = chunkCount;
+	state->count      = count;
+	state->grainSize  = grainSize;
+	state->fn         = &fn;
+
+	// チャンクが尽きるまで取り続ける
+	const auto drain = [](State& s) {
+		const uint32_t lane = s.nextLane.fetch_add(1);
+		for (;;) {
+			const size_t chunk = s.nextChunk.fetch_add(1);
+			if (chunk >= s.chunkCount) {
+				return;
+			}
+			const size_t begin = chunk * s.grainSize;
+			const size_t end   = std::min(begin + s.grainSize, s.count);
+			(*s.fn)(begin, end, lane);
+			if (s.doneChunk.fetch_add(1) + 1 == s.chunkCount) {
+				s.doneChunk.notify_all();
+			}
+		}
+	};
+
+	const size_t helperCount = std::min(chunkCount - 1, mWorkers.size());
+	for (size_t i = 0; i < helperCount; ++i) {
+		Submit([state, drain] { drain(*state); });
+	}
+
+	drain(*state);
+
+	// 他のレーンが処理中のチャンクを待つ
+	size_t done = state->doneChunk.load();
+	while (done < chunkCount) {
+		state->doneChunk.wait(done);
+		done = state->doneChunk.load();
+	}
+}
+
+uint32_t JobSystem::WorkerCount() const {
+	return static_cast<uint32_t>(mWorkers.size());
+}
+
+uint32_t JobSystem::MaxLanes() const {
+	return WorkerCount() + 1;
+}
+
+JobSystem& JobSystem::Get() {
+	static JobSystem instance;
+	return instance;
+}
+
+void JobSystem::WorkerMain() {
+	for (;;) {
+		std::function<void()> job;
+		{
+			std::unique_lock lock(mMutex);
+			mWakeCv.wait(lock, [this] {
+				return mStop || !mQueue.empty();
+			});
+			if (mStop && mQueue.empty()) {
+				return;
+			}
+			job = std::move(mQueue.front());
+			mQueue.pop_front();
+			++mActiveJobs;
+		}
+
+		job();
+
+		{
+			std::lock_guard lock(mMutex);
+			--mActiveJobs;
+			if (mQueue.empty() && mActiveJobs == 0) {
+				mIdleCv.notify_all();
+			}
+		}
+	}
+}
@@ -0,0 +1,55 @@
+﻿#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Purpose: ワーカースレッドプール
+//-----------------------------------------------------------------------------
+class JobSystem {
+public:
+	// [begin, end) の範囲と、その呼び出し内で一意なレーン番号を受け取る
+	// レーン番号はスレッドごとの作業領域(スタックなど)の添字に使えます
+	using RangeFn = std::function<void(size_t begin, size_t end, uint32_t lane)>;
+
+	/// @param workerCount ワーカー数。0ならハードウェアスレッド数 - 1
+	explicit JobSystem(uint32_t workerCount = 0);
+	~JobSystem();
+
+	JobSystem(const JobSystem&)            = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	/// @brief ジョブをキューに積みます
+	void Submit(std::function<void()> job);
+
+	/// @brief キューが空になり、全ワーカーが手空きになるまで待ちます
+	void WaitIdle();
+
+	/// @brief [0, count) を grainSize ごとに分割して並列に処理します
+	/// @details 呼び出し元スレッドも処理に参加し、全範囲の完了まで戻りません。
+	///          レーン数は最大で MaxLanes() です
+	void ParallelFor(size_t count, size_t grainSize, const RangeFn& fn);
+
+	[[nodiscard]] uint32_t WorkerCount() const;
+
+	// ParallelFor が同時に使うレーンの最大数(ワーカー + 呼び出し元)
+	[[nodiscard]] uint32_t MaxLanes() const;
+
+	// プロセス共通のプール
+	static JobSystem& Get();
+
+private:
+	void WorkerMain();
+
+	std::vector<std::thread>          mWorkers;
+	std::deque<std::function<void()>> mQueue;
+	std::mutex                        mMutex;
+	std::condition_variable           mWakeCv;
+	std::condition_variable           mIdleCv;
+	uint32_t                          mActiveJobs = 0;
+	bool                              mStop       = false;
+};
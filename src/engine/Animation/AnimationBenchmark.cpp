@@ -0,0 +1,1169 @@
+﻿#include <engine/Animation/AnimationBenchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <core/jobsystem/JobSystem.h>
+
+#include <engine/Animation/Animation.h>
+#include <engine/Animation/AnimationClip.h>
+#include <engine/Animation/AnimationGraph.h>
+#include <engine/Animation/AnimationPose.h>
+#include <engine/Animation/FlatSkeleton.h>
+#include <engine/Animation/Skeleton.h>
+#include <engine/Animation/Skinning.h>
+#include <engine/subsystem/console/Log.h>
+
+#include <runtime/assets/types/MeshAsset.h>
+#include <runtime/core/math/AffineCompose.h>
+#include <runtime/core/math/Math.h>
+
+namespace Unnamed::AnimationBenchmark {
+	namespace {
+		constexpr std::string_view kChannel = "Animation";
+
+		constexpr uint32_t kSeed         = 0x2545F491u;
+		constexpr float    kKeyRate      = 30.0f; // 元のキーのレート
+		constexpr float    kPlaybackRate = 60.0f; // 再生するフレームレート
+		constexpr uint32_t kMovingEvery  = 8;     // この本数に1本は移動もアニメーションする
+		constexpr uint32_t kRandomSeeks  = 10000;
+
+		// 許容誤差。Settings の既定値に、キーの間の nlerp と slerp の差の分だけ余裕を持たせる
+		constexpr float kTranslateTolerance = 0.002f;
+		constexpr float kRotateToleranceDeg = 0.2f;
+
+		// キーちょうどの時刻では旧実装は前の区間の t = 1、二分探索は次の区間の t = 0 を使う。
+		// Slerp は内積が1に丸まると最初のキーを返すので、ほぼ同じ回転のキーの間でだけ少しずれる
+		constexpr float kBinarySearchTolerance = 0.002f;
+
+		// 旧 CalculateValue 相当(先頭からキーをなめる)
+		template <typename T, typename Interpolate>
+		T LegacyCalculateValue(
+			const std::vector<Keyframe<T>>& keyframes,
+			const float                     time,
+			Interpolate                     interpolate
+		) {
+			if (keyframes.size() == 1 || time <= keyframes[0].time) {
+				return keyframes[0].value;
+			}
+			for (size_t index = 0; index < keyframes.size() - 1; ++index) {
+				const size_t nextIndex = index + 1;
+				if (keyframes[index].time <= time &&
+					time <= keyframes[nextIndex].time) {
+					const float t = (time - keyframes[index].time) /
+						(keyframes[nextIndex].time - keyframes[index].time);
+					return interpolate(
+						keyframes[index].value, keyframes[nextIndex].value, t
+					);
+				}
+			}
+			return keyframes.rbegin()->value;
+		}
+
+		Vec3 LegacyValue(const std::vector<KeyframeVec3>& keyframes, const float time) {
+			return LegacyCalculateValue(
+				keyframes, time,
+				[](const Vec3& a, const Vec3& b, const float t) {
+					return Math::Lerp(a, b, t);
+				}
+			);
+		}
+
+		Quaternion LegacyValue(
+			const std::vector<KeyframeQuaternion>& keyframes,
+			const float                            time
+		) {
+			return LegacyCalculateValue(
+				keyframes, time,
+				[](const Quaternion& a, const Quaternion& b, const float t) {
+					return Quaternion::Slerp(a, b, t);
+				}
+			);
+		}
+
+		struct Pose {
+			Vec3       translate;
+			Quaternion rotate;
+			Vec3       scale;
+		};
+
+		// DCC から焼き出したのと同じく、全ボーンの全チャンネルに毎フレームキーがあるクリップ
+		Animation MakeAnimation(const uint32_t boneCount, const float seconds) {
+			std::mt19937                   rng(kSeed);
+			std::uniform_real_distribution unit(-1.0f, 1.0f);
+			std::uniform_real_distribution frequency(0.1f, 1.5f); // Hz
+			std::uniform_real_distribution amplitude(5.0f, 60.0f); // 度
+
+			Animation animation;
+			animation.duration = seconds;
+
+			const uint32_t keyCount = static_cast<uint32_t>(
+				std::ceil(seconds * kKeyRate)
+			) + 1;
+			for (uint32_t bone = 0; bone < boneCount; ++bone) {
+				const std::string name = std::format("bone_{:03}", bone);
+				NodeAnimation&    node = animation.nodeAnimations[name];
+				animation.nodeNames.emplace_back(name);
+
+				const Vec3 axis = Vec3(unit(rng), unit(rng), unit(rng)).Normalized();
+				const Vec3 rest = Vec3(unit(rng), unit(rng), unit(rng)) * 0.2f;
+				const Vec3 move = Vec3(unit(rng), unit(rng), unit(rng)) * 0.5f;
+
+				const float rotateHz  = frequency(rng);
+				const float rotateDeg = amplitude(rng);
+				const float moveHz    = frequency(rng);
+				const float phase     = unit(rng) * Math::pi;
+				const bool  moving    = bone % kMovingEvery == 0;
+
+				node.translate.keyFrames.reserve(keyCount);
+				node.rotate.keyFrames.reserve(keyCount);
+				node.scale.keyFrames.reserve(keyCount);
+				for (uint32_t key = 0; key < keyCount; ++key) {
+					const float time = std::min(
+						static_cast<float>(key) / kKeyRate, seconds
+					);
+					const float wave = std::sin(2.0f * Math::pi * rotateHz * time + phase);
+
+					Vec3 translate = rest;
+					if (moving) {
+						translate += move * std::sin(2.0f * Math::pi * moveHz * time);
+					}
+					node.translate.keyFrames.push_back({time, translate});
+					node.rotate.keyFrames.push_back(
+						{time, Quaternion(axis, rotateDeg * wave * Math::deg2Rad)}
+					);
+					node.scale.keyFrames.push_back({time, Vec3::one});
+				}
+			}
+			return animation;
+		}
+
+		size_t LegacyMemoryBytes(const Animation& animation) {
+			size_t bytes = sizeof(Animation);
+			for (const auto& [name, node] : animation.nodeAnimations) {
+				bytes += sizeof(NodeAnimation) + sizeof(std::string) + name.capacity();
+				bytes += node.translate.keyFrames.capacity() * sizeof(KeyframeVec3);
+				bytes += node.rotate.keyFrames.capacity() * sizeof(KeyframeQuaternion);
+				bytes += node.scale.keyFrames.capacity() * sizeof(KeyframeVec3);
+			}
+			return bytes;
+		}
+
+		// acos は1付近で精度が出ないので、符号を揃えた差の長さ(弦)から角度を求める
+		float AngleDegrees(const Quaternion& a, const Quaternion& b) {
+			const float sign = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0.0f ?
+				                   -1.0f :
+				                   1.0f;
+			const float dx    = a.x - b.x * sign;
+			const float dy    = a.y - b.y * sign;
+			const float dz    = a.z - b.z * sign;
+			const float dw    = a.w - b.w * sign;
+			const float chord = std::sqrt(dx * dx + dy * dy + dz * dz + dw * dw);
+			return 4.0f * std::asin(std::min(chord * 0.5f, 1.0f)) * Math::rad2Deg;
+		}
+
+		float MaxDifference(const Vec3& a, const Vec3& b) {
+			return std::max({
+				std::abs(a.x - b.x), std::abs(a.y - b.y), std::abs(a.z - b.z)
+			});
+		}
+
+		bool SameBits(const Pose& a, const Pose& b) {
+			return a.translate.x == b.translate.x && a.translate.y == b.translate.y &&
+				a.translate.z == b.translate.z &&
+				a.rotate.x == b.rotate.x && a.rotate.y == b.rotate.y &&
+				a.rotate.z == b.rotate.z && a.rotate.w == b.rotate.w &&
+				a.scale.x == b.scale.x && a.scale.y == b.scale.y &&
+				a.scale.z == b.scale.z;
+		}
+
+		double ElapsedMs(const std::chrono::steady_clock::time_point begin) {
+			return std::chrono::duration<double, std::milli>(
+				std::chrono::steady_clock::now() - begin
+			).count();
+		}
+
+		// 最適化で消されないよう結果を畳み込む
+		float Checksum(const Pose& pose) {
+			return pose.translate.x + pose.rotate.w + pose.scale.y;
+		}
+
+		//---------------------------------------------------------------------
+		// スケルトン
+		//---------------------------------------------------------------------
+		constexpr uint32_t kJointCount     = 100;
+		constexpr uint32_t kMaxBones       = 256; // BoneMatrices::MAX_BONES
+		constexpr float    kPoseClipLength = 2.0f;
+		constexpr uint32_t kPoseFrames     = 30;
+		constexpr uint32_t kParentWindow   = 6; // 親はこの本数以内の前のジョイントから選ぶ
+		constexpr float    kPoseTolerance  = 1e-4f;
+
+		Node MakeNode(
+			const uint32_t                            index,
+			const std::vector<std::vector<uint32_t>>& children,
+			const std::vector<JointPose>&             binds
+		) {
+			Node node;
+			node.name                = std::format("joint_{:03}", index);
+			node.transform.translate = binds[index].translate;
+			node.transform.rotate    = binds[index].rotate;
+			node.transform.scale     = binds[index].scale;
+			node.localMat            = Mat4::Affine(
+				binds[index].scale, binds[index].rotate, binds[index].translate
+			);
+			for (const uint32_t child : children[index]) {
+				node.children.emplace_back(MakeNode(child, children, binds));
+			}
+			return node;
+		}
+
+		// シーンのルートとアーマチュア(ボーンではないノード)の下に、ランダムな木のボーンをぶら下げる
+		Skeleton MakeSkeleton(std::mt19937& rng) {
+			std::uniform_real_distribution unit(-1.0f, 1.0f);
+
+			std::vector<JointPose>             binds(kJointCount);
+			std::vector<uint32_t>              parents(kJointCount, 0);
+			std::vector<std::vector<uint32_t>> children(kJointCount);
+			for (uint32_t i = 0; i < kJointCount; ++i) {
+				const Vec3 axis = Vec3(unit(rng), unit(rng), unit(rng)).Normalized();
+				binds[i]        = {
+					Vec3(unit(rng), unit(rng), unit(rng)) * 0.3f,
+					Quaternion(axis, unit(rng) * 0.5f),
+					Vec3::one
+				};
+				if (i > 0) {
+					std::uniform_int_distribution<uint32_t> window(
+						i > kParentWindow ? i - kParentWindow : 0, i - 1
+					);
+					parents[i] = window(rng);
+					children[parents[i]].emplace_back(i);
+				}
+			}
+
+			Skeleton skeleton;
+			skeleton.rootNode.name     = "Scene";
+			skeleton.rootNode.localMat = Mat4::identity;
+			skeleton.rootNode.transform = {Vec3::zero, Quaternion::identity, Vec3::one};
+
+			Node armature;
+			armature.name      = "Armature";
+			armature.transform = {Vec3::zero, Quaternion::identity, Vec3::one * 0.01f};
+			armature.localMat  = Mat4::Scale(armature.transform.scale);
+			armature.children.emplace_back(MakeNode(0, children, binds));
+			skeleton.rootNode.children.emplace_back(std::move(armature));
+
+			// オフセット行列は初期姿勢のモデル空間の逆行列
+			std::vector<Mat4> model(kJointCount);
+			for (uint32_t i = 0; i < kJointCount; ++i) {
+				const Mat4 local = Mat4::Affine(
+					binds[i].scale, binds[i].rotate, binds[i].translate
+				);
+				model[i] = i == 0 ?
+					           local * Mat4::Scale(Vec3::one * 0.01f) :
+					           local * model[parents[i]];
+
+				Bone bone;
+				bone.name         = std::format("joint_{:03}", i);
+				bone.id           = static_cast<int>(i);
+				bone.offsetMatrix = model[i].Inverse();
+				skeleton.boneMap[bone.name] = bone.id;
+				skeleton.bones.emplace_back(bone);
+			}
+			skeleton.boneMatrices.resize(skeleton.bones.size(), Mat4::identity);
+			return skeleton;
+		}
+
+		Animation MakePoseAnimation(std::mt19937& rng) {
+			std::uniform_real_distribution unit(-1.0f, 1.0f);
+			std::uniform_real_distribution frequency(0.5f, 2.0f);
+
+			Animation animation;
+			animation.duration = kPoseClipLength;
+
+			const uint32_t keyCount = static_cast<uint32_t>(
+				std::ceil(kPoseClipLength * kKeyRate)
+			) + 1;
+			for (uint32_t joint = 0; joint < kJointCount; ++joint) {
+				const std::string name = std::format("joint_{:03}", joint);
+				NodeAnimation&    node = animation.nodeAnimations[name];
+				animation.nodeNames.emplace_back(name);
+
+				const Vec3  axis   = Vec3(unit(rng), unit(rng), unit(rng)).Normalized();
+				const Vec3  rest   = Vec3(unit(rng), unit(rng), unit(rng)) * 0.3f;
+				const float hz     = frequency(rng);
+				const float angle  = unit(rng); // ラジアン
+				const float phase  = unit(rng) * Math::pi;
+				for (uint32_t key = 0; key < keyCount; ++key) {
+					const float time = std::min(
+						static_cast<float>(key) / kKeyRate, kPoseClipLength
+					);
+					const float wave = std::sin(2.0f * Math::pi * hz * time + phase);
+					node.translate.keyFrames.push_back({time, rest});
+					node.rotate.keyFrames.push_back({time, Quaternion(axis, angle * wave)});
+					node.scale.keyFrames.push_back({time, Vec3::one});
+				}
+			}
+			return animation;
+		}
+
+		// 旧 SkeletalMeshRenderer::CalculateNodeTransform 相当
+		void LegacyNodeTransform(
+			const Skeleton&  skeleton,
+			const Node&      node,
+			const Mat4&      parentTransform,
+			const Animation& animation,
+			const float      time,
+			Mat4*            bones
+		) {
+			Mat4 nodeTransform = node.localMat;
+			if (animation.nodeAnimations.find(node.name) != animation.nodeAnimations.end()) {
+				const NodeAnimation& nodeAnim = animation.nodeAnimations.at(node.name);
+				nodeTransform = Mat4::Affine(
+					CalculateValue(nodeAnim.scale.keyFrames, time),
+					CalculateValue(nodeAnim.rotate.keyFrames, time),
+					CalculateValue(nodeAnim.translate.keyFrames, time)
+				);
+			}
+
+			const Mat4 globalTransform = nodeTransform * parentTransform;
+			if (const auto it = skeleton.boneMap.find(node.name);
+				it != skeleton.boneMap.end() && it->second < static_cast<int>(kMaxBones)) {
+				bones[it->second] = skeleton.bones[it->second].offsetMatrix * globalTransform;
+			}
+
+			for (const Node& child : node.children) {
+				LegacyNodeTransform(skeleton, child, globalTransform, animation, time, bones);
+			}
+		}
+
+		void LegacyUpdate(
+			const Skeleton&  skeleton,
+			const Animation& animation,
+			const float      time,
+			Mat4*            bones
+		) {
+			for (uint32_t i = 0; i < kMaxBones; ++i) {
+				bones[i] = Mat4::identity;
+			}
+			LegacyNodeTransform(
+				skeleton, skeleton.rootNode, Mat4::identity, animation, time, bones
+			);
+		}
+
+		float MaxError(const Mat4* a, const Mat4* b, const uint32_t count) {
+			float error = 0.0f;
+			for (uint32_t i = 0; i < count; ++i) {
+				for (int r = 0; r < 4; ++r) {
+					for (int c = 0; c < 4; ++c) {
+						error = std::max(error, std::abs(a[i].m[r][c] - b[i].m[r][c]));
+					}
+				}
+			}
+			return error;
+		}
+
+		//---------------------------------------------------------------------
+		// ブレンドグラフ
+		//---------------------------------------------------------------------
+		constexpr uint32_t kBlendFrames      = 60;
+		constexpr float    kBlendTolerance   = 1e-4f;
+		constexpr float    kCheckTime        = 0.3f;
+		constexpr uint32_t kUpperBodyJoint   = 10; // このジョイント以下を上半身として扱う
+		constexpr float    kCrossfadeSeconds = 0.5f;
+
+		// 全ジョイントが初期姿勢のまま動かないクリップ
+		Animation MakeBindAnimation(const FlatSkeleton& skeleton) {
+			Animation animation;
+			animation.duration = kPoseClipLength;
+			for (uint32_t joint = 0; joint < skeleton.JointCount(); ++joint) {
+				const std::string& name = skeleton.JointName(joint);
+				const JointPose&   bind = skeleton.BindPose()[joint];
+				NodeAnimation&     node = animation.nodeAnimations[name];
+				animation.nodeNames.emplace_back(name);
+				node.translate.keyFrames.push_back({0.0f, bind.translate});
+				node.rotate.keyFrames.push_back({0.0f, bind.rotate});
+				node.scale.keyFrames.push_back({0.0f, bind.scale});
+			}
+			return animation;
+		}
+
+		// 符号違いは同じ回転として比べる
+		float MaxDifference(const JointPose& a, const JointPose& b) {
+			const float dot = a.rotate.x * b.rotate.x + a.rotate.y * b.rotate.y +
+				a.rotate.z * b.rotate.z + a.rotate.w * b.rotate.w;
+			const float sign = dot < 0.0f ? -1.0f : 1.0f;
+			return std::max({
+				MaxDifference(a.translate, b.translate),
+				MaxDifference(a.scale, b.scale),
+				std::abs(a.rotate.x - b.rotate.x * sign),
+				std::abs(a.rotate.y - b.rotate.y * sign),
+				std::abs(a.rotate.z - b.rotate.z * sign),
+				std::abs(a.rotate.w - b.rotate.w * sign)
+			});
+		}
+
+		float MaxDifference(
+			const std::vector<JointPose>& a,
+			const std::vector<JointPose>& b
+		) {
+			float error = 0.0f;
+			for (size_t i = 0; i < a.size(); ++i) {
+				error = std::max(error, MaxDifference(a[i], b[i]));
+			}
+			return error;
+		}
+
+		std::vector<JointPose> SampleDirect(
+			const FlatSkeleton&  skeleton,
+			const AnimationClip& clip,
+			const float          time
+		) {
+			std::vector<JointPose> pose(skeleton.JointCount());
+			AnimationClipCursor    cursor(clip);
+			skeleton.SampleLocalPose(clip, skeleton.Bind(clip), time, cursor, pose.data());
+			return pose;
+		}
+
+		// 1体分の評価用のバッファ
+		struct Character {
+			float                  time = 0.0f;
+			AnimationClipCursor    cursor;
+			std::vector<JointPose> local;
+			std::vector<Mat4>      model;
+			std::vector<Mat4>      bones;
+		};
+	}
+
+	bool RunClipSampling(const uint32_t boneCount, const float seconds) {
+		if (boneCount == 0 || seconds <= 0.0f) {
+			return true;
+		}
+
+		const Animation animation = MakeAnimation(boneCount, seconds);
+
+		// ノード名ではなくチャンネル番号で引けるよう、ボーン順に並べておく
+		std::vector<const NodeAnimation*> nodes;
+		nodes.reserve(boneCount);
+		for (const std::string& name : animation.nodeNames) {
+			nodes.emplace_back(&animation.nodeAnimations.at(name));
+		}
+
+		auto                begin  = std::chrono::steady_clock::now();
+		const AnimationClip clip(animation);
+		const double        buildMs = ElapsedMs(begin);
+
+		std::vector<uint32_t> channels;
+		channels.reserve(boneCount);
+		for (const std::string& name : animation.nodeNames) {
+			channels.emplace_back(clip.FindChannel(name));
+		}
+
+		const uint32_t frameCount = static_cast<uint32_t>(
+			std::ceil(seconds * kPlaybackRate)
+		) + 1;
+		const auto timeOf = [&](const uint32_t frame) {
+			return std::min(static_cast<float>(frame) / kPlaybackRate, seconds);
+		};
+		const size_t        sampleCount = static_cast<size_t>(frameCount) * boneCount;
+		std::vector<Pose>   expected(sampleCount);
+		std::vector<Pose>   actual(sampleCount);
+		float               checksum = 0.0f;
+
+		// 旧実装
+		begin = std::chrono::steady_clock::now();
+		for (uint32_t frame = 0; frame < frameCount; ++frame) {
+			const float time = timeOf(frame);
+			for (uint32_t bone = 0; bone < boneCount; ++bone) {
+				const NodeAnimation& node = *nodes[bone];
+				Pose& pose     = expected[static_cast<size_t>(frame) * boneCount + bone];
+				pose.translate = LegacyValue(node.translate.keyFrames, time);
+				pose.rotate    = LegacyValue(node.rotate.keyFrames, time);
+				pose.scale     = LegacyValue(node.scale.keyFrames, time);
+			}
+		}
+		const double legacyMs = ElapsedMs(begin);
+
+		// 二分探索の CalculateValue
+		float binaryError = 0.0f;
+		begin             = std::chrono::steady_clock::now();
+		for (uint32_t frame = 0; frame < frameCount; ++frame) {
+			const float time = timeOf(frame);
+			for (uint32_t bone = 0; bone < boneCount; ++bone) {
+				const NodeAnimation& node = *nodes[bone];
+				Pose& pose     = actual[static_cast<size_t>(frame) * boneCount + bone];
+				pose.translate = CalculateValue(node.translate.keyFrames, time);
+				pose.rotate    = CalculateValue(node.rotate.keyFrames, time);
+				pose.scale     = CalculateValue(node.scale.keyFrames, time);
+			}
+		}
+		const double binaryMs = ElapsedMs(begin);
+		for (size_t i = 0; i < sampleCount; ++i) {
+			binaryError = std::max({
+				binaryError,
+				MaxDifference(actual[i].translate, expected[i].translate),
+				AngleDegrees(actual[i].rotate, expected[i].rotate) * Math::deg2Rad
+			});
+		}
+
+		// AnimationClip + カーソル
+		AnimationClipCursor cursor(clip);
+		begin = std::chrono::steady_clock::now();
+		for (uint32_t frame = 0; frame < frameCount; ++frame) {
+			const float time = timeOf(frame);
+			for (uint32_t bone = 0; bone < boneCount; ++bone) {
+				Pose& pose = actual[static_cast<size_t>(frame) * boneCount + bone];
+				clip.Sample(
+					channels[bone], time, cursor,
+					pose.translate, pose.rotate, pose.scale
+				);
+			}
+		}
+		const double cursorMs = ElapsedMs(begin);
+
+		float maxTranslate = 0.0f;
+		float maxRotate    = 0.0f; // 度
+		float maxScale     = 0.0f;
+		for (size_t i = 0; i < sampleCount; ++i) {
+			maxTranslate = std::max(
+				maxTranslate, MaxDifference(actual[i].translate, expected[i].translate)
+			);
+			maxRotate = std::max(
+				maxRotate, AngleDegrees(actual[i].rotate, expected[i].rotate)
+			);
+			maxScale = std::max(
+				maxScale, MaxDifference(actual[i].scale, expected[i].scale)
+			);
+		}
+
+		// AnimationClip(毎回二分探索)。カーソルありと全く同じ値になるはず
+		bool matches = true;
+		begin        = std::chrono::steady_clock::now();
+		for (uint32_t frame = 0; frame < frameCount; ++frame) {
+			const float time = timeOf(frame);
+			for (uint32_t bone = 0; bone < boneCount; ++bone) {
+				Pose pose;
+				clip.Sample(channels[bone], time, pose.translate, pose.rotate, pose.scale);
+				checksum += Checksum(pose);
+				matches = matches && SameBits(
+					pose, actual[static_cast<size_t>(frame) * boneCount + bone]
+				);
+			}
+		}
+		const double searchMs = ElapsedMs(begin);
+
+		// ループで先頭に戻ったり、ランダムにシークしてもカーソルが追従するか
+		{
+			std::mt19937                   rng(kSeed);
+			std::uniform_real_distribution time(-1.0f, seconds + 1.0f);
+			std::uniform_int_distribution  bone(0u, boneCount - 1);
+			for (uint32_t i = 0; i < kRandomSeeks && matches; ++i) {
+				const float    t       = i % 3 == 0 ? seconds - time(rng) : time(rng);
+				const uint32_t channel = channels[bone(rng)];
+				Pose           a;
+				Pose           b;
+				clip.Sample(channel, t, cursor, a.translate, a.rotate, a.scale);
+				clip.Sample(channel, t, b.translate, b.rotate, b.scale);
+				matches = SameBits(a, b);
+			}
+		}
+
+		size_t legacyKeys = 0;
+		for (const NodeAnimation* node : nodes) {
+			legacyKeys += node->translate.keyFrames.size() +
+				node->rotate.keyFrames.size() + node->scale.keyFrames.size();
+		}
+
+		const double samples = static_cast<double>(sampleCount) * kAnimationTrackCount;
+		Msg(
+			kChannel,
+			"[{} bones, {:g}s, {} frames @ {:.0f}fps] legacy {:.2f} ms, "
+			"binary search {:.2f} ms, clip+cursor {:.2f} ms, clip search {:.2f} ms "
+			"({:.1f}x vs legacy, {:.1f} ns/track sample)",
+			boneCount, seconds, frameCount, kPlaybackRate,
+			legacyMs, binaryMs, cursorMs, searchMs,
+			legacyMs / std::max(cursorMs, 1e-6),
+			cursorMs * 1e6 / samples
+		);
+		Msg(
+			kChannel,
+			"keys {} -> {} ({:.1f}%), memory {:.2f} MiB -> {:.2f} MiB, "
+			"clip build {:.2f} ms, checksum {:.3f}",
+			legacyKeys, clip.KeyCount(),
+			100.0 * static_cast<double>(clip.KeyCount()) / static_cast<double>(legacyKeys),
+			static_cast<double>(LegacyMemoryBytes(animation)) / (1024.0 * 1024.0),
+			static_cast<double>(clip.MemoryBytes()) / (1024.0 * 1024.0),
+			buildMs, checksum
+		);
+		Msg(
+			kChannel,
+			"max error vs legacy: translate {:.2e}, rotate {:.4f} deg, scale {:.2e}, "
+			"binary search {:.2e}",
+			maxTranslate, maxRotate, maxScale, binaryError
+		);
+
+		bool ok = true;
+		if (!matches) {
+			Warning(kChannel, "clip sampling FAILED: cursor and search disagree");
+			ok = false;
+		}
+		if (maxTranslate > kTranslateTolerance || maxScale > kTranslateTolerance ||
+			maxRotate > kRotateToleranceDeg || binaryError > kBinarySearchTolerance) {
+			Warning(kChannel, "clip sampling FAILED: error out of tolerance");
+			ok = false;
+		}
+		return ok;
+	}
+
+	bool RunSkeletonPose(const uint32_t characterCount) {
+		if (characterCount == 0) {
+			return true;
+		}
+
+		std::mt19937        rng(kSeed);
+		const Skeleton      skeleton  = MakeSkeleton(rng);
+		const Animation     animation = MakePoseAnimation(rng);
+		const FlatSkeleton  flat(skeleton);
+		const AnimationClip clip(animation);
+
+		// 再生開始時に一度だけ結び付ける
+		const std::vector<uint32_t> binding = flat.Bind(clip);
+
+		std::uniform_real_distribution<float> offset(0.0f, kPoseClipLength);
+		std::vector<Character>                characters(characterCount);
+		for (Character& character : characters) {
+			character.time = offset(rng);
+			character.cursor.Reset(clip);
+			character.local.resize(flat.JointCount());
+			character.model.resize(flat.JointCount());
+			character.bones.assign(kMaxBones, Mat4::identity);
+		}
+		std::vector<Mat4> legacyBones(static_cast<size_t>(characterCount) * kMaxBones);
+
+		const float step       = 1.0f / kPlaybackRate;
+		const auto  timeOf     = [&](const Character& character, const uint32_t frame) {
+			return std::fmod(character.time + static_cast<float>(frame) * step, kPoseClipLength);
+		};
+
+		// 旧実装
+		auto begin = std::chrono::steady_clock::now();
+		for (uint32_t frame = 0; frame < kPoseFrames; ++frame) {
+			for (uint32_t i = 0; i < characterCount; ++i) {
+				LegacyUpdate(
+					skeleton, animation, timeOf(characters[i], frame),
+					&legacyBones[static_cast<size_t>(i) * kMaxBones]
+				);
+			}
+		}
+		const double legacyMs = ElapsedMs(begin) / kPoseFrames;
+
+		// FlatSkeleton + AnimationClip
+		begin = std::chrono::steady_clock::now();
+		for (uint32_t frame = 0; frame < kPoseFrames; ++frame) {
+			for (Character& character : characters) {
+				flat.SampleLocalPose(
+					clip, binding, timeOf(character, frame), character.cursor,
+					character.local.data()
+				);
+				flat.LocalToModel(character.local.data(), character.model.data());
+				flat.WriteSkinMatrices(
+					character.model.data(), character.bones.data(), kMaxBones
+				);
+			}
+		}
+		const double flatMs = ElapsedMs(begin) / kPoseFrames;
+
+		// 最後のフレームを旧実装と比べる。クリップの量子化の分はずれるので参考値
+		float clipError = 0.0f;
+		for (uint32_t i = 0; i < characterCount; ++i) {
+			clipError = std::max(
+				clipError,
+				MaxError(
+					characters[i].bones.data(),
+					&legacyBones[static_cast<size_t>(i) * kMaxBones],
+					kMaxBones
+				)
+			);
+		}
+
+		// 同じローカルの姿勢(キーフレームから直接サンプルしたもの)なら旧実装と一致するか
+		std::vector<const NodeAnimation*> nodeAnims(flat.JointCount(), nullptr);
+		for (uint32_t joint = 0; joint < flat.JointCount(); ++joint) {
+			if (const auto it = animation.nodeAnimations.find(flat.JointName(joint));
+				it != animation.nodeAnimations.end()) {
+				nodeAnims[joint] = &it->second;
+			}
+		}
+		float poseError = 0.0f;
+		{
+			const Character&       character = characters.front();
+			const float            time      = timeOf(character, kPoseFrames - 1);
+			std::vector<JointPose> local     = flat.BindPose();
+			for (uint32_t joint = 0; joint < flat.JointCount(); ++joint) {
+				if (const NodeAnimation* node = nodeAnims[joint]) {
+					local[joint] = {
+						CalculateValue(node->translate.keyFrames, time),
+						CalculateValue(node->rotate.keyFrames, time).Normalized(),
+						CalculateValue(node->scale.keyFrames, time)
+					};
+				}
+			}
+			std::vector<Mat4> model(flat.JointCount());
+			std::vector<Mat4> bones(kMaxBones, Mat4::identity);
+			flat.LocalToModel(local.data(), model.data());
+			flat.WriteSkinMatrices(model.data(), bones.data(), kMaxBones);
+			poseError = MaxError(bones.data(), legacyBones.data(), kMaxBones);
+		}
+
+		Msg(
+			kChannel,
+			"[{} characters, {} joints, {} bones] legacy {:.3f} ms/frame, "
+			"flat {:.3f} ms/frame ({:.1f}x, {:.2f} us/character)",
+			characterCount, flat.JointCount(), flat.BoneCount(),
+			legacyMs, flatMs, legacyMs / std::max(flatMs, 1e-6),
+			flatMs * 1000.0 / characterCount
+		);
+		Msg(
+			kChannel,
+			"max bone matrix error: same pose {:.2e}, compressed clip {:.2e}",
+			poseError, clipError
+		);
+
+		if (poseError > kPoseTolerance) {
+			Warning(kChannel, "skeleton pose FAILED: bone matrices differ");
+			return false;
+		}
+		return true;
+	}
+
+	bool RunBlendGraph(const uint32_t characterCount) {
+		std::mt19937       rng(kSeed);
+		const Skeleton     skeleton = MakeSkeleton(rng);
+		const FlatSkeleton flat(skeleton);
+
+		const AnimationClip idle(MakePoseAnimation(rng));
+		const AnimationClip walk(MakePoseAnimation(rng));
+		const AnimationClip run(MakePoseAnimation(rng));
+		const AnimationClip breath(MakePoseAnimation(rng));
+		const AnimationClip wave(MakePoseAnimation(rng));
+		const AnimationClip bind(MakeBindAnimation(flat));
+
+		// 移動の Blend1D に呼吸を加算し、上半身だけ手を振るクリップで置き換える
+		AnimationGraph graph(flat);
+		const uint32_t speed       = graph.AddParameter("speed");
+		const uint32_t breathing   = graph.AddParameter("breath", 0.5f);
+		const uint32_t waving      = graph.AddParameter("wave");
+		const uint32_t upperBody   = graph.AddMask(std::format("joint_{:03}", kUpperBodyJoint));
+		const auto     locomotion  = graph.AddBlend1D(
+			speed,
+			{
+				{0.0f, graph.AddClip(idle)},
+				{1.0f, graph.AddClip(walk)},
+				{2.0f, graph.AddClip(run)},
+			}
+		);
+		const auto withBreath = graph.AddAdditive(locomotion, graph.AddClip(breath), breathing);
+		graph.SetRoot(graph.AddLayer(withBreath, graph.AddClip(wave), upperBody, waving));
+
+		bool ok = true;
+		const auto check = [&](const char* what, const float error, const float tolerance) {
+			if (error > tolerance) {
+				Warning(kChannel, "blend graph FAILED: {} (error {:.2e})", what, error);
+				ok = false;
+			}
+		};
+
+		// 入力1つだけの時(閾値ちょうど、範囲外)はクリップをそのままサンプルしたものと同じ
+		const std::vector<JointPose> idlePose = SampleDirect(flat, idle, kCheckTime);
+		const std::vector<JointPose> walkPose = SampleDirect(flat, walk, kCheckTime);
+		const std::vector<JointPose> runPose  = SampleDirect(flat, run, kCheckTime);
+		const std::vector<JointPose> wavePose = SampleDirect(flat, wave, kCheckTime);
+		const auto evaluate = [&](const float speedValue, const float breathValue, const float waveValue) {
+			AnimationGraphInstance instance(graph);
+			instance.SetParameter(speed, speedValue);
+			instance.SetParameter(breathing, breathValue);
+			instance.SetParameter(waving, waveValue);
+			instance.Update(kCheckTime);
+			return instance.LocalPose();
+		};
+		check("walk at its threshold", MaxDifference(evaluate(1.0f, 0.0f, 0.0f), walkPose), 0.0f);
+		check("speed below the range", MaxDifference(evaluate(-1.0f, 0.0f, 0.0f), idlePose), 0.0f);
+		check("speed above the range", MaxDifference(evaluate(5.0f, 0.0f, 0.0f), runPose), 0.0f);
+
+		// 中間では移動は平均、回転は両方から同じ角度になる
+		{
+			const std::vector<JointPose> half  = evaluate(1.5f, 0.0f, 0.0f);
+			float                        error = 0.0f;
+			for (uint32_t joint = 0; joint < flat.JointCount(); ++joint) {
+				const Vec3 mid = (walkPose[joint].translate + runPose[joint].translate) * 0.5f;
+				error          = std::max({
+					error,
+					MaxDifference(half[joint].translate, mid),
+					std::abs(
+						AngleDegrees(half[joint].rotate, walkPose[joint].rotate) -
+						AngleDegrees(half[joint].rotate, runPose[joint].rotate)
+					) * Math::deg2Rad
+				});
+			}
+			check("halfway between walk and run", error, kBlendTolerance);
+		}
+
+		// 上半身だけ置き換わり、それ以外は元のまま
+		{
+			const std::vector<JointPose> base    = evaluate(1.0f, 0.0f, 0.0f);
+			const std::vector<JointPose> layered = evaluate(1.0f, 0.0f, 1.0f);
+			const uint32_t               root    = flat.FindJoint(
+				std::format("joint_{:03}", kUpperBodyJoint)
+			);
+			std::vector<bool> upper(flat.JointCount(), false);
+			float             inside  = 0.0f;
+			float             outside = 0.0f;
+			for (uint32_t joint = 0; joint < flat.JointCount(); ++joint) {
+				const int32_t parent = flat.Parent(joint);
+				upper[joint]         = joint == root ||
+					(parent != FlatSkeleton::kNoParent && upper[parent]);
+				if (upper[joint]) {
+					inside = std::max(inside, MaxDifference(layered[joint], wavePose[joint]));
+				} else {
+					outside = std::max(outside, MaxDifference(layered[joint], base[joint]));
+				}
+			}
+			check("masked joints follow the layer", inside, kBlendTolerance);
+			check("joints outside the mask are untouched", outside, 0.0f);
+		}
+
+		// 初期姿勢のままのクリップを加算しても変わらない
+		{
+			AnimationGraph additive(flat);
+			additive.SetRoot(additive.AddAdditive(
+				additive.AddClip(walk), additive.AddClip(bind), AnimationGraph::kInvalidParameter
+			));
+			AnimationGraphInstance instance(additive);
+			instance.Update(kCheckTime);
+			check("adding the bind pose", MaxDifference(instance.LocalPose(), walkPose), kBlendTolerance);
+		}
+
+		// クロスフェード: 半分の時間で中間、最後で目標の値になる
+		{
+			AnimationGraphInstance instance(graph);
+			instance.FadeParameter(speed, 2.0f, kCrossfadeSeconds);
+			instance.Update(kCrossfadeSeconds * 0.5f);
+			check("crossfade halfway", std::abs(instance.Parameter(speed) - 1.0f), 1e-6f);
+			instance.Update(kCrossfadeSeconds);
+			check("crossfade end", std::abs(instance.Parameter(speed) - 2.0f), 0.0f);
+		}
+
+		// 1スレッドとジョブで同じ結果になるか
+		if (characterCount > 0) {
+			std::uniform_real_distribution<float> param(0.0f, 2.0f);
+			std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+			std::vector<AnimationGraphInstance>   serial;
+			serial.reserve(characterCount);
+			for (uint32_t i = 0; i < characterCount; ++i) {
+				AnimationGraphInstance& instance = serial.emplace_back(graph);
+				instance.SetParameter(speed, param(rng));
+				instance.SetParameter(breathing, unit(rng));
+				instance.SetParameter(waving, unit(rng) < 0.3f ? 1.0f : 0.0f);
+				instance.Update(unit(rng) * kPoseClipLength); // 再生位置をばらけさせる
+				if (i % 4 == 0) {
+					instance.FadeParameter(speed, param(rng), kCrossfadeSeconds);
+				}
+			}
+			std::vector<AnimationGraphInstance> parallel = serial;
+
+			std::vector<AnimationGraphInstance*> serialPtrs;
+			std::vector<AnimationGraphInstance*> parallelPtrs;
+			for (uint32_t i = 0; i < characterCount; ++i) {
+				serialPtrs.emplace_back(&serial[i]);
+				parallelPtrs.emplace_back(&parallel[i]);
+			}
+
+			const float step  = 1.0f / kPlaybackRate;
+			auto        begin = std::chrono::steady_clock::now();
+			for (uint32_t frame = 0; frame < kBlendFrames; ++frame) {
+				UpdateAnimationGraphs(serialPtrs.data(), characterCount, step);
+			}
+			const double serialMs = ElapsedMs(begin) / kBlendFrames;
+
+			JobSystem& jobs = JobSystem::Get();
+			begin           = std::chrono::steady_clock::now();
+			for (uint32_t frame = 0; frame < kBlendFrames; ++frame) {
+				UpdateAnimationGraphs(parallelPtrs.data(), characterCount, step, &jobs);
+			}
+			const double parallelMs = ElapsedMs(begin) / kBlendFrames;
+
+			float difference = 0.0f;
+			for (uint32_t i = 0; i < characterCount; ++i) {
+				difference = std::max(
+					difference,
+					MaxError(
+						serial[i].ModelPose().data(),
+						parallel[i].ModelPose().data(),
+						flat.JointCount()
+					)
+				);
+			}
+			check("serial and parallel updates match", difference, 0.0f);
+
+			Msg(
+				kChannel,
+				"[{} characters, {} nodes, {} scratch poses, {} lanes] serial {:.3f} ms/frame, "
+				"parallel {:.3f} ms/frame ({:.1f}x)",
+				characterCount, graph.NodeCount(), graph.ScratchPoseCount(), jobs.MaxLanes(),
+				serialMs, parallelMs, serialMs / std::max(parallelMs, 1e-6)
+			);
+		}
+
+		if (ok) {
+			Msg(kChannel, "blend graph checks passed");
+		}
+		return ok;
+	}
+
+	namespace {
+		constexpr uint32_t kSkinBones      = 64;
+		constexpr uint32_t kSkinIterations = 20;
+		constexpr float    kSkinTolerance  = 1e-4f;
+		constexpr float    kTwistTolerance = 1e-4f;
+
+		struct SkinTestMesh {
+			std::vector<Vec3>                    positions;
+			std::vector<Vec3>                    normals;
+			std::vector<Mat4>                    invBind;
+			std::vector<std::array<uint16_t, 4>> joints;
+			std::vector<std::array<float, 4>>    weights;
+
+			MeshStreamView View() const {
+				MeshStreamView view;
+				view.positions = positions;
+				view.normals   = normals;
+				view.invBind   = invBind;
+				view.joints    = joints;
+				view.weights   = weights;
+				return view;
+			}
+		};
+
+		SkinTestMesh MakeSkinMesh(std::mt19937& rng, const uint32_t vertexCount) {
+			std::uniform_real_distribution<float> pos(-1.0f, 1.0f);
+			std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+			std::uniform_int_distribution<int>    bone(0, static_cast<int>(kSkinBones) - 1);
+
+			SkinTestMesh mesh;
+			mesh.invBind.assign(kSkinBones, Mat4::identity);
+			mesh.positions.reserve(vertexCount);
+			mesh.normals.reserve(vertexCount);
+			mesh.joints.reserve(vertexCount);
+			mesh.weights.reserve(vertexCount);
+			for (uint32_t v = 0; v < vertexCount; ++v) {
+				mesh.positions.emplace_back(pos(rng), pos(rng), pos(rng));
+				mesh.normals.emplace_back(Vec3(pos(rng), pos(rng), pos(rng) + 2.0f).Normalized());
+
+				// 重みは足して1
+				std::array<float, 4> w   = {unit(rng), unit(rng), unit(rng), unit(rng)};
+				const float          sum = w[0] + w[1] + w[2] + w[3];
+				for (float& x : w) {
+					x /= sum;
+				}
+				mesh.weights.emplace_back(w);
+				mesh.joints.push_back({
+					static_cast<uint16_t>(bone(rng)), static_cast<uint16_t>(bone(rng)),
+					static_cast<uint16_t>(bone(rng)), static_cast<uint16_t>(bone(rng))
+				});
+			}
+			return mesh;
+		}
+
+		Mat4 MakeSkinMatrix(std::mt19937& rng) {
+			std::uniform_real_distribution<float> pos(-2.0f, 2.0f);
+			std::uniform_real_distribution<float> scale(0.8f, 1.2f);
+			const Quaternion rotate = Quaternion(
+				Vec3(pos(rng), pos(rng), pos(rng)).Normalized(), pos(rng)
+			).Normalized();
+
+			Mat4 m;
+			Math::ComposeLocal(
+				Vec3(pos(rng), pos(rng), pos(rng)), rotate,
+				Vec3(scale(rng), scale(rng), scale(rng)), m.m
+			);
+			return m;
+		}
+
+		// 参照用のスカラー実装
+		void SkinLinearReference(
+			const MeshStreamView& streams,
+			const Mat4*           skinMatrices,
+			Vec3*                 outPositions,
+			Vec3*                 outNormals
+		) {
+			for (size_t v = 0; v < streams.positions.size(); ++v) {
+				float m[4][4] = {};
+				for (int i = 0; i < 4; ++i) {
+					const Mat4& bone = skinMatrices[streams.joints[v][i]];
+					for (int row = 0; row < 4; ++row) {
+						for (int col = 0; col < 4; ++col) {
+							m[row][col] += streams.weights[v][i] * bone.m[row][col];
+						}
+					}
+				}
+				const Vec3& p = streams.positions[v];
+				const Vec3& n = streams.normals[v];
+				outPositions[v] = {
+					p.x * m[0][0] + p.y * m[1][0] + p.z * m[2][0] + m[3][0],
+					p.x * m[0][1] + p.y * m[1][1] + p.z * m[2][1] + m[3][1],
+					p.x * m[0][2] + p.y * m[1][2] + p.z * m[2][2] + m[3][2]
+				};
+				outNormals[v] = Vec3(
+					n.x * m[0][0] + n.y * m[1][0] + n.z * m[2][0],
+					n.x * m[0][1] + n.y * m[1][1] + n.z * m[2][1],
+					n.x * m[0][2] + n.y * m[1][2] + n.z * m[2][2]
+				).Normalized();
+			}
+		}
+
+		float MaxError(const std::vector<Vec3>& a, const std::vector<Vec3>& b) {
+			float error = 0.0f;
+			for (size_t i = 0; i < a.size(); ++i) {
+				error = std::max(error, MaxDifference(a[i], b[i]));
+			}
+			return error;
+		}
+
+		double VerticesPerSecond(const uint32_t vertexCount, const double ms) {
+			return static_cast<double>(vertexCount) * kSkinIterations / std::max(ms, 1e-6) * 1000.0;
+		}
+	}
+
+	bool RunSkinning(const uint32_t vertexCount) {
+		std::mt19937       rng(kSeed);
+		const SkinTestMesh mesh  = MakeSkinMesh(rng, std::max(vertexCount, 1u));
+		const auto         view  = mesh.View();
+		const uint32_t     count = static_cast<uint32_t>(mesh.positions.size());
+
+		std::vector<Mat4> skinMatrices;
+		for (uint32_t i = 0; i < kSkinBones; ++i) {
+			skinMatrices.emplace_back(MakeSkinMatrix(rng));
+		}
+
+		bool ok = true;
+		const auto check = [&](const char* what, const float error, const float tolerance) {
+			if (error > tolerance) {
+				Warning(kChannel, "skinning FAILED: {} (error {:.2e})", what, error);
+				ok = false;
+			}
+		};
+
+		std::vector<Vec3> referencePos(count), referenceNrm(count);
+		std::vector<Vec3> linearPos(count), linearNrm(count);
+		std::vector<Vec3> parallelPos(count), parallelNrm(count);
+		std::vector<Vec3> dqPos(count), dqNrm(count);
+		std::vector<Vec3> dqParallelPos(count), dqParallelNrm(count);
+
+		// 行列が足りなければ何もしない
+		if (SkinMesh(view, std::span(skinMatrices).first(1), SKINNING_MODE::LINEAR, linearPos.data(), nullptr)) {
+			Warning(kChannel, "skinning FAILED: accepted too few skin matrices");
+			ok = false;
+		}
+		auto shortNormals    = view;
+		shortNormals.normals = view.normals.first(count - 1);
+		if (count > 1 && SkinMesh(shortNormals, skinMatrices, SKINNING_MODE::LINEAR, linearPos.data(), linearNrm.data())) {
+			Warning(kChannel, "skinning FAILED: accepted too few normals");
+			ok = false;
+		}
+
+		JobSystem& jobs = JobSystem::Get();
+
+		const auto time = [&](auto&& body) {
+			const auto begin = std::chrono::steady_clock::now();
+			for (uint32_t i = 0; i < kSkinIterations; ++i) {
+				body();
+			}
+			return ElapsedMs(begin);
+		};
+		const double referenceMs = time([&] {
+			SkinLinearReference(view, skinMatrices.data(), referencePos.data(), referenceNrm.data());
+		});
+		const double linearMs = time([&] {
+			SkinMesh(view, skinMatrices, SKINNING_MODE::LINEAR, linearPos.data(), linearNrm.data());
+		});
+		const double parallelMs = time([&] {
+			SkinMesh(view, skinMatrices, SKINNING_MODE::LINEAR, parallelPos.data(), parallelNrm.data(), &jobs);
+		});
+		const double dqMs = time([&] {
+			SkinMesh(view, skinMatrices, SKINNING_MODE::DUAL_QUATERNION, dqPos.data(), dqNrm.data());
+		});
+		const double dqParallelMs = time([&] {
+			SkinMesh(view, skinMatrices, SKINNING_MODE::DUAL_QUATERNION, dqParallelPos.data(), dqParallelNrm.data(), &jobs);
+		});
+
+		check("SIMD positions match the reference", MaxError(linearPos, referencePos), kSkinTolerance);
+		check("SIMD normals match the reference", MaxError(linearNrm, referenceNrm), kSkinTolerance);
+		check("serial and parallel linear skinning match",
+		      std::max(MaxError(linearPos, parallelPos), MaxError(linearNrm, parallelNrm)), 0.0f);
+		check("serial and parallel dual quaternion skinning match",
+		      std::max(MaxError(dqPos, dqParallelPos), MaxError(dqNrm, dqParallelNrm)), 0.0f);
+
+		// 重み1本なら補間しないので、どちらのモードも行列そのままの結果になる
+		{
+			SkinTestMesh single = mesh;
+			for (uint32_t v = 0; v < count; ++v) {
+				single.weights[v] = {1.0f, 0.0f, 0.0f, 0.0f};
+			}
+			const auto        singleView = single.View();
+			std::vector<Vec3> lbs(count);
+			std::vector<Vec3> lbsNrm(count);
+			std::vector<Vec3> dq(count);
+			std::vector<Vec3> dqNrmSingle(count);
+			SkinMesh(singleView, skinMatrices, SKINNING_MODE::LINEAR, lbs.data(), lbsNrm.data());
+			SkinMesh(singleView, skinMatrices, SKINNING_MODE::DUAL_QUATERNION, dq.data(), dqNrmSingle.data());
+			check("single-bone vertices match in both modes", MaxError(lbs, dq), kSkinTolerance);
+			check("single-bone normals match in both modes", MaxError(lbsNrm, dqNrmSingle), kSkinTolerance);
+		}
+
+		// X軸回りに180度ひねった関節の真ん中(重み半々)。線形だと潰れて軸に寄るが、
+		// デュアルクォータニオンなら半径1のまま90度回ったところに来る
+		{
+			SkinTestMesh twist;
+			twist.invBind.assign(2, Mat4::identity);
+			twist.positions = {Vec3(0.0f, 1.0f, 0.0f)};
+			twist.normals   = {Vec3(0.0f, 1.0f, 0.0f)};
+			twist.joints    = {{0, 1, 0, 0}};
+			twist.weights   = {{0.5f, 0.5f, 0.0f, 0.0f}};
+
+			std::vector<Mat4> bones(2, Mat4::identity);
+			Math::ComposeLocal(
+				Vec3::zero, Quaternion(Vec3(1.0f, 0.0f, 0.0f), Math::pi), Vec3::one, bones[1].m
+			);
+
+			Vec3 lbs;
+			Vec3 dq;
+			SkinMesh(twist.View(), bones, SKINNING_MODE::LINEAR, &lbs, nullptr);
+			SkinMesh(twist.View(), bones, SKINNING_MODE::DUAL_QUATERNION, &dq, nullptr);
+			const float dqRadius  = std::sqrt(dq.y * dq.y + dq.z * dq.z);
+			const float lbsRadius = std::sqrt(lbs.y * lbs.y + lbs.z * lbs.z);
+			check("dual quaternion keeps the radius of a twisted joint", std::abs(dqRadius - 1.0f), kTwistTolerance);
+			check("dual quaternion rotates a twisted joint by half", std::abs(dq.y), kTwistTolerance);
+			Msg(kChannel, "180 degree twist at 0.5/0.5: linear radius {:.3f}, dual quaternion radius {:.3f}", lbsRadius, dqRadius);
+		}
+
+		Msg(
+			kChannel,
+			"[{} vertices, {} bones, {} lanes] reference {:.1f} Mverts/s, SIMD {:.1f} Mverts/s, "
+			"SIMD parallel {:.1f} Mverts/s, dual quaternion {:.1f} Mverts/s, "
+			"dual quaternion parallel {:.1f} Mverts/s",
+			count, kSkinBones, jobs.MaxLanes(),
+			VerticesPerSecond(count, referenceMs) / 1e6, VerticesPerSecond(count, linearMs) / 1e6,
+			VerticesPerSecond(count, parallelMs) / 1e6, VerticesPerSecond(count, dqMs) / 1e6,
+			VerticesPerSecond(count, dqParallelMs) / 1e6
+		);
+
+		if (ok) {
+			Msg(kChannel, "skinning checks passed");
+		}
+		return ok;
+	}
+}
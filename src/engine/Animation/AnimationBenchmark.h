@@ -0,0 +1,32 @@
+﻿#pragma once
+#include <cstdint>
+
+namespace Unnamed::AnimationBenchmark {
+	// boneCount 本のボーンを持つ seconds 秒のクリップ(30Hzで焼いたキー)を作り、
+	// 60fpsで頭から最後まで再生した時のサンプルのコストを、旧実装(キーを先頭からなめる)、
+	// 二分探索の CalculateValue、AnimationClip(カーソルあり/なし)で比べてログに出します。
+	// キー数とメモリ、旧実装との誤差も出し、カーソルの有無やループ・シークで結果が変わらないか確認します
+	// @return 誤差が許容内で、カーソルの有無で結果が一致したらtrue
+	bool RunClipSampling(uint32_t boneCount, float seconds);
+
+	// characterCount 体のキャラクター(100ジョイントのスケルトン)のボーン行列を、
+	// 旧実装(ノードを再帰してノード名で std::map を引き、256本を毎回初期化)と
+	// FlatSkeleton + AnimationClip で毎フレーム求めるコストを比べてログに出します。
+	// 同じローカルの姿勢からは旧実装と同じボーン行列になるかも確認します
+	// @return 一致したらtrue
+	bool RunSkeletonPose(uint32_t characterCount);
+
+	// 歩き/走りの Blend1D、呼吸の加算、上半身のレイヤーを持つブレンドグラフで、
+	// 閾値ちょうどや中間での補間、差分0の加算、マスク外のジョイント、パラメーターのフェードが
+	// 期待通りになるかを確認します。characterCount 体を1スレッドとジョブで Update し、
+	// 結果がビット単位で一致するかと、1フレームあたりの時間もログに出します
+	// @return 全て期待通りならtrue
+	bool RunBlendGraph(uint32_t characterCount);
+
+	// 64本のボーンに4本ずつ重みを振った vertexCount 頂点のメッシュを CPU でスキニングし、
+	// スカラーの参照実装、SIMD(1スレッド/ジョブ)、デュアルクォータニオンの頂点/秒をログに出します。
+	// SIMD と参照実装の誤差、重み1本の頂点で両モードが一致するか、180度ひねった関節で
+	// デュアルクォータニオンが痩せないか、1スレッドとジョブで結果がビット単位で一致するかも確認します
+	// @return 全て期待通りならtrue
+	bool RunSkinning(uint32_t vertexCount);
+}
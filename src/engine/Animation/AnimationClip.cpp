@@ -0,0 +1,620 @@
+﻿#include <engine/Animation/AnimationClip.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <engine/Animation/Animation.h>
+
+namespace {
+	constexpr float    kQuantizeMax   = 65535.0f;
+	constexpr uint32_t kMaxFrameCount = UINT16_MAX; // フレーム番号が16bitに収まる数
+	constexpr uint32_t kMaxKeySpan    = 64;         // キーを間引く時に1区間で飛ばせる最大フレーム数
+	constexpr uint32_t kMaxCursorStep = 4;          // これ以上先ならカーソルから二分探索に切り替える
+
+	uint32_t ComponentCount(const ANIMATION_TRACK kind) {
+		return kind == ANIMATION_TRACK::ROTATE ? 4u : 3u;
+	}
+
+	uint16_t Quantize(const float value01) {
+		const float q = std::round(std::clamp(value01, 0.0f, 1.0f) * kQuantizeMax);
+		return static_cast<uint16_t>(q);
+	}
+
+	float Dequantize(const uint16_t q) {
+		return static_cast<float>(q) * (1.0f / kQuantizeMax);
+	}
+
+	Quaternion Normalized(Quaternion q) {
+		const float len = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+		if (len > 0.0f) {
+			const float inv = 1.0f / len;
+			q.x *= inv;
+			q.y *= inv;
+			q.z *= inv;
+			q.w *= inv;
+		}
+		return q;
+	}
+
+	// キーは同じ半球に揃えてあるので符号は見ない
+	Quaternion NLerp(const Quaternion& a, const Quaternion& b, const float t) {
+		const float s = 1.0f - t;
+		return Normalized({
+			s * a.x + t * b.x,
+			s * a.y + t * b.y,
+			s * a.z + t * b.z,
+			s * a.w + t * b.w
+		});
+	}
+
+	template <class T>
+	void AppendPod(std::vector<uint8_t>& out, const T* data, const size_t count) {
+		const auto bytes = reinterpret_cast<const uint8_t*>(data);
+		out.insert(out.end(), bytes, bytes + sizeof(T) * count);
+	}
+
+	template <class T>
+	bool ReadPod(std::span<const uint8_t>& data, T* out, const size_t count) {
+		if (count > data.size() / sizeof(T)) {
+			return false;
+		}
+		const size_t bytes = sizeof(T) * count;
+		if (bytes > 0) {
+			std::memcpy(out, data.data(), bytes);
+		}
+		data = data.subspan(bytes);
+		return true;
+	}
+
+	// 量子化して戻した値 decoded の a と b の間を補間して、元の値 samples が誤差内に収まるか
+	bool IsSpanWithinTolerance(
+		const std::vector<float>& samples,
+		const std::vector<float>& decoded,
+		const uint32_t            components,
+		const uint32_t            a,
+		const uint32_t            b,
+		const float               tolerance
+	) {
+		const float* va  = &decoded[a * components];
+		const float* vb  = &decoded[b * components];
+		const float  inv = 1.0f / static_cast<float>(b - a);
+		for (uint32_t i = a + 1; i < b; ++i) {
+			const float  t      = static_cast<float>(i - a) * inv;
+			const float* source = &samples[i * components];
+			if (components == 4) {
+				const Quaternion q = NLerp(
+					{va[0], va[1], va[2], va[3]},
+					{vb[0], vb[1], vb[2], vb[3]},
+					t
+				);
+				if (std::abs(q.x - source[0]) > tolerance ||
+					std::abs(q.y - source[1]) > tolerance ||
+					std::abs(q.z - source[2]) > tolerance ||
+					std::abs(q.w - source[3]) > tolerance) {
+					return false;
+				}
+			} else {
+				for (uint32_t c = 0; c < components; ++c) {
+					const float v = va[c] + (vb[c] - va[c]) * t;
+					if (std::abs(v - source[c]) > tolerance) {
+						return false;
+					}
+				}
+			}
+		}
+		return true;
+	}
+}
+
+AnimationClipCursor::AnimationClipCursor(const AnimationClip& clip) {
+	Reset(clip);
+}
+
+void AnimationClipCursor::Reset(const AnimationClip& clip) {
+	mKeys.assign(
+		static_cast<size_t>(clip.ChannelCount()) * kAnimationTrackCount,
+		0
+	);
+}
+
+AnimationClip::AnimationClip(const Animation& animation)
+	: AnimationClip(animation, Settings()) {
+}
+
+AnimationClip::AnimationClip(
+	const Animation& animation,
+	const Settings&  settings
+) {
+	mDuration = std::max(animation.duration, 0.0f);
+
+	// 尺がちょうど最後のフレームになるようにフレーム数を決め、レートの方を合わせる
+	const float rate   = std::max(settings.sampleRate, 1.0f);
+	const float frames = std::ceil(mDuration * rate - 1e-3f);
+	mFrameCount        = std::clamp(
+		static_cast<uint32_t>(std::max(frames, 0.0f)) + 1,
+		1u,
+		kMaxFrameCount
+	);
+	mSampleRate = mFrameCount > 1 ?
+		              static_cast<float>(mFrameCount - 1) / mDuration :
+		              0.0f;
+
+	const size_t channelCount = animation.nodeAnimations.size();
+	mChannelNames.reserve(channelCount);
+	mChannelLookup.reserve(channelCount);
+	mTracks.resize(channelCount * kAnimationTrackCount);
+
+	std::vector<float> samples;
+	for (const auto& [name, nodeAnim] : animation.nodeAnimations) {
+		const uint32_t channel = static_cast<uint32_t>(mChannelNames.size());
+		mChannelNames.emplace_back(name);
+		mChannelLookup.emplace(name, channel);
+
+		const auto timeOf = [&](const uint32_t frame) {
+			return frame + 1 == mFrameCount ?
+				       mDuration :
+				       static_cast<float>(frame) / mSampleRate;
+		};
+
+		// 移動とスケール。キーが無いチャンネルは初期値で埋める
+		const auto buildVec3 = [&](
+			const ANIMATION_TRACK            kind,
+			const std::vector<KeyframeVec3>& keys,
+			const Vec3&                      fallback,
+			const float                      tolerance
+		) {
+			samples.resize(static_cast<size_t>(mFrameCount) * 3);
+			for (uint32_t f = 0; f < mFrameCount; ++f) {
+				const Vec3 v = keys.empty() ?
+					               fallback :
+					               CalculateValue(keys, timeOf(f));
+				samples[f * 3 + 0] = v.x;
+				samples[f * 3 + 1] = v.y;
+				samples[f * 3 + 2] = v.z;
+			}
+			BuildTrack(
+				kind, samples, tolerance,
+				mTracks[channel * kAnimationTrackCount + static_cast<uint32_t>(kind)]
+			);
+		};
+
+		buildVec3(
+			ANIMATION_TRACK::TRANSLATE,
+			nodeAnim.translate.keyFrames,
+			Vec3::zero,
+			settings.translateTolerance
+		);
+		buildVec3(
+			ANIMATION_TRACK::SCALE,
+			nodeAnim.scale.keyFrames,
+			Vec3::one,
+			settings.scaleTolerance
+		);
+
+		// 回転は隣のフレームと同じ半球に揃えてから量子化し、実行時の符号チェックを省く
+		samples.resize(static_cast<size_t>(mFrameCount) * 4);
+		Quaternion prev = Quaternion::identity;
+		for (uint32_t f = 0; f < mFrameCount; ++f) {
+			Quaternion q = nodeAnim.rotate.keyFrames.empty() ?
+				               Quaternion::identity :
+				               CalculateValue(nodeAnim.rotate.keyFrames, timeOf(f)).Normalized();
+			if (f > 0 &&
+				prev.x * q.x + prev.y * q.y + prev.z * q.z + prev.w * q.w < 0.0f) {
+				q = {-q.x, -q.y, -q.z, -q.w};
+			}
+			samples[f * 4 + 0] = q.x;
+			samples[f * 4 + 1] = q.y;
+			samples[f * 4 + 2] = q.z;
+			samples[f * 4 + 3] = q.w;
+			prev               = q;
+		}
+		BuildTrack(
+			ANIMATION_TRACK::ROTATE, samples, settings.rotateTolerance,
+			mTracks[channel * kAnimationTrackCount +
+				static_cast<uint32_t>(ANIMATION_TRACK::ROTATE)]
+		);
+	}
+
+	mFrames.shrink_to_fit();
+	mValues.shrink_to_fit();
+}
+
+const std::string& AnimationClip::ChannelName(const uint32_t channel) const {
+	return mChannelNames[channel];
+}
+
+uint32_t AnimationClip::FindChannel(const std::string_view name) const {
+	const auto it = mChannelLookup.find(std::string(name));
+	return it != mChannelLookup.end() ? it->second : kInvalidChannel;
+}
+
+size_t AnimationClip::MemoryBytes() const {
+	size_t bytes = sizeof(*this);
+	bytes += mTracks.capacity() * sizeof(Track);
+	bytes += mFrames.capacity() * sizeof(uint16_t);
+	bytes += mValues.capacity() * sizeof(uint16_t);
+	for (const std::string& name : mChannelNames) {
+		bytes += sizeof(std::string) + name.capacity();
+	}
+	return bytes;
+}
+
+void AnimationClip::Serialize(std::vector<uint8_t>& out) const {
+	const uint32_t counts[] = {
+		mFrameCount,
+		ChannelCount(),
+		static_cast<uint32_t>(mFrames.size()),
+		static_cast<uint32_t>(mValues.size()),
+	};
+	AppendPod(out, counts, std::size(counts));
+	AppendPod(out, &mDuration, 1);
+	AppendPod(out, &mSampleRate, 1);
+
+	for (const std::string& name : mChannelNames) {
+		const auto length = static_cast<uint32_t>(name.size());
+		AppendPod(out, &length, 1);
+		AppendPod(out, name.data(), name.size());
+	}
+
+	// パディングを書かないよう、トラックはメンバーごとに詰める
+	for (const Track& track : mTracks) {
+		AppendPod(out, &track.firstKey, 1);
+		AppendPod(out, &track.firstValue, 1);
+		AppendPod(out, &track.keyCount, 1);
+		AppendPod(out, &track.min.x, 3);
+		AppendPod(out, &track.extent.x, 3);
+	}
+
+	AppendPod(out, mFrames.data(), mFrames.size());
+	AppendPod(out, mValues.data(), mValues.size());
+}
+
+bool AnimationClip::Deserialize(std::span<const uint8_t>& data) {
+	std::span<const uint8_t> in = data;
+	AnimationClip            clip;
+
+	uint32_t counts[4];
+	if (!ReadPod(in, counts, std::size(counts)) ||
+		!ReadPod(in, &clip.mDuration, 1) ||
+		!ReadPod(in, &clip.mSampleRate, 1)) {
+		return false;
+	}
+	const uint32_t channelCount = counts[1];
+	clip.mFrameCount            = counts[0];
+	if (clip.mFrameCount == 0 || clip.mFrameCount > kMaxFrameCount ||
+		!(clip.mDuration >= 0.0f) || !(clip.mSampleRate >= 0.0f) ||
+		channelCount > in.size()) {
+		return false;
+	}
+
+	clip.mChannelNames.resize(channelCount);
+	clip.mChannelLookup.reserve(channelCount);
+	for (uint32_t channel = 0; channel < channelCount; ++channel) {
+		uint32_t length;
+		if (!ReadPod(in, &length, 1) || length > in.size()) {
+			return false;
+		}
+		std::string& name = clip.mChannelNames[channel];
+		name.resize(length);
+		ReadPod(in, name.data(), length);
+		clip.mChannelLookup.emplace(name, channel);
+	}
+
+	clip.mTracks.resize(static_cast<size_t>(channelCount) * kAnimationTrackCount);
+	for (Track& track : clip.mTracks) {
+		if (!ReadPod(in, &track.firstKey, 1) ||
+			!ReadPod(in, &track.firstValue, 1) ||
+			!ReadPod(in, &track.keyCount, 1) ||
+			!ReadPod(in, &track.min.x, 3) ||
+			!ReadPod(in, &track.extent.x, 3)) {
+			return false;
+		}
+	}
+
+	clip.mFrames.resize(counts[2]);
+	clip.mValues.resize(counts[3]);
+	if (!ReadPod(in, clip.mFrames.data(), clip.mFrames.size()) ||
+		!ReadPod(in, clip.mValues.data(), clip.mValues.size())) {
+		return false;
+	}
+
+	// サンプル時は範囲を確認しないので、ここで全トラックのキーが収まっているか、
+	// キーがフレーム0から昇順に並んでいるか(FindSpan の前提)を見ておく
+	for (size_t i = 0; i < clip.mTracks.size(); ++i) {
+		const Track&   track = clip.mTracks[i];
+		const auto     kind  = static_cast<ANIMATION_TRACK>(i % kAnimationTrackCount);
+		const uint64_t keys  = track.keyCount;
+		if (keys == 0 ||
+			track.firstKey + keys > clip.mFrames.size() ||
+			track.firstValue + keys * ComponentCount(kind) > clip.mValues.size()) {
+			return false;
+		}
+		const uint16_t* frames = clip.mFrames.data() + track.firstKey;
+		if (frames[0] != 0 || frames[keys - 1] >= clip.mFrameCount) {
+			return false;
+		}
+		for (uint64_t key = 1; key < keys; ++key) {
+			if (frames[key] <= frames[key - 1]) {
+				return false;
+			}
+		}
+	}
+
+	*this = std::move(clip);
+	data  = in;
+	return true;
+}
+
+Vec3 AnimationClip::SampleTranslate(
+	const uint32_t       channel,
+	const float          time,
+	AnimationClipCursor& cursor
+) const {
+	const uint32_t track = channel * kAnimationTrackCount +
+		static_cast<uint32_t>(ANIMATION_TRACK::TRANSLATE);
+	return SampleVec3(mTracks[track], FrameOf(time), &cursor.mKeys[track]);
+}
+
+Quaternion AnimationClip::SampleRotate(
+	const uint32_t       channel,
+	const float          time,
+	AnimationClipCursor& cursor
+) const {
+	const uint32_t track = channel * kAnimationTrackCount +
+		static_cast<uint32_t>(ANIMATION_TRACK::ROTATE);
+	return SampleRotateTrack(mTracks[track], FrameOf(time), &cursor.mKeys[track]);
+}
+
+Vec3 AnimationClip::SampleScale(
+	const uint32_t       channel,
+	const float          time,
+	AnimationClipCursor& cursor
+) const {
+	const uint32_t track = channel * kAnimationTrackCount +
+		static_cast<uint32_t>(ANIMATION_TRACK::SCALE);
+	return SampleVec3(mTracks[track], FrameOf(time), &cursor.mKeys[track]);
+}
+
+void AnimationClip::Sample(
+	const uint32_t       channel,
+	const float          time,
+	AnimationClipCursor& cursor,
+	Vec3&                outTranslate,
+	Quaternion&          outRotate,
+	Vec3&                outScale
+) const {
+	const float    frame = FrameOf(time);
+	const uint32_t base  = channel * kAnimationTrackCount;
+	uint16_t*      keys  = cursor.mKeys.data() + base;
+
+	outTranslate = SampleVec3(
+		mTracks[base + static_cast<uint32_t>(ANIMATION_TRACK::TRANSLATE)],
+		frame,
+		keys + static_cast<uint32_t>(ANIMATION_TRACK::TRANSLATE)
+	);
+	outRotate = SampleRotateTrack(
+		mTracks[base + static_cast<uint32_t>(ANIMATION_TRACK::ROTATE)],
+		frame,
+		keys + static_cast<uint32_t>(ANIMATION_TRACK::ROTATE)
+	);
+	outScale = SampleVec3(
+		mTracks[base + static_cast<uint32_t>(ANIMATION_TRACK::SCALE)],
+		frame,
+		keys + static_cast<uint32_t>(ANIMATION_TRACK::SCALE)
+	);
+}
+
+void AnimationClip::Sample(
+	const uint32_t channel,
+	const float    time,
+	Vec3&          outTranslate,
+	Quaternion&    outRotate,
+	Vec3&          outScale
+) const {
+	const float frame = FrameOf(time);
+	outTranslate      = SampleVec3(
+		TrackOf(channel, ANIMATION_TRACK::TRANSLATE), frame, nullptr
+	);
+	outRotate = SampleRotateTrack(
+		TrackOf(channel, ANIMATION_TRACK::ROTATE), frame, nullptr
+	);
+	outScale = SampleVec3(
+		TrackOf(channel, ANIMATION_TRACK::SCALE), frame, nullptr
+	);
+}
+
+const AnimationClip::Track& AnimationClip::TrackOf(
+	const uint32_t        channel,
+	const ANIMATION_TRACK kind
+) const {
+	return mTracks[channel * kAnimationTrackCount + static_cast<uint32_t>(kind)];
+}
+
+float AnimationClip::FrameOf(const float time) const {
+	return std::clamp(
+		time * mSampleRate,
+		0.0f,
+		static_cast<float>(mFrameCount - 1)
+	);
+}
+
+AnimationClip::KeySpan AnimationClip::FindSpan(
+	const Track&    track,
+	const float     frame,
+	uint16_t* const cursor
+) const {
+	const uint32_t count = track.keyCount;
+	if (count <= 1) {
+		return {0, 0, 0.0f};
+	}
+
+	// 最初のキーは必ずフレーム0なので、frame >= 0 なら key は先頭以降にある
+	const uint16_t* frames = mFrames.data() + track.firstKey;
+	uint32_t        key    = 0;
+	bool            found  = false;
+	if (cursor && *cursor < count && frames[*cursor] <= frame) {
+		// 前回の位置から数キーだけ進める
+		key = *cursor;
+		for (uint32_t step = 0; step < kMaxCursorStep; ++step) {
+			if (key + 1 >= count || frame < frames[key + 1]) {
+				found = true;
+				break;
+			}
+			++key;
+		}
+	}
+	if (!found) {
+		const auto it = std::upper_bound(
+			frames + key, frames + count, frame,
+			[](const float f, const uint16_t k) {
+				return f < static_cast<float>(k);
+			}
+		);
+		key = static_cast<uint32_t>(it - frames) - 1;
+	}
+	if (cursor) {
+		*cursor = static_cast<uint16_t>(key);
+	}
+
+	if (key + 1 >= count) {
+		return {key, key, 0.0f};
+	}
+	const float f0 = frames[key];
+	const float f1 = frames[key + 1];
+	return {key, key + 1, (frame - f0) / (f1 - f0)};
+}
+
+Vec3 AnimationClip::DecodeVec3(const Track& track, const uint32_t key) const {
+	const uint16_t* q = mValues.data() + track.firstValue + key * 3;
+	return {
+		track.min.x + Dequantize(q[0]) * track.extent.x,
+		track.min.y + Dequantize(q[1]) * track.extent.y,
+		track.min.z + Dequantize(q[2]) * track.extent.z
+	};
+}
+
+Quaternion AnimationClip::DecodeRotate(const Track& track, const uint32_t key) const {
+	const uint16_t* q = mValues.data() + track.firstValue + key * 4;
+	return {
+		Dequantize(q[0]) * 2.0f - 1.0f,
+		Dequantize(q[1]) * 2.0f - 1.0f,
+		Dequantize(q[2]) * 2.0f - 1.0f,
+		Dequantize(q[3]) * 2.0f - 1.0f
+	};
+}
+
+Vec3 AnimationClip::SampleVec3(
+	const Track&    track,
+	const float     frame,
+	uint16_t* const cursor
+) const {
+	const KeySpan span = FindSpan(track, frame, cursor);
+	const Vec3    a    = DecodeVec3(track, span.key0);
+	if (span.key0 == span.key1) {
+		return a;
+	}
+	return Math::Lerp(a, DecodeVec3(track, span.key1), span.alpha);
+}
+
+Quaternion AnimationClip::SampleRotateTrack(
+	const Track&    track,
+	const float     frame,
+	uint16_t* const cursor
+) const {
+	const KeySpan    span = FindSpan(track, frame, cursor);
+	const Quaternion a    = DecodeRotate(track, span.key0);
+	if (span.key0 == span.key1) {
+		return Normalized(a);
+	}
+	return NLerp(a, DecodeRotate(track, span.key1), span.alpha);
+}
+
+void AnimationClip::BuildTrack(
+	const ANIMATION_TRACK     kind,
+	const std::vector<float>& samples,
+	const float               tolerance,
+	Track&                    outTrack
+) {
+	const uint32_t components = ComponentCount(kind);
+	const bool     isRotate   = kind == ANIMATION_TRACK::ROTATE;
+
+	// 量子化範囲
+	float minValue[3] = {0.0f, 0.0f, 0.0f};
+	float extent[3]   = {0.0f, 0.0f, 0.0f};
+	if (!isRotate) {
+		float maxValue[3];
+		for (uint32_t c = 0; c < 3; ++c) {
+			minValue[c] = maxValue[c] = samples[c];
+		}
+		for (uint32_t f = 1; f < mFrameCount; ++f) {
+			for (uint32_t c = 0; c < 3; ++c) {
+				minValue[c] = std::min(minValue[c], samples[f * 3 + c]);
+				maxValue[c] = std::max(maxValue[c], samples[f * 3 + c]);
+			}
+		}
+		for (uint32_t c = 0; c < 3; ++c) {
+			extent[c] = maxValue[c] - minValue[c];
+		}
+		outTrack.min    = {minValue[0], minValue[1], minValue[2]};
+		outTrack.extent = {extent[0], extent[1], extent[2]};
+	}
+
+	// 全フレームを量子化し、戻した値で間引きの誤差を測る
+	std::vector<uint16_t> quantized(samples.size());
+	std::vector<float>    decoded(samples.size());
+	for (uint32_t f = 0; f < mFrameCount; ++f) {
+		for (uint32_t c = 0; c < components; ++c) {
+			const size_t i = static_cast<size_t>(f) * components + c;
+			if (isRotate) {
+				quantized[i] = Quantize(samples[i] * 0.5f + 0.5f);
+				decoded[i]   = Dequantize(quantized[i]) * 2.0f - 1.0f;
+			} else if (extent[c] > 0.0f) {
+				quantized[i] = Quantize((samples[i] - minValue[c]) / extent[c]);
+				decoded[i]   = minValue[c] + Dequantize(quantized[i]) * extent[c];
+			} else {
+				quantized[i] = 0;
+				decoded[i]   = minValue[c];
+			}
+		}
+	}
+
+	// 残すキーを先頭から貪欲に選ぶ
+	std::vector<uint32_t> keys = {0};
+	bool                  constant = true;
+	for (uint32_t f = 1; f < mFrameCount && constant; ++f) {
+		for (uint32_t c = 0; c < components; ++c) {
+			if (std::abs(samples[f * components + c] - decoded[c]) > tolerance) {
+				constant = false;
+				break;
+			}
+		}
+	}
+	if (!constant) {
+		uint32_t start = 0;
+		while (start + 1 < mFrameCount) {
+			uint32_t end = start + 1;
+			const uint32_t last = std::min(start + kMaxKeySpan, mFrameCount - 1);
+			for (uint32_t candidate = end + 1; candidate <= last; ++candidate) {
+				if (!IsSpanWithinTolerance(
+					samples, decoded, components, start, candidate, tolerance
+				)) {
+					break;
+				}
+				end = candidate;
+			}
+			keys.emplace_back(end);
+			start = end;
+		}
+	}
+
+	outTrack.firstKey   = static_cast<uint32_t>(mFrames.size());
+	outTrack.firstValue = static_cast<uint32_t>(mValues.size());
+	outTrack.keyCount   = static_cast<uint16_t>(keys.size());
+	for (const uint32_t key : keys) {
+		mFrames.emplace_back(static_cast<uint16_t>(key));
+		for (uint32_t c = 0; c < components; ++c) {
+			mValues.emplace_back(quantized[key * components + c]);
+		}
+	}
+}
@@ -0,0 +1,158 @@
+﻿#pragma once
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <runtime/core/math/Math.h>
+
+struct Animation;
+class AnimationClip;
+
+enum class ANIMATION_TRACK : uint8_t {
+	TRANSLATE,
+	ROTATE,
+	SCALE,
+	COUNT,
+};
+
+constexpr uint32_t kAnimationTrackCount = static_cast<uint32_t>(
+	ANIMATION_TRACK::COUNT
+);
+
+// AnimationClip をサンプルする時の、トラックごとの前回のキー位置
+// 再生中は時刻が少しずつ進むので、前回の位置から前に進めるだけで済みます。
+// 時刻が戻った時(ループなど)だけ二分探索し直します
+class AnimationClipCursor {
+public:
+	AnimationClipCursor() = default;
+	explicit AnimationClipCursor(const AnimationClip& clip);
+
+	// クリップを差し替えた時や、シークした時に呼んでください
+	void Reset(const AnimationClip& clip);
+
+private:
+	friend class AnimationClip;
+	std::vector<uint16_t> mKeys;
+};
+
+// Animation を一様にリサンプルして量子化したクリップ
+// - 全チャンネルを同じフレームレートでサンプルし直し、キーはフレーム番号(16bit)で持ちます
+// - 回転は各成分を [-1, 1] の16bit、移動とスケールはトラックごとの範囲で16bitに量子化します
+// - 間のキーを線形補間で誤差内に再現できるものは捨てます。全フレーム同じ値ならキー1つです
+// - 回転の補間は nlerp です。キーの符号は前のキーと同じ半球に揃えてあります
+class AnimationClip {
+public:
+	static constexpr uint32_t kInvalidChannel = UINT32_MAX;
+
+	struct Settings {
+		float sampleRate = 30.0f; // 元のキーと同じレートにすると、キーの時刻ではずれません
+
+		// 再現できる誤差(成分ごとの差の絶対値)
+		float translateTolerance = 0.001f;
+		float rotateTolerance    = 0.0005f; // クォータニオンの成分。角度ならおよそ 0.06°
+		float scaleTolerance     = 0.001f;
+	};
+
+	AnimationClip() = default;
+	explicit AnimationClip(const Animation& animation);
+	AnimationClip(const Animation& animation, const Settings& settings);
+
+	[[nodiscard]] float    Duration() const { return mDuration; }
+	[[nodiscard]] float    SampleRate() const { return mSampleRate; }
+	[[nodiscard]] uint32_t FrameCount() const { return mFrameCount; }
+
+	// チャンネルは Animation::nodeAnimations のノード1つ分です
+	[[nodiscard]] uint32_t ChannelCount() const {
+		return static_cast<uint32_t>(mChannelNames.size());
+	}
+
+	[[nodiscard]] const std::string& ChannelName(uint32_t channel) const;
+
+	// 再生開始時などに一度だけ引いて、番号を持っておいてください
+	[[nodiscard]] uint32_t FindChannel(std::string_view name) const;
+
+	// 全トラックのキーの数
+	[[nodiscard]] size_t KeyCount() const { return mFrames.size(); }
+	[[nodiscard]] size_t MemoryBytes() const;
+
+	// 焼いたクリップ(.uanim)用のバイト列を out の末尾に追記します
+	void Serialize(std::vector<uint8_t>& out) const;
+
+	/// @brief Serialize したバイト列から読み戻します。読み戻したクリップは元と同じ値をサンプルします
+	/// @param data 読んだ分だけ先に進めます
+	/// @return 途中で切れている、キーの範囲が合わないなどで読めなければfalse(クリップは変わりません)
+	bool Deserialize(std::span<const uint8_t>& data);
+
+	// cursor を使って time の値を求めます。cursor はこのクリップで Reset したものを渡してください
+	Vec3 SampleTranslate(uint32_t channel, float time, AnimationClipCursor& cursor) const;
+	Quaternion SampleRotate(uint32_t channel, float time, AnimationClipCursor& cursor) const;
+	Vec3 SampleScale(uint32_t channel, float time, AnimationClipCursor& cursor) const;
+
+	void Sample(
+		uint32_t             channel,
+		float                time,
+		AnimationClipCursor& cursor,
+		Vec3&                outTranslate,
+		Quaternion&          outRotate,
+		Vec3&                outScale
+	) const;
+
+	// カーソルなし。毎回二分探索します
+	void Sample(
+		uint32_t    channel,
+		float       time,
+		Vec3&       outTranslate,
+		Quaternion& outRotate,
+		Vec3&       outScale
+	) const;
+
+private:
+	struct Track {
+		uint32_t firstKey   = 0; // mFrames のインデックス
+		uint32_t firstValue = 0; // mValues のインデックス
+		uint16_t keyCount   = 0;
+		Vec3     min;    // 移動とスケールの量子化範囲
+		Vec3     extent;
+	};
+
+	// 補間するキーの組
+	struct KeySpan {
+		uint32_t key0;
+		uint32_t key1;
+		float    alpha;
+	};
+
+	[[nodiscard]] const Track& TrackOf(uint32_t channel, ANIMATION_TRACK kind) const;
+	[[nodiscard]] float        FrameOf(float time) const;
+
+	KeySpan FindSpan(const Track& track, float frame, uint16_t* cursor) const;
+
+	Vec3       DecodeVec3(const Track& track, uint32_t key) const;
+	Quaternion DecodeRotate(const Track& track, uint32_t key) const;
+
+	Vec3       SampleVec3(const Track& track, float frame, uint16_t* cursor) const;
+	Quaternion SampleRotateTrack(const Track& track, float frame, uint16_t* cursor) const;
+
+	// samples はフレームごとの成分(回転は4、それ以外は3)を詰めたもの
+	void BuildTrack(
+		ANIMATION_TRACK           kind,
+		const std::vector<float>& samples,
+		float                     tolerance,
+		Track&                    outTrack
+	);
+
+private:
+	float    mDuration   = 0.0f;
+	float    mSampleRate = 0.0f; // 尺がフレームで割り切れるよう Settings から少しずらしたもの
+	uint32_t mFrameCount = 0;
+
+	std::vector<std::string>                  mChannelNames;
+	std::unordered_map<std::string, uint32_t> mChannelLookup;
+
+	std::vector<Track>    mTracks; // チャンネル * kAnimationTrackCount
+	std::vector<uint16_t> mFrames; // キーのフレーム番号
+	std::vector<uint16_t> mValues; // 移動とスケールは3成分、回転は4成分
+};
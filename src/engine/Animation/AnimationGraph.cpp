@@ -0,0 +1,355 @@
+﻿#include <engine/Animation/AnimationGraph.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <core/jobsystem/JobSystem.h>
+
+#include <engine/Animation/AnimationPose.h>
+
+namespace {
+	// これより少なければ1スレッドで回す
+	constexpr size_t kParallelThreshold = 32;
+	constexpr size_t kGrainSize         = 8;
+}
+
+const char* ToString(const ANIMATION_GRAPH_NODE e) {
+	switch (e) {
+	case ANIMATION_GRAPH_NODE::CLIP: return "CLIP";
+	case ANIMATION_GRAPH_NODE::BLEND_1D: return "BLEND_1D";
+	case ANIMATION_GRAPH_NODE::ADDITIVE: return "ADDITIVE";
+	case ANIMATION_GRAPH_NODE::LAYER: return "LAYER";
+	default: return "unknown";
+	}
+}
+
+AnimationGraph::AnimationGraph(const FlatSkeleton& skeleton)
+	: mSkeleton(&skeleton) {
+}
+
+uint32_t AnimationGraph::AddParameter(
+	const std::string_view name,
+	const float            defaultValue
+) {
+	mParameters.push_back({std::string(name), defaultValue});
+	return static_cast<uint32_t>(mParameters.size() - 1);
+}
+
+uint32_t AnimationGraph::FindParameter(const std::string_view name) const {
+	for (uint32_t i = 0; i < mParameters.size(); ++i) {
+		if (mParameters[i].name == name) {
+			return i;
+		}
+	}
+	return kInvalidParameter;
+}
+
+uint32_t AnimationGraph::AddMask(const std::string_view rootJoint, const float weight) {
+	const uint32_t root = mSkeleton->FindJoint(rootJoint);
+	if (root == FlatSkeleton::kInvalidJoint) {
+		return kInvalidMask;
+	}
+
+	// 親は子より前に並んでいるので、親が含まれていれば子も含める
+	const uint32_t     count = mSkeleton->JointCount();
+	std::vector<float> mask(count, 0.0f);
+	std::vector<bool>  inside(count, false);
+	for (uint32_t joint = root; joint < count; ++joint) {
+		const int32_t parent = mSkeleton->Parent(joint);
+		inside[joint]        = joint == root ||
+			(parent != FlatSkeleton::kNoParent && inside[parent]);
+		if (inside[joint]) {
+			mask[joint] = weight;
+		}
+	}
+	mMasks.emplace_back(std::move(mask));
+	return static_cast<uint32_t>(mMasks.size() - 1);
+}
+
+AnimationGraph::NodeIndex AnimationGraph::AddClip(
+	const AnimationClip& clip,
+	const float          speed,
+	const bool           loop
+) {
+	Node node;
+	node.type     = ANIMATION_GRAPH_NODE::CLIP;
+	node.clip     = &clip;
+	node.binding  = mSkeleton->Bind(clip);
+	node.clipSlot = mClipCount++;
+	node.speed    = speed;
+	node.loop     = loop;
+	return AddNode(std::move(node));
+}
+
+AnimationGraph::NodeIndex AnimationGraph::AddBlend1D(
+	const uint32_t          parameter,
+	std::vector<BlendPoint> inputs
+) {
+	if (inputs.empty()) {
+		return kInvalidNode;
+	}
+	Node node;
+	node.type   = ANIMATION_GRAPH_NODE::BLEND_1D;
+	node.weight = parameter;
+	node.points = std::move(inputs);
+	return AddNode(std::move(node));
+}
+
+AnimationGraph::NodeIndex AnimationGraph::AddAdditive(
+	const NodeIndex base,
+	const NodeIndex additive,
+	const uint32_t  weightParameter
+) {
+	Node node;
+	node.type   = ANIMATION_GRAPH_NODE::ADDITIVE;
+	node.base   = base;
+	node.other  = additive;
+	node.weight = weightParameter;
+	return AddNode(std::move(node));
+}
+
+AnimationGraph::NodeIndex AnimationGraph::AddLayer(
+	const NodeIndex base,
+	const NodeIndex layer,
+	const uint32_t  mask,
+	const uint32_t  weightParameter
+) {
+	if (mask >= mMasks.size()) {
+		return kInvalidNode;
+	}
+	Node node;
+	node.type   = ANIMATION_GRAPH_NODE::LAYER;
+	node.base   = base;
+	node.other  = layer;
+	node.mask   = mask;
+	node.weight = weightParameter;
+	return AddNode(std::move(node));
+}
+
+void AnimationGraph::SetRoot(const NodeIndex node) {
+	mRoot             = node;
+	mScratchPoseCount = node < mNodes.size() ? ScratchNeeded(node) : 1;
+}
+
+AnimationGraph::NodeIndex AnimationGraph::AddNode(Node&& node) {
+	mNodes.emplace_back(std::move(node));
+	return static_cast<NodeIndex>(mNodes.size() - 1);
+}
+
+uint32_t AnimationGraph::ScratchNeeded(const NodeIndex node) const {
+	// 1つ目の入力は自分のバッファ、2つ目は1つ深いバッファで評価する
+	const Node& n = mNodes[node];
+	switch (n.type) {
+	case ANIMATION_GRAPH_NODE::CLIP:
+		return 1;
+	case ANIMATION_GRAPH_NODE::BLEND_1D: {
+		uint32_t deepest = 0;
+		for (const BlendPoint& point : n.points) {
+			deepest = std::max(deepest, ScratchNeeded(point.input));
+		}
+		return n.points.size() > 1 ? deepest + 1 : deepest;
+	}
+	case ANIMATION_GRAPH_NODE::ADDITIVE:
+	case ANIMATION_GRAPH_NODE::LAYER:
+		return std::max(ScratchNeeded(n.base), ScratchNeeded(n.other) + 1);
+	default:
+		return 1;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// AnimationGraphInstance
+//-----------------------------------------------------------------------------
+AnimationGraphInstance::AnimationGraphInstance(const AnimationGraph& graph)
+	: mGraph(&graph) {
+	const uint32_t jointCount = graph.GetSkeleton().JointCount();
+
+	mParameters.reserve(graph.mParameters.size());
+	for (const auto& parameter : graph.mParameters) {
+		mParameters.emplace_back(parameter.defaultValue);
+	}
+	mFades.resize(graph.mParameters.size());
+
+	mClipTimes.assign(graph.ClipCount(), 0.0f);
+	mCursors.resize(graph.ClipCount());
+	for (const auto& node : graph.mNodes) {
+		if (node.type == ANIMATION_GRAPH_NODE::CLIP) {
+			mCursors[node.clipSlot].Reset(*node.clip);
+		}
+	}
+
+	mScratch.resize(graph.ScratchPoseCount());
+	for (auto& pose : mScratch) {
+		pose = graph.GetSkeleton().BindPose();
+	}
+	mModel.resize(jointCount);
+}
+
+void AnimationGraphInstance::SetParameter(const uint32_t parameter, const float value) {
+	mParameters[parameter]      = value;
+	mFades[parameter].duration = 0.0f;
+}
+
+float AnimationGraphInstance::Parameter(const uint32_t parameter) const {
+	return mParameters[parameter];
+}
+
+void AnimationGraphInstance::FadeParameter(
+	const uint32_t parameter,
+	const float    target,
+	const float    seconds
+) {
+	if (seconds <= 0.0f) {
+		SetParameter(parameter, target);
+		return;
+	}
+	mFades[parameter] = {mParameters[parameter], target, 0.0f, seconds};
+}
+
+void AnimationGraphInstance::Update(const float deltaTime) {
+	Advance(deltaTime);
+	if (mGraph->Root() == AnimationGraph::kInvalidNode) {
+		return;
+	}
+	Evaluate(mGraph->Root(), 0);
+	mGraph->GetSkeleton().LocalToModel(mScratch[0].data(), mModel.data());
+}
+
+void AnimationGraphInstance::WriteSkinMatrices(
+	Mat4* const    outBones,
+	const uint32_t maxBones
+) const {
+	mGraph->GetSkeleton().WriteSkinMatrices(mModel.data(), outBones, maxBones);
+}
+
+void AnimationGraphInstance::Advance(const float deltaTime) {
+	for (size_t i = 0; i < mFades.size(); ++i) {
+		Fade& fade = mFades[i];
+		if (fade.duration <= 0.0f) {
+			continue;
+		}
+		fade.elapsed += deltaTime;
+		const float t = std::min(fade.elapsed / fade.duration, 1.0f);
+		mParameters[i] = fade.from + (fade.to - fade.from) * t;
+		if (t >= 1.0f) {
+			fade.duration = 0.0f;
+		}
+	}
+
+	// 使っていないクリップも時間は進めておく(重みが戻った時に飛ばないように)
+	for (const auto& node : mGraph->mNodes) {
+		if (node.type != ANIMATION_GRAPH_NODE::CLIP) {
+			continue;
+		}
+		const float duration = node.clip->Duration();
+		float&      time     = mClipTimes[node.clipSlot];
+		time += deltaTime * node.speed;
+		if (node.loop && duration > 0.0f) {
+			time = std::fmod(time, duration);
+			if (time < 0.0f) {
+				time += duration;
+			}
+		} else {
+			time = std::clamp(time, 0.0f, duration);
+		}
+	}
+}
+
+float AnimationGraphInstance::WeightOf(const uint32_t parameter) const {
+	return parameter == AnimationGraph::kInvalidParameter ?
+		       1.0f :
+		       mParameters[parameter];
+}
+
+void AnimationGraphInstance::Evaluate(
+	const AnimationGraph::NodeIndex node,
+	const uint32_t                  depth
+) {
+	const AnimationGraph::Node& n          = mGraph->mNodes[node];
+	const FlatSkeleton&         skeleton   = mGraph->GetSkeleton();
+	const uint32_t              jointCount = skeleton.JointCount();
+	JointPose*                  out        = mScratch[depth].data();
+
+	switch (n.type) {
+	case ANIMATION_GRAPH_NODE::CLIP:
+		skeleton.SampleLocalPose(
+			*n.clip, n.binding, mClipTimes[n.clipSlot], mCursors[n.clipSlot], out
+		);
+		break;
+
+	case ANIMATION_GRAPH_NODE::BLEND_1D: {
+		const auto& points = n.points;
+		const float value  = WeightOf(n.weight);
+		if (points.size() == 1 || value <= points.front().threshold) {
+			Evaluate(points.front().input, depth);
+			break;
+		}
+		if (value >= points.back().threshold) {
+			Evaluate(points.back().input, depth);
+			break;
+		}
+		size_t i = 0;
+		while (value >= points[i + 1].threshold) {
+			++i;
+		}
+		const float range  = points[i + 1].threshold - points[i].threshold;
+		const float weight = (value - points[i].threshold) / range;
+		Evaluate(points[i].input, depth);
+		if (weight > 0.0f) {
+			Evaluate(points[i + 1].input, depth + 1);
+			BlendPoses(out, mScratch[depth + 1].data(), weight, jointCount, out);
+		}
+		break;
+	}
+
+	case ANIMATION_GRAPH_NODE::ADDITIVE: {
+		Evaluate(n.base, depth);
+		const float weight = WeightOf(n.weight);
+		if (weight == 0.0f) {
+			break;
+		}
+		Evaluate(n.other, depth + 1);
+		AddPoses(
+			out, mScratch[depth + 1].data(), skeleton.BindPose().data(),
+			weight, jointCount, out
+		);
+		break;
+	}
+
+	case ANIMATION_GRAPH_NODE::LAYER: {
+		Evaluate(n.base, depth);
+		const float weight = std::clamp(WeightOf(n.weight), 0.0f, 1.0f);
+		if (weight <= 0.0f) {
+			break;
+		}
+		Evaluate(n.other, depth + 1);
+		BlendPosesMasked(
+			out, mScratch[depth + 1].data(), weight,
+			mGraph->mMasks[n.mask].data(), jointCount, out
+		);
+		break;
+	}
+	}
+}
+
+void UpdateAnimationGraphs(
+	AnimationGraphInstance* const* instances,
+	const size_t                   count,
+	const float                    deltaTime,
+	JobSystem*                     jobs
+) {
+	if (!jobs || count < kParallelThreshold) {
+		for (size_t i = 0; i < count; ++i) {
+			instances[i]->Update(deltaTime);
+		}
+		return;
+	}
+	jobs->ParallelFor(
+		count, kGrainSize,
+		[instances, deltaTime](const size_t begin, const size_t end, uint32_t) {
+			for (size_t i = begin; i < end; ++i) {
+				instances[i]->Update(deltaTime);
+			}
+		}
+	);
+}
@@ -0,0 +1,171 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <engine/Animation/AnimationClip.h>
+#include <engine/Animation/FlatSkeleton.h>
+
+class JobSystem;
+
+enum class ANIMATION_GRAPH_NODE : uint8_t {
+	CLIP,     // クリップを再生
+	BLEND_1D, // パラメーターで隣り合う2つの入力を補間(歩き/走りなど)
+	ADDITIVE, // 差分のポーズを足す
+	LAYER,    // マスクしたジョイントだけ上書き(上半身だけ別の動きなど)
+};
+
+const char* ToString(ANIMATION_GRAPH_NODE e);
+
+// ポーズのブレンドグラフの定義
+// 1つのスケルトンに対して組み立て、同じ動きをするキャラクター全員で共有します。
+// 再生時間やパラメーターなどのキャラクターごとの状態は AnimationGraphInstance が持ちます
+class AnimationGraph {
+public:
+	using NodeIndex = uint32_t;
+
+	static constexpr NodeIndex kInvalidNode      = UINT32_MAX;
+	static constexpr uint32_t  kInvalidParameter = UINT32_MAX;
+	static constexpr uint32_t  kInvalidMask      = UINT32_MAX;
+
+	struct BlendPoint {
+		float     threshold; // パラメーターがこの値の時にこの入力だけになる
+		NodeIndex input;
+	};
+
+	// skeleton はグラフより長生きさせてください
+	explicit AnimationGraph(const FlatSkeleton& skeleton);
+
+	[[nodiscard]] const FlatSkeleton& GetSkeleton() const { return *mSkeleton; }
+
+	uint32_t               AddParameter(std::string_view name, float defaultValue = 0.0f);
+	[[nodiscard]] uint32_t FindParameter(std::string_view name) const;
+
+	// rootJoint とその子孫を weight、それ以外を0にしたマスクを作ります
+	// @return 見つからなければ kInvalidMask
+	uint32_t AddMask(std::string_view rootJoint, float weight = 1.0f);
+
+	// clip はグラフより長生きさせてください。チャンネルとジョイントはここで結び付けます
+	NodeIndex AddClip(const AnimationClip& clip, float speed = 1.0f, bool loop = true);
+
+	// inputs は閾値の昇順に並べてください
+	NodeIndex AddBlend1D(uint32_t parameter, std::vector<BlendPoint> inputs);
+
+	// additive の初期姿勢(バインドポーズ)からの差分を、weightParameter の重みで base に足します
+	// weightParameter が kInvalidParameter なら重みは1です
+	NodeIndex AddAdditive(NodeIndex base, NodeIndex additive, uint32_t weightParameter);
+
+	// mask のジョイントを layer に、weightParameter の重み(0～1)で置き換えます
+	NodeIndex AddLayer(
+		NodeIndex base,
+		NodeIndex layer,
+		uint32_t  mask,
+		uint32_t  weightParameter
+	);
+
+	void SetRoot(NodeIndex node);
+
+	[[nodiscard]] NodeIndex Root() const { return mRoot; }
+	[[nodiscard]] uint32_t  NodeCount() const { return static_cast<uint32_t>(mNodes.size()); }
+	[[nodiscard]] uint32_t  ClipCount() const { return mClipCount; }
+
+	[[nodiscard]] uint32_t ParameterCount() const {
+		return static_cast<uint32_t>(mParameters.size());
+	}
+
+	// ルートの評価に同時に要るポーズの数
+	[[nodiscard]] uint32_t ScratchPoseCount() const { return mScratchPoseCount; }
+
+private:
+	friend class AnimationGraphInstance;
+
+	struct Node {
+		ANIMATION_GRAPH_NODE type = ANIMATION_GRAPH_NODE::CLIP;
+
+		// CLIP
+		const AnimationClip*  clip = nullptr;
+		std::vector<uint32_t> binding;      // ジョイントごとのチャンネル
+		uint32_t              clipSlot = 0; // インスタンスの再生時間とカーソルの添字
+		float                 speed    = 1.0f;
+		bool                  loop     = true;
+
+		// BLEND_1D
+		std::vector<BlendPoint> points;
+
+		// ADDITIVE / LAYER
+		NodeIndex base   = kInvalidNode;
+		NodeIndex other  = kInvalidNode;
+		uint32_t  mask   = kInvalidMask;
+		uint32_t  weight = kInvalidParameter; // BLEND_1D ではブレンドのパラメーター
+	};
+
+	struct Parameter {
+		std::string name;
+		float       defaultValue;
+	};
+
+	NodeIndex AddNode(Node&& node);
+	uint32_t  ScratchNeeded(NodeIndex node) const;
+
+private:
+	const FlatSkeleton*             mSkeleton;
+	std::vector<Node>               mNodes;
+	std::vector<Parameter>          mParameters;
+	std::vector<std::vector<float>> mMasks;
+	NodeIndex                       mRoot             = kInvalidNode;
+	uint32_t                        mClipCount        = 0;
+	uint32_t                        mScratchPoseCount = 1;
+};
+
+// AnimationGraph をキャラクター1体分再生する状態
+// ポーズのバッファは作成時に全て確保するので、Update の中では確保しません。
+// インスタンスどうしは何も共有しないので、別々のスレッドで Update できます
+class AnimationGraphInstance {
+public:
+	// graph はインスタンスより長生きさせてください。SetRoot の後に作ってください
+	explicit AnimationGraphInstance(const AnimationGraph& graph);
+
+	void                SetParameter(uint32_t parameter, float value);
+	[[nodiscard]] float Parameter(uint32_t parameter) const;
+
+	// パラメーターを seconds 秒かけて target まで動かします(クロスフェードなど)
+	void FadeParameter(uint32_t parameter, float target, float seconds);
+
+	// 時間を進めてポーズを評価し、モデル空間の行列まで求めます
+	void Update(float deltaTime);
+
+	[[nodiscard]] const std::vector<JointPose>& LocalPose() const { return mScratch[0]; }
+	[[nodiscard]] const std::vector<Mat4>&      ModelPose() const { return mModel; }
+
+	void WriteSkinMatrices(Mat4* outBones, uint32_t maxBones) const;
+
+private:
+	struct Fade {
+		float from     = 0.0f;
+		float to       = 0.0f;
+		float elapsed  = 0.0f;
+		float duration = 0.0f; // 0ならフェードしていない
+	};
+
+	void  Advance(float deltaTime);
+	void  Evaluate(AnimationGraph::NodeIndex node, uint32_t depth);
+	float WeightOf(uint32_t parameter) const;
+
+private:
+	const AnimationGraph*               mGraph;
+	std::vector<float>                  mParameters;
+	std::vector<Fade>                   mFades;
+	std::vector<float>                  mClipTimes;
+	std::vector<AnimationClipCursor>    mCursors;
+	std::vector<std::vector<JointPose>> mScratch; // 評価の深さごと。0番が結果
+	std::vector<Mat4>                   mModel;
+};
+
+// instances を全て Update します。jobs があれば JobSystem::ParallelFor で分けます
+void UpdateAnimationGraphs(
+	AnimationGraphInstance* const* instances,
+	size_t                         count,
+	float                          deltaTime,
+	JobSystem*                     jobs = nullptr
+);
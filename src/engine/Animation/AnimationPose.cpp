@@ -0,0 +1,99 @@
+﻿#include <engine/Animation/AnimationPose.h>
+
+#include <cmath>
+
+namespace {
+	Quaternion NormalizedQuaternion(const float x, const float y, const float z, const float w) {
+		const float len = std::sqrt(x * x + y * y + z * z + w * w);
+		if (len <= 0.0f) {
+			return Quaternion::identity;
+		}
+		const float inv = 1.0f / len;
+		return {x * inv, y * inv, z * inv, w * inv};
+	}
+
+	Quaternion NLerpShortest(const Quaternion& a, const Quaternion& b, const float t) {
+		const float dot = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+		const float s   = 1.0f - t;
+		const float u   = dot < 0.0f ? -t : t;
+		return NormalizedQuaternion(
+			s * a.x + u * b.x,
+			s * a.y + u * b.y,
+			s * a.z + u * b.z,
+			s * a.w + u * b.w
+		);
+	}
+
+	JointPose BlendJoint(const JointPose& a, const JointPose& b, const float t) {
+		return {
+			Math::Lerp(a.translate, b.translate, t),
+			NLerpShortest(a.rotate, b.rotate, t),
+			Math::Lerp(a.scale, b.scale, t)
+		};
+	}
+
+	float Ratio(const float value, const float reference) {
+		return reference != 0.0f ? value / reference : 1.0f;
+	}
+}
+
+void BlendPoses(
+	const JointPose* a,
+	const JointPose* b,
+	const float      weight,
+	const uint32_t   count,
+	JointPose*       out
+) {
+	for (uint32_t joint = 0; joint < count; ++joint) {
+		out[joint] = BlendJoint(a[joint], b[joint], weight);
+	}
+}
+
+void BlendPosesMasked(
+	const JointPose* a,
+	const JointPose* b,
+	const float      weight,
+	const float*     mask,
+	const uint32_t   count,
+	JointPose*       out
+) {
+	for (uint32_t joint = 0; joint < count; ++joint) {
+		const float t = weight * mask[joint];
+		if (t <= 0.0f) {
+			out[joint] = a[joint];
+		} else {
+			out[joint] = BlendJoint(a[joint], b[joint], t);
+		}
+	}
+}
+
+void AddPoses(
+	const JointPose* base,
+	const JointPose* additive,
+	const JointPose* reference,
+	const float      weight,
+	const uint32_t   count,
+	JointPose*       out
+) {
+	for (uint32_t joint = 0; joint < count; ++joint) {
+		const JointPose& b   = base[joint];
+		const JointPose& add = additive[joint];
+		const JointPose& ref = reference[joint];
+
+		// reference から additive への回転を weight だけ進めたもの
+		const Quaternion delta = NLerpShortest(
+			Quaternion::identity, ref.rotate.Conjugate() * add.rotate, weight
+		);
+		const Quaternion r = b.rotate * delta;
+
+		out[joint] = {
+			b.translate + (add.translate - ref.translate) * weight,
+			NormalizedQuaternion(r.x, r.y, r.z, r.w),
+			Vec3(
+				b.scale.x * (1.0f + (Ratio(add.scale.x, ref.scale.x) - 1.0f) * weight),
+				b.scale.y * (1.0f + (Ratio(add.scale.y, ref.scale.y) - 1.0f) * weight),
+				b.scale.z * (1.0f + (Ratio(add.scale.z, ref.scale.z) - 1.0f) * weight)
+			)
+		};
+	}
+}
@@ -0,0 +1,37 @@
+﻿#pragma once
+#include <cstdint>
+
+#include <engine/Animation/FlatSkeleton.h>
+
+// ジョイントの姿勢の配列どうしの演算
+// どれも out に入力と同じ配列を渡しても構いません
+
+// a から b へ weight で補間します。回転は近い方の半球で nlerp します
+void BlendPoses(
+	const JointPose* a,
+	const JointPose* b,
+	float            weight,
+	uint32_t         count,
+	JointPose*       out
+);
+
+// BlendPoses と同じですが、ジョイントごとの重みは weight * mask[ジョイント] です
+void BlendPosesMasked(
+	const JointPose* a,
+	const JointPose* b,
+	float            weight,
+	const float*     mask,
+	uint32_t         count,
+	JointPose*       out
+);
+
+// base に additive の reference からの差分を weight 倍して足します
+// 回転は差分の回転を base の後ろから掛け、スケールは比を掛けます
+void AddPoses(
+	const JointPose* base,
+	const JointPose* additive,
+	const JointPose* reference,
+	float            weight,
+	uint32_t         count,
+	JointPose*       out
+);
@@ -0,0 +1,120 @@
+﻿#include <engine/Animation/FlatSkeleton.h>
+
+#include <algorithm>
+
+#include <engine/Animation/AnimationClip.h>
+#include <engine/Animation/Skeleton.h>
+
+#include <runtime/core/math/AffineCompose.h>
+
+FlatSkeleton::FlatSkeleton(const Skeleton& skeleton) {
+	// 再帰していた時と同じ順(行きがけ順)で並べる。親は必ず子より前に来る
+	struct Pending {
+		const Node* node;
+		int32_t     parent;
+	};
+	std::vector<Pending> stack = {{&skeleton.rootNode, kNoParent}};
+	while (!stack.empty()) {
+		const Pending pending = stack.back();
+		stack.pop_back();
+
+		const Node&    node  = *pending.node;
+		const uint32_t joint = static_cast<uint32_t>(mParents.size());
+		mNames.emplace_back(node.name);
+		mParents.emplace_back(pending.parent);
+		mBindPose.push_back({
+			node.transform.translate,
+			node.transform.rotate.Normalized(),
+			node.transform.scale
+		});
+		mLookup.emplace(node.name, joint);
+
+		int32_t bone = kNoBone;
+		if (const auto it = skeleton.boneMap.find(node.name);
+			it != skeleton.boneMap.end()) {
+			bone = it->second;
+			mSkinJoints.push_back({
+				joint,
+				static_cast<uint32_t>(bone),
+				skeleton.bones[bone].offsetMatrix
+			});
+			mBoneCount = std::max(mBoneCount, static_cast<uint32_t>(bone) + 1);
+		}
+		mBoneIndices.emplace_back(bone);
+
+		for (auto child = node.children.rbegin(); child != node.children.rend(); ++child) {
+			stack.push_back({&*child, static_cast<int32_t>(joint)});
+		}
+	}
+}
+
+const std::string& FlatSkeleton::JointName(const uint32_t joint) const {
+	return mNames[joint];
+}
+
+int32_t FlatSkeleton::Parent(const uint32_t joint) const {
+	return mParents[joint];
+}
+
+int32_t FlatSkeleton::BoneIndex(const uint32_t joint) const {
+	return mBoneIndices[joint];
+}
+
+uint32_t FlatSkeleton::FindJoint(const std::string_view name) const {
+	const auto it = mLookup.find(std::string(name));
+	return it != mLookup.end() ? it->second : kInvalidJoint;
+}
+
+std::vector<uint32_t> FlatSkeleton::Bind(const AnimationClip& clip) const {
+	std::vector<uint32_t> binding(mNames.size());
+	for (size_t joint = 0; joint < mNames.size(); ++joint) {
+		binding[joint] = clip.FindChannel(mNames[joint]);
+	}
+	return binding;
+}
+
+void FlatSkeleton::SampleLocalPose(
+	const AnimationClip&         clip,
+	const std::vector<uint32_t>& binding,
+	const float                  time,
+	AnimationClipCursor&         cursor,
+	JointPose*                   outLocal
+) const {
+	const uint32_t count = JointCount();
+	for (uint32_t joint = 0; joint < count; ++joint) {
+		const uint32_t channel = binding[joint];
+		if (channel == AnimationClip::kInvalidChannel) {
+			outLocal[joint] = mBindPose[joint];
+			continue;
+		}
+		JointPose& pose = outLocal[joint];
+		clip.Sample(channel, time, cursor, pose.translate, pose.rotate, pose.scale);
+	}
+}
+
+void FlatSkeleton::LocalToModel(const JointPose* local, Mat4* outModel) const {
+	const uint32_t count = JointCount();
+	for (uint32_t joint = 0; joint < count; ++joint) {
+		const JointPose& pose   = local[joint];
+		const int32_t    parent = mParents[joint];
+		if (parent == kNoParent) {
+			Math::ComposeLocal(pose.translate, pose.rotate, pose.scale, outModel[joint].m);
+		} else {
+			alignas(16) float localMat[4][4];
+			Math::ComposeLocal(pose.translate, pose.rotate, pose.scale, localMat);
+			Math::MultiplyRows(localMat, outModel[parent], outModel[joint]);
+		}
+	}
+}
+
+void FlatSkeleton::WriteSkinMatrices(
+	const Mat4*    model,
+	Mat4*          outBones,
+	const uint32_t maxBones
+) const {
+	for (const SkinJoint& skin : mSkinJoints) {
+		if (skin.bone < maxBones) {
+			Math::MultiplyRows(skin.offset.m, model[skin.joint], outBones[skin.bone]);
+		}
+	}
+}
@@ -0,0 +1,90 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <runtime/core/math/Math.h>
+
+struct Skeleton;
+class AnimationClip;
+class AnimationClipCursor;
+
+// ジョイント1つ分のローカルの姿勢
+struct JointPose {
+	Vec3       translate;
+	Quaternion rotate;
+	Vec3       scale;
+};
+
+// Skeleton のノード階層を、親が必ず子より前に来る配列に並べ直したもの
+// 名前で引くのは構築時とクリップを結び付ける時だけで、
+// 毎フレームの評価は配列を前から1回なめるだけです
+class FlatSkeleton {
+public:
+	static constexpr int32_t  kNoParent     = -1;
+	static constexpr int32_t  kNoBone       = -1;
+	static constexpr uint32_t kInvalidJoint = UINT32_MAX;
+
+	FlatSkeleton() = default;
+	explicit FlatSkeleton(const Skeleton& skeleton);
+
+	[[nodiscard]] uint32_t JointCount() const {
+		return static_cast<uint32_t>(mParents.size());
+	}
+
+	[[nodiscard]] const std::string& JointName(uint32_t joint) const;
+	[[nodiscard]] int32_t            Parent(uint32_t joint) const;
+	[[nodiscard]] int32_t            BoneIndex(uint32_t joint) const;
+	[[nodiscard]] uint32_t           FindJoint(std::string_view name) const;
+
+	// ノードの初期姿勢
+	[[nodiscard]] const std::vector<JointPose>& BindPose() const {
+		return mBindPose;
+	}
+
+	// スキン行列を書くボーン番号の最大 + 1
+	[[nodiscard]] uint32_t BoneCount() const { return mBoneCount; }
+
+	// ジョイントごとのクリップのチャンネル番号(無ければ AnimationClip::kInvalidChannel)
+	// 再生を始める時に一度だけ作っておきます
+	[[nodiscard]] std::vector<uint32_t> Bind(const AnimationClip& clip) const;
+
+	// clip を time でサンプルして outLocal (JointCount 個) に書きます
+	// チャンネルの無いジョイントは初期姿勢になります
+	void SampleLocalPose(
+		const AnimationClip&         clip,
+		const std::vector<uint32_t>& binding,
+		float                        time,
+		AnimationClipCursor&         cursor,
+		JointPose*                   outLocal
+	) const;
+
+	// ローカルの姿勢からモデル空間の行列を求めます(outModel も JointCount 個)
+	void LocalToModel(const JointPose* local, Mat4* outModel) const;
+
+	// ボーンになっているジョイントだけ、offset * model を outBones[ボーン番号] に書きます
+	// それ以外の要素には触らないので、初期化は再生を始める時に一度だけで済みます
+	void WriteSkinMatrices(
+		const Mat4* model,
+		Mat4*       outBones,
+		uint32_t    maxBones
+	) const;
+
+private:
+	// スキン行列を書くジョイント
+	struct SkinJoint {
+		uint32_t joint;
+		uint32_t bone;
+		Mat4     offset;
+	};
+
+	std::vector<std::string>                  mNames;
+	std::vector<int32_t>                      mParents;
+	std::vector<int32_t>                      mBoneIndices;
+	std::vector<JointPose>                    mBindPose;
+	std::vector<SkinJoint>                    mSkinJoints; // ジョイント順
+	std::unordered_map<std::string, uint32_t> mLookup;     // 同名なら最初のジョイント
+	uint32_t                                  mBoneCount = 0;
+};
@@ -1,7 +1,27 @@
 ﻿#include <engine/Animation/KeyFrame.h>
 
+#include <algorithm>
+
 #include "engine/OldConsole/Console.h"
 
+namespace {
+	// time を挟む区間の先頭のキーを二分探索します
+	// 最初のキー以前なら0、最後のキー以降なら最後のキーを返します
+	template <typename T>
+	size_t FindKeyIndex(const std::vector<Keyframe<T>>& keyframes, const float time) {
+		const auto it = std::upper_bound(
+			keyframes.begin(), keyframes.end(), time,
+			[](const float t, const Keyframe<T>& key) {
+				return t < key.time;
+			}
+		);
+		if (it == keyframes.begin()) {
+			return 0;
+		}
+		return static_cast<size_t>(it - keyframes.begin()) - 1;
+	}
+}
+
 Vec3 CalculateValue(const std::vector<KeyframeVec3>& keyframes, float time) {
 	//assert(!keyframes.empty() && "Keyframes must not be empty");
 	if (keyframes.empty()) {
@@ -15,22 +35,17 @@ Vec3 CalculateValue(const std::vector<KeyframeVec3>& keyframes, float time) {
 		return keyframes[0].value; // キーが1つしかない場合はその値を返す
 	}
 
-	for (size_t index = 0; index < keyframes.size() - 1; ++index) {
-		size_t nextIndex = index + 1;
-		// indexとnextIndexの２つのkeyframeを取得して範囲内に時刻があるかを判定
-		if (
-			keyframes[index].time <= time &&
-			time <= keyframes[nextIndex].time
-		) {
-			float t = (time - keyframes[index].time) / (keyframes[nextIndex]
-				.
-				time - keyframes[index].time);
-			return Math::Lerp(
-				keyframes[index].value,
-				keyframes[nextIndex].value,
-				t
-			);
-		}
+	// 長いクリップでも先頭からなめないよう、区間は二分探索で求める
+	const size_t index     = FindKeyIndex(keyframes, time);
+	const size_t nextIndex = index + 1;
+	if (nextIndex < keyframes.size()) {
+		const float t = (time - keyframes[index].time) /
+			(keyframes[nextIndex].time - keyframes[index].time);
+		return Math::Lerp(
+			keyframes[index].value,
+			keyframes[nextIndex].value,
+			t
+		);
 	}
 	// ここまで来た場合は最後の時刻よりも後ろなので最後の値を返すことになる
 	return keyframes.rbegin()->value;
@@ -50,22 +65,16 @@ Quaternion CalculateValue(const std::vector<KeyframeQuaternion>& keyframes,
 		return keyframes[0].value; // キーが1つしかない場合はその値を返す
 	}
 
-	for (size_t index = 0; index < keyframes.size() - 1; ++index) {
-		size_t nextIndex = index + 1;
-		// indexとnextIndexの２つのkeyframeを取得して範囲内に時刻があるかを判定
-		if (
-			keyframes[index].time <= time &&
-			time <= keyframes[nextIndex].time
-		) {
-			float t = (time - keyframes[index].time) / (keyframes[nextIndex]
-				.
-				time - keyframes[index].time);
-			return Quaternion::Slerp(
-				keyframes[index].value,
-				keyframes[nextIndex].value,
-				t
-			);
-		}
+	const size_t index     = FindKeyIndex(keyframes, time);
+	const size_t nextIndex = index + 1;
+	if (nextIndex < keyframes.size()) {
+		const float t = (time - keyframes[index].time) /
+			(keyframes[nextIndex].time - keyframes[index].time);
+		return Quaternion::Slerp(
+			keyframes[index].value,
+			keyframes[nextIndex].value,
+			t
+		);
 	}
 	// ここまで来た場合は最後の時刻よりも後ろなので最後の値を返すことになる
 	return keyframes.rbegin()->value;
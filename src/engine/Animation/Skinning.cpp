@@ -0,0 +1,248 @@
+﻿#include <engine/Animation/Skinning.h>
+
+#include <cmath>
+#include <vector>
+#include <xmmintrin.h>
+
+#include <core/jobsystem/JobSystem.h>
+
+#include <runtime/core/math/AffineCompose.h>
+
+namespace {
+	// これより少なければ1スレッドで回す
+	constexpr size_t kParallelThreshold = 4096;
+	constexpr size_t kGrainSize         = 1024;
+
+	Quaternion Multiply(const Quaternion& a, const Quaternion& b) {
+		return {
+			a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+			a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+			a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+			a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+		};
+	}
+
+	// ComposeLocal の回転部分(行ごとに正規化済み)からクォータニオンに戻す
+	Quaternion RotationFromRows(const float (&m)[3][3]) {
+		const float trace = m[0][0] + m[1][1] + m[2][2];
+		if (trace > 0.0f) {
+			const float s = std::sqrt(trace + 1.0f) * 2.0f; // 4w
+			return {(m[1][2] - m[2][1]) / s, (m[2][0] - m[0][2]) / s, (m[0][1] - m[1][0]) / s, 0.25f * s};
+		}
+		if (m[0][0] > m[1][1] && m[0][0] > m[2][2]) {
+			const float s = std::sqrt(1.0f + m[0][0] - m[1][1] - m[2][2]) * 2.0f; // 4x
+			return {0.25f * s, (m[0][1] + m[1][0]) / s, (m[2][0] + m[0][2]) / s, (m[1][2] - m[2][1]) / s};
+		}
+		if (m[1][1] > m[2][2]) {
+			const float s = std::sqrt(1.0f - m[0][0] + m[1][1] - m[2][2]) * 2.0f; // 4y
+			return {(m[0][1] + m[1][0]) / s, 0.25f * s, (m[1][2] + m[2][1]) / s, (m[2][0] - m[0][2]) / s};
+		}
+		const float s = std::sqrt(1.0f - m[0][0] - m[1][1] + m[2][2]) * 2.0f; // 4z
+		return {(m[2][0] + m[0][2]) / s, (m[1][2] + m[2][1]) / s, 0.25f * s, (m[0][1] - m[1][0]) / s};
+	}
+
+	// 行ベクトル p * M。rows[3] が移動
+	void StorePoint(const __m128 (&rows)[4], const Vec3& p, Vec3& out) {
+		__m128 r = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.x), rows[0]), rows[3]);
+		r        = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(p.y), rows[1]));
+		r        = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(p.z), rows[2]));
+
+		alignas(16) float v[4];
+		_mm_store_ps(v, r);
+		out = {v[0], v[1], v[2]};
+	}
+
+	// 法線は移動を足さずに正規化する(スケールが軸ごとに違う場合の逆転置は省く)
+	void StoreNormal(const __m128 (&rows)[4], const Vec3& n, Vec3& out) {
+		__m128 r = _mm_mul_ps(_mm_set1_ps(n.x), rows[0]);
+		r        = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(n.y), rows[1]));
+		r        = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(n.z), rows[2]));
+
+		alignas(16) float v[4];
+		_mm_store_ps(v, r);
+		const float len = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+		const float inv = len > 0.0f ? 1.0f / len : 0.0f;
+		out             = {v[0] * inv, v[1] * inv, v[2] * inv};
+	}
+}
+
+const char* ToString(const SKINNING_MODE e) {
+	switch (e) {
+	case SKINNING_MODE::LINEAR: return "LINEAR";
+	case SKINNING_MODE::DUAL_QUATERNION: return "DUAL_QUATERNION";
+	default: return "unknown";
+	}
+}
+
+SkinDualQuaternion ToSkinDualQuaternion(const Mat4& skinMatrix) {
+	SkinDualQuaternion result;
+	float              rotation[3][3];
+	for (uint32_t row = 0; row < 3; ++row) {
+		const float* m    = skinMatrix.m[row];
+		const float  len  = std::sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+		const float  inv  = len > 0.0f ? 1.0f / len : 0.0f;
+		result.scale[row] = len;
+		rotation[row][0]  = m[0] * inv;
+		rotation[row][1]  = m[1] * inv;
+		rotation[row][2]  = m[2] * inv;
+	}
+
+	result.real = RotationFromRows(rotation).Normalized();
+
+	// dual = 0.5 * t * real (t は w = 0 のクォータニオン)
+	const Quaternion t = {skinMatrix.m[3][0], skinMatrix.m[3][1], skinMatrix.m[3][2], 0.0f};
+	const Quaternion d = Multiply(t, result.real);
+	result.dual        = {d.x * 0.5f, d.y * 0.5f, d.z * 0.5f, d.w * 0.5f};
+	return result;
+}
+
+void SkinVerticesLinear(
+	const Unnamed::MeshStreamView& streams,
+	const Mat4*                    skinMatrices,
+	const uint32_t                 begin,
+	const uint32_t                 end,
+	Vec3*                          outPositions,
+	Vec3*                          outNormals
+) {
+	const bool normals = outNormals && !streams.normals.empty();
+	for (uint32_t v = begin; v < end; ++v) {
+		const auto& joints  = streams.joints[v];
+		const auto& weights = streams.weights[v];
+
+		// 4本の行列を重みで足す
+		__m128 rows[4];
+		for (int row = 0; row < 4; ++row) {
+			__m128 r = _mm_mul_ps(
+				_mm_set1_ps(weights[0]), _mm_loadu_ps(skinMatrices[joints[0]].m[row])
+			);
+			for (int i = 1; i < 4; ++i) {
+				r = _mm_add_ps(r, _mm_mul_ps(
+					_mm_set1_ps(weights[i]), _mm_loadu_ps(skinMatrices[joints[i]].m[row])
+				));
+			}
+			rows[row] = r;
+		}
+
+		StorePoint(rows, streams.positions[v], outPositions[v]);
+		if (normals) {
+			StoreNormal(rows, streams.normals[v], outNormals[v]);
+		}
+	}
+}
+
+void SkinVerticesDualQuaternion(
+	const Unnamed::MeshStreamView& streams,
+	const SkinDualQuaternion*      bones,
+	const uint32_t                 begin,
+	const uint32_t                 end,
+	Vec3*                          outPositions,
+	Vec3*                          outNormals
+) {
+	const bool normals = outNormals && !streams.normals.empty();
+	for (uint32_t v = begin; v < end; ++v) {
+		const auto& joints  = streams.joints[v];
+		const auto& weights = streams.weights[v];
+
+		// 最初のボーンと同じ半球に揃えて足す
+		const __m128 pivot = _mm_loadu_ps(&bones[joints[0]].real.x);
+		__m128       real  = _mm_setzero_ps();
+		__m128       dual  = _mm_setzero_ps();
+		__m128       scale = _mm_setzero_ps();
+		for (int i = 0; i < 4; ++i) {
+			const SkinDualQuaternion& bone = bones[joints[i]];
+			const __m128              r    = _mm_loadu_ps(&bone.real.x);
+
+			alignas(16) float dot[4];
+			_mm_store_ps(dot, _mm_mul_ps(r, pivot));
+			const float  sign = dot[0] + dot[1] + dot[2] + dot[3] < 0.0f ? -1.0f : 1.0f;
+			const __m128 w    = _mm_set1_ps(weights[i] * sign);
+
+			real  = _mm_add_ps(real, _mm_mul_ps(w, r));
+			dual  = _mm_add_ps(dual, _mm_mul_ps(w, _mm_loadu_ps(&bone.dual.x)));
+			scale = _mm_add_ps(scale, _mm_mul_ps(
+				_mm_set1_ps(weights[i]),
+				_mm_setr_ps(bone.scale.x, bone.scale.y, bone.scale.z, 0.0f)
+			));
+		}
+
+		alignas(16) float q[4];
+		alignas(16) float d[4];
+		alignas(16) float s[4];
+		_mm_store_ps(q, real);
+		_mm_store_ps(d, dual);
+		_mm_store_ps(s, scale);
+
+		const float len = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+		const float inv = len > 0.0f ? 1.0f / len : 0.0f;
+		const Quaternion rotate = {q[0] * inv, q[1] * inv, q[2] * inv, q[3] * inv};
+		const Quaternion dualN  = {d[0] * inv, d[1] * inv, d[2] * inv, d[3] * inv};
+
+		// t = 2 * dual * conj(real)
+		const Quaternion t = Multiply(dualN, {-rotate.x, -rotate.y, -rotate.z, rotate.w});
+
+		float local[4][4];
+		Math::ComposeLocal(
+			Vec3(t.x * 2.0f, t.y * 2.0f, t.z * 2.0f), rotate, Vec3(s[0], s[1], s[2]),
+			local
+		);
+		const __m128 rows[4] = {
+			_mm_loadu_ps(local[0]),
+			_mm_loadu_ps(local[1]),
+			_mm_loadu_ps(local[2]),
+			_mm_loadu_ps(local[3]),
+		};
+
+		StorePoint(rows, streams.positions[v], outPositions[v]);
+		if (normals) {
+			StoreNormal(rows, streams.normals[v], outNormals[v]);
+		}
+	}
+}
+
+bool SkinMesh(
+	const Unnamed::MeshStreamView& streams,
+	const std::span<const Mat4>    skinMatrices,
+	const SKINNING_MODE            mode,
+	Vec3*                          outPositions,
+	Vec3*                          outNormals,
+	JobSystem*                     jobs
+) {
+	const size_t count = streams.positions.size();
+	if (streams.joints.size() < count || streams.weights.size() < count ||
+		(!streams.normals.empty() && streams.normals.size() < count) ||
+		skinMatrices.size() < streams.invBind.size() || skinMatrices.empty()) {
+		return false;
+	}
+
+	std::vector<SkinDualQuaternion> bones;
+	if (mode == SKINNING_MODE::DUAL_QUATERNION) {
+		bones.reserve(skinMatrices.size());
+		for (const Mat4& m : skinMatrices) {
+			bones.emplace_back(ToSkinDualQuaternion(m));
+		}
+	}
+
+	const auto skin = [&](const size_t begin, const size_t end, uint32_t) {
+		if (mode == SKINNING_MODE::DUAL_QUATERNION) {
+			SkinVerticesDualQuaternion(
+				streams, bones.data(),
+				static_cast<uint32_t>(begin), static_cast<uint32_t>(end),
+				outPositions, outNormals
+			);
+		} else {
+			SkinVerticesLinear(
+				streams, skinMatrices.data(),
+				static_cast<uint32_t>(begin), static_cast<uint32_t>(end),
+				outPositions, outNormals
+			);
+		}
+	};
+
+	// 頂点ごとに独立していて、書き込み先も範囲で分かれるのでロックは要らない
+	if (!jobs || count < kParallelThreshold) {
+		skin(0, count, 0);
+	} else {
+		jobs->ParallelFor(count, kGrainSize, skin);
+	}
+	return true;
+}
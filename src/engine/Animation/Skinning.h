@@ -0,0 +1,61 @@
+﻿#pragma once
+#include <cstdint>
+#include <span>
+
+#include <runtime/assets/types/MeshAsset.h>
+#include <runtime/core/math/Math.h>
+
+class JobSystem;
+
+// CPU でのスキニング
+// GPU に頼らずにスキン後の頂点が要るところ(サーバーの当たり判定、描画の無いテスト環境)向けです。
+// 入力は MeshStreamView の positions / normals / joints / weights で、
+// スキン行列はスキンのジョイント(MeshSkin::jointNames)の順に invBind * モデル空間の行列を並べたものです
+
+enum class SKINNING_MODE : uint8_t {
+	LINEAR,          // 行列を重みで足す。頂点シェーダーのスキニングと同じ結果になります
+	DUAL_QUATERNION, // 回転と移動をデュアルクォータニオンで補間するので、ひねった関節が痩せません
+};
+
+const char* ToString(SKINNING_MODE e);
+
+// スキン行列を S * R * T に分けたもの。スケールは軸ごとに線形補間します
+// (せん断や負のスケールは表せません)
+struct SkinDualQuaternion {
+	Quaternion real;
+	Quaternion dual;
+	Vec3       scale;
+};
+
+SkinDualQuaternion ToSkinDualQuaternion(const Mat4& skinMatrix);
+
+// [begin, end) の頂点をスキニングします。法線が無いか outNormals がnullなら法線は書きません
+void SkinVerticesLinear(
+	const Unnamed::MeshStreamView& streams,
+	const Mat4*                    skinMatrices,
+	uint32_t                       begin,
+	uint32_t                       end,
+	Vec3*                          outPositions,
+	Vec3*                          outNormals
+);
+
+void SkinVerticesDualQuaternion(
+	const Unnamed::MeshStreamView& streams,
+	const SkinDualQuaternion*      bones,
+	uint32_t                       begin,
+	uint32_t                       end,
+	Vec3*                          outPositions,
+	Vec3*                          outNormals
+);
+
+/// @brief 全頂点をスキニングします。jobs があれば頂点の範囲ごとに JobSystem::ParallelFor で分けます
+/// @details 頂点ごとのジョイント番号は確認しないので、skinMatrices はスキンの全ジョイント分渡してください
+/// @return スキンが無い、行列や法線が足りないなどでスキニングできなければfalse
+bool SkinMesh(
+	const Unnamed::MeshStreamView& streams,
+	std::span<const Mat4>          skinMatrices,
+	SKINNING_MODE                  mode,
+	Vec3*                          outPositions,
+	Vec3*                          outNormals,
+	JobSystem*                     jobs = nullptr
+);
@@ -7,7 +7,7 @@ class StaticMesh;
 class StaticMeshRenderer;
 struct AABB;
 
-class MeshColliderComponent : public ColliderComponent {
+class MeshColliderComponent final : public ColliderComponent {
 public:
 	void OnAttach(Entity& owner) override;
 	void Update(float deltaTime) override;
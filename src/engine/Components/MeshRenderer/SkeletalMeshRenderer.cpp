@@ -5,6 +5,7 @@
 #include <engine/Components/MeshRenderer/SkeletalMeshRenderer.h>
 
 #include "engine/Engine.h"
+#include "engine/Animation/AnimationPose.h"
 #include "engine/Camera/CameraManager.h"
 #include "engine/Debug/Debug.h"
 #include "engine/Debug/DebugHud.h"
@@ -29,6 +30,8 @@ SkeletalMeshRenderer::~SkeletalMeshRenderer() {
 	mBoneMatrices         = nullptr;
 	mSkeletalMesh         = nullptr;
 	mCurrentAnimation     = nullptr;
+	mCurrentClip          = nullptr;
+	mFadeClip             = nullptr;
 }
 
 void SkeletalMeshRenderer::OnAttach(Entity& owner) {
@@ -135,6 +138,21 @@ void SkeletalMeshRenderer::Update(float deltaTime) {
 			mIsPlaying     = false;
 		}
 
+		if (mFadeDuration > 0.0f) {
+			mFadeElapsed += deltaTime;
+			if (mFadeElapsed >= mFadeDuration) {
+				mFadeClip     = nullptr;
+				mFadeDuration = 0.0f;
+			} else if (mFadeClip) {
+				// 長さ0のクリップで fmod が NaN を返さないように
+				const float duration = mFadeClip->Duration();
+				mFadeTime += deltaTime * mAnimationSpeed;
+				mFadeTime = mFadeLooping && duration > 0.0f ?
+					            std::fmod(mFadeTime, duration) :
+					            std::min(mFadeTime, duration);
+			}
+		}
+
 		// ボーン変換行列を更新
 		UpdateBoneMatrices();
 	}
@@ -492,6 +510,7 @@ void SkeletalMeshRenderer::SetSkeletalMesh(SkeletalMesh* skeletalMesh) {
 		mCurrentAnimationName  = firstAnim->first;
 		mCurrentAnimation      = &firstAnim->second;
 		mAnimationTime         = 0.0f;
+		BindAnimation(mCurrentAnimationName);
 	}
 }
 
@@ -506,6 +525,7 @@ void SkeletalMeshRenderer::PlayAnimation(const std::string& animationName,
 		mIsLooping            = loop;
 		mIsPlaying            = true;
 		mAnimationTime        = 0.0f;
+		BindAnimation(animationName);
 
 		Msg(
 			"SkeletalMeshRenderer",
@@ -520,7 +540,53 @@ void SkeletalMeshRenderer::PlayAnimation(const std::string& animationName,
 	}
 }
 
+void SkeletalMeshRenderer::CrossfadeAnimation(
+	const std::string& animationName,
+	const float        seconds,
+	const bool         loop
+) {
+	if (!mSkeletalMesh) return;
+
+	const AnimationClip* previous = mIsPlaying ? mCurrentClip : nullptr;
+	if (!previous || seconds <= 0.0f ||
+		!mSkeletalMesh->GetAnimation(animationName)) {
+		PlayAnimation(animationName, loop);
+		return;
+	}
+
+	// フェード中なら2つのクリップを混ぜた今の姿勢で止めて、そこから切り替える
+	if (mFadeDuration > 0.0f) {
+		std::vector<JointPose> current = mLocalPose;
+		PlayAnimation(animationName, loop);
+
+		mFadePose     = std::move(current);
+		mFadePose.resize(mSkeletalMesh->GetFlatSkeleton().JointCount());
+		mFadeElapsed  = 0.0f;
+		mFadeDuration = seconds;
+		return;
+	}
+
+	// 新しいクリップを結び付けると上書きされるので、今のクリップの状態を先に退避する
+	std::vector<uint32_t> previousBinding = std::move(mClipBinding);
+	AnimationClipCursor   previousCursor  = std::move(mClipCursor);
+	const float           previousTime    = mAnimationTime;
+	const bool            previousLooping = mIsLooping;
+
+	PlayAnimation(animationName, loop);
+
+	mFadeClip     = previous;
+	mFadeBinding  = std::move(previousBinding);
+	mFadeCursor   = std::move(previousCursor);
+	mFadeTime     = previousTime;
+	mFadeElapsed  = 0.0f;
+	mFadeDuration = seconds;
+	mFadeLooping  = previousLooping;
+	mFadePose.resize(mSkeletalMesh->GetFlatSkeleton().JointCount());
+}
+
 void SkeletalMeshRenderer::StopAnimation() {
+	mFadeClip      = nullptr;
+	mFadeDuration  = 0.0f;
 	mIsPlaying     = false;
 	mAnimationTime = 0.0f;
 }
@@ -557,64 +623,52 @@ void SkeletalMeshRenderer::BindTransform(
 }
 
 void SkeletalMeshRenderer::UpdateBoneMatrices() {
-	if (!mSkeletalMesh || !mCurrentAnimation) return;
+	if (!mSkeletalMesh || !mCurrentClip || !mBoneMatrices) return;
 
-	const Skeleton& skeleton = mSkeletalMesh->GetSkeleton();
-
-	// ボーン行列を単位行列で初期化
-	for (int i = 0; i < BoneMatrices::MAX_BONES; ++i) {
-		mBoneMatrices->bones[i] = Mat4::identity;
+	// ジョイントは親から順に並んでいるので、前から1回なめるだけで済む
+	const FlatSkeleton& skeleton = mSkeletalMesh->GetFlatSkeleton();
+	skeleton.SampleLocalPose(
+		*mCurrentClip, mClipBinding, mAnimationTime, mClipCursor,
+		mLocalPose.data()
+	);
+	if (mFadeDuration > 0.0f) {
+		// クリップが無ければ mFadePose は切り替えた時の姿勢のまま
+		if (mFadeClip) {
+			skeleton.SampleLocalPose(
+				*mFadeClip, mFadeBinding, mFadeTime, mFadeCursor, mFadePose.data()
+			);
+		}
+		BlendPoses(
+			mFadePose.data(), mLocalPose.data(), mFadeElapsed / mFadeDuration,
+			skeleton.JointCount(), mLocalPose.data()
+		);
 	}
-
-	// ルートノードから開始して変換行列を計算
-	CalculateNodeTransform(skeleton.rootNode, Mat4::identity, mCurrentAnimation,
-	                       mAnimationTime);
+	skeleton.LocalToModel(mLocalPose.data(), mModelPose.data());
+	skeleton.WriteSkinMatrices(
+		mModelPose.data(), mBoneMatrices->bones, BoneMatrices::MAX_BONES
+	);
 }
 
-void SkeletalMeshRenderer::CalculateNodeTransform(
-	const Node&      node, const Mat4& parentTransform,
-	const Animation* animation, float  animationTime) {
-	Mat4 nodeTransform = node.localMat;
-
-	// アニメーションデータがある場合は適用
-	if (animation && animation->nodeAnimations.find(node.name) != animation->
-		nodeAnimations.end()) {
-		const NodeAnimation& nodeAnim = animation->nodeAnimations.at(node.name);
-
-		Vec3 translation = CalculateValue(nodeAnim.translate.keyFrames,
-		                                  animationTime);
-		Quaternion rotation = CalculateValue(nodeAnim.rotate.keyFrames,
-		                                     animationTime);
-
-		Vec3 scale    = CalculateValue(nodeAnim.scale.keyFrames, animationTime);
-		nodeTransform = Mat4::Affine(
-			scale,
-			rotation,
-			translation
-		);
+void SkeletalMeshRenderer::BindAnimation(const std::string& animationName) {
+	mFadeClip     = nullptr;
+	mFadeDuration = 0.0f;
+	mCurrentClip  = mSkeletalMesh->GetClip(animationName);
+	if (!mCurrentClip) {
+		mClipBinding.clear();
+		return;
 	}
 
-	// 左手座標系かつ行ベクトルの場合、変換順序を修正
-	Mat4 globalTransform = nodeTransform * parentTransform;
-
-	// このノードがボーンの場合、変換行列を設定
-	if (mSkeletalMesh) {
-		const Skeleton& skeleton = mSkeletalMesh->GetSkeleton();
-		auto            it       = skeleton.boneMap.find(node.name);
-		if (it != skeleton.boneMap.end()) {
-			int boneIndex = it->second;
-			if (boneIndex < BoneMatrices::MAX_BONES) {
-				// 元の計算に戻す（補正なし）
-				mBoneMatrices->bones[boneIndex] = skeleton.
-					bones[boneIndex].offsetMatrix * globalTransform;
-			}
-		}
-	}
+	const FlatSkeleton& skeleton = mSkeletalMesh->GetFlatSkeleton();
+	mClipBinding                 = skeleton.Bind(*mCurrentClip);
+	mClipCursor.Reset(*mCurrentClip);
+	mLocalPose.resize(skeleton.JointCount());
+	mModelPose.resize(skeleton.JointCount());
 
-	// 子ノードを再帰的に処理
-	for (const Node& child : node.children) {
-		CalculateNodeTransform(child, globalTransform, animation,
-		                       animationTime);
+	// スキン行列はボーンの分だけ毎フレーム上書きするので、残りはここで一度だけ初期化する
+	if (mBoneMatrices) {
+		for (auto& bone : mBoneMatrices->bones) {
+			bone = Mat4::identity;
+		}
 	}
 }
 
@@ -40,6 +40,9 @@ public:
 
 	// アニメーション制御
 	void                PlayAnimation(const std::string& animationName, bool loop = true);
+	// 今の姿勢から seconds 秒かけて切り替えます。再生中でなければ PlayAnimation と同じです
+	// フェード中に呼ぶと、混ぜている途中の姿勢を止めてそこから切り替えます
+	void                CrossfadeAnimation(const std::string& animationName, float seconds, bool loop = true);
 	void                StopAnimation();
 	void                PauseAnimation();
 	void                ResumeAnimation();
@@ -56,9 +59,8 @@ public:
 protected:
 	void BindTransform(ID3D12GraphicsCommandList* commandList) override;
 	void UpdateBoneMatrices();
-	void CalculateNodeTransform(const Node& node, const Mat4& parentTransform,
-	                            const Animation* animation,
-	                            float animationTime);
+	// クリップのチャンネルをジョイントに結び付け、ボーン行列を初期化します
+	void BindAnimation(const std::string& animationName);
 
 	void DrawBoneHierarchy(const Node& node, const Mat4& parentTransform);
 	void DrawBoneDebug();
@@ -81,6 +83,25 @@ private:
 	// アニメーション制御
 	const Animation* mCurrentAnimation = nullptr;
 	std::string      mCurrentAnimationName;
+
+	// 毎フレームの評価用。PlayAnimation の時に作ります
+	const AnimationClip*   mCurrentClip = nullptr;
+	std::vector<uint32_t>  mClipBinding; // ジョイントごとのチャンネル
+	AnimationClipCursor    mClipCursor;
+	std::vector<JointPose> mLocalPose;
+	std::vector<Mat4>      mModelPose;
+
+	// クロスフェード中のフェードアウトする側(mFadeDuration が 0 より大きい間)
+	// mFadeClip が無い時は mFadePose が止めた姿勢
+	const AnimationClip*   mFadeClip = nullptr;
+	std::vector<uint32_t>  mFadeBinding;
+	AnimationClipCursor    mFadeCursor;
+	std::vector<JointPose> mFadePose;
+	float                  mFadeTime     = 0.0f;
+	float                  mFadeElapsed  = 0.0f;
+	float                  mFadeDuration = 0.0f;
+	bool                   mFadeLooping  = true;
+
 	float            mAnimationTime  = 0.0f;
 	float            mAnimationSpeed = 1.0f;
 	bool             mIsPlaying      = false;
@@ -11,7 +11,7 @@ struct CameraForGPU;
 struct PointLight;
 struct SpotLight;
 
-class StaticMeshRenderer : public MeshRenderer {
+class StaticMeshRenderer final : public MeshRenderer {
 public:
 	StaticMeshRenderer() = default;
 	~StaticMeshRenderer() override;
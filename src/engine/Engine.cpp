@@ -7,9 +7,11 @@
 #endif
 
 #include <engine/Engine.h>
+#include <engine/Animation/AnimationBenchmark.h>
 #include <engine/Camera/CameraManager.h>
 #include <engine/Debug/Debug.h>
 #include <engine/Debug/DebugHud.h>
+#include <engine/gameframework/GameFrameworkBenchmark.h>
 #include <engine/ImGui/Icons.h>
 #include <engine/ImGui/ImGuiWidgets.h>
 #include <engine/Input/InputSystem.h>
@@ -24,9 +26,16 @@
 #include <engine/subsystem/interface/ServiceLocator.h>
 #include <engine/subsystem/time/TimeSystem.h>
 #include <engine/TextureManager/TexManager.h>
+#include <engine/uphysics/PhysicsBenchmark.h>
 #include <engine/Window/MainWindow.h>
 #include <engine/Window/WindowsUtils.h>
 
+#include <runtime/assets/core/AssetBenchmark.h>
+#include <runtime/assets/core/UAssetManager.h>
+#include <runtime/assets/loaders/AnimationLoader.h>
+#include <runtime/assets/loaders/CookedAnimationLoader.h>
+#include <runtime/render/RenderBenchmark.h>
+
 #include "game/scene/EmptyScene.h"
 #include "game/scene/GameScene.h"
 
@@ -121,7 +130,14 @@ namespace Unnamed {
 			ConVarManager::GetConVar("launchargs")->GetValueAsString()
 		);
 
-		mResourceManager = std::make_unique<ResourceManager>(mRenderer.get());
+		// 旧エンジンのリソースで共有するアセットマネージャー(今はアニメーションのみ)
+		mAssetManager = std::make_unique<UAssetManager>();
+		mAssetManager->RegisterLoader(std::make_unique<AnimationLoader>());
+		mAssetManager->RegisterLoader(std::make_unique<CookedAnimationLoader>());
+
+		mResourceManager = std::make_unique<ResourceManager>(
+			mRenderer.get(), mAssetManager.get()
+		);
 
 		mSrvManager = std::make_unique<SrvManager>();
 		mSrvManager->Init(mRenderer.get());
@@ -844,6 +860,9 @@ namespace Unnamed {
 
 		mRenderer->PostRender();
 
+		// 描画が終わったので、リロードで差し替えたペイロードを解放する
+		mAssetManager->CollectRetired();
+
 		mTimeSystem->EndFrame();
 	}
 
@@ -871,6 +890,7 @@ namespace Unnamed {
 #endif
 		mResourceManager->Shutdown();
 		mResourceManager.reset();
+		mAssetManager.reset();
 
 		SpecialMsg(
 			LogLevel::Success,
@@ -1042,6 +1062,229 @@ namespace Unnamed {
 			"Toggle editor mode."
 		);
 
+		// ベンチマーク
+		ConCommand::RegisterCommand(
+			"phys_bench_broadphase",
+			[]([[maybe_unused]] const std::vector<std::string>& args) {
+				UPhysics::Benchmark::RunBroadphase();
+			},
+			"Benchmark ray/box/sphere casts with TLAS vs linear broadphase."
+		);
+		ConCommand::RegisterCommand(
+			"phys_bench_batch",
+			[]([[maybe_unused]] const std::vector<std::string>& args) {
+				UPhysics::Benchmark::RunBatchQueries();
+			},
+			"Benchmark batched scene queries vs single-query calls."
+		);
+		ConCommand::RegisterCommand(
+			"phys_bench_bvh4",
+			[]([[maybe_unused]] const std::vector<std::string>& args) {
+				UPhysics::Benchmark::RunBVH4();
+			},
+			"Benchmark SSE BVH4 node tests and traversal vs the binary layout."
+		);
+		ConCommand::RegisterCommand(
+			"phys_stress_registry",
+			[]([[maybe_unused]] const std::vector<std::string>& args) {
+				UPhysics::Benchmark::RunRegistryStress();
+			},
+			"Churn thousands of colliders and verify cast results are unchanged."
+		);
+		ConCommand::RegisterCommand(
+			"phys_bench_build",
+			[]([[maybe_unused]] const std::vector<std::string>& args) {
+				UPhysics::Benchmark::RunBuild();
+			},
+			"Benchmark serial vs parallel BVH builds on a large mesh."
+		);
+		ConCommand::RegisterCommand(
+			"phys_bench_moving",
+			[]([[maybe_unused]] const std::vector<std::string>& args) {
+				UPhysics::Benchmark::RunMovingColliders();
+			},
+			"Compare moving colliders by transform update vs re-registration."
+		);
+		ConCommand::RegisterCommand(
+			"phys_bench_cache",
+			[]([[maybe_unused]] const std::vector<std::string>& args) {
+				UPhysics::Benchmark::RunBVHCache();
+			},
+			"Compare cold BVH builds against warm loads from the disk cache."
+		);
+		ConCommand::RegisterCommand(
+			"asset_bench_contention",
+			[]([[maybe_unused]] const std::vector<std::string>& args) {
+				Unnamed::AssetBenchmark::RunContention();
+			},
+			"Benchmark multithreaded asset lookups: mutex vs slot table."
+		);
+		ConCommand::RegisterCommand(
+			"asset_bench_mesh",
+			[](const std::vector<std::string>& args) {
+				if (args.empty()) {
+					Unnamed::AssetBenchmark::RunMeshLoad();
+				} else {
+					Unnamed::AssetBenchmark::RunMeshLoad(args[0]);
+				}
+			},
+			"Compare Assimp mesh loads with mapped cooked meshes. Usage: asset_bench_mesh [root]"
+		);
+		ConCommand::RegisterCommand(
+			"asset_bench_texture",
+			[](const std::vector<std::string>& args) {
+				if (args.empty()) {
+					Unnamed::AssetBenchmark::RunTextureLoad();
+				} else {
+					Unnamed::AssetBenchmark::RunTextureLoad(args[0]);
+				}
+			},
+			"Compare RGBA8 texture loads with cooked BC textures. Usage: asset_bench_texture [root]"
+		);
+		ConCommand::RegisterCommand(
+			"asset_bench_animation",
+			[](const std::vector<std::string>& args) {
+				if (args.empty()) {
+					Unnamed::AssetBenchmark::RunAnimationLoad();
+				} else {
+					Unnamed::AssetBenchmark::RunAnimationLoad(args[0]);
+				}
+			},
+			"Compare per-call Assimp animation imports with cached cooked clips. Usage: asset_bench_animation [root]"
+		);
+		ConCommand::RegisterCommand(
+			"shader_cache_check",
+			[]([[maybe_unused]] const std::vector<std::string>& args) {
+				Unnamed::RenderBenchmark::RunShaderCache();
+			},
+			"Check shader cache hits, include invalidation and compile dedupe with a fake compiler."
+		);
+		ConCommand::RegisterCommand(
+			"pipeline_library_check",
+			[]([[maybe_unused]] const std::vector<std::string>& args) {
+				Unnamed::RenderBenchmark::RunPipelineLibrary();
+			},
+			"Check the pipeline manifest format and PSO precompile scheduling without a device."
+		);
+
+		ConCommand::RegisterCommand(
+			"render_bench_collect",
+			[](const std::vector<std::string>& args) {
+				if (!args.empty()) {
+					Unnamed::RenderBenchmark::RunCollect(
+						static_cast<uint32_t>(std::stoul(args[0]))
+					);
+					return;
+				}
+				Unnamed::RenderBenchmark::RunCollect(10000);
+				Unnamed::RenderBenchmark::RunCollect(100000);
+			},
+			"Compare serial draw collection against parallel frustum culling with radix-sorted keys. Usage: render_bench_collect [count]"
+		);
+
+		ConCommand::RegisterCommand(
+			"render_batch_check",
+			[]([[maybe_unused]] const std::vector<std::string>& args) {
+				Unnamed::RenderBenchmark::RunDrawBatching();
+			},
+			"Check instanced draw batching and report draw-call reduction on a repeated-prop scene."
+		);
+
+		ConCommand::RegisterCommand(
+			"render_record_check",
+			[]([[maybe_unused]] const std::vector<std::string>& args) {
+				Unnamed::RenderBenchmark::RunParallelRecording();
+			},
+			"Check thread-safe upload arena allocation and parallel draw recording against a mock command list."
+		);
+
+		ConCommand::RegisterCommand(
+			"transform_bench",
+			[](const std::vector<std::string>& args) {
+				Unnamed::GameFrameworkBenchmark::RunTransformHierarchy(
+					args.empty() ?
+						100000 :
+						static_cast<uint32_t>(std::stoul(args[0]))
+				);
+			},
+			"Compare per-component transform ticking against the depth-sorted transform system and verify world matrices. Usage: transform_bench [count]"
+		);
+
+		ConCommand::RegisterCommand(
+			"component_bench",
+			[](const std::vector<std::string>& args) {
+				Unnamed::GameFrameworkBenchmark::RunComponentLookup(
+					args.empty() ?
+						100000 :
+						static_cast<uint32_t>(std::stoul(args[0]))
+				);
+			},
+			"Compare dynamic_cast component lookups against per-type component pools and verify they agree. Usage: component_bench [count]"
+		);
+
+		ConCommand::RegisterCommand(
+			"world_tick_check",
+			[](const std::vector<std::string>& args) {
+				Unnamed::GameFrameworkBenchmark::RunWorldTick(
+					args.empty() ?
+						10000 :
+						static_cast<uint32_t>(std::stoul(args[0]))
+				);
+			},
+			"Check that nested worlds tick once per frame in ordered phases and report per-phase timings. Usage: world_tick_check [count]"
+		);
+
+		ConCommand::RegisterCommand(
+			"anim_clip_bench",
+			[](const std::vector<std::string>& args) {
+				Unnamed::AnimationBenchmark::RunClipSampling(
+					args.empty() ?
+						200 :
+						static_cast<uint32_t>(std::stoul(args[0])),
+					args.size() < 2 ? 60.0f : std::stof(args[1])
+				);
+			},
+			"Compare keyframe scans against compressed animation clips with sample cursors and report error and memory. Usage: anim_clip_bench [bones] [seconds]"
+		);
+
+		ConCommand::RegisterCommand(
+			"anim_pose_bench",
+			[](const std::vector<std::string>& args) {
+				if (!args.empty()) {
+					Unnamed::AnimationBenchmark::RunSkeletonPose(
+						static_cast<uint32_t>(std::stoul(args[0]))
+					);
+					return;
+				}
+				for (const uint32_t count : {1u, 100u, 1000u}) {
+					Unnamed::AnimationBenchmark::RunSkeletonPose(count);
+				}
+			},
+			"Compare recursive node-tree bone updates against flattened skeleton evaluation. Usage: anim_pose_bench [characters] (default: 1, 100 and 1000)"
+		);
+
+		ConCommand::RegisterCommand(
+			"anim_blend_check",
+			[](const std::vector<std::string>& args) {
+				const uint32_t count = args.empty() ?
+					                       1000u :
+					                       static_cast<uint32_t>(std::stoul(args[0]));
+				Unnamed::AnimationBenchmark::RunBlendGraph(count);
+			},
+			"Check blend1D/additive/layer graph results and time serial vs job-parallel graph updates. Usage: anim_blend_check [characters] (default: 1000)"
+		);
+
+		ConCommand::RegisterCommand(
+			"anim_skin_bench",
+			[](const std::vector<std::string>& args) {
+				const uint32_t count = args.empty() ?
+					                       100000u :
+					                       static_cast<uint32_t>(std::stoul(args[0]));
+				Unnamed::AnimationBenchmark::RunSkinning(count);
+			},
+			"Check CPU skinning (SIMD linear and dual quaternion) against a scalar reference and report vertices/sec serial vs job-parallel. Usage: anim_skin_bench [vertices] (default: 100000)"
+		);
+
 		// コンソール変数を登録
 		ConVarManager::RegisterConVar<bool>("r_vulkanenabled", false,
 		                                    "Enable Vulkan renderer",
@@ -1129,6 +1372,7 @@ namespace Unnamed {
 
 	bool                             Engine::mWishShutdown    = false;
 	std::unique_ptr<D3D12>           Engine::mRenderer        = nullptr;
+	std::unique_ptr<UAssetManager>   Engine::mAssetManager    = nullptr;
 	std::unique_ptr<ResourceManager> Engine::mResourceManager = nullptr;
 	std::unique_ptr<ParticleManager> Engine::mParticleManager = nullptr;
 	std::unique_ptr<SrvManager>      Engine::mSrvManager      = nullptr;
@@ -25,6 +25,7 @@
 
 namespace Unnamed {
 	class ConsoleSystem;
+	class UAssetManager;
 
 	class Engine {
 	public:
@@ -116,6 +117,7 @@ namespace Unnamed {
 		std::unique_ptr<OldWindowManager> mWindowManager;
 
 		static std::unique_ptr<SrvManager>      mSrvManager;
+		static std::unique_ptr<UAssetManager>   mAssetManager;
 		static std::unique_ptr<ResourceManager> mResourceManager;
 
 		static std::unique_ptr<D3D12> mRenderer;
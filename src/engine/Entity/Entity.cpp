@@ -4,6 +4,8 @@
 #include <engine/Entity/Entity.h>
 #include <engine/OldConsole/ConVarManager.h>
 
+#include <runtime/physics/core/UPhysics.h>
+
 #include "engine/Debug/DebugHud.h"
 #include "engine/ImGui/ImGuiUtil.h"
 
@@ -12,13 +14,10 @@
 #endif
 
 Entity::~Entity() {
-	/*if (auto* collider = GetComponent<ColliderComponent>()) {
-		if (collider) {
-			if (collider->GetPhysicsEngine()) {
-				collider->GetPhysicsEngine()->UnregisterEntity(this);
-			}
-		}
-	}*/
+	// 物理エンジンが破棄済みのポインタを毎フレーム読まないように、登録を解除する
+	if (mUPhysicsEngine) {
+		mUPhysicsEngine->UnregisterEntity(this);
+	}
 }
 
 void Entity::PrePhysics(float deltaTime) const {
@@ -333,4 +332,13 @@ void Entity::SetName(const std::string& name) {
 
 void Entity::RemoveAllComponents() {
 	mComponents.clear();
+	mComponentTypes.clear();
+}
+
+UPhysics::Engine* Entity::GetUPhysicsEngine() const {
+	return mUPhysicsEngine;
+}
+
+void Entity::SetUPhysicsEngine(UPhysics::Engine* engine) {
+	mUPhysicsEngine = engine;
 }
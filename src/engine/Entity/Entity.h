@@ -9,6 +9,11 @@
 
 #include <engine/Components/Base/Component.h>
 #include <engine/Components/Transform/SceneComponent.h>
+#include <engine/gameframework/component/base/ComponentTypeId.h>
+
+namespace UPhysics {
+	class Engine;
+}
 
 enum class EntityType {
 	RuntimeOnly, // ゲーム中のみ
@@ -44,6 +49,7 @@ public:
 	void               SetVisible(bool visible);
 
 	// コンポーネント
+	// final の型は型番号で引き、それ以外は派生も含めて dynamic_cast で探します
 	template <typename T, typename... Args>
 	T* AddComponent(Args&&... args);
 	template <typename T>
@@ -69,17 +75,24 @@ public:
 
 	void RemoveAllComponents();
 
+	// 登録先の物理エンジン(登録中のみ)。破棄する時にここから登録を解除します
+	[[nodiscard]] UPhysics::Engine* GetUPhysicsEngine() const;
+	void                            SetUPhysicsEngine(UPhysics::Engine* engine);
+
 private:
 	Entity* mParent = nullptr;
 	std::vector<Entity*> mChildren;
 
 	std::unique_ptr<SceneComponent>         mScene;
 	std::vector<std::unique_ptr<Component>> mComponents;
+	std::vector<Unnamed::ComponentTypeId>   mComponentTypes; // mComponents と同じ並び
 	EntityType                              mEntityType; // エンティティの種類
 	std::string                             mName;       // エンティティの名前
 
 	bool bIsActive_ = true; // Updateを呼ぶかどうか
 	bool bIsVisible_ = true; // 描画を行うかどうか
+
+	UPhysics::Engine* mUPhysicsEngine = nullptr; // 登録先の物理エンジン
 };
 
 template <typename T, typename... Args>
@@ -89,18 +102,29 @@ T* Entity::AddComponent(Args&&... args) {
 	auto component = std::make_unique<T>(std::forward<Args>(args)...);
 	T* rawPtr = component.get();
 	mComponents.emplace_back(std::move(component));
+	mComponentTypes.emplace_back(Unnamed::ComponentTypeIdOf<T>());
 	rawPtr->OnAttach(*this);
 	return rawPtr;
 }
 
 template <typename T>
 T* Entity::GetComponent() {
-	for (const auto& component : mComponents) {
-		if (auto* castedComponent = dynamic_cast<T*>(component.get())) {
-			return castedComponent;
+	if constexpr (std::is_final_v<T>) {
+		const Unnamed::ComponentTypeId type = Unnamed::ComponentTypeIdOf<T>();
+		for (size_t i = 0; i < mComponentTypes.size(); ++i) {
+			if (mComponentTypes[i] == type) {
+				return static_cast<T*>(mComponents[i].get());
+			}
+		}
+		return nullptr;
+	} else {
+		for (const auto& component : mComponents) {
+			if (auto* castedComponent = dynamic_cast<T*>(component.get())) {
+				return castedComponent;
+			}
 		}
+		return nullptr;
 	}
-	return nullptr;
 }
 
 template <typename T>
@@ -120,12 +144,18 @@ template <typename T>
 bool Entity::HasComponent() const {
 	static_assert(std::is_base_of_v<Component, T>,
 		"T must derive from Component");
-	for (const auto& component : mComponents) {
-		if (dynamic_cast<T*>(component.get())) {
-			return true;
+	if constexpr (std::is_final_v<T>) {
+		return std::ranges::find(
+			mComponentTypes, Unnamed::ComponentTypeIdOf<T>()
+		) != mComponentTypes.end();
+	} else {
+		for (const auto& component : mComponents) {
+			if (dynamic_cast<T*>(component.get())) {
+				return true;
+			}
 		}
+		return false;
 	}
-	return false;
 }
 
 template <typename T>
@@ -136,6 +166,9 @@ bool Entity::RemoveComponent() {
 		if (auto* castedComponent = dynamic_cast<T*>(it->get())) {
 			// コンポーネントを削除する前にOnDetachを呼ぶ
 			castedComponent->OnDetach();
+			mComponentTypes.erase(
+				mComponentTypes.begin() + (it - mComponents.begin())
+			);
 			mComponents.erase(it);
 			return true; // 最初に見つかったコンポーネントを削除
 		}
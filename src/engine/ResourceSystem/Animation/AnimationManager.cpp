@@ -1,215 +1,127 @@
 ﻿#include "engine/ResourceSystem/Animation/AnimationManager.h"
 
-#include <cassert>
+#include <format>
 
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
+#include <engine/Animation/AnimationClip.h>
+
+#include <runtime/assets/core/UAssetManager.h>
+#include <runtime/assets/loaders/AnimationLoader.h>
 
 #include "engine/OldConsole/Console.h"
 
-void AnimationManager::Init() {
-	// 特に何もしない
+void AnimationManager::Init(Unnamed::UAssetManager* assetManager) {
+	assetManager_ = assetManager;
 }
 
 void AnimationManager::Shutdown() {
-	// アニメーションのキャッシュをクリア
-	animations_.clear();
-	fileAnimationNames_.clear();
+	// 配ったハンドルはクリップを共有しているので、マネージャーを消しても生きている
+	assetManager_ = nullptr;
 }
 
-Animation AnimationManager::GetAnimation(const std::string& name) const {
-	auto it = animations_.find(name);
-	if (it != animations_.end()) {
-		return it->second;
+AnimationManager::ClipHandle AnimationManager::GetAnimation(
+	const std::string& name
+) const {
+	const size_t separator = name.rfind("::");
+	const std::string filePath = separator != std::string::npos ?
+		                             name.substr(0, separator) :
+		                             name;
+	if (const Unnamed::AnimationAssetData* data = Find(filePath)) {
+		if (separator == std::string::npos) {
+			if (!data->clips.empty()) {
+				return data->clips.front();
+			}
+		} else if (ClipHandle clip = data->Find(name.substr(separator + 2))) {
+			return clip;
+		}
 	}
 	Console::Print(
 		std::format("アニメーションが見つかりませんでした: {}", name)
 	);
-	return {}; // 見つからなかった場合は空のアニメーションを返す
+	return nullptr;
 }
 
-Animation AnimationManager::LoadAnimationFile(const std::string& filePath) {
-	// キャッシュしているものがあったらそれを返す
-	auto it = animations_.find(filePath);
-	if (it != animations_.end()) {
-		return it->second;
-	}
-
-	// キャッシュに無い場合は新たに読み込む
-	Animation        animation;
-	Assimp::Importer importer;
-	const aiScene*   aScene = importer.ReadFile(filePath.c_str(), 0);
-	assert(aScene->mNumAnimations != 0 && "No animations found in the file");
-	aiAnimation* animationAssimp = aScene->mAnimations[0];
+AnimationManager::ClipHandle AnimationManager::LoadAnimationFile(
+	const std::string& filePath
+) {
 	// 最初のアニメーションだけ採用（既存の互換性のため）
-	animation = LoadSingleAnimation(animationAssimp);
-
-	// キャッシュに詰め込む
-	animations_[filePath] = animation;
-
-	return animation;
+	const Unnamed::AnimationAssetData* data = Load(filePath);
+	return data && !data->clips.empty() ? data->clips.front() : nullptr;
 }
 
-std::vector<Animation> AnimationManager::LoadAllAnimationsFromFile(const std::string& filePath) {
-	std::vector<Animation> animations;
-	
-	Assimp::Importer importer;
-	const aiScene* aScene = importer.ReadFile(filePath.c_str(), 0);
-	assert(aScene && "Failed to load animation file");
-	assert(aScene->mNumAnimations != 0 && "No animations found in the file");
-	
-	// ファイル内のアニメーション名をキャッシュ
-	std::vector<std::string> animationNames;
-	
-	for (uint32_t animIndex = 0; animIndex < aScene->mNumAnimations; ++animIndex) {
-		aiAnimation* animationAssimp = aScene->mAnimations[animIndex];
-		Animation animation = LoadSingleAnimation(animationAssimp);
-		
-		// アニメーションに名前をつける
-		std::string animationKey = filePath + "::" + std::string(animationAssimp->mName.C_Str());
-		animationNames.emplace_back(animationAssimp->mName.C_Str());
-		
-		// キャッシュに保存
-		animations_[animationKey] = animation;
-		animations.emplace_back(animation);
-	}
-	
-	// ファイルのアニメーション名リストをキャッシュ
-	fileAnimationNames_[filePath] = animationNames;
-	
-	return animations;
+std::vector<AnimationManager::ClipHandle> AnimationManager::LoadAllAnimationsFromFile(
+	const std::string& filePath
+) {
+	const Unnamed::AnimationAssetData* data = Load(filePath);
+	return data ? data->clips : std::vector<ClipHandle>{};
 }
 
-Animation AnimationManager::LoadAnimationByName(const std::string& filePath, const std::string& animationName) {
-	// キャッシュを確認
-	const std::string animationKey = filePath + "::" + animationName;
-	auto it = animations_.find(animationKey);
-	if (it != animations_.end()) {
-		return it->second;
+AnimationManager::ClipHandle AnimationManager::LoadAnimationByName(
+	const std::string& filePath,
+	const std::string& animationName
+) {
+	const Unnamed::AnimationAssetData* data = Load(filePath);
+	if (!data) {
+		return nullptr;
 	}
-	
-	Assimp::Importer importer;
-	const aiScene* aScene = importer.ReadFile(filePath.c_str(), 0);
-	assert(aScene && "Failed to load animation file");
-	assert(aScene->mNumAnimations != 0 && "No animations found in the file");
-	
-	// 指定された名前のアニメーションを探す
-	for (uint32_t animIndex = 0; animIndex < aScene->mNumAnimations; ++animIndex) {
-		aiAnimation* animationAssimp = aScene->mAnimations[animIndex];
-		if (std::string(animationAssimp->mName.C_Str()) == animationName) {
-			Animation animation = LoadSingleAnimation(animationAssimp);
-			
-			// キャッシュに保存
-			animations_[animationKey] = animation;
-			return animation;
-		}
+	if (ClipHandle clip = data->Find(animationName)) {
+		return clip;
 	}
-	
 	Console::Print(
 		std::format("指定されたアニメーションが見つかりませんでした: {} in {}", animationName, filePath)
 	);
-	return {};
+	return nullptr;
 }
 
-std::vector<std::string> AnimationManager::GetAnimationNamesFromFile(const std::string& filePath) {
-	// キャッシュを確認
-	auto it = fileAnimationNames_.find(filePath);
-	if (it != fileAnimationNames_.end()) {
-		return it->second;
-	}
-	
-	std::vector<std::string> animationNames;
-	
-	Assimp::Importer importer;
-	const aiScene* aScene = importer.ReadFile(filePath.c_str(), 0);
-	if (!aScene || aScene->mNumAnimations == 0) {
-		return animationNames;
+std::vector<std::string> AnimationManager::GetAnimationNamesFromFile(
+	const std::string& filePath
+) {
+	const Unnamed::AnimationAssetData* data = Load(filePath);
+	return data ? data->names : std::vector<std::string>{};
+}
+
+Unnamed::AssetID AnimationManager::LoadFile(const std::string& filePath) {
+	if (!assetManager_) {
+		return Unnamed::kInvalidAssetID;
 	}
-	
-	for (uint32_t animIndex = 0; animIndex < aScene->mNumAnimations; ++animIndex) {
-		aiAnimation* animationAssimp = aScene->mAnimations[animIndex];
-		animationNames.emplace_back(std::string(animationAssimp->mName.C_Str()));
+	return assetManager_->LoadFromFile(
+		Unnamed::AnimationLoader::AssetPathFor(filePath),
+		Unnamed::UASSET_TYPE::ANIMATION
+	);
+}
+
+bool AnimationManager::Reload(const std::string& filePath) {
+	if (!assetManager_) {
+		return false;
 	}
-	
-	// キャッシュに保存
-	fileAnimationNames_[filePath] = animationNames;
-	
-	return animationNames;
+	const Unnamed::AssetID id = assetManager_->FindByPath(
+		Unnamed::AnimationLoader::AssetPathFor(filePath)
+	);
+	return id != Unnamed::kInvalidAssetID && assetManager_->Reload(id);
 }
 
-Animation AnimationManager::LoadSingleAnimation(const aiAnimation* animationAssimp) {
-	Animation animation;
-	animation.duration = static_cast<float>(
-		animationAssimp->mDuration / animationAssimp->mTicksPerSecond
+const Unnamed::AnimationAssetData* AnimationManager::Find(
+	const std::string& filePath
+) const {
+	if (!assetManager_) {
+		return nullptr;
+	}
+	const Unnamed::AssetID id = assetManager_->FindByPath(
+		Unnamed::AnimationLoader::AssetPathFor(filePath)
 	);
+	return assetManager_->Get<Unnamed::AnimationAssetData>(id);
+}
 
-	for (
-		uint32_t channelIndex = 0;
-		channelIndex < animationAssimp->mNumChannels
-		; ++channelIndex
-	) {
-		aiNodeAnim* nodeAnimationAssimp = animationAssimp->mChannels[
-			channelIndex];
-		NodeAnimation& nodeAnimation = animation.nodeAnimations[
-			nodeAnimationAssimp->mNodeName.C_Str()
-		];
-		// ノード名をキャッシュに追加
-		animation.nodeNames.emplace_back(
-			nodeAnimationAssimp->mNodeName.C_Str()
+const Unnamed::AnimationAssetData* AnimationManager::Load(
+	const std::string& filePath
+) {
+	const Unnamed::AnimationAssetData* data =
+		assetManager_ ?
+			assetManager_->Get<Unnamed::AnimationAssetData>(LoadFile(filePath)) :
+			nullptr;
+	if (!data) {
+		Console::Print(
+			std::format("アニメーションを読み込めませんでした: {}", filePath)
 		);
-		for (
-			uint32_t keyIndex = 0;
-			keyIndex < nodeAnimationAssimp->mNumPositionKeys;
-			++keyIndex
-		) {
-			aiVectorKey& keyAssimp = nodeAnimationAssimp->mPositionKeys[
-				keyIndex];
-			Keyframe<Vec3> keyframe;
-			keyframe.time = static_cast<float>(keyAssimp.mTime / animationAssimp
-				->mTicksPerSecond); // 秒に変換
-			keyframe.value = {
-				-keyAssimp.mValue.x,
-				keyAssimp.mValue.y,
-				keyAssimp.mValue.z
-			}; // 右手から左手
-			nodeAnimation.translate.keyFrames.emplace_back(keyframe);
-		}
-		for (
-			uint32_t keyIndex = 0;
-			keyIndex < nodeAnimationAssimp->mNumRotationKeys;
-			++keyIndex
-		) {
-			aiQuatKey& keyAssimp = nodeAnimationAssimp->mRotationKeys[
-				keyIndex];
-			Keyframe<Quaternion> keyframe;
-			keyframe.time = static_cast<float>(keyAssimp.mTime /
-				animationAssimp->mTicksPerSecond);
-			keyframe.value = {
-				keyAssimp.mValue.x,
-				-keyAssimp.mValue.y,
-				-keyAssimp.mValue.z,
-				keyAssimp.mValue.w
-			}; // 右手から左手
-			nodeAnimation.rotate.keyFrames.emplace_back(keyframe);
-		}
-		for (
-			uint32_t keyIndex = 0;
-			keyIndex < nodeAnimationAssimp->mNumScalingKeys;
-			++keyIndex
-		) {
-			aiVectorKey& keyAssimp = nodeAnimationAssimp->mScalingKeys[
-				keyIndex];
-			Keyframe<Vec3> keyframe;
-			keyframe.time = static_cast<float>(keyAssimp.mTime /
-				animationAssimp->mTicksPerSecond);
-			keyframe.value = {
-				keyAssimp.mValue.x,
-				keyAssimp.mValue.y,
-				keyAssimp.mValue.z
-			};
-			nodeAnimation.scale.keyFrames.emplace_back(keyframe);
-		}
 	}
-
-	return animation;
+	return data;
 }
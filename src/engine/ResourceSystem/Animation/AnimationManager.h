@@ -1,42 +1,59 @@
 ﻿#pragma once
-#include <format>
-#include <unordered_map>
+#include <memory>
+#include <string>
 #include <vector>
 
-#include <engine/Animation/Animation.h>
+#include <runtime/assets/core/UAssetID.h>
 
-struct aiAnimation;
+class AnimationClip;
 
+namespace Unnamed {
+	class UAssetManager;
+	struct AnimationAssetData;
+}
+
+// ファイルごとのアニメーションをアセットとして読み込み、クリップを共有します
+// ファイルは最初に触った時に1回だけ読み込み(焼いたものがあればそれを読み)、
+// 名前の一覧も全クリップもそのペイロードから引くので、何度呼んでも読み直しません
 class AnimationManager {
 public:
-	void Init();
+	// 読み込み後に変更しないクリップ。コピーせずにそのまま持っていて構いません
+	using ClipHandle = std::shared_ptr<const AnimationClip>;
+
+	/// @param assetManager 読み込みに使う共有のマネージャー
+	/// @details AnimationLoader / CookedAnimationLoader を登録しておき、
+	/// リロードで差し替えた古いクリップはフレーム境界の CollectRetired で解放してください
+	void Init(Unnamed::UAssetManager* assetManager);
 
 	void Shutdown();
 
-	[[nodiscard]] Animation GetAnimation(const std::string& name) const;
+	// "ファイルパス::アニメーション名"、またはファイルパス(最初のアニメーション)で
+	// 読み込み済みのものを引きます。無ければnull
+	[[nodiscard]] ClipHandle GetAnimation(const std::string& name) const;
 
-	// 単一アニメーション読み込み
-	Animation LoadAnimationFile(const std::string& filePath);
+	// 単一アニメーション読み込み(ファイル内の最初のもの)
+	ClipHandle LoadAnimationFile(const std::string& filePath);
 
 	// 複数アニメーション読み込み
-	std::vector<Animation> LoadAllAnimationsFromFile(
-		const std::string& filePath);
+	std::vector<ClipHandle> LoadAllAnimationsFromFile(const std::string& filePath);
 
 	// ファイル内の特定のアニメーションを名前で読み込み
-	Animation LoadAnimationByName(const std::string& filePath,
-	                              const std::string& animationName);
+	ClipHandle LoadAnimationByName(const std::string& filePath,
+	                               const std::string& animationName);
 
 	// ファイル内のアニメーション名一覧を取得
-	std::vector<std::string> GetAnimationNamesFromFile(
-		const std::string& filePath);
+	std::vector<std::string> GetAnimationNamesFromFile(const std::string& filePath);
+
+	// ファイルのアセットを読み込んでIDを返します(読み込み済みならそのまま)
+	Unnamed::AssetID LoadFile(const std::string& filePath);
+
+	// ソースを読み直して差し替えます。取得済みのハンドルは古いクリップを指したままです
+	bool Reload(const std::string& filePath);
 
 private:
-	std::unordered_map<std::string, Animation> animations_;
-	// ファイルパス/アニメーション名
-	std::unordered_map<std::string, std::vector<std::string>>
-	fileAnimationNames_;
-	// アニメーション名/アニメーション
-
-	// アニメーション読み込みのヘルパー関数
-	static Animation LoadSingleAnimation(const aiAnimation* animationAssimp);
+	// 読み込みはしません
+	[[nodiscard]] const Unnamed::AnimationAssetData* Find(const std::string& filePath) const;
+	const Unnamed::AnimationAssetData*               Load(const std::string& filePath);
+
+	Unnamed::UAssetManager* assetManager_ = nullptr;
 };
@@ -8,8 +8,12 @@
 #include "engine/ResourceSystem/RootSignature/RootSignatureManager2.h"
 #include "engine/TextureManager/TexManager.h"
 
-ResourceManager::ResourceManager(D3D12* d3d12) :
+ResourceManager::ResourceManager(
+	D3D12*                  d3d12,
+	Unnamed::UAssetManager* assetManager
+) :
 	d3d12_(d3d12),
+	assetManager_(assetManager),
 	srvManager_(nullptr),
 	shaderManager_(nullptr),
 	materialManager_(nullptr),
@@ -33,7 +37,7 @@ void ResourceManager::Init() const {
 	meshManager_->Init(d3d12_->GetDevice(),
 	                   shaderManager_.get(), materialManager_.get());
 
-	animationManager_->Init();
+	animationManager_->Init(assetManager_);
 
 	Console::Print("ResourceManager の初期化が完了しました\n", kConTextColorCompleted,
 	               Channel::ResourceSystem);
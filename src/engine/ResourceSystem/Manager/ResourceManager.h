@@ -7,9 +7,13 @@
 
 class TexManager;
 
+namespace Unnamed {
+	class UAssetManager;
+}
+
 class ResourceManager {
 public:
-	ResourceManager(D3D12* d3d12);
+	ResourceManager(D3D12* d3d12, Unnamed::UAssetManager* assetManager);
 	~ResourceManager() = default;
 
 	void Init() const;
@@ -23,7 +27,8 @@ public:
 	[[nodiscard]] AnimationManager* GetAnimationManager() const;
 
 private:
-	D3D12* d3d12_;
+	D3D12*                  d3d12_;
+	Unnamed::UAssetManager* assetManager_;
 
 	std::unique_ptr<SrvManager>       srvManager_;
 	std::unique_ptr<ShaderManager>    shaderManager_;
@@ -7,21 +7,9 @@
 #include <engine/ResourceSystem/Mesh/SubMesh.h>
 
 #include "engine/Animation/Animation.h"
-
-// ボーン情報を格納する構造体
-struct Bone {
-	std::string name;
-	int         id;
-	Mat4        offsetMatrix; // ボーンのオフセット行列
-};
-
-// スケルトン情報を格納する構造体
-struct Skeleton {
-	std::vector<Bone>                bones;
-	std::map<std::string, int>       boneMap; // ボーン名からIDへのマップ
-	std::vector<Mat4>                boneMatrices; // ボーン変換行列
-	Node                             rootNode;
-};
+#include "engine/Animation/AnimationClip.h"
+#include "engine/Animation/FlatSkeleton.h"
+#include "engine/Animation/Skeleton.h"
 
 class SkeletalMesh {
 public:
@@ -44,16 +32,23 @@ public:
 
 	// スケルトン関連
 	void SetSkeleton(const Skeleton& skeleton) {
-		skeleton_ = skeleton;
+		skeleton_     = skeleton;
+		flatSkeleton_ = FlatSkeleton(skeleton_);
 	}
 
 	[[nodiscard]] const Skeleton& GetSkeleton() const {
 		return skeleton_;
 	}
 
+	// 毎フレームの姿勢の評価にはこちらを使います
+	[[nodiscard]] const FlatSkeleton& GetFlatSkeleton() const {
+		return flatSkeleton_;
+	}
+
 	// アニメーション関連
 	void AddAnimation(const std::string& name, const Animation& animation) {
 		animations_[name] = animation;
+		clips_[name]      = AnimationClip(animation);
 	}
 
 	[[nodiscard]] const Animation* GetAnimation(const std::string& name) const {
@@ -65,6 +60,12 @@ public:
 		return animations_;
 	}
 
+	// GetAnimation と同じアニメーションを圧縮したもの
+	[[nodiscard]] const AnimationClip* GetClip(const std::string& name) const {
+		auto it = clips_.find(name);
+		return it != clips_.end() ? &it->second : nullptr;
+	}
+
 	void Render(ID3D12GraphicsCommandList* commandList) const {
 		for (const auto& subMesh : subMeshes_) {
 			subMesh->Render(commandList);
@@ -77,11 +78,14 @@ public:
 		}
 		subMeshes_.clear();
 		animations_.clear();
+		clips_.clear();
 	}
 
 private:
 	std::string                           name_;
 	std::vector<std::unique_ptr<SubMesh>> subMeshes_;
 	Skeleton                              skeleton_;
+	FlatSkeleton                          flatSkeleton_;
 	std::map<std::string, Animation>      animations_;
+	std::map<std::string, AnimationClip>  clips_;
 };
@@ -0,0 +1,713 @@
+﻿#include <engine/gameframework/GameFrameworkBenchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <core/jobsystem/JobSystem.h>
+
+#include <engine/gameframework/component/base/ComponentRegistry.h>
+#include <engine/gameframework/component/Transform/TransformSystem.h>
+#include <engine/gameframework/entity/UEntity/UEntity.h>
+#include <engine/gameframework/world/UWorld.h>
+#include <engine/subsystem/console/Log.h>
+
+#include <runtime/core/math/Math.h>
+
+namespace Unnamed::GameFrameworkBenchmark {
+	namespace {
+		constexpr std::string_view kChannel = "GameFramework";
+
+		constexpr uint32_t kSeed            = 0x7F4A7C15u;
+		constexpr float    kRootChance      = 0.02f; // ルートになる割合
+		constexpr uint32_t kFrames          = 20;
+		constexpr float    kMovedPartial    = 0.1f; // 1フレームで動かす割合
+		constexpr float    kTolerance       = 1e-4f;
+		constexpr float    kTopologyChanges = 0.01f;
+
+		struct LocalTRS {
+			Vec3       position;
+			Quaternion rotation;
+			Vec3       scale;
+		};
+
+		// 旧 TransformComponent 相当
+		struct LegacyNode {
+			LocalTRS         local;
+			Mat4             world;
+			int32_t          parent = -1;
+			std::vector<int> children;
+			bool             dirty = true;
+		};
+
+		void LegacyMarkDirty(std::vector<LegacyNode>& nodes, const int index) {
+			nodes[index].dirty = true;
+			for (const int child : nodes[index].children) {
+				LegacyMarkDirty(nodes, child);
+			}
+		}
+
+		void LegacyTick(std::vector<LegacyNode>& nodes, const int index) {
+			LegacyNode& node = nodes[index];
+			if (!node.dirty) {
+				return;
+			}
+			const Mat4 S = Mat4::Scale(node.local.scale);
+			const Mat4 R = Mat4::FromQuaternion(node.local.rotation);
+			const Mat4 T = Mat4::Translate(node.local.position);
+
+			const Mat4 localMat = S * R * T;
+			if (node.parent >= 0) {
+				node.world = localMat * nodes[node.parent].world;
+			} else {
+				node.world = localMat;
+			}
+			node.dirty = false;
+		}
+
+		LocalTRS RandomTRS(std::mt19937& rng) {
+			std::uniform_real_distribution pos(-10.0f, 10.0f);
+			std::uniform_real_distribution angle(-180.0f, 180.0f); // 度
+			std::uniform_real_distribution scale(0.9f, 1.1f);
+
+			const Vec3 axis = Vec3(pos(rng), pos(rng), pos(rng)).Normalized();
+			return {
+				Vec3(pos(rng), pos(rng), pos(rng)),
+				Quaternion::AxisAngle(axis.IsZero() ? Vec3::up : axis, angle(rng)),
+				Vec3(scale(rng), scale(rng), scale(rng))
+			};
+		}
+
+		// 親から順に計算し直した正解
+		std::vector<Mat4> Reference(
+			const std::vector<LocalTRS>& locals,
+			const std::vector<int32_t>&  parents,
+			const std::vector<uint8_t>&  alive
+		) {
+			const size_t         count = locals.size();
+			std::vector<Mat4>    result(count);
+			std::vector<uint8_t> done(count, 0);
+			std::vector<int32_t> chain;
+			for (size_t i = 0; i < count; ++i) {
+				if (!alive[i]) {
+					continue;
+				}
+				chain.clear();
+				for (int32_t n = static_cast<int32_t>(i); n >= 0 && !done[n];
+				     n = parents[n]) {
+					chain.emplace_back(n);
+				}
+				for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+					const LocalTRS& l = locals[*it];
+					const Mat4 localMat = Mat4::Scale(l.scale) *
+						Mat4::FromQuaternion(l.rotation) *
+						Mat4::Translate(l.position);
+					result[*it] = parents[*it] >= 0 ?
+						              localMat * result[parents[*it]] :
+						              localMat;
+					done[*it] = 1;
+				}
+			}
+			return result;
+		}
+
+		float MaxError(const Mat4& a, const Mat4& b) {
+			float error = 0.0f;
+			for (int r = 0; r < 4; ++r) {
+				for (int c = 0; c < 4; ++c) {
+					const float diff = std::abs(a.m[r][c] - b.m[r][c]);
+					error = std::max(error, diff / std::max(1.0f, std::abs(b.m[r][c])));
+				}
+			}
+			return error;
+		}
+
+		// ルックアップ用の中身の無いコンポーネント
+		template <int Kind>
+		class BenchComponent : public BaseComponent {
+		public:
+			void Serialize(JsonWriter&) const override {
+			}
+
+			void Deserialize(const JsonReader&) override {
+			}
+
+			[[nodiscard]] std::string_view GetComponentName() const override {
+				return "BenchComponent";
+			}
+
+			uint32_t value = 0;
+		};
+
+		using BenchTransform = BenchComponent<0>;
+		using BenchMesh      = BenchComponent<1>;
+		using BenchLight     = BenchComponent<2>;
+		using BenchCamera    = BenchComponent<3>; // 少ない(ほとんど見つからない)
+
+		// 旧 BaseEntity::GetComponent
+		template <typename ComponentType>
+		ComponentType* LegacyGetComponent(const BaseEntity& entity) {
+			for (const auto& component : entity.GetComponents()) {
+				if (auto* casted = dynamic_cast<ComponentType*>(component.get())) {
+					return casted;
+				}
+			}
+			return nullptr;
+		}
+
+		template <typename ComponentType>
+		bool SameLookup(const BaseEntity& entity) {
+			return entity.GetComponent<ComponentType>() ==
+				LegacyGetComponent<ComponentType>(entity);
+		}
+
+		// 段階ごとに呼ばれた回数を全プローブで数える
+		struct TickProbeShared {
+			std::array<std::atomic<uint32_t>, kWorldTickPhaseCount> done = {};
+			std::atomic<uint32_t> orderViolations = 0;
+			uint32_t              probes          = 0;
+		};
+
+		// 呼ばれた回数を数え、前の段階が全員済んでいるかを確かめるコンポーネント
+		template <bool ThreadSafe>
+		class TickProbe : public BaseComponent {
+		public:
+			void PrePhysicsTick(float) override {
+				Hit(WORLD_TICK_PHASE::PRE_PHYSICS);
+			}
+
+			void OnTick(float) override {
+				Hit(WORLD_TICK_PHASE::TICK);
+			}
+
+			void PostPhysicsTick(float) override {
+				Hit(WORLD_TICK_PHASE::POST_PHYSICS);
+			}
+
+			[[nodiscard]] bool IsTickThreadSafe() const override {
+				return ThreadSafe;
+			}
+
+			void Serialize(JsonWriter&) const override {
+			}
+
+			void Deserialize(const JsonReader&) override {
+			}
+
+			[[nodiscard]] std::string_view GetComponentName() const override {
+				return "TickProbe";
+			}
+
+			TickProbeShared*                          shared = nullptr;
+			std::array<uint32_t, kWorldTickPhaseCount> calls  = {};
+			float                                     work   = 0.0f;
+
+		private:
+			void Hit(const WORLD_TICK_PHASE phase) {
+				const auto index = static_cast<size_t>(phase);
+				if (index > 0) {
+					// 前の段階はこのフレーム分まで全員済んでいるはず
+					const uint32_t expected = shared->probes * (calls[index] + 1);
+					if (shared->done[index - 1].load() != expected) {
+						shared->orderViolations.fetch_add(1);
+					}
+				}
+				// 少し重い処理の代わり
+				for (int i = 0; i < 256; ++i) {
+					work = work * 0.999f + static_cast<float>(i) * 1e-3f;
+				}
+				++calls[index];
+				shared->done[index].fetch_add(1);
+			}
+		};
+
+		double MsPerFrame(const std::chrono::steady_clock::duration elapsed) {
+			return std::chrono::duration<double, std::milli>(elapsed).count() /
+				kFrames;
+		}
+	}
+
+	bool RunTransformHierarchy(const uint32_t count) {
+		if (count == 0) {
+			return true;
+		}
+
+		std::mt19937 rng(kSeed);
+		std::uniform_real_distribution chance(0.0f, 1.0f);
+
+		// ランダムな順に並べ、各ノードはそれより前のノードを親にする(循環しない)
+		std::vector<int32_t> rank(count);
+		std::iota(rank.begin(), rank.end(), 0);
+		std::ranges::shuffle(rank, rng);
+
+		std::vector<LocalTRS> locals(count);
+		std::vector<int32_t>  parents(count, -1);
+		std::vector<uint8_t>  alive(count, 1);
+		for (uint32_t k = 0; k < count; ++k) {
+			const int32_t node = rank[k];
+			locals[node]       = RandomTRS(rng);
+			if (k > 0 && chance(rng) >= kRootChance) {
+				std::uniform_int_distribution<uint32_t> pick(0, k - 1);
+				parents[node] = rank[pick(rng)];
+			}
+		}
+
+		// 旧実装
+		std::vector<LegacyNode> legacy(count);
+		for (uint32_t i = 0; i < count; ++i) {
+			legacy[i].local  = locals[i];
+			legacy[i].parent = parents[i];
+			if (parents[i] >= 0) {
+				legacy[parents[i]].children.emplace_back(static_cast<int>(i));
+			}
+		}
+
+		// 新実装(ノードの作成もエンティティ順で、深さ順とは限らない)
+		TransformSystem              system;
+		std::vector<TransformHandle> handles(count);
+		for (uint32_t i = 0; i < count; ++i) {
+			handles[i] = system.Create();
+		}
+		for (uint32_t i = 0; i < count; ++i) {
+			if (parents[i] >= 0) {
+				system.SetParent(handles[i], handles[parents[i]]);
+			}
+			system.SetLocal(
+				handles[i], locals[i].position, locals[i].rotation, locals[i].scale
+			);
+		}
+
+		auto begin = std::chrono::steady_clock::now();
+		system.Update();
+		const double rebuildMs = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - begin
+		).count();
+
+		bool ok = true;
+
+		// 初回の旧実装は、エンティティ順に回すと親より先に回った子が古い行列を使う
+		for (uint32_t i = 0; i < count; ++i) {
+			LegacyTick(legacy, static_cast<int>(i));
+		}
+		{
+			const std::vector<Mat4> expected = Reference(locals, parents, alive);
+			uint32_t                stale    = 0;
+			float                   maxError = 0.0f;
+			for (uint32_t i = 0; i < count; ++i) {
+				if (MaxError(legacy[i].world, expected[i]) > kTolerance) {
+					++stale;
+				}
+				maxError = std::max(
+					maxError, MaxError(system.World(handles[i]), expected[i])
+				);
+			}
+			Msg(
+				kChannel,
+				"[{} transforms, {} levels] first frame: legacy left {} stale, "
+				"system max error {:.2e} (sort {:.3f} ms)",
+				count, system.LevelCount(), stale, maxError, rebuildMs
+			);
+			if (maxError > kTolerance) {
+				ok = false;
+			}
+		}
+
+		// 毎フレーム、一部(または全部)を動かして1フレーム分の時間を比べる
+		auto measure = [&](const float movedRatio, const char* label) {
+			std::vector<int> moved;
+			for (uint32_t i = 0; i < count; ++i) {
+				if (chance(rng) < movedRatio) {
+					moved.emplace_back(static_cast<int>(i));
+				}
+			}
+
+			auto start = std::chrono::steady_clock::now();
+			for (uint32_t frame = 0; frame < kFrames; ++frame) {
+				for (const int i : moved) {
+					LegacyMarkDirty(legacy, i);
+				}
+				for (uint32_t i = 0; i < count; ++i) {
+					LegacyTick(legacy, static_cast<int>(i));
+				}
+			}
+			const double legacyMs = MsPerFrame(
+				std::chrono::steady_clock::now() - start
+			);
+
+			auto runSystem = [&](JobSystem* jobs) {
+				start = std::chrono::steady_clock::now();
+				for (uint32_t frame = 0; frame < kFrames; ++frame) {
+					for (const int i : moved) {
+						system.SetLocal(
+							handles[i],
+							locals[i].position,
+							locals[i].rotation,
+							locals[i].scale
+						);
+					}
+					system.Update(jobs);
+				}
+				return MsPerFrame(std::chrono::steady_clock::now() - start);
+			};
+			const double serialMs   = runSystem(nullptr);
+			const double parallelMs = runSystem(&JobSystem::Get());
+
+			Msg(
+				kChannel,
+				"[{} transforms, {} lanes] {} ({} moved, {} recomputed): "
+				"legacy {:.3f} ms / system {:.3f} ms / parallel {:.3f} ms (x{:.1f})",
+				count, JobSystem::Get().MaxLanes(), label, moved.size(),
+				system.LastUpdatedCount(), legacyMs, serialMs, parallelMs,
+				legacyMs / std::max(parallelMs, 1e-6)
+			);
+		};
+		measure(kMovedPartial, "partial");
+		measure(1.0f, "all");
+
+		// 循環する親子付けは拒否する
+		for (uint32_t i = 0; i < count; ++i) {
+			if (parents[i] >= 0) {
+				if (system.SetParent(handles[parents[i]], handles[i]) ||
+					system.SetParent(handles[i], handles[i])) {
+					Warning(kChannel, "transform hierarchy FAILED: cycle accepted");
+					ok = false;
+				}
+				break;
+			}
+		}
+
+		// 付け替えと削除(子はルートに戻る)の後も一致するか
+		std::uniform_int_distribution<uint32_t> pickNode(0, count - 1);
+		const uint32_t changes = std::max(
+			1u, static_cast<uint32_t>(static_cast<float>(count) * kTopologyChanges)
+		);
+		for (uint32_t c = 0; c < changes; ++c) {
+			const uint32_t node   = pickNode(rng);
+			const uint32_t parent = pickNode(rng);
+			if (!alive[node] || !alive[parent]) {
+				continue;
+			}
+			if (system.SetParent(handles[node], handles[parent])) {
+				parents[node] = static_cast<int32_t>(parent);
+			}
+		}
+		for (uint32_t c = 0; c < changes; ++c) {
+			const uint32_t node = pickNode(rng);
+			if (!alive[node]) {
+				continue;
+			}
+			system.Destroy(handles[node]);
+			alive[node] = 0;
+			for (uint32_t i = 0; i < count; ++i) {
+				if (parents[i] == static_cast<int32_t>(node)) {
+					parents[i] = -1;
+				}
+			}
+		}
+		// 削除で空いたスロットを使い回しても、古いハンドルは無効のまま
+		const TransformHandle reused = system.Create();
+		for (uint32_t i = 0; i < count; ++i) {
+			if (!alive[i] && system.IsValid(handles[i])) {
+				Warning(kChannel, "transform hierarchy FAILED: stale handle is valid");
+				ok = false;
+				break;
+			}
+		}
+		system.Destroy(reused);
+
+		system.Update(&JobSystem::Get());
+		{
+			const std::vector<Mat4> expected = Reference(locals, parents, alive);
+			float                   maxError = 0.0f;
+			for (uint32_t i = 0; i < count; ++i) {
+				if (alive[i]) {
+					maxError = std::max(
+						maxError, MaxError(system.World(handles[i]), expected[i])
+					);
+				}
+			}
+			Msg(
+				kChannel,
+				"[{} transforms] after {} reparents / deletes: {} alive, "
+				"{} levels, max error {:.2e}",
+				count, changes, system.Count(), system.LevelCount(), maxError
+			);
+			if (maxError > kTolerance) {
+				ok = false;
+			}
+		}
+
+		if (!ok) {
+			Warning(kChannel, "transform hierarchy FAILED");
+		}
+		return ok;
+	}
+
+	bool RunComponentLookup(const uint32_t count) {
+		std::mt19937                   rng(kSeed);
+		std::uniform_real_distribution chance(0.0f, 1.0f);
+
+		std::vector<std::unique_ptr<UEntity>> entities;
+		entities.reserve(count);
+		for (uint32_t i = 0; i < count; ++i) {
+			auto entity = std::make_unique<UEntity>("bench");
+			// 付ける順もばらばらにする
+			if (chance(rng) < 0.5f) {
+				(void)entity->AddComponent<BenchLight>();
+			}
+			(void)entity->AddComponent<BenchTransform>();
+			if (chance(rng) < 0.8f) {
+				(void)entity->AddComponent<BenchMesh>();
+			}
+			if (chance(rng) < 0.001f) {
+				(void)entity->AddComponent<BenchCamera>();
+			}
+			entities.emplace_back(std::move(entity));
+		}
+
+		bool ok = true;
+
+		// 描画の収集と同じく、毎フレーム全エンティティから2つずつ引く
+		uint64_t legacySum = 0;
+		auto     begin     = std::chrono::steady_clock::now();
+		for (uint32_t frame = 0; frame < kFrames; ++frame) {
+			for (const auto& entity : entities) {
+				const auto* tr = LegacyGetComponent<BenchTransform>(*entity);
+				const auto* mr = LegacyGetComponent<BenchMesh>(*entity);
+				legacySum += (tr ? 1 : 0) + (mr ? 1 : 0);
+			}
+		}
+		const double legacyMs = MsPerFrame(std::chrono::steady_clock::now() - begin);
+
+		uint64_t poolSum = 0;
+		begin            = std::chrono::steady_clock::now();
+		for (uint32_t frame = 0; frame < kFrames; ++frame) {
+			for (const auto& entity : entities) {
+				const auto* tr = entity->GetComponent<BenchTransform>();
+				const auto* mr = entity->GetComponent<BenchMesh>();
+				poolSum += (tr ? 1 : 0) + (mr ? 1 : 0);
+			}
+		}
+		const double poolMs = MsPerFrame(std::chrono::steady_clock::now() - begin);
+
+		// メインカメラ探し(ほぼ全員が持っていない)
+		begin = std::chrono::steady_clock::now();
+		uint64_t legacyCameras = 0;
+		for (uint32_t frame = 0; frame < kFrames; ++frame) {
+			for (const auto& entity : entities) {
+				legacyCameras += LegacyGetComponent<BenchCamera>(*entity) ? 1 : 0;
+			}
+		}
+		const double legacyMissMs = MsPerFrame(
+			std::chrono::steady_clock::now() - begin
+		);
+
+		// 1つの型を詰めた順に全部回す
+		const auto& registry = ComponentRegistry::Get();
+		uint64_t    iterated = 0;
+		begin                = std::chrono::steady_clock::now();
+		for (uint32_t frame = 0; frame < kFrames; ++frame) {
+			registry.ForEach<BenchCamera>([&](const BenchCamera&) { ++iterated; });
+		}
+		const double forEachMs = MsPerFrame(
+			std::chrono::steady_clock::now() - begin
+		);
+
+		Msg(
+			kChannel,
+			"[{} entities] GetComponent x2: dynamic_cast {:.3f} ms / pool {:.3f} ms (x{:.1f})",
+			count, legacyMs, poolMs, legacyMs / std::max(poolMs, 1e-6)
+		);
+		Msg(
+			kChannel,
+			"[{} entities] find {} cameras: dynamic_cast scan {:.3f} ms / pool iteration {:.4f} ms",
+			count, legacyCameras / kFrames, legacyMissMs, forEachMs
+		);
+		if (legacySum != poolSum || legacyCameras != iterated) {
+			Warning(kChannel, "component lookup FAILED: counts differ");
+			ok = false;
+		}
+
+		auto verifyAll = [&](const char* stage) {
+			uint32_t mismatches = 0;
+			for (const auto& entity : entities) {
+				if (!entity) {
+					continue;
+				}
+				if (!SameLookup<BenchTransform>(*entity) ||
+					!SameLookup<BenchMesh>(*entity) ||
+					!SameLookup<BenchLight>(*entity) ||
+					!SameLookup<BenchCamera>(*entity)) {
+					++mismatches;
+				}
+			}
+			if (mismatches > 0) {
+				Warning(
+					kChannel,
+					"component lookup FAILED ({}): {} entities differ",
+					stage, mismatches
+				);
+				ok = false;
+			}
+		};
+		verifyAll("initial");
+
+		// 同じ型の重複: 先に付けたものが返り、それを外すと次のものが返る
+		{
+			UEntity    entity("dup");
+			auto*      first  = entity.AddComponent<BenchMesh>();
+			auto*      second = entity.AddComponent<BenchMesh>();
+			const bool firstWins = entity.GetComponent<BenchMesh>() == first;
+			entity.RemoveComponent(first);
+			const bool promoted = entity.GetComponent<BenchMesh>() == second;
+			entity.RemoveComponent(second);
+			if (!firstWins || !promoted || entity.GetComponent<BenchMesh>()) {
+				Warning(kChannel, "component lookup FAILED: duplicate handling");
+				ok = false;
+			}
+		}
+
+		// 一部を外したり、エンティティを消して作り直したりした後も一致するか
+		std::uniform_int_distribution<uint32_t> pick(0, count - 1);
+		for (uint32_t i = 0; i < count / 10; ++i) {
+			auto& entity = entities[pick(rng)];
+			if (!entity) {
+				continue;
+			}
+			if (chance(rng) < 0.5f) {
+				entity.reset();
+			} else if (auto* mesh = entity->GetComponent<BenchMesh>()) {
+				entity->RemoveComponent(mesh);
+			}
+		}
+		for (auto& entity : entities) {
+			if (!entity) {
+				// 空いた番号を使い回す。前の持ち主のコンポーネントが見えてはいけない
+				entity = std::make_unique<UEntity>("reused");
+				(void)entity->AddComponent<BenchLight>();
+			}
+		}
+		verifyAll("after remove / reuse");
+
+		if (!ok) {
+			Warning(kChannel, "component lookup FAILED");
+		}
+		return ok;
+	}
+
+	bool RunWorldTick(const uint32_t count) {
+		constexpr uint32_t kChildWorlds = 3;
+
+		using ProbeCalls = std::array<uint32_t, kWorldTickPhaseCount>;
+
+		TickProbeShared                shared;
+		std::vector<const ProbeCalls*> probes;
+		std::vector<UWorld*>           worlds;
+
+		auto populate = [&](UWorld& world, const uint32_t entities) {
+			for (uint32_t i = 0; i < entities; ++i) {
+				UEntity* entity = world.SpawnEmpty("probe");
+				// 1割はスレッドセーフでないものを混ぜる
+				if (i % 10 == 0) {
+					auto* probe   = entity->AddComponent<TickProbe<false>>();
+					probe->shared = &shared;
+					probes.emplace_back(&probe->calls);
+				} else {
+					auto* probe   = entity->AddComponent<TickProbe<true>>();
+					probe->shared = &shared;
+					probes.emplace_back(&probe->calls);
+				}
+			}
+			worlds.emplace_back(&world);
+		};
+
+		UWorld root("root");
+		populate(root, count);
+		for (uint32_t c = 0; c < kChildWorlds; ++c) {
+			auto child = std::make_unique<UWorld>("child");
+			populate(*child, std::max(1u, count / 10));
+			if (c == 0) {
+				auto grandchild = std::make_unique<UWorld>("grandchild");
+				populate(*grandchild, std::max(1u, count / 10));
+				child->AddChildWorld(std::move(grandchild), nullptr);
+			}
+			root.AddChildWorld(std::move(child), nullptr);
+		}
+		shared.probes = static_cast<uint32_t>(probes.size());
+
+		bool ok = true;
+
+		auto run = [&](JobSystem* jobs, const char* label) {
+			std::array<double, kWorldTickPhaseCount> phaseMs = {};
+			for (uint32_t frame = 0; frame < kFrames; ++frame) {
+				root.Tick(1.0f / 60.0f, jobs);
+				for (size_t p = 0; p < kWorldTickPhaseCount; ++p) {
+					phaseMs[p] += root.LastTickStats().phaseMs[p] / kFrames;
+				}
+			}
+			const WorldTickStats& stats = root.LastTickStats();
+			Msg(
+				kChannel,
+				"[{} entities, {} worlds] {}: {} {:.3f} ms / {} {:.3f} ms / {} {:.3f} ms "
+				"({} serial, {} parallel)",
+				probes.size(), stats.worlds, label,
+				ToString(WORLD_TICK_PHASE::PRE_PHYSICS), phaseMs[0],
+				ToString(WORLD_TICK_PHASE::TICK), phaseMs[1],
+				ToString(WORLD_TICK_PHASE::POST_PHYSICS), phaseMs[2],
+				stats.serialEntities, stats.parallelEntities
+			);
+		};
+		run(nullptr, "serial");
+		run(&JobSystem::Get(), "jobs");
+
+		constexpr uint32_t kTicks = kFrames * 2;
+		for (const UWorld* world : worlds) {
+			if (world->TickCount() != kTicks) {
+				Warning(
+					kChannel,
+					"world tick FAILED: '{}' ticked {} times in {} frames",
+					world->Name(), world->TickCount(), kTicks
+				);
+				ok = false;
+			}
+		}
+
+		uint32_t wrongCalls = 0;
+		for (const ProbeCalls* calls : probes) {
+			for (const uint32_t c : *calls) {
+				if (c != kTicks) {
+					++wrongCalls;
+					break;
+				}
+			}
+		}
+		const uint32_t violations = shared.orderViolations.load();
+		if (wrongCalls > 0 || violations > 0) {
+			Warning(
+				kChannel,
+				"world tick FAILED: {} probes miscounted, {} phase order violations",
+				wrongCalls, violations
+			);
+			ok = false;
+		}
+
+		// 旧実装は親のエンティティ1つごとに子ワールドを回していた
+		Msg(
+			kChannel,
+			"[{} entities] each of {} worlds ticked once per frame "
+			"(legacy ticked each child world once per root entity: {} times per frame)",
+			probes.size(), worlds.size(), count
+		);
+
+		if (!ok) {
+			Warning(kChannel, "world tick FAILED");
+		}
+		return ok;
+	}
+}
@@ -0,0 +1,24 @@
+﻿#pragma once
+#include <cstdint>
+
+namespace Unnamed::GameFrameworkBenchmark {
+	// count 個のトランスフォームをランダムな森にして、旧実装(セッターで子孫を再帰的に
+	// ダーティにし、エンティティ順に1つずつ親の行列を掛ける)と TransformSystem の
+	// 1フレームあたりのコストを比べてログに出します。
+	// 親の付け替えや削除の後も含めて、全ノードの行列が親から順に計算し直した値と一致するかを確認します
+	// @return 全て一致し、循環する親子付けを拒否できたらtrue
+	bool RunTransformHierarchy(uint32_t count);
+
+	// count 個のエンティティにいくつかの型のコンポーネントを付け、
+	// 旧実装(dynamic_cast で全コンポーネントをなめる)と型ごとのプールでの
+	// GetComponent と、1つの型を全て回す時間を比べてログに出します。
+	// 同じ型の重複、削除後の付け直し、エンティティ番号の使い回しでも結果が一致するかを確認します
+	// @return 全て一致したらtrue
+	bool RunComponentLookup(uint32_t count);
+
+	// 子と孫のワールドを持つワールドを Tick し、各ワールドが1フレームに1回だけ回ること、
+	// 全エンティティの PrePhysics が終わってから Tick、Tick が終わってから PostPhysics が
+	// 呼ばれることを確認します。1スレッドとワーカー込みの段階ごとの時間もログに出します
+	// @return 全て期待通りならtrue
+	bool RunWorldTick(uint32_t count);
+}
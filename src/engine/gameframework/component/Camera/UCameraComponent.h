@@ -19,6 +19,8 @@ namespace Unnamed {
 			return "Camera";
 		}
 
+		[[nodiscard]] bool IsTickThreadSafe() const override { return true; }
+
 		float fovY  = 90.0f * Math::deg2Rad;
 		float zNear = 0.001f;
 		float zFar  = 10000.0f;
@@ -37,6 +37,9 @@ namespace Unnamed {
 
 		void InvalidateGPU(RenderResourceManager* renderResourceManager);
 
+		// EnsureGPU が済んでいるか(描画の収集でワーカーから読みます)
+		[[nodiscard]] bool IsGPUReady() const { return mGPUReady; }
+
 
 		// BaseComponent interface
 		void OnAttached() override;
@@ -45,6 +48,8 @@ namespace Unnamed {
 		void Serialize(JsonWriter& writer) const override;
 		void Deserialize(const JsonReader& reader) override;
 
+		[[nodiscard]] bool IsTickThreadSafe() const override { return true; }
+
 	private:
 		bool mGPUReady = false;
 	};
@@ -16,6 +16,10 @@ namespace Unnamed {
 		}
 	}
 
+	bool RotatorComponent::IsTickThreadSafe() const {
+		return true;
+	}
+
 	/// @brief 毎フレーム呼び出され、回転を更新します。
 	void RotatorComponent::OnTick(float deltaTime) {
 		// 回転が無効、またはTransformComponentが無い場合は何もしない
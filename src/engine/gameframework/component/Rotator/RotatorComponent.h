@@ -21,6 +21,9 @@ namespace Unnamed {
 
 		[[nodiscard]] std::string_view GetComponentName() const override;
 
+		// 自分のエンティティの TransformComponent しか触りません
+		[[nodiscard]] bool IsTickThreadSafe() const override;
+
 		//---------------------------------------------------------------------
 		// RotatorComponent
 		//---------------------------------------------------------------------
@@ -9,6 +9,21 @@
 #include "engine/Debug/Debug.h"
 
 namespace Unnamed {
+	TransformComponent::TransformComponent()
+		: mNode(TransformSystem::Get().Create()) {
+	}
+
+	TransformComponent::~TransformComponent() {
+		// 子はルートに戻す
+		for (auto* child : mChildren) {
+			child->mParent = nullptr;
+		}
+		if (mParent) {
+			std::erase(mParent->mChildren, this);
+		}
+		TransformSystem::Get().Destroy(mNode);
+	}
+
 	const Vec3& TransformComponent::Position() const noexcept {
 		return mLocalPos;
 	}
@@ -26,7 +41,7 @@ namespace Unnamed {
 	}
 
 	const Mat4& TransformComponent::WorldMat() const noexcept {
-		return mWorldMat;
+		return TransformSystem::Get().World(mNode);
 	}
 
 	void TransformComponent::SetPosition(const Vec3& newPosition) {
@@ -53,6 +68,16 @@ namespace Unnamed {
 			return;
 		}
 
+		if (!TransformSystem::Get().SetParent(
+			mNode, newParent ? newParent->mNode : kInvalidTransform
+		)) {
+			Warning(
+				GetComponentName(),
+				"SetParent: 自分または子孫を親にしようとしました。"
+			);
+			return;
+		}
+
 		// 前回の親から自分を削除
 		if (mParent) {
 			auto& children = mParent->mChildren;
@@ -64,8 +89,6 @@ namespace Unnamed {
 		if (mParent) {
 			mParent->mChildren.emplace_back(this);
 		}
-
-		MarkDirty();
 	}
 
 	void TransformComponent::OnAttached() {
@@ -80,28 +103,17 @@ namespace Unnamed {
 	}
 
 	void TransformComponent::OnTick(float) {
-		if (!mIsDirty) {
-			return; // ・・・・・・なにも!!! な゛かった・・・!!!!(ドンッ!!)
-		}
-
-		Mat4 S = Mat4::Scale(mLocalScale);
-		Mat4 R = Mat4::FromQuaternion(mLocalRot);
-		Mat4 T = Mat4::Translate(mLocalPos);
-
-		const Mat4 localMat = S * R * T;
-
-		if (mParent) {
-			mWorldMat = localMat * mParent->WorldMat();
-		} else {
-			mWorldMat = localMat;
-		}
-
-		mIsDirty = false;
+		// 行列は TransformSystem::Update() でまとめて計算します
 	}
 
 	void TransformComponent::PostPhysicsTick(float) {
 	}
 
+	bool TransformComponent::IsTickThreadSafe() const {
+		// セッターは TransformSystem の自分のノードにしか書き込みません
+		return true;
+	}
+
 	void TransformComponent::OnPreRender() const {
 	}
 
@@ -161,6 +173,8 @@ namespace Unnamed {
 			mLocalScale = {(*s)[0], (*s)[1], (*s)[2]};
 		}
 
+		MarkDirty();
+
 		// if (
 		// 	auto parentId = reader.Read<uint64_t>("parentId");
 		// 	parentId && mOwner
@@ -191,9 +205,7 @@ namespace Unnamed {
 	}
 
 	void TransformComponent::MarkDirty() {
-		mIsDirty = true;
-		for (auto* child : mChildren) {
-			child->MarkDirty();
-		}
+		// 子孫は Update() で親が変わったのを見て計算し直されます
+		TransformSystem::Get().SetLocal(mNode, mLocalPos, mLocalRot, mLocalScale);
 	}
 }
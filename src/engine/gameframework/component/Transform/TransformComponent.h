@@ -2,14 +2,23 @@
 #include <vector>
 
 #include <engine/gameframework/component/base/BaseComponent.h>
+#include <engine/gameframework/component/Transform/TransformSystem.h>
 
 #include <runtime/core/math/Math.h>
 
 namespace Unnamed {
 	/// @class TransformComponent
 	/// @brief エンティティに空間をもたせるコンポーネントです。
+	/// @details ワールド行列は TransformSystem が持ち、UEngine がワールドの Tick の後に
+	/// まとめて更新します。セッターで変えた値はその更新まで WorldMat() に反映されません
 	class TransformComponent : public BaseComponent {
 	public:
+		TransformComponent();
+		~TransformComponent() override;
+
+		TransformComponent(const TransformComponent&)            = delete;
+		TransformComponent& operator=(const TransformComponent&) = delete;
+
 		//---------------------------------------------------------------------
 		// TransformComponent
 		//---------------------------------------------------------------------
@@ -34,6 +43,8 @@ namespace Unnamed {
 		void OnTick(float deltaTime) override;
 		void PostPhysicsTick(float deltaTime) override;
 
+		[[nodiscard]] bool IsTickThreadSafe() const override;
+
 		void OnPreRender() const override;
 		void OnRender() const override;
 		void OnPostRender() const override;
@@ -44,17 +55,15 @@ namespace Unnamed {
 		[[nodiscard]] std::string_view GetComponentName() const override;
 
 	private:
-		void MarkDirty(); // 変化が合った場合のみ行列を更新する
+		void MarkDirty(); // ローカルの値をシステムに渡します
 
-		Vec3       mLocalPos = Vec3::zero;
-		Quaternion mLocalRot = Quaternion::identity;
-		Vec3       mLocalScale    = Vec3::one;
+		Vec3       mLocalPos   = Vec3::zero;
+		Quaternion mLocalRot   = Quaternion::identity;
+		Vec3       mLocalScale = Vec3::one;
 
-		Mat4 mWorldMat = Mat4::identity;
+		TransformHandle mNode = kInvalidTransform;
 
 		TransformComponent*              mParent = nullptr;
 		std::vector<TransformComponent*> mChildren;
-
-		bool mIsDirty = false; // 変更があったか?
 	};
 }
@@ -0,0 +1,320 @@
+﻿#include <pch.h>
+
+//-----------------------------------------------------------------------------
+
+#include <engine/gameframework/component/Transform/TransformSystem.h>
+
+#include <atomic>
+
+#include <core/jobsystem/JobSystem.h>
+
+#include <runtime/core/math/AffineCompose.h>
+
+namespace Unnamed {
+	namespace {
+		// これより小さい段は分けるより1スレッドで回した方が速い
+		constexpr uint32_t kParallelThreshold = 4096;
+		constexpr size_t   kGrainSize         = 1024;
+
+		template <class T>
+		void Permute(std::vector<T>& values, const std::vector<uint32_t>& order) {
+			std::vector<T> sorted;
+			sorted.reserve(values.size());
+			for (const uint32_t index : order) {
+				sorted.emplace_back(values[index]);
+			}
+			values.swap(sorted);
+		}
+	}
+
+	TransformHandle TransformSystem::Create() {
+		uint32_t slot;
+		if (!mFreeSlots.empty()) {
+			slot = mFreeSlots.back();
+			mFreeSlots.pop_back();
+		} else {
+			slot = static_cast<uint32_t>(mDenseOfSlot.size());
+			UASSERT(slot < kIndexMask && "TransformSystem: too many transforms");
+			mDenseOfSlot.emplace_back(kNoParent);
+			mGeneration.emplace_back(static_cast<uint8_t>(0));
+		}
+
+		const TransformHandle handle =
+			slot | (static_cast<uint32_t>(mGeneration[slot]) << kIndexBits);
+		mDenseOfSlot[slot] = Count();
+
+		mPosition.emplace_back(Vec3::zero);
+		mRotation.emplace_back(Quaternion::identity);
+		mScale.emplace_back(Vec3::one);
+		mWorld.emplace_back(Mat4::identity);
+		mParentHandle.emplace_back(kInvalidTransform);
+		mParentIndex.emplace_back(kNoParent);
+		mHandle.emplace_back(handle);
+		mDirty.emplace_back(static_cast<uint8_t>(1));
+		mChanged.emplace_back(static_cast<uint8_t>(0));
+
+		mOrderDirty = true;
+		mAnyDirty   = true;
+		return handle;
+	}
+
+	void TransformSystem::Destroy(const TransformHandle handle) {
+		const uint32_t dense = DenseOf(handle);
+		if (dense == kNoParent) {
+			return;
+		}
+
+		// 末尾を穴に詰めます。並びが崩れるので次の Update() で並べ直します
+		const uint32_t last = Count() - 1;
+		if (dense != last) {
+			mPosition[dense]     = mPosition[last];
+			mRotation[dense]     = mRotation[last];
+			mScale[dense]        = mScale[last];
+			mWorld[dense]        = mWorld[last];
+			mParentHandle[dense] = mParentHandle[last];
+			mHandle[dense]       = mHandle[last];
+			mDirty[dense]        = mDirty[last];
+
+			mDenseOfSlot[mHandle[dense] & kIndexMask] = dense;
+		}
+		mPosition.pop_back();
+		mRotation.pop_back();
+		mScale.pop_back();
+		mWorld.pop_back();
+		mParentHandle.pop_back();
+		mParentIndex.pop_back();
+		mHandle.pop_back();
+		mDirty.pop_back();
+		mChanged.pop_back();
+
+		const uint32_t slot = handle & kIndexMask;
+		mGeneration[slot]   = static_cast<uint8_t>((mGeneration[slot] + 1) & kGenerationMask);
+		mDenseOfSlot[slot]  = kNoParent;
+		mFreeSlots.emplace_back(slot);
+
+		mOrderDirty = true;
+	}
+
+	bool TransformSystem::IsValid(const TransformHandle handle) const {
+		return DenseOf(handle) != kNoParent;
+	}
+
+	bool TransformSystem::SetParent(
+		const TransformHandle handle,
+		const TransformHandle parent
+	) {
+		const uint32_t dense = DenseOf(handle);
+		if (dense == kNoParent) {
+			return false;
+		}
+
+		// 親をたどって自分に当たるなら循環になる
+		for (TransformHandle h = parent; h != kInvalidTransform;) {
+			if (h == handle) {
+				return false;
+			}
+			const uint32_t d = DenseOf(h);
+			if (d == kNoParent) {
+				break;
+			}
+			h = mParentHandle[d];
+		}
+
+		mParentHandle[dense] = IsValid(parent) ? parent : kInvalidTransform;
+		mDirty[dense]        = 1;
+		mOrderDirty          = true;
+		mAnyDirty            = true;
+		return true;
+	}
+
+	void TransformSystem::SetLocal(
+		const TransformHandle handle,
+		const Vec3&           position,
+		const Quaternion&     rotation,
+		const Vec3&           scale
+	) {
+		const uint32_t dense = DenseOf(handle);
+		if (dense == kNoParent) {
+			return;
+		}
+		mPosition[dense] = position;
+		mRotation[dense] = rotation;
+		mScale[dense]    = scale;
+		mDirty[dense]    = 1;
+		mAnyDirty.store(true, std::memory_order_relaxed);
+	}
+
+	const Mat4& TransformSystem::World(const TransformHandle handle) const {
+		const uint32_t dense = DenseOf(handle);
+		return dense != kNoParent ? mWorld[dense] : Mat4::identity;
+	}
+
+	void TransformSystem::Update(JobSystem* jobs) {
+		mLastUpdated = 0;
+		if (mOrderDirty) {
+			Rebuild();
+		}
+		if (!mAnyDirty.load(std::memory_order_relaxed)) {
+			return;
+		}
+
+		// 段の順に処理すれば、親は必ず先に計算済み
+		uint32_t begin = 0;
+		for (const uint32_t end : mLevelEnds) {
+			const uint32_t size = end - begin;
+			if (jobs && size >= kParallelThreshold) {
+				std::atomic<uint32_t> updated = 0;
+				jobs->ParallelFor(
+					size, kGrainSize,
+					[&](const size_t b, const size_t e, uint32_t) {
+						updated.fetch_add(
+							UpdateRange(
+								begin + static_cast<uint32_t>(b),
+								begin + static_cast<uint32_t>(e)
+							),
+							std::memory_order_relaxed
+						);
+					}
+				);
+				mLastUpdated += updated.load(std::memory_order_relaxed);
+			} else {
+				mLastUpdated += UpdateRange(begin, end);
+			}
+			begin = end;
+		}
+		mAnyDirty.store(false, std::memory_order_relaxed);
+	}
+
+	uint32_t TransformSystem::Count() const {
+		return static_cast<uint32_t>(mHandle.size());
+	}
+
+	uint32_t TransformSystem::LevelCount() const {
+		return static_cast<uint32_t>(mLevelEnds.size());
+	}
+
+	uint32_t TransformSystem::LastUpdatedCount() const {
+		return mLastUpdated;
+	}
+
+	TransformSystem& TransformSystem::Get() {
+		static TransformSystem system;
+		return system;
+	}
+
+	uint32_t TransformSystem::DenseOf(const TransformHandle handle) const {
+		const uint32_t slot = handle & kIndexMask;
+		if (slot >= mDenseOfSlot.size() ||
+			mGeneration[slot] != (handle >> kIndexBits)) {
+			return kNoParent;
+		}
+		return mDenseOfSlot[slot];
+	}
+
+	void TransformSystem::Rebuild() {
+		const uint32_t count = Count();
+
+		// 親が消えたものはルートにします
+		for (uint32_t i = 0; i < count; ++i) {
+			if (mParentHandle[i] != kInvalidTransform &&
+				DenseOf(mParentHandle[i]) == kNoParent) {
+				mParentHandle[i] = kInvalidTransform;
+				mDirty[i]        = 1;
+				mAnyDirty        = true;
+			}
+		}
+
+		// 深さを求めます。たどった経路はまとめて埋めるので各ノード1回ずつ
+		mDepth.assign(count, kNoParent);
+		uint32_t levelCount = 0;
+		for (uint32_t i = 0; i < count; ++i) {
+			mOrder.clear(); // 経路の一時置き場
+			uint32_t node  = i;
+			uint32_t depth = 0;
+			for (;;) {
+				if (mDepth[node] != kNoParent) {
+					depth = mDepth[node] + 1;
+					break;
+				}
+				mOrder.emplace_back(node);
+				const uint32_t parent = DenseOf(mParentHandle[node]);
+				if (parent == kNoParent) {
+					break;
+				}
+				node = parent;
+			}
+			for (auto it = mOrder.rbegin(); it != mOrder.rend(); ++it) {
+				mDepth[*it] = depth++;
+			}
+			levelCount = std::max(levelCount, depth);
+		}
+
+		// 深さで数え上げソート(同じ深さの中では元の順を保つ)
+		mLevelEnds.assign(levelCount, 0);
+		for (uint32_t i = 0; i < count; ++i) {
+			++mLevelEnds[mDepth[i]];
+		}
+		uint32_t offset = 0;
+		for (uint32_t& end : mLevelEnds) {
+			offset += end;
+			end = offset;
+		}
+		mOrder.resize(count);
+		for (uint32_t i = count; i-- > 0;) {
+			mOrder[--mLevelEnds[mDepth[i]]] = i;
+		}
+		// 上で各段の先頭まで戻したので、終わりの添字に直す
+		for (uint32_t level = 0; level + 1 < levelCount; ++level) {
+			mLevelEnds[level] = mLevelEnds[level + 1];
+		}
+		if (levelCount > 0) {
+			mLevelEnds[levelCount - 1] = count;
+		}
+
+		Permute(mPosition, mOrder);
+		Permute(mRotation, mOrder);
+		Permute(mScale, mOrder);
+		Permute(mWorld, mOrder);
+		Permute(mParentHandle, mOrder);
+		Permute(mHandle, mOrder);
+		Permute(mDirty, mOrder);
+
+		for (uint32_t i = 0; i < count; ++i) {
+			mDenseOfSlot[mHandle[i] & kIndexMask] = i;
+		}
+		mParentIndex.resize(count);
+		for (uint32_t i = 0; i < count; ++i) {
+			mParentIndex[i] = DenseOf(mParentHandle[i]);
+		}
+		mChanged.assign(count, static_cast<uint8_t>(0));
+
+		mOrderDirty = false;
+	}
+
+	uint32_t TransformSystem::UpdateRange(
+		const uint32_t begin,
+		const uint32_t end
+	) {
+		uint32_t updated = 0;
+		for (uint32_t i = begin; i < end; ++i) {
+			const uint32_t parent  = mParentIndex[i];
+			const bool     changed = mDirty[i] != 0 ||
+				(parent != kNoParent && mChanged[parent] != 0);
+			mChanged[i] = changed ? 1 : 0;
+			if (!changed) {
+				continue;
+			}
+			mDirty[i] = 0;
+
+			if (parent == kNoParent) {
+				Math::ComposeLocal(mPosition[i], mRotation[i], mScale[i], mWorld[i].m);
+			} else {
+				alignas(16) float local[4][4];
+				Math::ComposeLocal(mPosition[i], mRotation[i], mScale[i], local);
+				Math::MultiplyRows(local, mWorld[parent], mWorld[i]);
+			}
+			++updated;
+		}
+		return updated;
+	}
+}
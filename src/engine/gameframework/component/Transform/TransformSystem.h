@@ -0,0 +1,104 @@
+﻿#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <runtime/core/math/Math.h>
+
+class JobSystem;
+
+namespace Unnamed {
+	// 下位24bitがスロット番号、上位8bitが世代
+	using TransformHandle = uint32_t;
+	constexpr TransformHandle kInvalidTransform = UINT32_MAX;
+
+	/// @class TransformSystem
+	/// @brief トランスフォームの階層をまとめて持ち、ワールド行列を1フレームに1回更新します
+	/// @details ローカルのTRSとワールド行列は階層の深さ順に並べた連続配列に持ちます。
+	/// 親は必ず子より前に並ぶので、Update() は先頭から1回なめるだけで
+	/// 全ての子が同じフレームの親の行列を使います。
+	/// 深さが同じノード同士は依存しないので、大きい段は JobSystem で分けて処理します。
+	/// 変更されたノードと、その子孫だけを計算し直します
+	class TransformSystem {
+	public:
+		TransformSystem() = default;
+
+		TransformSystem(const TransformSystem&)            = delete;
+		TransformSystem& operator=(const TransformSystem&) = delete;
+
+		TransformHandle Create();
+		// 子は次の Update() でルートになります
+		void Destroy(TransformHandle handle);
+
+		[[nodiscard]] bool IsValid(TransformHandle handle) const;
+
+		/// @brief 親を付け替えます。kInvalidTransform ならルートにします
+		/// @return 自分や自分の子孫を親にしようとした場合はfalse
+		bool SetParent(TransformHandle handle, TransformHandle parent);
+
+		// 印を付けるだけで、行列は Update() で計算します
+		// 別々のノードに対してなら、複数のスレッドから同時に呼べます(Create などとは重ねないでください)
+		void SetLocal(
+			TransformHandle   handle,
+			const Vec3&       position,
+			const Quaternion& rotation,
+			const Vec3&       scale
+		);
+
+		// 最後の Update() の結果
+		[[nodiscard]] const Mat4& World(TransformHandle handle) const;
+
+		/// @brief 変更のあったノードのワールド行列を計算し直します
+		/// @param jobs nullでなければ、大きい段を並列に処理します
+		void Update(JobSystem* jobs = nullptr);
+
+		[[nodiscard]] uint32_t Count() const;
+		[[nodiscard]] uint32_t LevelCount() const;
+		// 直前の Update() で計算し直したノードの数
+		[[nodiscard]] uint32_t LastUpdatedCount() const;
+
+		// プロセス共通のシステム
+		static TransformSystem& Get();
+
+	private:
+		static constexpr uint32_t kIndexBits      = 24;
+		static constexpr uint32_t kIndexMask      = (1u << kIndexBits) - 1u;
+		static constexpr uint32_t kGenerationMask = 0xFFu;
+		static constexpr uint32_t kNoParent       = UINT32_MAX;
+
+		// スロットから密な配列の添字を引きます。無効ならkNoParent
+		[[nodiscard]] uint32_t DenseOf(TransformHandle handle) const;
+
+		// 深さ順に並べ直し、親の添字と段の境界を作り直します
+		void Rebuild();
+
+		// [begin, end) のノードを計算します。同じ段の中ならどの分け方でも構いません
+		uint32_t UpdateRange(uint32_t begin, uint32_t end);
+
+		// 以下は密な配列(深さ順)
+		std::vector<Vec3>            mPosition;
+		std::vector<Quaternion>      mRotation;
+		std::vector<Vec3>            mScale;
+		std::vector<Mat4>            mWorld;
+		std::vector<TransformHandle> mParentHandle;
+		std::vector<uint32_t>        mParentIndex; // Rebuild() で作る
+		std::vector<TransformHandle> mHandle;
+		std::vector<uint8_t>         mDirty;   // 自分のTRSが変わった
+		std::vector<uint8_t>         mChanged; // 今回の Update() で行列が変わった
+
+		std::vector<uint32_t> mLevelEnds; // 段ごとの終わりの添字
+
+		// スロット
+		std::vector<uint32_t> mDenseOfSlot;
+		std::vector<uint8_t>  mGeneration;
+		std::vector<uint32_t> mFreeSlots;
+
+		// Rebuild() の作業領域
+		std::vector<uint32_t> mDepth;
+		std::vector<uint32_t> mOrder;
+
+		bool              mOrderDirty  = false; // 追加・削除・親の付け替えがあった
+		std::atomic<bool> mAnyDirty    = false; // SetLocal はワーカーからも呼ばれる
+		uint32_t          mLastUpdated = 0;
+	};
+}
@@ -18,5 +18,8 @@ namespace Unnamed {
 		bool LoadAndAtatch(UAssetManager* am, TransformComponent* parent);
 
 		[[nodiscard]] std::string_view GetComponentName() const override;
+
+		// Tick では何もしません
+		[[nodiscard]] bool IsTickThreadSafe() const override { return true; }
 	};
 }
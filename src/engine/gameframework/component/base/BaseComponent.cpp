@@ -43,6 +43,11 @@ namespace Unnamed {
 	void BaseComponent::OnEditorRender() const {
 	}
 
+	/// @brief 他のエンティティと並列に Tick してよいかを返します。
+	bool BaseComponent::IsTickThreadSafe() const {
+		return false;
+	}
+
 	/// @brief 所有者を設定します。
 	void BaseComponent::SetOwner(BaseEntity* owner) {
 		mOwner = owner; // 所有者を設定
@@ -30,6 +30,12 @@ namespace Unnamed {
 		virtual void OnEditorTick(float deltaTime);
 		virtual void OnEditorRender() const;
 
+		// PrePhysicsTick / OnTick / PostPhysicsTick が、他のエンティティの Tick と
+		// 同時に呼ばれても安全なら true を返してください。
+		// 自分のエンティティのコンポーネント以外に書き込まないものが対象です。
+		// エンティティの全コンポーネントが true ならワーカーで Tick されます
+		[[nodiscard]] virtual bool IsTickThreadSafe() const;
+
 		// コンポーネントの値を書き込む際に使用されます。 
 		virtual void Serialize(JsonWriter& writer) const = 0;
 
@@ -0,0 +1,93 @@
+﻿#include <pch.h>
+
+//-----------------------------------------------------------------------------
+
+#include <engine/gameframework/component/base/ComponentRegistry.h>
+
+#include <atomic>
+
+namespace Unnamed {
+	namespace Detail {
+		ComponentTypeId NextComponentTypeId() {
+			static std::atomic<ComponentTypeId> next = 0;
+			return next.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	bool ComponentPool::Insert(const uint32_t entity, BaseComponent* component) {
+		if (entity >= mSparse.size()) {
+			mSparse.resize(entity + 1, kNone);
+		}
+		if (mSparse[entity] != kNone) {
+			return false;
+		}
+		mSparse[entity] = static_cast<uint32_t>(mComponents.size());
+		mEntities.emplace_back(entity);
+		mComponents.emplace_back(component);
+		return true;
+	}
+
+	void ComponentPool::Erase(const uint32_t entity) {
+		if (entity >= mSparse.size() || mSparse[entity] == kNone) {
+			return;
+		}
+		// 末尾を穴に詰める
+		const uint32_t dense = mSparse[entity];
+		const uint32_t last  = static_cast<uint32_t>(mComponents.size()) - 1;
+		if (dense != last) {
+			mEntities[dense]          = mEntities[last];
+			mComponents[dense]        = mComponents[last];
+			mSparse[mEntities[dense]] = dense;
+		}
+		mEntities.pop_back();
+		mComponents.pop_back();
+		mSparse[entity] = kNone;
+	}
+
+	uint32_t ComponentRegistry::AcquireEntity() {
+		if (!mFreeEntities.empty()) {
+			const uint32_t entity = mFreeEntities.back();
+			mFreeEntities.pop_back();
+			return entity;
+		}
+		return mNextEntity++;
+	}
+
+	void ComponentRegistry::ReleaseEntity(const uint32_t entity) {
+		// 取り残しがあると使い回した先で見えてしまう
+		for (const auto& pool : mPools) {
+			if (pool) {
+				pool->Erase(entity);
+			}
+		}
+		mFreeEntities.emplace_back(entity);
+	}
+
+	bool ComponentRegistry::Insert(
+		const uint32_t        entity,
+		const ComponentTypeId type,
+		BaseComponent*        component
+	) {
+		if (type >= mPools.size()) {
+			mPools.resize(type + 1);
+		}
+		if (!mPools[type]) {
+			mPools[type] = std::make_unique<ComponentPool>();
+		}
+		return mPools[type]->Insert(entity, component);
+	}
+
+	void ComponentRegistry::Erase(
+		const uint32_t        entity,
+		const ComponentTypeId type
+	) {
+		if (type < mPools.size() && mPools[type]) {
+			mPools[type]->Erase(entity);
+		}
+	}
+
+	ComponentRegistry& ComponentRegistry::Get() {
+		static ComponentRegistry registry;
+		return registry;
+	}
+}
@@ -0,0 +1,101 @@
+﻿#pragma once
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <engine/gameframework/component/base/ComponentTypeId.h>
+
+namespace Unnamed {
+	class BaseComponent;
+
+	/// @class ComponentPool
+	/// @brief 1つの型のコンポーネントを、エンティティの番号から引けるように詰めて持ちます(スパースセット)
+	/// @details コンポーネント同士がポインタで参照し合うので、実体はエンティティが持ち、
+	/// ここには詰めたポインタだけを置きます。削除は末尾と入れ替えるので、並びは保証しません
+	class ComponentPool {
+	public:
+		static constexpr uint32_t kNone = UINT32_MAX;
+
+		[[nodiscard]] BaseComponent* Find(uint32_t entity) const {
+			if (entity >= mSparse.size()) {
+				return nullptr;
+			}
+			const uint32_t dense = mSparse[entity];
+			return dense != kNone ? mComponents[dense] : nullptr;
+		}
+
+		// 既にあれば何もしません(先に付けたものが優先)
+		bool Insert(uint32_t entity, BaseComponent* component);
+		void Erase(uint32_t entity);
+
+		[[nodiscard]] std::span<BaseComponent* const> Components() const {
+			return mComponents;
+		}
+
+		[[nodiscard]] std::span<const uint32_t> Entities() const {
+			return mEntities;
+		}
+
+	private:
+		std::vector<uint32_t>       mSparse;     // エンティティ -> 密な添字
+		std::vector<uint32_t>       mEntities;   // 密な添字 -> エンティティ
+		std::vector<BaseComponent*> mComponents; // 密な添字 -> コンポーネント
+	};
+
+	/// @class ComponentRegistry
+	/// @brief 型ごとのプールと、エンティティの番号を管理します
+	/// @details BaseEntity がコンポーネントの追加・削除のたびに更新します。
+	/// 書き込みはゲームスレッドから行い、読み込み(Find / ForEach)は
+	/// 書き込みと重ならなければ複数のスレッドから同時に行えます
+	class ComponentRegistry {
+	public:
+		ComponentRegistry() = default;
+
+		ComponentRegistry(const ComponentRegistry&)            = delete;
+		ComponentRegistry& operator=(const ComponentRegistry&) = delete;
+
+		// エンティティの番号を払い出します。解放した番号は使い回します
+		uint32_t AcquireEntity();
+		void     ReleaseEntity(uint32_t entity);
+
+		bool Insert(uint32_t entity, ComponentTypeId type, BaseComponent* component);
+		void Erase(uint32_t entity, ComponentTypeId type);
+
+		[[nodiscard]] BaseComponent* Find(uint32_t entity, ComponentTypeId type) const {
+			const ComponentPool* pool = Pool(type);
+			return pool ? pool->Find(entity) : nullptr;
+		}
+
+		template <typename ComponentType>
+		[[nodiscard]] ComponentType* Find(const uint32_t entity) const {
+			return static_cast<ComponentType*>(
+				Find(entity, ComponentTypeIdOf<ComponentType>())
+			);
+		}
+
+		// まだ一度も追加されていない型ならnull
+		[[nodiscard]] const ComponentPool* Pool(const ComponentTypeId type) const {
+			return type < mPools.size() ? mPools[type].get() : nullptr;
+		}
+
+		// その型のコンポーネントを全て、詰めた順に回します
+		template <typename ComponentType, typename Fn>
+		void ForEach(Fn&& fn) const {
+			const ComponentPool* pool = Pool(ComponentTypeIdOf<ComponentType>());
+			if (!pool) {
+				return;
+			}
+			for (BaseComponent* component : pool->Components()) {
+				fn(*static_cast<ComponentType*>(component));
+			}
+		}
+
+		// プロセス共通のレジストリ
+		static ComponentRegistry& Get();
+
+	private:
+		std::vector<std::unique_ptr<ComponentPool>> mPools; // ComponentTypeId で引く
+		std::vector<uint32_t>                       mFreeEntities;
+		uint32_t                                    mNextEntity = 0;
+	};
+}
@@ -0,0 +1,25 @@
+﻿#pragma once
+#include <cstdint>
+#include <type_traits>
+
+namespace Unnamed {
+	// コンポーネントの型ごとの連番。プール(ComponentRegistry)の添字に使います
+	using ComponentTypeId = uint32_t;
+
+	namespace Detail {
+		ComponentTypeId NextComponentTypeId();
+	}
+
+	/// @brief 型ごとに一意な ComponentTypeId を返します
+	/// @details 番号は最初に問い合わせた順に振られるので、実行ごとに変わることがあります。
+	/// シリアライズには使わないでください
+	template <typename ComponentType>
+	ComponentTypeId ComponentTypeIdOf() {
+		static_assert(
+			std::is_same_v<ComponentType, std::remove_cvref_t<ComponentType>>,
+			"参照やconstの付いていない型で問い合わせてください。"
+		);
+		static const ComponentTypeId id = Detail::NextComponentTypeId();
+		return id;
+	}
+}
@@ -72,8 +72,9 @@ namespace Unnamed {
 	}
 
 	void UEntity::OnDestroy() {
-		for (const auto& component : mComponents) {
-			RemoveComponent(component.get());
+		// RemoveComponent が mComponents を縮めるので末尾から外す
+		while (!mComponents.empty()) {
+			RemoveComponent(mComponents.back().get());
 		}
 	}
 }
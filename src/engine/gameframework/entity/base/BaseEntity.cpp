@@ -1,10 +1,54 @@
 ﻿#include <engine/gameframework/entity/base/BaseEntity.h>
 
+#include <algorithm>
+#include <iterator>
+
 namespace Unnamed {
-	BaseEntity::BaseEntity(std::string name) : mName(std::move(name)) {
+	BaseEntity::BaseEntity(std::string name)
+		: mName(std::move(name)),
+		  mIndex(ComponentRegistry::Get().AcquireEntity()) {
+	}
+
+	BaseEntity::~BaseEntity() {
+		// コンポーネントの実体より先にプールから外す
+		ComponentRegistry::Get().ReleaseEntity(mIndex);
 	}
 
-	BaseEntity::~BaseEntity() = default;
+	void BaseEntity::RemoveComponent(BaseComponent* component) {
+		if (!component) return;
+
+		const auto it = std::ranges::find_if(
+			mComponents,
+			[component](
+			const std::unique_ptr<BaseComponent>& comp) {
+				return comp.get() == component;
+			}
+		);
+		if (it == mComponents.end()) {
+			return;
+		}
+
+		const auto            index = std::distance(mComponents.begin(), it);
+		const ComponentTypeId type  = mComponentTypes[index];
+
+		(*it)->OnDetached();
+
+		// プールに載っているものを外したら、同じ型の次のものを載せ直す
+		auto& registry = ComponentRegistry::Get();
+		if (registry.Find(mIndex, type) == component) {
+			registry.Erase(mIndex, type);
+			for (size_t i = 0; i < mComponents.size(); ++i) {
+				if (static_cast<ptrdiff_t>(i) != index &&
+					mComponentTypes[i] == type) {
+					registry.Insert(mIndex, type, mComponents[i].get());
+					break;
+				}
+			}
+		}
+
+		mComponents.erase(it);
+		mComponentTypes.erase(mComponentTypes.begin() + index);
+	}
 
 	void BaseEntity::OnEditorTick(float) {
 	}
@@ -27,4 +71,17 @@ namespace Unnamed {
 	uint64_t BaseEntity::GetId() const noexcept {
 		return mId;
 	}
+
+	bool BaseEntity::IsTickThreadSafe() const {
+		return std::ranges::all_of(
+			mComponents,
+			[](const std::unique_ptr<BaseComponent>& component) {
+				return component->IsTickThreadSafe();
+			}
+		);
+	}
+
+	uint32_t BaseEntity::GetIndex() const noexcept {
+		return mIndex;
+	}
 }
@@ -4,6 +4,7 @@
 #include <vector>
 
 #include <engine/gameframework/component/base/BaseComponent.h>
+#include <engine/gameframework/component/base/ComponentRegistry.h>
 
 namespace Unnamed {
 	// TODO: 従来版を取り除いたらEntityに名前変更
@@ -50,24 +51,24 @@ namespace Unnamed {
 			);
 			component->SetOwner(this); // 所有者を設定
 			component->OnAttached();   // 取り付け時の処理を呼び出す
+
+			ComponentType*        raw  = component.get();
+			const ComponentTypeId type = ComponentTypeIdOf<ComponentType>();
 			mComponents.emplace_back(std::move(component));
-			return static_cast<ComponentType*>(mComponents.back().get());
+			mComponentTypes.emplace_back(type);
+			ComponentRegistry::Get().Insert(mIndex, type, raw);
+			return raw;
 		}
 
+		/// @brief 追加した時の型そのもので引きます(基底クラスでは引けません)
+		/// @details 同じ型が複数ある場合は先に追加したものを返します
 		template <typename ComponentType>
-		[[nodiscard]] ComponentType* GetComponent() {
+		[[nodiscard]] ComponentType* GetComponent() const {
 			static_assert(
 				std::is_base_of_v<BaseComponent, ComponentType>,
 				"T は BaseComponent の派生クラスでなければなりません。"
 			);
-			for (const auto& component : mComponents) {
-				if (
-					auto* casted = dynamic_cast<ComponentType*>(component.get())
-				) {
-					return casted;
-				}
-			}
-			return nullptr;
+			return ComponentRegistry::Get().Find<ComponentType>(mIndex);
 		}
 
 		template <typename ComponentType, typename... Args>
@@ -78,22 +79,7 @@ namespace Unnamed {
 			return AddComponent<ComponentType>(std::forward<Args>(args)...);
 		}
 
-		void RemoveComponent(BaseComponent* component) {
-			if (!component) return;
-
-			const auto it = std::ranges::find_if(
-				mComponents,
-				[component](
-				const std::unique_ptr<BaseComponent>& comp) {
-					return comp.get() == component;
-				}
-			);
-
-			if (it != mComponents.end()) {
-				(*it)->OnDetached();
-				mComponents.erase(it);
-			}
-		}
+		void RemoveComponent(BaseComponent* component);
 
 		[[nodiscard]] const std::vector<std::unique_ptr<BaseComponent>>&
 		GetComponents() const {
@@ -107,6 +93,12 @@ namespace Unnamed {
 
 		[[nodiscard]] uint64_t GetId() const noexcept;
 
+		// 全コンポーネントが IsTickThreadSafe() なら、他のエンティティと並列に Tick できます
+		[[nodiscard]] bool IsTickThreadSafe() const;
+
+		// ComponentRegistry でのエンティティの番号
+		[[nodiscard]] uint32_t GetIndex() const noexcept;
+
 	protected:
 		std::string mName;                 // 名前
 		bool        mIsEditorOnly = false; // エディター専用か?
@@ -114,5 +106,9 @@ namespace Unnamed {
 
 		// 所有しているコンポーネント
 		std::vector<std::unique_ptr<BaseComponent>> mComponents;
+		std::vector<ComponentTypeId>                mComponentTypes; // mComponents と同じ並び
+
+	private:
+		uint32_t mIndex = 0;
 	};
 }
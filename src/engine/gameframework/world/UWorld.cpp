@@ -1,5 +1,8 @@
 ﻿#include "UWorld.h"
 
+#include <chrono>
+
+#include <core/jobsystem/JobSystem.h>
 #include <core/json/JsonReader.h>
 #include <core/json/JsonWriter.h>
 
@@ -9,6 +12,37 @@
 #include <engine/gameframework/component/WorldInstance/WorldInstanceComponent.h>
 
 namespace Unnamed {
+	namespace {
+		// これより少なければワーカーに配るより1スレッドで回した方が速い
+		constexpr size_t kParallelTickThreshold = 256;
+		constexpr size_t kTickGrainSize         = 64;
+
+		void TickEntity(
+			UEntity&               entity,
+			const WORLD_TICK_PHASE phase,
+			const float            deltaTime
+		) {
+			switch (phase) {
+			case WORLD_TICK_PHASE::PRE_PHYSICS: entity.PrePhysicsTick(deltaTime);
+				break;
+			case WORLD_TICK_PHASE::TICK: entity.Tick(deltaTime);
+				break;
+			case WORLD_TICK_PHASE::POST_PHYSICS: entity.PostPhysicsTick(deltaTime);
+				break;
+			default: break;
+			}
+		}
+	}
+
+	const char* ToString(const WORLD_TICK_PHASE e) {
+		switch (e) {
+		case WORLD_TICK_PHASE::PRE_PHYSICS: return "PrePhysics";
+		case WORLD_TICK_PHASE::TICK: return "Tick";
+		case WORLD_TICK_PHASE::POST_PHYSICS: return "PostPhysics";
+		default: return "unknown";
+		}
+	}
+
 	UWorld::UWorld(std::string name) : mName(std::move(name)) {
 		// JsonWriter writer("./test.json");
 		//
@@ -53,20 +87,75 @@ namespace Unnamed {
 		);
 	}
 
-	void UWorld::Tick(const float deltaTime) {
-		for (const auto& e : mEntities) {
-			if (!e) { continue; }
-
-			e->PrePhysicsTick(deltaTime);
-			e->Tick(deltaTime);
-			e->PostPhysicsTick(deltaTime);
+	void UWorld::Tick(const float deltaTime, JobSystem* jobs) {
+		mTickWorlds.clear();
+		GatherTickWorlds(mTickWorlds);
 
-			for (auto& [world, parentTransform] : mChildren) {
-				if (world) {
-					world->Tick(deltaTime);
+		// Tick 中に増えたエンティティは次のフレームから
+		mSerialTicks.clear();
+		mParallelTicks.clear();
+		for (UWorld* world : mTickWorlds) {
+			++world->mTickCount;
+			for (const auto& e : world->mEntities) {
+				if (!e) { continue; }
+				if (jobs && e->IsTickThreadSafe()) {
+					mParallelTicks.emplace_back(e.get());
+				} else {
+					mSerialTicks.emplace_back(e.get());
 				}
 			}
 		}
+		if (mParallelTicks.size() < kParallelTickThreshold) {
+			mSerialTicks.insert(
+				mSerialTicks.end(), mParallelTicks.begin(), mParallelTicks.end()
+			);
+			mParallelTicks.clear();
+		}
+
+		mTickStats                  = {};
+		mTickStats.worlds           = static_cast<uint32_t>(mTickWorlds.size());
+		mTickStats.serialEntities   = static_cast<uint32_t>(mSerialTicks.size());
+		mTickStats.parallelEntities = static_cast<uint32_t>(mParallelTicks.size());
+
+		RunTickPhase(WORLD_TICK_PHASE::PRE_PHYSICS, deltaTime, jobs);
+		RunTickPhase(WORLD_TICK_PHASE::TICK, deltaTime, jobs);
+		RunTickPhase(WORLD_TICK_PHASE::POST_PHYSICS, deltaTime, jobs);
+	}
+
+	void UWorld::GatherTickWorlds(std::vector<UWorld*>& out) {
+		out.emplace_back(this);
+		for (auto& [world, parentTransform] : mChildren) {
+			if (world) {
+				world->GatherTickWorlds(out);
+			}
+		}
+	}
+
+	void UWorld::RunTickPhase(
+		const WORLD_TICK_PHASE phase,
+		const float            deltaTime,
+		JobSystem*             jobs
+	) {
+		const auto begin = std::chrono::steady_clock::now();
+
+		for (UEntity* e : mSerialTicks) {
+			TickEntity(*e, phase, deltaTime);
+		}
+		if (!mParallelTicks.empty()) {
+			jobs->ParallelFor(
+				mParallelTicks.size(), kTickGrainSize,
+				[&](const size_t b, const size_t e, uint32_t) {
+					for (size_t i = b; i < e; ++i) {
+						TickEntity(*mParallelTicks[i], phase, deltaTime);
+					}
+				}
+			);
+		}
+
+		mTickStats.phaseMs[static_cast<size_t>(phase)] =
+			std::chrono::duration<double, std::milli>(
+				std::chrono::steady_clock::now() - begin
+			).count();
 	}
 
 	void UWorld::PreRender() {
@@ -1,4 +1,5 @@
 ﻿#pragma once
+#include <array>
 #include <memory>
 #include <string>
 #include <vector>
@@ -9,7 +10,30 @@
 
 #include "WorldSettings.h"
 
+class JobSystem;
+
 namespace Unnamed {
+	// UWorld::Tick の段階。全ワールドの全エンティティが段階ごとにそろって進みます
+	enum class WORLD_TICK_PHASE : uint8_t {
+		PRE_PHYSICS,
+		TICK,
+		POST_PHYSICS,
+		COUNT,
+	};
+
+	constexpr size_t kWorldTickPhaseCount =
+		static_cast<size_t>(WORLD_TICK_PHASE::COUNT);
+
+	const char* ToString(WORLD_TICK_PHASE e);
+
+	// 直前の UWorld::Tick の内訳
+	struct WorldTickStats {
+		std::array<double, kWorldTickPhaseCount> phaseMs = {};
+		uint32_t worlds           = 0; // 自分と子孫のワールドの数
+		uint32_t serialEntities   = 0; // このスレッドで Tick したもの
+		uint32_t parallelEntities = 0; // ワーカーで Tick したもの
+	};
+
 	class UWorld {
 	public:
 		explicit UWorld(std::string name = "World");
@@ -26,7 +50,10 @@ namespace Unnamed {
 		UEntity* SpawnEmpty(const std::string& name = "Entity");
 		void     DestroyEntity(uint64_t entityID);
 
-		void Tick(float deltaTime);
+		/// @brief 自分と子孫のワールドを1回ずつ Tick します
+		/// @details PrePhysics / Tick / PostPhysics の段階ごとに全エンティティを回します。
+		/// 全コンポーネントがスレッドセーフなエンティティは、jobs があればワーカーで回します
+		void Tick(float deltaTime, JobSystem* jobs = nullptr);
 		void PreRender();
 		void PostRender();
 
@@ -62,6 +89,13 @@ namespace Unnamed {
 			return mSettings;
 		}
 
+		[[nodiscard]] const WorldTickStats& LastTickStats() const {
+			return mTickStats;
+		}
+
+		// このワールドが Tick された回数(親から回された分も含む)
+		[[nodiscard]] uint64_t TickCount() const { return mTickCount; }
+
 		[[nodiscard]] const std::string& Name() const { return mName; }
 		void SetName(std::string& name) { mName = std::move(name); }
 
@@ -69,7 +103,17 @@ namespace Unnamed {
 		std::string   mName;
 		WorldSettings mSettings;
 
+		void GatherTickWorlds(std::vector<UWorld*>& out);
+		void RunTickPhase(WORLD_TICK_PHASE phase, float deltaTime, JobSystem* jobs);
+
 		std::vector<std::unique_ptr<UEntity>> mEntities;
 		std::vector<ChildWorld>               mChildren;
+
+		// Tick の作業領域
+		std::vector<UWorld*>  mTickWorlds;
+		std::vector<UEntity*> mSerialTicks;
+		std::vector<UEntity*> mParallelTicks;
+		WorldTickStats        mTickStats;
+		uint64_t              mTickCount = 0;
 	};
 }
@@ -1,6 +1,9 @@
 #include <pch.h>
+#include <iterator>
 #include <unordered_set>
 
+#include <core/jobsystem/JobSystem.h>
+
 #include <engine/gameframework/component/MeshRenderer/MeshRendererComponent.h>
 #include <engine/gameframework/component/Transform/TransformComponent.h>
 #include <engine/gameframework/world/UWorld.h>
@@ -11,12 +14,35 @@
 
 namespace Unnamed {
 	namespace {
+		// 1ジョブで処理するエンティティ数
+		constexpr size_t kCollectGrainSize = 256;
+
 		float ComputeViewDepth(const Mat4& world, const Mat4& view) {
 			const Vec4 worldPos = Vec4(world.m[3][0], world.m[3][1],
 			                           world.m[3][2], 1.0f);
 			const Vec4 viewPos = worldPos * view;
 			return viewPos.z;
 		}
+
+		// 境界球が画面上で占める大きさ(直径のピクセル数)
+		float ComputeScreenPixels(
+			const MeshGPU& mesh, const Mat4& world, const Mat4& view,
+			const Mat4&    proj, const float viewportHeight
+		) {
+			const Vec4 center = Vec4(mesh.boundsCenter.x, mesh.boundsCenter.y,
+			                         mesh.boundsCenter.z, 1.0f) * world * view;
+			const float scale = std::max({
+				Vec3(world.m[0][0], world.m[0][1], world.m[0][2]).Length(),
+				Vec3(world.m[1][0], world.m[1][1], world.m[1][2]).Length(),
+				Vec3(world.m[2][0], world.m[2][1], world.m[2][2]).Length()
+			});
+			const float radius = mesh.boundsRadius * scale;
+			// カメラが球の中にいる時は最大
+			if (center.z <= radius) {
+				return viewportHeight;
+			}
+			return radius * proj.m[1][1] * viewportHeight / center.z;
+		}
 	}
 
 	URenderSubsystem::URenderSubsystem(
@@ -60,6 +86,10 @@ namespace Unnamed {
 				mContext.backIndex);
 		}
 
+		// 前のフレームの要求を元にミップを出し入れする(描画より前に)
+		mRenderResourceManager->ProcessDeferredMipUploads(mContext.cmd);
+		mRenderResourceManager->UpdateStreaming(mContext.cmd);
+
 		auto& [keep, fence, fenceValue] = mTransient[mContext.backIndex];
 		keep.clear();
 		fence.Reset();
@@ -77,19 +107,8 @@ namespace Unnamed {
 	}
 
 	void URenderSubsystem::RenderWorld(const UWorld& world) {
-		Collect(world, Mat4::identity);
-		std::ranges::sort(
-			mItems,
-			[](const RenderItem& a, const RenderItem& b) {
-				if (a.psoId != b.psoId) {
-					return a.psoId < b.psoId;
-				}
-				if (a.materialKey != b.materialKey) {
-					return a.materialKey < b.materialKey;
-				}
-				return a.depthVS < b.depthVS; // Front to Back (不透明用)
-			}
-		);
+		Collect(world);
+		SortItems();
 
 		// デバッグ: 描画順序を確認（最初の10個だけ）
 		static bool logged = false;
@@ -122,49 +141,281 @@ namespace Unnamed {
 		);
 	}
 
-	void URenderSubsystem::Collect(const UWorld& world, const Mat4& parent) {
-		for (auto& e : world.Entities()) {
-			if (!e) { continue; }
-			const auto* tr = e->GetComponent<TransformComponent>();
-			auto*       mr = e->GetComponent<MeshRendererComponent>();
-			if (tr && mr) {
+	void URenderSubsystem::Collect(const UWorld& world) {
+		mSources.clear();
+		mParents.clear();
+		mParents.emplace_back(Mat4::identity);
+		Gather(world, 0);
+
+		mFrustum = Frustum::FromViewProj(mView.viewProj);
+
+		auto&          jobs  = JobSystem::Get();
+		const uint32_t lanes = jobs.MaxLanes();
+		if (mLaneItems.size() < lanes) {
+			mLaneItems.resize(lanes);
+			mLanePending.resize(lanes);
+			mLaneCulled.resize(lanes);
+		}
+		for (uint32_t lane = 0; lane < lanes; ++lane) {
+			mLaneItems[lane].clear();
+			mLanePending[lane].clear();
+			mLaneCulled[lane] = 0;
+		}
+
+		jobs.ParallelFor(
+			mSources.size(), kCollectGrainSize,
+			[this](const size_t begin, const size_t end, const uint32_t lane) {
+				auto& items   = mLaneItems[lane];
+				auto& pending = mLanePending[lane];
+
+				// GetMesh はロックを取るので、同じメッシュが続く間は使い回す
+				MeshHandle     lastHandle = {};
+				const MeshGPU* lastMesh   = nullptr;
+
+				for (size_t i = begin; i < end; ++i) {
+					const CollectSource& src = mSources[i];
+					const auto* tr = src.entity->GetComponent<TransformComponent>();
+					auto*       mr = src.entity->GetComponent<MeshRendererComponent>();
+					if (!tr || !mr) {
+						continue;
+					}
+					if (!mr->IsGPUReady()) {
+						pending.emplace_back(static_cast<uint32_t>(i));
+						continue;
+					}
+
+					if (mr->meshHandle.id != lastHandle.id ||
+						mr->meshHandle.gen != lastHandle.gen) {
+						lastHandle = mr->meshHandle;
+						lastMesh   = mRenderResourceManager->GetMesh(lastHandle);
+					}
+
+					const size_t before = items.size();
+					EmitItem(*tr, *mr, mParents[src.parent], lastMesh, items);
+					if (items.size() == before) {
+						++mLaneCulled[lane];
+					}
+				}
+			}
+		);
+
+		// GPUの準備はコマンドリストに積むのでこのスレッドで(初回だけ)
+		for (uint32_t lane = 0; lane < lanes; ++lane) {
+			for (const uint32_t i : mLanePending[lane]) {
+				const CollectSource& src = mSources[i];
+				const auto* tr = src.entity->GetComponent<TransformComponent>();
+				auto*       mr = src.entity->GetComponent<MeshRendererComponent>();
 				if (
-					mr->EnsureGPU(
+					!mr->EnsureGPU(
 						mGraphicsDevice, mRenderResourceManager,
 						mShaderLibrary, mRootSignatureCache,
 						mPipelineCache, mContext.cmd
 					)
 				) {
-					const Mat4 worldMat = tr->WorldMat() * parent;
-
-					RenderItem it{};
-					it.world      = worldMat;
-					it.material   = &mr->material;
-					it.meshHandle = mr->meshHandle; // 共有メッシュのハンドル
+					continue;
+				}
+				const size_t before = mLaneItems[0].size();
+				EmitItem(
+					*tr, *mr, mParents[src.parent],
+					mRenderResourceManager->GetMesh(mr->meshHandle),
+					mLaneItems[0]
+				);
+				if (mLaneItems[0].size() == before) {
+					++mLaneCulled[0];
+				}
+			}
+		}
 
-					it.depthVS = ComputeViewDepth(it.world, mView.view);
+		size_t total = 0;
+		mCulledCount = 0;
+		for (uint32_t lane = 0; lane < lanes; ++lane) {
+			total += mLaneItems[lane].size();
+			mCulledCount += mLaneCulled[lane];
+		}
+		mItems.reserve(total);
+		for (uint32_t lane = 0; lane < lanes; ++lane) {
+			std::ranges::move(mLaneItems[lane], std::back_inserter(mItems));
+		}
 
-					it.psoId = mr->material.pso.id;
-					it.materialKey = mr->materialAsset;
-					it.rsPtr = mRootSignatureCache->Get(it.material->root);
+		// 見えているものだけ画面上の大きさをテクスチャストリーミングに伝える
+		for (const auto& it : mItems) {
+			it.material->RequestTextureMips(
+				mRenderResourceManager, it.screenPixels
+			);
+		}
+	}
 
-					mItems.emplace_back(std::move(it));
-				}
+	void URenderSubsystem::Gather(const UWorld& world, const uint32_t parent) {
+		for (auto& e : world.Entities()) {
+			if (e) {
+				mSources.emplace_back(CollectSource{e.get(), parent});
 			}
 		}
 
 		for (const auto& child : world.Children()) {
 			const auto& worldPtr        = child.world;
 			const auto& parentTransform = child.parentTransform;
-			Mat4        p               = parent;
+			if (!worldPtr) {
+				continue;
+			}
+			Mat4 p = mParents[parent];
 			if (parentTransform) { p = parentTransform->WorldMat() * p; }
-			if (worldPtr) { Collect(*worldPtr, p); }
+			const auto index = static_cast<uint32_t>(mParents.size());
+			mParents.emplace_back(p);
+			Gather(*worldPtr, index);
+		}
+	}
+
+	void URenderSubsystem::EmitItem(
+		const TransformComponent&    transform,
+		MeshRendererComponent&       meshRenderer,
+		const Mat4&                  parent,
+		const MeshGPU*               mesh,
+		std::vector<RenderItem>&     items
+	) const {
+		const Mat4 worldMat = transform.WorldMat() * parent;
+
+		// メッシュ全体のAABB(サブメッシュの和)で判定する
+		if (mesh && !mFrustum.Intersects(mesh->boundsMin, mesh->boundsMax,
+		                                 worldMat)) {
+			return;
+		}
+
+		RenderItem it{};
+		it.world      = worldMat;
+		it.material   = &meshRenderer.material;
+		it.meshHandle = meshRenderer.meshHandle; // 共有メッシュのハンドル
+
+		it.depthVS = ComputeViewDepth(it.world, mView.view);
+		if (mesh) {
+			it.screenPixels = ComputeScreenPixels(
+				*mesh, it.world, mView.view, mView.proj,
+				static_cast<float>(mGraphicsDevice->Height())
+			);
+		}
+
+		it.psoId       = meshRenderer.material.pso.id;
+		it.materialKey = meshRenderer.materialAsset;
+		it.rsPtr       = mRootSignatureCache->Get(it.material->root);
+		it.sortKey     = MakeRenderSortKey(
+			it.psoId, it.materialKey, it.meshHandle.id, it.depthVS
+		);
+
+		items.emplace_back(std::move(it));
+	}
+
+	void URenderSubsystem::SortItems() {
+		// PSO → マテリアル → 手前から(不透明用)
+		mSortKeys.resize(mItems.size());
+		for (size_t i = 0; i < mItems.size(); ++i) {
+			mSortKeys[i] = {mItems[i].sortKey, static_cast<uint32_t>(i)};
+		}
+		RadixSort(mSortKeys, mSortScratch);
+
+		mSorted.clear();
+		mSorted.reserve(mItems.size());
+		for (const auto& k : mSortKeys) {
+			mSorted.emplace_back(std::move(mItems[k.index]));
 		}
+		mItems.swap(mSorted);
 	}
 
 	void URenderSubsystem::DrawItems() {
-		auto* cmd = mContext.cmd;
+		mBatchKeys.resize(mItems.size());
+		for (size_t i = 0; i < mItems.size(); ++i) {
+			const auto& it = mItems[i];
+			mBatchKeys[i]  = {
+				.mesh      = MakeDrawBatchMesh(it.meshHandle.id, it.meshHandle.gen),
+				.material  = it.materialKey,
+				.pso       = it.psoId,
+				.instanced = it.material->rootParams.instances != UINT_MAX
+			};
+		}
+		BuildDrawBatches(mBatchKeys, kMaxInstancesPerBatch, mBatches);
+
+		// マテリアルのCBはここで1度だけ書く(ワーカーはアドレスを積むだけ)
+		mBatchMaterialCB.resize(mBatches.size());
+		for (size_t b = 0; b < mBatches.size(); ++b) {
+			mBatchMaterialCB[b] = mItems[mBatches[b].first].material->WriteConstants(
+				mContext.backIndex, 0.0f
+			);
+		}
+
+		auto& jobs  = JobSystem::Get();
+		auto* arena = mRenderResourceManager->GetUploadArena();
+		PartitionDrawBatches(
+			mBatches, jobs.MaxLanes(), kMinBatchesPerList, mRanges
+		);
+
+		// 少なければ今まで通りフレームのコマンドリストに直接
+		if (mRanges.size() <= 1) {
+			UploadBlockCursor cursor = arena->CreateCursor();
+			RecordBatches(
+				mContext.cmd,
+				{0, static_cast<uint32_t>(mBatches.size())},
+				cursor
+			);
+			return;
+		}
+
+		// リストの作成はスレッドセーフだが、ここで先に揃えておく
+		auto& lists = mRecordLists[mContext.backIndex];
+		while (lists.size() < mRanges.size()) {
+			auto&         rl     = lists.emplace_back();
+			ID3D12Device* device = mGraphicsDevice->Device();
+			THROW(
+				device->CreateCommandAllocator(
+					D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&rl.allocator)
+				)
+			);
+			THROW(
+				device->CreateCommandList(
+					0, D3D12_COMMAND_LIST_TYPE_DIRECT, rl.allocator.Get(),
+					nullptr, IID_PPV_ARGS(&rl.list)
+				)
+			);
+			THROW(rl.list->Close());
+		}
 
+		// ワーカーで範囲ごとに記録する(例外を投げないよう HRESULT はここに集める)
+		mRecordResults.assign(mRanges.size(), S_OK);
+		jobs.ParallelFor(
+			mRanges.size(), 1,
+			[&](const size_t begin, const size_t end, uint32_t) {
+				for (size_t r = begin; r < end; ++r) {
+					auto&   rl = lists[r];
+					HRESULT hr = rl.allocator->Reset();
+					if (SUCCEEDED(hr)) {
+						hr = rl.list->Reset(rl.allocator.Get(), nullptr);
+					}
+					if (FAILED(hr)) {
+						mRecordResults[r] = hr;
+						continue;
+					}
+					mGraphicsDevice->BindFrameTargets(
+						rl.list.Get(), mContext.backIndex
+					);
+					UploadBlockCursor cursor = arena->CreateCursor();
+					RecordBatches(rl.list.Get(), mRanges[r], cursor);
+					mRecordResults[r] = rl.list->Close();
+				}
+			}
+		);
+
+		mRecorded.clear();
+		for (size_t r = 0; r < mRanges.size(); ++r) {
+			const HRESULT hr = mRecordResults[r];
+			THROW(hr);
+			mRecorded.emplace_back(lists[r].list.Get());
+		}
+		mGraphicsDevice->ExecuteRecorded(mContext, mRecorded);
+	}
+
+	void URenderSubsystem::RecordBatches(
+		ID3D12GraphicsCommandList* cmd,
+		const DrawRange&           range,
+		UploadBlockCursor&         cursor
+	) const {
 		const std::array heaps = {
 			mGraphicsDevice->GetSrvAllocator()->GetHeap(),
 			mGraphicsDevice->GetSamplerAllocator()->GetHeap()
@@ -177,23 +428,23 @@ namespace Unnamed {
 		uint32_t                   lastPso = 0;
 		uint32_t                   lastMat = UINT32_MAX;
 
-		for (auto& it : mItems) {
+		for (uint32_t b = 0; b < range.batchCount; ++b) {
+			const DrawBatch& batch      = mBatches[range.firstBatch + b];
+			const auto&      it         = mItems[batch.first];
+			const auto       materialCB = mBatchMaterialCB[range.firstBatch + b];
 			if (it.psoId != lastPso || it.rsPtr != lastRs) {
 				cmd->SetGraphicsRootSignature(it.rsPtr);
 				cmd->SetPipelineState(mPipelineCache->Get({it.psoId}));
 				lastPso = it.psoId;
 				lastRs  = it.rsPtr;
 				// ルートシグネチャが変わったら同じマテリアルでもう一度適用
-				it.material->Apply(cmd, mRenderResourceManager,
-				                   mContext.backIndex, 0.0f);
+				it.material->Bind(cmd, mRenderResourceManager, materialCB);
 				lastMat = it.materialKey;
 			}
 
 			// マテリアル変更時に適用
 			else if (it.materialKey != lastMat) {
-				it.material->Apply(
-					cmd, mRenderResourceManager, mContext.backIndex, 0.0f
-				);
+				it.material->Bind(cmd, mRenderResourceManager, materialCB);
 				lastMat = it.materialKey;
 			}
 
@@ -201,16 +452,6 @@ namespace Unnamed {
 				it.material->rootParams.frameCB, mFrameCBVA
 			);
 
-			// オブジェクトコンスタントバッファ
-			ObjectCBData o = {
-				.world = it.world,
-				.worldInverseTranspose = it.world.Inverse().Transpose()
-			};
-			D3D12_GPU_VIRTUAL_ADDRESS objCbGpu = UploadCB(&o, sizeof(o));
-			UASSERT(objCbGpu != 0 && (objCbGpu & 0xFF) == 0);
-			cmd->SetGraphicsRootConstantBufferView(
-				it.material->rootParams.objectCB, objCbGpu);
-
 			// 共有メッシュから実際のメッシュデータを取得
 			const MeshGPU* mesh = mRenderResourceManager->
 				GetMesh(it.meshHandle);
@@ -218,6 +459,27 @@ namespace Unnamed {
 				continue; // メッシュが無効な場合はスキップ
 			}
 
+			if (it.material->rootParams.instances != UINT_MAX) {
+				// インスタンスバッファ
+				const D3D12_GPU_VIRTUAL_ADDRESS instances = UploadInstances(batch, cursor);
+				if (instances == 0) {
+					continue;
+				}
+				cmd->SetGraphicsRootShaderResourceView(
+					it.material->rootParams.instances, instances
+				);
+			} else {
+				// オブジェクトコンスタントバッファ
+				ObjectCBData o = {
+					.world = it.world,
+					.worldInverseTranspose = it.world.Inverse().Transpose()
+				};
+				D3D12_GPU_VIRTUAL_ADDRESS objCbGpu = UploadCB(&o, sizeof(o), &cursor);
+				UASSERT(objCbGpu != 0 && (objCbGpu & 0xFF) == 0);
+				cmd->SetGraphicsRootConstantBufferView(
+					it.material->rootParams.objectCB, objCbGpu);
+			}
+
 			mRenderResourceManager->BindVertexBuffer(cmd, mesh->vb);
 			mRenderResourceManager->BindIndexBuffer(cmd, mesh->ib);
 			cmd->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
@@ -225,23 +487,25 @@ namespace Unnamed {
 			if (mesh->indexCount > 0) {
 				cmd->DrawIndexedInstanced(
 					mesh->indexCount,
-					1,
+					batch.count,
 					mesh->firstIndex,
 					mesh->baseVertex,
 					0
 				);
 			} else {
-				cmd->DrawInstanced(3, 1, 0, 0);
+				cmd->DrawInstanced(3, batch.count, 0, 0);
 			}
 		}
 	}
 
 	D3D12_GPU_VIRTUAL_ADDRESS URenderSubsystem::UploadCB(
-		const void* src, const size_t bytes
+		const void* src, const size_t bytes, UploadBlockCursor* cursor
 	) const {
 		const size_t aligned = (bytes + 255) & ~static_cast<size_t>(255);
-		const auto   slice = mRenderResourceManager->GetUploadArena()->Allocate(
-			aligned, 256);
+		auto*        arena   = mRenderResourceManager->GetUploadArena();
+		const auto   slice   = cursor ?
+			                       arena->Allocate(*cursor, aligned, 256) :
+			                       arena->Allocate(aligned, 256);
 		if (!slice.cpu) {
 			// 足りないときのフォールバック（警告だけ出して早期 return でもOK）
 			Warning("Render",
@@ -252,4 +516,24 @@ namespace Unnamed {
 		std::memcpy(slice.cpu, src, bytes);
 		return slice.gpuVirtualAddress;
 	}
+
+	D3D12_GPU_VIRTUAL_ADDRESS URenderSubsystem::UploadInstances(
+		const DrawBatch& batch, UploadBlockCursor& cursor
+	) const {
+		const size_t bytes = sizeof(InstanceData) * batch.count;
+		const auto   slice = mRenderResourceManager->GetUploadArena()->Allocate(
+			cursor, bytes, 256);
+		if (!slice.cpu) {
+			Warning("Render",
+			        "UploadArena capacity exceeded (size={}, frame={})",
+			        bytes, mContext.backIndex);
+			return 0;
+		}
+		// 書き込み結合のメモリなので、先頭から順に書くだけにする
+		auto* dst = static_cast<InstanceData*>(slice.cpu);
+		for (uint32_t i = 0; i < batch.count; ++i) {
+			dst[i].world = mItems[batch.first + i].world;
+		}
+		return slice.gpuVirtualAddress;
+	}
 }
@@ -6,6 +6,8 @@
 
 #include <runtime/assets/core/UAssetID.h>
 #include <runtime/core/math/Math.h>
+#include <runtime/render/batching/RenderBatching.h>
+#include <runtime/render/culling/RenderCulling.h>
 #include <runtime/render/types/RenderTypes.h>
 
 #include "engine/subsystem/interface/ISubsystem.h"
@@ -18,6 +20,10 @@ namespace Unnamed {
 	class RootSignatureCache;
 	class UPipelineCache;
 	class UWorld;
+	class UEntity;
+	class TransformComponent;
+	class MeshRendererComponent;
+	class UploadBlockCursor;
 
 	struct LastSubmit {
 		Microsoft::WRL::ComPtr<ID3D12Fence> fence;
@@ -52,10 +58,47 @@ namespace Unnamed {
 			return "RenderSubsystem";
 		}
 
+		// 直近のフレームの収集結果
+		[[nodiscard]] size_t VisibleCount() const { return mItems.size(); }
+		[[nodiscard]] size_t CulledCount() const { return mCulledCount; }
+		[[nodiscard]] size_t DrawCount() const { return mBatches.size(); }
+
 	private:
-		void Collect(const UWorld& world, const Mat4& parent);
+		struct RenderItem;
+
+		/// @brief 描画するアイテムを集めます
+		/// @details ワールドの木をたどってエンティティを平らに並べ、
+		/// チャンクごとにワーカーでカリングしてレーンごとのリストに入れます。
+		/// GPUの準備(EnsureGPU)はコマンドリストを使うので、まだのものだけ後で直列に行います
+		void Collect(const UWorld& world);
+		void Gather(const UWorld& world, uint32_t parent);
+
+		// カリングして通ったら items に足します(ワーカーから呼ばれる)
+		void EmitItem(
+			const TransformComponent&    transform,
+			MeshRendererComponent&       meshRenderer,
+			const Mat4&                  parent,
+			const MeshGPU*               mesh,
+			std::vector<RenderItem>&     items
+		) const;
+
+		void SortItems();
+
+		/// @brief 並べ替えたアイテムを描きます
+		/// @details 連続していてメッシュとマテリアルが同じものは1回のインスタンス描画にまとめ、
+		/// ワールド行列をインスタンスバッファ(t1)で渡します。
+		/// インスタンス描画に対応していないマテリアルは今まで通り ObjectCB で1つずつ描きます。
+		/// バッチが多ければ範囲に分けてワーカーで別々のコマンドリストに記録し、
+		/// フレームのコマンドリストの後に順番通り実行します
 		void DrawItems();
 
+		// range のバッチを cmd に記録します(ワーカーから呼ばれる)
+		void RecordBatches(
+			ID3D12GraphicsCommandList* cmd,
+			const DrawRange&           range,
+			UploadBlockCursor&         cursor
+		) const;
+
 		struct FrameCBData {
 			Mat4  view;
 			Mat4  proj;
@@ -69,6 +112,23 @@ namespace Unnamed {
 			Mat4 worldInverseTranspose;
 		};
 
+		// MaterialABI.hlsli の InstanceData と同じ並び
+		struct InstanceData {
+			Mat4 world;
+		};
+
+		// 1バッチのインスタンス数の上限(64KB)
+		static constexpr uint32_t kMaxInstancesPerBatch = 1024;
+
+		// コマンドリスト1つに記録するバッチ数の下限(これより少なければ分けない)
+		static constexpr uint32_t kMinBatchesPerList = 64;
+
+		// ワーカーが記録するコマンドリスト
+		struct RecordList {
+			Microsoft::WRL::ComPtr<ID3D12CommandAllocator>    allocator;
+			Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> list;
+		};
+
 		struct TempCB {
 			Microsoft::WRL::ComPtr<ID3D12Resource> resource;
 			D3D12_GPU_VIRTUAL_ADDRESS              gpu = 0;
@@ -83,8 +143,14 @@ namespace Unnamed {
 		static constexpr int kFrameInFlight = kFrameBufferCount;
 		std::array<TransientBin, kFrameInFlight> mTransient;
 
+		// cursor があればそこから、無ければアリーナから直接切り出します
 		D3D12_GPU_VIRTUAL_ADDRESS UploadCB(
-			const void* src, size_t bytes
+			const void* src, size_t bytes, UploadBlockCursor* cursor = nullptr
+		) const;
+
+		// バッチのワールド行列をアップロードアリーナに並べます
+		D3D12_GPU_VIRTUAL_ADDRESS UploadInstances(
+			const DrawBatch& batch, UploadBlockCursor& cursor
 		) const;
 
 	private:
@@ -104,14 +170,43 @@ namespace Unnamed {
 			MeshHandle        meshHandle;  // 共有メッシュのハンドル
 			UMaterialRuntime* material;
 
-			float                depthVS     = 0.0f;
-			AssetID              psoId       = 0;
-			AssetID              materialKey = 0;
-			ID3D12RootSignature* rsPtr       = nullptr;
+			float                depthVS      = 0.0f;
+			float                screenPixels = 0.0f; // テクスチャストリーミング用
+			uint64_t             sortKey      = 0;
+			AssetID              psoId        = 0;
+			AssetID              materialKey  = 0;
+			ID3D12RootSignature* rsPtr        = nullptr;
+		};
+
+		// 収集するエンティティ(parent は mParents の添字)
+		struct CollectSource {
+			UEntity* entity = nullptr;
+			uint32_t parent = 0;
 		};
 
 		std::vector<RenderItem> mItems;
 
+		// 収集用(フレームをまたいで使い回す)
+		std::vector<CollectSource>           mSources;
+		std::vector<Mat4>                    mParents;
+		std::vector<std::vector<RenderItem>> mLaneItems;
+		std::vector<std::vector<uint32_t>>   mLanePending; // EnsureGPU がまだのもの
+		std::vector<size_t>                  mLaneCulled;
+		std::vector<RenderSortKey>           mSortKeys;
+		std::vector<RenderSortKey>           mSortScratch;
+		std::vector<RenderItem>              mSorted;
+		std::vector<DrawBatchKey>            mBatchKeys;
+		std::vector<DrawBatch>               mBatches;
+
+		// 並列記録用(コマンドリストはフレームごと)
+		std::array<std::vector<RecordList>, kFrameInFlight> mRecordLists;
+		std::vector<DrawRange>                              mRanges;
+		std::vector<D3D12_GPU_VIRTUAL_ADDRESS>              mBatchMaterialCB; // 記録前に書いたマテリアルCB
+		std::vector<HRESULT>                                mRecordResults;
+		std::vector<ID3D12CommandList*>                     mRecorded;
+		Frustum                              mFrustum;
+		size_t                               mCulledCount = 0;
+
 		D3D12_GPU_VIRTUAL_ADDRESS mFrameCBVA = 0;
 
 		LastSubmit mLastSubmit;
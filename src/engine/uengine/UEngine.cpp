@@ -6,6 +6,7 @@
 #include <engine/gameframework/component/MeshRenderer/MeshRendererComponent.h>
 #include <engine/gameframework/component/Rotator/RotatorComponent.h>
 #include <engine/gameframework/component/Transform/TransformComponent.h>
+#include <engine/gameframework/component/Transform/TransformSystem.h>
 #include <engine/subsystem/console/ConsoleSystem.h>
 #include <engine/subsystem/input/KeyNameTable.h>
 #include <engine/subsystem/input/UInputSystem.h>
@@ -16,9 +17,14 @@
 #include <engine/subsystem/window/Win32/Win32WindowSystem.h>
 #include <engine/uengine/UEngine.h>
 
+#include <core/jobsystem/JobSystem.h>
+
 #include <runtime/assets/core/UAssetManager.h>
+#include <runtime/assets/loaders/AnimationLoader.h>
+#include <runtime/assets/loaders/CookedAnimationLoader.h>
 #include <runtime/assets/loaders/DirectXTexTextureLoader.h>
 #include <runtime/assets/loaders/MaterialLoader.h>
+#include <runtime/assets/loaders/CookedMeshLoader.h>
 #include <runtime/assets/loaders/MeshLoader.h>
 #include <runtime/assets/loaders/RawLoader.h>
 #include <runtime/assets/loaders/ShaderLoader.h>
@@ -213,11 +219,17 @@ namespace Unnamed {
 		auto shaderLoader = std::make_unique<ShaderLoader>(mAssetManager.get());
 		auto rawFileLoader = std::make_unique<RawLoader>();
 		auto meshLoader = std::make_unique<MeshLoader>();
+		auto cookedMeshLoader = std::make_unique<CookedMeshLoader>();
+		auto animationLoader = std::make_unique<AnimationLoader>();
+		auto cookedAnimationLoader = std::make_unique<CookedAnimationLoader>();
 		mAssetManager->RegisterLoader(std::move(matLoader));
 		mAssetManager->RegisterLoader(std::move(texLoader));
 		mAssetManager->RegisterLoader(std::move(shaderLoader));
 		mAssetManager->RegisterLoader(std::move(rawFileLoader));
 		mAssetManager->RegisterLoader(std::move(meshLoader));
+		mAssetManager->RegisterLoader(std::move(cookedMeshLoader));
+		mAssetManager->RegisterLoader(std::move(animationLoader));
+		mAssetManager->RegisterLoader(std::move(cookedAnimationLoader));
 
 		mUploadArena = std::make_unique<UploadArena>();
 		mUploadArena->Init(
@@ -229,6 +241,12 @@ namespace Unnamed {
 		mRenderResourceManager = std::make_unique<RenderResourceManager>(
 			mGraphicsDevice.get(), mAssetManager.get(), mUploadArena.get()
 		);
+		mRenderResourceManager->SetStreamingSettings({
+			.enabled = true,
+			.tailSize = 64,
+			.budgetBytes = 256ull * 1024 * 1024,
+			.uploadBytesPerFrame = 8ull * 1024 * 1024, // アリーナの半分まで
+		});
 
 		// ShaderLibraryの作成と初期化
 		mShaderLibrary = std::make_unique<ShaderLibrary>(
@@ -244,6 +262,8 @@ namespace Unnamed {
 		mPipelineCache = std::make_unique<UPipelineCache>(
 			mGraphicsDevice.get(), mRootSignatureCache.get()
 		);
+		// 前回のセッションで使ったPSOをワーカーで先に作っておく
+		mPipelineCache->Precompile();
 
 		// RenderSubsystemの作成と初期化、サービスロケーターに登録
 		mSubsystems.emplace_back(
@@ -423,7 +443,10 @@ namespace Unnamed {
 
 			mCameraTransform->SetPosition(prevPos);
 
-			mWorld->Tick(deltaTime);
+			mWorld->Tick(deltaTime, &JobSystem::Get());
+
+			// ワールド行列は全エンティティの更新が終わってから階層順にまとめて計算
+			TransformSystem::Get().Update(&JobSystem::Get());
 
 			//-----------------------------------------------------------------
 
@@ -496,6 +519,9 @@ namespace Unnamed {
 			mRenderer->BeginFrame();
 			mRenderer->RenderWorld(*mWorld);
 			mRenderer->EndFrame();
+
+			// 描画が終わったので差し替え前のペイロードを解放する
+			mAssetManager->CollectRetired();
 			//-----------------------------------------------------------------
 
 			// auto buffer = mGraphicsDevice->GetFrameBuffer(context.backIndex);
@@ -1,7 +1,11 @@
 ﻿#pragma once
+#include <memory>
+#include <span>
 #include <vector>
 
 #include <engine/uphysics/BVHBuilder.h>
+#include <engine/uphysics/BVHCache.h>
+#include <engine/uphysics/InstanceTransform.h>
 
 class Entity;
 
@@ -11,10 +15,34 @@ struct BVH {
 };
 
 struct RegisteredBVH {
+	// ノードと三角形はローカル空間。transformでワールドに置く
+	// キャッシュから読み込んだものは以下の3つが空で、mapped を参照する
 	std::vector<UPhysics::FlatNode> nodes;
-	std::vector<uint32_t> triIndices;
+	std::vector<UPhysics::BVH4Node> nodes4; // nodesを4分岐に畳んだもの
+	std::vector<uint32_t> triIndices;   // triStartからの相対インデックス
+
+	// キャッシュファイルをマップしたもの。三角形も三角形領域(triStart)ではなくこちらにある
+	std::shared_ptr<const UPhysics::MappedBVH> mapped;
 
 	size_t  triStart;
 	size_t  triCount;
 	Entity* owner;
+
+	UPhysics::InstanceTransform transform;
+	Unnamed::AABB               worldBounds; // ルートAABBをワールド空間に変換したもの(TLAS用)
+
+	uint32_t generation = 0;     // スロットが解放されるたびに進む
+	bool     alive      = false; // falseなら空きスロット
+
+	[[nodiscard]] std::span<const UPhysics::FlatNode> Nodes() const {
+		return mapped ? mapped->nodes : std::span(nodes);
+	}
+
+	[[nodiscard]] std::span<const UPhysics::BVH4Node> Nodes4() const {
+		return mapped ? mapped->nodes4 : std::span(nodes4);
+	}
+
+	[[nodiscard]] std::span<const uint32_t> TriIndices() const {
+		return mapped ? mapped->triIndices : std::span(triIndices);
+	}
 };
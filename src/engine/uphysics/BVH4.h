@@ -0,0 +1,99 @@
+﻿#pragma once
+#include <cstdint>
+#include <xmmintrin.h>
+
+#include <engine/uphysics/PhysicsTypes.h>
+
+namespace UPhysics {
+	// 4分岐BVHノード
+	// 子のAABBをSoAで持ち、1本のレイと4つのAABBをSSEで同時に判定します
+	struct alignas(16) BVH4Node {
+		float minX[4];
+		float minY[4];
+		float minZ[4];
+		float maxX[4];
+		float maxY[4];
+		float maxZ[4];
+
+		uint32_t child[4];     // 内部: 子ノードの番号 / 葉: triIndices上の先頭位置
+		uint16_t primCount[4]; // 0なら内部ノード
+		uint8_t  childCount;   // 有効な子の数(先頭から詰める)
+		uint8_t  pad[7];       // 128バイトに揃える(C4324 を出さないよう明示的に詰める)
+	};
+	static_assert(sizeof(BVH4Node) == 128);
+
+	// SIMD判定用に前計算したレイ
+	struct BVH4Ray {
+		__m128 originX, originY, originZ;
+		__m128 invDirX, invDirY, invDirZ;
+		__m128 expandX, expandY, expandZ; // ノードを膨らませる量(ボックス/スフィアキャスト用)
+	};
+
+	inline BVH4Ray MakeBVH4Ray(
+		const Vec3& origin,
+		const Vec3& dir,
+		const Vec3& expand
+	) {
+		// 軸に平行なレイでも inf * 0 による NaN を出さないよう巨大値で代用
+		const auto safeInv = [](const float d) {
+			constexpr float kHuge = 1e30f;
+			if (d > 1e-8f || d < -1e-8f) {
+				return 1.0f / d;
+			}
+			return d < 0.0f ? -kHuge : kHuge;
+		};
+
+		return BVH4Ray{
+			.originX = _mm_set1_ps(origin.x),
+			.originY = _mm_set1_ps(origin.y),
+			.originZ = _mm_set1_ps(origin.z),
+			.invDirX = _mm_set1_ps(safeInv(dir.x)),
+			.invDirY = _mm_set1_ps(safeInv(dir.y)),
+			.invDirZ = _mm_set1_ps(safeInv(dir.z)),
+			.expandX = _mm_set1_ps(expand.x),
+			.expandY = _mm_set1_ps(expand.y),
+			.expandZ = _mm_set1_ps(expand.z),
+		};
+	}
+
+	/// @brief レイと4つの子AABBのスラブ判定
+	/// @param outTNear 各子への進入距離
+	/// @return 交差した子のビットマスク
+	inline uint32_t RayVsBVH4Node(
+		const BVH4Node& node,
+		const BVH4Ray&  ray,
+		const float     tMin,
+		const float     tMax,
+		float           outTNear[4]
+	) {
+		const __m128 minX = _mm_sub_ps(_mm_load_ps(node.minX), ray.expandX);
+		const __m128 minY = _mm_sub_ps(_mm_load_ps(node.minY), ray.expandY);
+		const __m128 minZ = _mm_sub_ps(_mm_load_ps(node.minZ), ray.expandZ);
+		const __m128 maxX = _mm_add_ps(_mm_load_ps(node.maxX), ray.expandX);
+		const __m128 maxY = _mm_add_ps(_mm_load_ps(node.maxY), ray.expandY);
+		const __m128 maxZ = _mm_add_ps(_mm_load_ps(node.maxZ), ray.expandZ);
+
+		const __m128 t1X = _mm_mul_ps(_mm_sub_ps(minX, ray.originX), ray.invDirX);
+		const __m128 t2X = _mm_mul_ps(_mm_sub_ps(maxX, ray.originX), ray.invDirX);
+		const __m128 t1Y = _mm_mul_ps(_mm_sub_ps(minY, ray.originY), ray.invDirY);
+		const __m128 t2Y = _mm_mul_ps(_mm_sub_ps(maxY, ray.originY), ray.invDirY);
+		const __m128 t1Z = _mm_mul_ps(_mm_sub_ps(minZ, ray.originZ), ray.invDirZ);
+		const __m128 t2Z = _mm_mul_ps(_mm_sub_ps(maxZ, ray.originZ), ray.invDirZ);
+
+		const __m128 tNear = _mm_max_ps(
+			_mm_max_ps(_mm_min_ps(t1X, t2X), _mm_min_ps(t1Y, t2Y)),
+			_mm_max_ps(_mm_min_ps(t1Z, t2Z), _mm_set1_ps(tMin))
+		);
+		const __m128 tFar = _mm_min_ps(
+			_mm_min_ps(_mm_max_ps(t1X, t2X), _mm_max_ps(t1Y, t2Y)),
+			_mm_min_ps(_mm_max_ps(t1Z, t2Z), _mm_set1_ps(tMax))
+		);
+
+		_mm_storeu_ps(outTNear, tNear);
+
+		const uint32_t validMask = (1u << node.childCount) - 1u;
+		return static_cast<uint32_t>(
+			_mm_movemask_ps(_mm_cmple_ps(tNear, tFar))
+		) & validMask;
+	}
+}
@@ -1,116 +1,319 @@
 ﻿#include <engine/uphysics/BVHBuilder.h>
 
+#include <chrono>
+
+#include <core/jobsystem/JobSystem.h>
+
 namespace UPhysics {
+	namespace {
+		constexpr int kBucket = 12;
+
+		// これ以上の三角形を持つ部分木は左右を並列に構築する
+		constexpr uint32_t kParallelSubtreeCutoff = 16384;
+		// これ以上の三角形を持つノードではビニングを並列に行う
+		constexpr uint32_t kParallelBinCutoff = 65536;
+		// 並列ビニングで1レーンが処理する三角形数
+		constexpr size_t kBinGrainSize = 16384;
+
+		// SAHのトラバーサルコスト(三角形1つの判定を1とする)
+		constexpr float kTraversalCost = 0.125f;
+
+		struct Bucket {
+			Unnamed::AABB bounds;
+			uint32_t      count = 0;
+		};
+
+		struct BinSet {
+			Bucket buckets[kBucket] = {};
+		};
+
+		int BucketOf(const float c, const float minC, const float scale) {
+			const int b = static_cast<int>((c - minC) * scale);
+			return std::clamp(b, 0, kBucket - 1);
+		}
+	}
+
+	void BVHBuilder::SetParallel(const bool parallel) {
+		mParallel = parallel;
+	}
+
 	void BVHBuilder::Build(
 		const std::vector<Unnamed::Triangle>& triangles,
 		std::vector<FlatNode>&       outNodes,
 		std::vector<uint32_t>&       outTriIndices,
 		const uint32_t               leafSize
 	) {
+		const auto begin = std::chrono::steady_clock::now();
+
 		mLeafSize = leafSize;
 		size_t n  = triangles.size();
 		mTriInfos.resize(n);
 		mTriIndices.resize(n);
 
-		for (size_t i = 0; i < n; ++i) {
-			const Unnamed::Triangle& t    = triangles[i];
-			TriInfo&        info = mTriInfos[i];
-			info.bounds.Expand(t.v0);
-			info.bounds.Expand(t.v1);
-			info.bounds.Expand(t.v2);
-			info.center    = (t.v0 + t.v1 + t.v2) / 3.0f;
-			info.triIndex  = static_cast<uint32_t>(i);
-			mTriIndices[i] = static_cast<uint32_t>(i);
+		const auto fillInfos = [&](const size_t first, const size_t last) {
+			for (size_t i = first; i < last; ++i) {
+				const Unnamed::Triangle& t    = triangles[i];
+				TriInfo&                 info = mTriInfos[i];
+				info.bounds                   = {};
+				info.bounds.Expand(t.v0);
+				info.bounds.Expand(t.v1);
+				info.bounds.Expand(t.v2);
+				info.center    = (t.v0 + t.v1 + t.v2) / 3.0f;
+				info.triIndex  = static_cast<uint32_t>(i);
+				mTriIndices[i] = static_cast<uint32_t>(i);
+			}
+		};
+		if (mParallel && n >= kParallelBinCutoff) {
+			JobSystem::Get().ParallelFor(
+				n, kBinGrainSize,
+				[&](const size_t first, const size_t last, uint32_t) {
+					fillInfos(first, last);
+				}
+			);
+		} else {
+			fillInfos(0, n);
 		}
 
 		// 再帰構築
-		mNodes.reserve(n * 2);
-		Recurse(0, static_cast<uint32_t>(n), 0);
+		std::vector<FlatNode> nodes;
+		nodes.reserve(n * 2);
+		Recurse(0, static_cast<uint32_t>(n), nodes);
+
+		mStats               = ComputeStats(nodes);
+		mStats.triangleCount = static_cast<uint32_t>(n);
+		mStats.buildMs       = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - begin
+		).count();
 
-		outNodes      = std::move(mNodes);
+		outNodes      = std::move(nodes);
 		outTriIndices = std::move(mTriIndices);
 	}
 
+	const BVHBuildStats& BVHBuilder::GetStats() const {
+		return mStats;
+	}
+
+	BVHBuildStats BVHBuilder::ComputeStats(const std::vector<FlatNode>& nodes) {
+		BVHBuildStats stats;
+		stats.nodeCount = static_cast<uint32_t>(nodes.size());
+		if (nodes.empty()) {
+			return stats;
+		}
+
+		const float rootArea = nodes[0].bounds.SurfaceArea();
+		const float invRoot  = rootArea > 0.0f ? 1.0f / rootArea : 0.0f;
+
+		struct Entry {
+			uint32_t node;
+			uint32_t depth;
+		};
+		std::vector<Entry> stack;
+		stack.emplace_back(0u, 0u);
+		while (!stack.empty()) {
+			const auto [index, depth] = stack.back();
+			stack.pop_back();
+
+			const FlatNode& node = nodes[index];
+			const float     area = node.bounds.SurfaceArea() * invRoot;
+			stats.maxDepth       = std::max(stats.maxDepth, depth);
+
+			if (node.primCount == 0 && nodes.size() > 1) {
+				stats.sahCost += kTraversalCost * area;
+				stack.emplace_back(node.leftFirst, depth + 1);
+				stack.emplace_back(node.rightFirst, depth + 1);
+			} else {
+				stats.sahCost += static_cast<float>(node.primCount) * area;
+				++stats.leafCount;
+			}
+		}
+		return stats;
+	}
+
+	void BVHBuilder::ComputeBounds(
+		const uint32_t start,
+		const uint32_t end,
+		Unnamed::AABB& outBounds,
+		Unnamed::AABB& outCenterBounds
+	) const {
+		const auto accumulate = [&](
+			const size_t   first, const size_t last,
+			Unnamed::AABB& bounds, Unnamed::AABB& centers
+		) {
+			for (size_t i = first; i < last; ++i) {
+				const TriInfo& info = mTriInfos[mTriIndices[i]];
+				bounds.Expand(info.bounds);
+				centers.Expand(info.center);
+			}
+		};
+
+		outBounds       = {};
+		outCenterBounds = {};
+		const uint32_t count = end - start;
+		if (!mParallel || count < kParallelBinCutoff) {
+			accumulate(start, end, outBounds, outCenterBounds);
+			return;
+		}
+
+		// チャンクごとに集計してから順番にマージする(結果は直列と一致する)
+		const size_t chunkCount = (count + kBinGrainSize - 1) / kBinGrainSize;
+		std::vector<Unnamed::AABB> bounds(chunkCount);
+		std::vector<Unnamed::AABB> centers(chunkCount);
+		JobSystem::Get().ParallelFor(
+			count, kBinGrainSize,
+			[&](const size_t first, const size_t last, uint32_t) {
+				const size_t chunk = first / kBinGrainSize;
+				accumulate(
+					start + first, start + last, bounds[chunk], centers[chunk]
+				);
+			}
+		);
+		for (size_t i = 0; i < chunkCount; ++i) {
+			outBounds.Expand(bounds[i]);
+			outCenterBounds.Expand(centers[i]);
+		}
+	}
+
 	uint32_t BVHBuilder::Recurse(
-		uint32_t start, uint32_t end,
-		int      depth
+		const uint32_t         start,
+		const uint32_t         end,
+		std::vector<FlatNode>& nodes
 	) {
-		FlatNode node      = {};
-		uint32_t nodeIndex = static_cast<uint32_t>(mNodes.size());
-		mNodes.emplace_back(node);
+		const uint32_t nodeIndex = static_cast<uint32_t>(nodes.size());
+		nodes.emplace_back();
 
-		Unnamed::AABB bounds = {};
-		for (uint32_t i = start; i < end; ++i) {
-			bounds.Expand(mTriInfos[mTriIndices[i]].bounds);
-		}
-		mNodes[nodeIndex].bounds = bounds;
+		Unnamed::AABB bounds;
+		Unnamed::AABB centerBounds;
+		ComputeBounds(start, end, bounds, centerBounds);
+		nodes[nodeIndex].bounds = bounds;
 
 		uint32_t triCount = end - start;
 		if (triCount <= mLeafSize) {
-			mNodes[nodeIndex].leftFirst = start;
-			mNodes[nodeIndex].primCount = static_cast<uint16_t>(triCount);
+			nodes[nodeIndex].leftFirst = start;
+			nodes[nodeIndex].primCount = static_cast<uint16_t>(triCount);
 			return nodeIndex;
 		}
 
 		// ノードの分割
 		int      axis = bounds.LongestAxis();
 		uint32_t mid;
-		SAHSplit(start, end, axis, mid);
+		SAHSplit(start, end, axis, centerBounds, mid);
 
 		// 分割失敗
 		if (mid == start || mid == end) {
 			mid = (start + end) / 2;
 		}
 
-		// 子を深度優先でプッシュ
-		const uint32_t left  = Recurse(start, mid, depth + 1);
-		const uint32_t right = Recurse(mid, end, depth + 1);
+		uint32_t left;
+		uint32_t right;
+		if (mParallel && triCount >= kParallelSubtreeCutoff) {
+			// 左右を別々のノード列に並列で構築し、直列と同じ順(左→右)で連結する
+			std::vector<FlatNode> sub[2];
+			uint32_t              subRoot[2] = {};
+			JobSystem::Get().ParallelFor(
+				2, 1,
+				[&](const size_t first, const size_t last, uint32_t) {
+					for (size_t i = first; i < last; ++i) {
+						sub[i].reserve(static_cast<size_t>(
+							i == 0 ? mid - start : end - mid) * 2);
+						subRoot[i] = i == 0
+							             ? Recurse(start, mid, sub[i])
+							             : Recurse(mid, end, sub[i]);
+					}
+				}
+			);
+
+			for (int i = 0; i < 2; ++i) {
+				const uint32_t offset = static_cast<uint32_t>(nodes.size());
+				for (FlatNode node : sub[i]) {
+					if (node.primCount == 0) {
+						node.leftFirst  += offset;
+						node.rightFirst += offset;
+					}
+					nodes.emplace_back(node);
+				}
+				(i == 0 ? left : right) = subRoot[i] + offset;
+			}
+		} else {
+			// 子を深度優先でプッシュ
+			left  = Recurse(start, mid, nodes);
+			right = Recurse(mid, end, nodes);
+		}
 
-		mNodes[nodeIndex].leftFirst  = left;
-		mNodes[nodeIndex].rightFirst = right;
-		mNodes[nodeIndex].primCount  = 0;
+		nodes[nodeIndex].leftFirst  = left;
+		nodes[nodeIndex].rightFirst = right;
+		nodes[nodeIndex].primCount  = 0;
 		return nodeIndex;
 	}
 
 	void BVHBuilder::SAHSplit(
-		uint32_t start, uint32_t end,
-		int      axis, uint32_t& outMid
+		const uint32_t       start,
+		const uint32_t       end,
+		const int            axis,
+		const Unnamed::AABB& centerBounds,
+		uint32_t&            outMid
 	) {
-		const int kBucket = 12;
-		struct Bucket {
-			Unnamed::AABB     bounds;
-			uint32_t count = 0;
-		};
-		Bucket buckets[kBucket] = {};
-
-		Unnamed::AABB centerBounds = {};
-		for (uint32_t i = start; i < end; ++i) {
-			centerBounds.Expand(mTriInfos[mTriIndices[i]].center);
-		}
-
 		float minC  = (&centerBounds.min.x)[axis];
 		float maxC  = (&centerBounds.max.x)[axis];
 		float scale = (maxC - minC > 1e-5f) ? (kBucket / (maxC - minC)) : 0.0f;
 
 		// バケットに三角形を振り分け
-		for (uint32_t i = start; i < end; ++i) {
-			float c = (&mTriInfos[mTriIndices[i]].center.x)[axis];
-			int b = std::min(kBucket - 1, static_cast<int>((c - minC) * scale));
-			buckets[b].bounds.Expand(mTriInfos[mTriIndices[i]].bounds);
-			buckets[b].count++;
-		}
-
-		// 前方後方累積でコストを計算a
-		float    cost[kBucket - 1];
-		Unnamed::AABB     left[kBucket - 1];
-		Unnamed::AABB     right[kBucket - 1];
-		uint32_t leftCount[kBucket - 1];
-		uint32_t rightCount[kBucket - 1];
-
-		Unnamed::AABB     t;
-		uint32_t c = 0;
+		const auto binRange = [&](
+			const size_t first, const size_t last, BinSet& bins
+		) {
+			for (size_t i = first; i < last; ++i) {
+				const TriInfo& info = mTriInfos[mTriIndices[i]];
+				const int      b    = BucketOf(
+					(&info.center.x)[axis], minC, scale
+				);
+				bins.buckets[b].bounds.Expand(info.bounds);
+				bins.buckets[b].count++;
+			}
+		};
+
+		BinSet         bins;
+		const uint32_t count = end - start;
+		if (!mParallel || count < kParallelBinCutoff) {
+			binRange(start, end, bins);
+		} else {
+			// チャンクごとのビンを順番にマージする(結果は直列と一致する)
+			const size_t chunkCount = (count + kBinGrainSize - 1) /
+				kBinGrainSize;
+			std::vector<BinSet> chunkBins(chunkCount);
+			JobSystem::Get().ParallelFor(
+				count, kBinGrainSize,
+				[&](const size_t first, const size_t last, uint32_t) {
+					binRange(
+						start + first, start + last,
+						chunkBins[first / kBinGrainSize]
+					);
+				}
+			);
+			for (const BinSet& chunk : chunkBins) {
+				for (int b = 0; b < kBucket; ++b) {
+					if (chunk.buckets[b].count == 0) {
+						continue;
+					}
+					bins.buckets[b].bounds.Expand(chunk.buckets[b].bounds);
+					bins.buckets[b].count += chunk.buckets[b].count;
+				}
+			}
+		}
+		const Bucket* buckets = bins.buckets;
+
+		// 前方後方累積でコストを計算
+		// 空のバケットは無効なAABB(min > max)なので、Expandすると無限大の箱になってしまう
+		float         cost[kBucket - 1];
+		Unnamed::AABB left[kBucket - 1];
+		Unnamed::AABB right[kBucket - 1];
+		uint32_t      leftCount[kBucket - 1];
+		uint32_t      rightCount[kBucket - 1];
+
+		Unnamed::AABB t;
+		uint32_t      c = 0;
 		for (int i = 0; i < kBucket - 1; ++i) {
-			t.Expand(buckets[i].bounds);
+			if (buckets[i].count) {
+				t.Expand(buckets[i].bounds);
+			}
 			c += buckets[i].count;
 			left[i]      = t;
 			leftCount[i] = c;
@@ -118,13 +321,15 @@ namespace UPhysics {
 		t = {};
 		c = 0;
 		for (int i = kBucket - 1; i > 0; --i) {
-			t.Expand(buckets[i].bounds);
+			if (buckets[i].count) {
+				t.Expand(buckets[i].bounds);
+			}
 			c += buckets[i].count;
 			right[i - 1]      = t;
 			rightCount[i - 1] = c;
 		}
 		for (int i = 0; i < kBucket - 1; ++i) {
-			cost[i] = 0.125f +
+			cost[i] = kTraversalCost +
 				(leftCount[i]
 					 ? left[i].SurfaceArea() * static_cast<float>(leftCount[i])
 					 : 0.0f) +
@@ -134,17 +339,157 @@ namespace UPhysics {
 					 : 0.0f);
 		}
 
-		// 最小コストのバケットをMidにする
-		int   best     = int(std::min_element(cost, cost + kBucket - 1) - cost);
-		float splitPos = minC + static_cast<float>(best + 1) / scale;
+		// 最小コストのバケットの境界で分割する
+		// 振り分けと同じ式で判定するので、集計したバケットと分割結果が食い違わない
+		const int best = static_cast<int>(
+			std::min_element(cost, cost + kBucket - 1) - cost
+		);
 
 		size_t mid_raw = std::partition(
 			mTriIndices.begin() + start,
 			mTriIndices.begin() + end,
 			[&](const uint32_t index) {
-				return (&mTriInfos[index].center.x)[axis] < splitPos;
+				return BucketOf(
+					(&mTriInfos[index].center.x)[axis], minC, scale
+				) <= best;
 			}
 		) - mTriIndices.begin();
 		outMid = static_cast<uint32_t>(mid_raw); // 明示的キャストで警告回避
 	}
+
+	void BVHBuilder::CollapseBVH4(
+		const std::vector<FlatNode>& nodes,
+		std::vector<BVH4Node>&       outNodes4
+	) {
+		outNodes4.clear();
+		// 三角形が無い場合はルートだけの空ノードになっている
+		if (nodes.empty() || (nodes.size() == 1 && nodes[0].primCount == 0)) {
+			return;
+		}
+		outNodes4.reserve(nodes.size() / 2 + 1);
+		CollapseRecurse(nodes, 0, outNodes4);
+	}
+
+	uint32_t BVHBuilder::CollapseRecurse(
+		const std::vector<FlatNode>& nodes,
+		const uint32_t               nodeIndex,
+		std::vector<BVH4Node>&       outNodes4
+	) {
+		const uint32_t outIndex = static_cast<uint32_t>(outNodes4.size());
+		outNodes4.emplace_back();
+
+		// 表面積の大きい内部ノードから開いて最大4つの子を集める
+		uint32_t slots[4];
+		int      slotCount = 0;
+
+		const FlatNode& root = nodes[nodeIndex];
+		if (root.primCount != 0) {
+			slots[slotCount++] = nodeIndex;
+		} else {
+			slots[slotCount++] = root.leftFirst;
+			slots[slotCount++] = root.rightFirst;
+			while (slotCount < 4) {
+				int   best     = -1;
+				float bestArea = -1.0f;
+				for (int i = 0; i < slotCount; ++i) {
+					const FlatNode& n = nodes[slots[i]];
+					if (n.primCount != 0) {
+						continue;
+					}
+					const float area = n.bounds.SurfaceArea();
+					if (area > bestArea) {
+						bestArea = area;
+						best     = i;
+					}
+				}
+				if (best < 0) {
+					break; // 全部葉
+				}
+				const FlatNode& open = nodes[slots[best]];
+				slots[best]          = open.leftFirst;
+				slots[slotCount++]   = open.rightFirst;
+			}
+		}
+
+		// 子を再帰で作る(再帰中にoutNodes4が再確保されるので値で組み立てる)
+		BVH4Node node   = {};
+		node.childCount = static_cast<uint8_t>(slotCount);
+		for (int i = 0; i < 4; ++i) {
+			if (i >= slotCount) {
+				node.minX[i] = node.minY[i] = node.minZ[i] = 0.0f;
+				node.maxX[i] = node.maxY[i] = node.maxZ[i] = 0.0f;
+				continue;
+			}
+
+			const FlatNode& child = nodes[slots[i]];
+			node.minX[i]          = child.bounds.min.x;
+			node.minY[i]          = child.bounds.min.y;
+			node.minZ[i]          = child.bounds.min.z;
+			node.maxX[i]          = child.bounds.max.x;
+			node.maxY[i]          = child.bounds.max.y;
+			node.maxZ[i]          = child.bounds.max.z;
+
+			if (child.primCount != 0) {
+				node.child[i]     = child.leftFirst;
+				node.primCount[i] = child.primCount;
+			} else {
+				node.child[i]     = CollapseRecurse(nodes, slots[i], outNodes4);
+				node.primCount[i] = 0;
+			}
+		}
+
+		outNodes4[outIndex] = node;
+		return outIndex;
+	}
+
+	void BVHBuilder::Refit(
+		std::vector<FlatNode>&                   nodes,
+		std::vector<BVH4Node>&                   nodes4,
+		const std::span<const Unnamed::Triangle> triangles,
+		const std::vector<uint32_t>&             triIndices
+	) {
+		const auto leafBounds = [&](const uint32_t first, const uint32_t count) {
+			Unnamed::AABB bounds;
+			for (uint32_t i = 0; i < count; ++i) {
+				const Unnamed::Triangle& t = triangles[triIndices[first + i]];
+				bounds.Expand(t.v0);
+				bounds.Expand(t.v1);
+				bounds.Expand(t.v2);
+			}
+			return bounds;
+		};
+
+		// 子は親より後ろにあるので、後ろから処理すれば子が先に確定する
+		for (size_t i = nodes.size(); i-- > 0;) {
+			FlatNode& node = nodes[i];
+			if (node.primCount != 0) {
+				node.bounds = leafBounds(node.leftFirst, node.primCount);
+			} else if (nodes.size() > 1) {
+				node.bounds = nodes[node.leftFirst].bounds;
+				node.bounds.Expand(nodes[node.rightFirst].bounds);
+			}
+		}
+
+		for (size_t i = nodes4.size(); i-- > 0;) {
+			BVH4Node& node = nodes4[i];
+			for (int c = 0; c < node.childCount; ++c) {
+				Unnamed::AABB bounds;
+				if (node.primCount[c] != 0) {
+					bounds = leafBounds(node.child[c], node.primCount[c]);
+				} else {
+					const BVH4Node& child = nodes4[node.child[c]];
+					for (int k = 0; k < child.childCount; ++k) {
+						bounds.Expand(Vec3(child.minX[k], child.minY[k], child.minZ[k]));
+						bounds.Expand(Vec3(child.maxX[k], child.maxY[k], child.maxZ[k]));
+					}
+				}
+				node.minX[c] = bounds.min.x;
+				node.minY[c] = bounds.min.y;
+				node.minZ[c] = bounds.min.z;
+				node.maxX[c] = bounds.max.x;
+				node.maxY[c] = bounds.max.y;
+				node.maxZ[c] = bounds.max.z;
+			}
+		}
+	}
 }
@@ -1,6 +1,8 @@
 ﻿#pragma once
+#include <span>
 #include <vector>
 
+#include <engine/uphysics/BVH4.h>
 #include <engine/uphysics/PhysicsTypes.h>
 
 namespace UPhysics {
@@ -12,8 +14,23 @@ namespace UPhysics {
 		uint16_t primCount;
 	};
 
+	// 構築統計(品質と速度の回帰確認用)
+	struct BVHBuildStats {
+		double   buildMs       = 0.0;
+		uint32_t triangleCount = 0;
+		uint32_t nodeCount     = 0;
+		uint32_t leafCount     = 0;
+		uint32_t maxDepth      = 0;
+		float    sahCost       = 0.0f; // ルートの表面積で正規化したSAHコスト
+	};
+
 	class BVHBuilder {
 	public:
+		/// @brief 並列構築を使うか
+		/// @details 大きな部分木は左右を別スレッドで構築し、上位レベルでは
+		///          重心のビニングも並列に行います。出力は直列構築と同じです
+		void SetParallel(bool parallel);
+
 		void Build(
 			const std::vector<Unnamed::Triangle>& triangles,
 			std::vector<FlatNode>&       outNodes,
@@ -21,13 +38,62 @@ namespace UPhysics {
 			uint32_t                     leafSize = 4
 		);
 
+		[[nodiscard]] const BVHBuildStats& GetStats() const;
+
+		// ノード列からSAHコストや深さを集計する
+		static BVHBuildStats ComputeStats(const std::vector<FlatNode>& nodes);
+
+		// 2分岐のノード列を4分岐に畳み込む(三角形の並びは共有)
+		static void CollapseBVH4(
+			const std::vector<FlatNode>& nodes,
+			std::vector<BVH4Node>&       outNodes4
+		);
+
+		/// @brief 木の形はそのままで、三角形の移動に合わせてAABBだけを更新します
+		/// @details 変形するメッシュ向け。親は子より前に並んでいるので後ろから1回なめるだけです。
+		///          三角形が大きく動くと木の質は落ちるので、その場合は作り直してください
+		/// @param triangles triIndices が指す三角形(先頭が triIndices の0番)
+		static void Refit(
+			std::vector<FlatNode>&                nodes,
+			std::vector<BVH4Node>&                nodes4,
+			std::span<const Unnamed::Triangle>    triangles,
+			const std::vector<uint32_t>&          triIndices
+		);
+
 	private:
-		uint32_t Recurse(uint32_t start, uint32_t end, int depth);
-		void SAHSplit(uint32_t start, uint32_t end, int axis, uint32_t& outMid);
+		static uint32_t CollapseRecurse(
+			const std::vector<FlatNode>& nodes,
+			uint32_t                     nodeIndex,
+			std::vector<BVH4Node>&       outNodes4
+		);
+
+		// 部分木を nodes に構築し、ルートのインデックスを返す
+		uint32_t Recurse(
+			uint32_t               start,
+			uint32_t               end,
+			std::vector<FlatNode>& nodes
+		);
+
+		// ノードのAABBと重心のAABBを求める
+		void ComputeBounds(
+			uint32_t       start,
+			uint32_t       end,
+			Unnamed::AABB& outBounds,
+			Unnamed::AABB& outCenterBounds
+		) const;
+
+		void SAHSplit(
+			uint32_t             start,
+			uint32_t             end,
+			int                  axis,
+			const Unnamed::AABB& centerBounds,
+			uint32_t&            outMid
+		);
 
 		std::vector<TriInfo>  mTriInfos;
 		std::vector<uint32_t> mTriIndices;
-		std::vector<FlatNode> mNodes;
 		uint32_t              mLeafSize = 4;
+		bool                  mParallel = true;
+		BVHBuildStats         mStats;
 	};
 }
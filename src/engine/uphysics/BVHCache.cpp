@@ -0,0 +1,276 @@
+﻿#include <engine/uphysics/BVHCache.h>
+
+#include <format>
+#include <fstream>
+#include <thread>
+#include <type_traits>
+
+#include <core/memory/MemUtil.h>
+
+#include <engine/subsystem/console/Log.h>
+
+namespace UPhysics {
+	namespace {
+		constexpr uint32_t kMagic   = 0x48564255; // "UBVH"
+		constexpr uint32_t kVersion = 1;
+		// BVH4Node の要求アライメント。各セクションの先頭をこれに揃える
+		constexpr uint64_t kSectionAlignment = 16;
+
+		static_assert(std::is_trivially_copyable_v<FlatNode>);
+		static_assert(std::is_trivially_copyable_v<BVH4Node>);
+		static_assert(std::is_trivially_copyable_v<Unnamed::Triangle>);
+		static_assert(alignof(BVH4Node) <= kSectionAlignment);
+
+		struct Header {
+			uint32_t magic;
+			uint32_t version;
+			uint64_t keyHash;
+			int64_t  sourceWriteTime; // ナノ秒
+			uint64_t sourceSize;
+
+			// 構造体のサイズが変わったら作り直す
+			uint32_t nodeSize;
+			uint32_t node4Size;
+			uint32_t triangleSize;
+
+			uint32_t nodeCount;
+			uint32_t node4Count;
+			uint32_t triIndexCount;
+			uint32_t triangleCount;
+			uint32_t reserved;
+
+			uint64_t nodeOffset;
+			uint64_t node4Offset;
+			uint64_t triIndexOffset;
+			uint64_t triangleOffset;
+			uint64_t fileSize;
+		};
+
+		int64_t ToNanoseconds(const Unnamed::FileStamp& stamp) {
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				stamp.lastWrite.time_since_epoch()
+			).count();
+		}
+
+		// マップした領域の [offset, offset + count) を型付きで参照する
+		template <class T>
+		bool View(
+			const MappedFile& file,
+			const uint64_t    offset,
+			const uint32_t    count,
+			std::span<const T>& out
+		) {
+			const uint64_t bytes = static_cast<uint64_t>(count) * sizeof(T);
+			if (offset % alignof(T) != 0 || offset > file.Size() ||
+				bytes > file.Size() - offset) {
+				return false;
+			}
+			out = {reinterpret_cast<const T*>(file.Data() + offset), count};
+			return true;
+		}
+
+		// 葉が指す [first, first + count) が triIndices に収まっているか
+		bool LeafInRange(const uint64_t first, const uint64_t count, const size_t triIndexCount) {
+			return first <= triIndexCount && count <= triIndexCount - first;
+		}
+
+		// 走査で範囲外を読まないよう、全ての番号を確認する
+		// ビルダーは子を親より後ろに置くので、子の番号が親より大きいことも求める(循環を弾く)
+		bool Validate(const MappedBVH& bvh) {
+			const size_t nodeCount  = bvh.nodes.size();
+			const size_t node4Count = bvh.nodes4.size();
+			const size_t indexCount = bvh.triIndices.size();
+
+			for (size_t i = 0; i < nodeCount; ++i) {
+				const FlatNode& node = bvh.nodes[i];
+				if (node.primCount == 0) {
+					if (node.leftFirst <= i || node.leftFirst >= nodeCount ||
+						node.rightFirst <= i || node.rightFirst >= nodeCount) {
+						return false;
+					}
+				} else if (!LeafInRange(node.leftFirst, node.primCount, indexCount)) {
+					return false;
+				}
+			}
+
+			for (size_t i = 0; i < node4Count; ++i) {
+				const BVH4Node& node = bvh.nodes4[i];
+				if (node.childCount > 4) {
+					return false;
+				}
+				for (int c = 0; c < node.childCount; ++c) {
+					if (node.primCount[c] == 0) {
+						if (node.child[c] <= i || node.child[c] >= node4Count) {
+							return false;
+						}
+					} else if (!LeafInRange(node.child[c], node.primCount[c], indexCount)) {
+						return false;
+					}
+				}
+			}
+
+			for (const uint32_t index : bvh.triIndices) {
+				if (index >= bvh.triangles.size()) {
+					return false;
+				}
+			}
+			return true;
+		}
+	}
+
+	BVHCache::BVHCache(std::filesystem::path directory)
+		: mDirectory(std::move(directory)) {
+	}
+
+	std::shared_ptr<const MappedBVH> BVHCache::Load(
+		const std::string&        key,
+		const Unnamed::FileStamp& stamp
+	) const {
+		auto mapped = std::make_shared<MappedBVH>();
+		if (!mapped->file.Open(PathFor(key))) {
+			return nullptr;
+		}
+
+		const MappedFile& file = mapped->file;
+		if (file.Size() < sizeof(Header)) {
+			return nullptr;
+		}
+
+		const auto& header = *reinterpret_cast<const Header*>(file.Data());
+		if (
+			header.magic != kMagic ||
+			header.version != kVersion ||
+			header.keyHash != std::hash<std::string>{}(key) ||
+			header.sourceWriteTime != ToNanoseconds(stamp) ||
+			header.sourceSize != stamp.sizeInBytes ||
+			header.nodeSize != sizeof(FlatNode) ||
+			header.node4Size != sizeof(BVH4Node) ||
+			header.triangleSize != sizeof(Unnamed::Triangle) ||
+			header.fileSize != file.Size()
+		) {
+			return nullptr;
+		}
+
+		if (
+			!View(file, header.nodeOffset, header.nodeCount, mapped->nodes) ||
+			!View(file, header.node4Offset, header.node4Count, mapped->nodes4) ||
+			!View(
+				file, header.triIndexOffset, header.triIndexCount,
+				mapped->triIndices
+			) ||
+			!View(
+				file, header.triangleOffset, header.triangleCount,
+				mapped->triangles
+			) ||
+			mapped->nodes.empty() ||
+			!Validate(*mapped)
+		) {
+			Warning("UPhysics", "BVH cache '{}' is corrupted.", key);
+			return nullptr;
+		}
+
+		return mapped;
+	}
+
+	bool BVHCache::Save(
+		const std::string&                       key,
+		const Unnamed::FileStamp&                stamp,
+		const std::span<const FlatNode>          nodes,
+		const std::span<const BVH4Node>          nodes4,
+		const std::span<const uint32_t>          triIndices,
+		const std::span<const Unnamed::Triangle> triangles
+	) const {
+		Header header          = {};
+		header.magic           = kMagic;
+		header.version         = kVersion;
+		header.keyHash         = std::hash<std::string>{}(key);
+		header.sourceWriteTime = ToNanoseconds(stamp);
+		header.sourceSize      = stamp.sizeInBytes;
+		header.nodeSize        = sizeof(FlatNode);
+		header.node4Size       = sizeof(BVH4Node);
+		header.triangleSize    = sizeof(Unnamed::Triangle);
+		header.nodeCount       = static_cast<uint32_t>(nodes.size());
+		header.node4Count      = static_cast<uint32_t>(nodes4.size());
+		header.triIndexCount   = static_cast<uint32_t>(triIndices.size());
+		header.triangleCount   = static_cast<uint32_t>(triangles.size());
+
+		// ヘッダーの後ろに各セクションをアライメントを揃えて並べる
+		uint64_t   offset  = sizeof(Header);
+		const auto section = [&](const size_t bytes) {
+			offset              = MemUtil::AlignUp(offset, kSectionAlignment);
+			const uint64_t head = offset;
+			offset += bytes;
+			return head;
+		};
+		header.nodeOffset     = section(nodes.size_bytes());
+		header.node4Offset    = section(nodes4.size_bytes());
+		header.triIndexOffset = section(triIndices.size_bytes());
+		header.triangleOffset = section(triangles.size_bytes());
+		header.fileSize       = offset;
+
+		std::error_code ec;
+		std::filesystem::create_directories(mDirectory, ec);
+
+		const std::filesystem::path path = PathFor(key);
+		std::filesystem::path       temp = path;
+		temp += std::format( // 並列に書いてもぶつからないようにスレッドごとに分ける
+			".{:x}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id())
+		);
+		{
+			std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+			if (!out) {
+				Warning(
+					"UPhysics", "Failed to write BVH cache '{}'.",
+					temp.string()
+				);
+				return false;
+			}
+
+			const auto write = [&](const uint64_t at, const void* data,
+			                       const size_t   bytes) {
+				// パディングをゼロで埋める
+				static constexpr char kZero[kSectionAlignment] = {};
+				const uint64_t        pos = static_cast<uint64_t>(out.tellp());
+				out.write(kZero, static_cast<std::streamsize>(at - pos));
+				out.write(
+					static_cast<const char*>(data),
+					static_cast<std::streamsize>(bytes)
+				);
+			};
+			write(0, &header, sizeof(header));
+			write(header.nodeOffset, nodes.data(), nodes.size_bytes());
+			write(header.node4Offset, nodes4.data(), nodes4.size_bytes());
+			write(
+				header.triIndexOffset, triIndices.data(),
+				triIndices.size_bytes()
+			);
+			write(
+				header.triangleOffset, triangles.data(),
+				triangles.size_bytes()
+			);
+			if (!out) {
+				return false;
+			}
+		}
+
+		std::filesystem::rename(temp, path, ec);
+		if (ec) {
+			std::filesystem::remove(temp, ec);
+			return false;
+		}
+		return true;
+	}
+
+	std::filesystem::path BVHCache::PathFor(const std::string& key) const {
+		return mDirectory / std::format(
+			"{:016x}.ubvh", std::hash<std::string>{}(key)
+		);
+	}
+
+	bool BVHCache::StampOf(
+		const std::filesystem::path& source,
+		Unnamed::FileStamp&          outStamp
+	) {
+		return Unnamed::ReadFileStamp(source, outStamp);
+	}
+}
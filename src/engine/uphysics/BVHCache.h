@@ -0,0 +1,64 @@
+﻿#pragma once
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+
+#include <core/io/MappedFile.h>
+
+#include <engine/uphysics/BVHBuilder.h>
+
+#include <runtime/assets/core/UAsset.h>
+
+namespace UPhysics {
+	// キャッシュファイルをマップしたままのBLAS
+	// 各配列はマップした領域を直接指すので、読み込み時にパースもコピーもしません
+	struct MappedBVH {
+		std::span<const FlatNode>          nodes;
+		std::span<const BVH4Node>          nodes4;
+		std::span<const uint32_t>          triIndices;
+		std::span<const Unnamed::Triangle> triangles; // ローカル空間
+
+		MappedFile file;
+	};
+
+	//-------------------------------------------------------------------------
+	// Purpose: コリジョン用BVHのディスクキャッシュ
+	// メッシュアセットのパス(+サブメッシュ番号)をキーに、ソースの FileStamp が
+	// 一致する間はビルド済みのノードと三角形をそのまま再利用します
+	//-------------------------------------------------------------------------
+	class BVHCache {
+	public:
+		explicit BVHCache(std::filesystem::path directory = "./cache/physics");
+
+		/// @brief キャッシュを探してマップします
+		/// @return 無い、スタンプが古い、形式が違うなどで使えなければnullptr
+		[[nodiscard]] std::shared_ptr<const MappedBVH> Load(
+			const std::string&        key,
+			const Unnamed::FileStamp& stamp
+		) const;
+
+		/// @brief ビルドしたBLASを書き出します
+		/// @details 一時ファイルに書いてから置き換えるので、書き込み中に落ちても壊れたキャッシュは残りません
+		bool Save(
+			const std::string&                 key,
+			const Unnamed::FileStamp&          stamp,
+			std::span<const FlatNode>          nodes,
+			std::span<const BVH4Node>          nodes4,
+			std::span<const uint32_t>          triIndices,
+			std::span<const Unnamed::Triangle> triangles
+		) const;
+
+		[[nodiscard]] std::filesystem::path PathFor(const std::string& key) const;
+
+		/// @brief ソースファイルのスタンプを取得します
+		/// @return ファイルが無ければfalse
+		static bool StampOf(
+			const std::filesystem::path& source,
+			Unnamed::FileStamp&          outStamp
+		);
+
+	private:
+		std::filesystem::path mDirectory;
+	};
+}
@@ -11,6 +11,10 @@ namespace UPhysics {
 		};
 	}
 
+	Vec3 BoxCast::NodeExpansion() const {
+		return half;
+	}
+
 	bool BoxCast::TestTriangle(
 		const Unnamed::Triangle& triangle,
 		const Vec3&     dir,
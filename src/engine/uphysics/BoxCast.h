@@ -4,6 +4,7 @@
 namespace UPhysics {
 	struct BoxCast final : ShapeCast {
 		[[nodiscard]] Unnamed::AABB ExpandNode(const Unnamed::AABB& nodeBounds) const override;
+		[[nodiscard]] Vec3          NodeExpansion() const override;
 
 		bool TestTriangle(
 			const Unnamed::Triangle& triangle,
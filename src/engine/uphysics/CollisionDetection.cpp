@@ -17,9 +17,9 @@ namespace UPhysics {
 				if (ray.origin[i] < aabb.min[i] || ray.origin[i] > aabb.max[i])
 					return false;
 			} else {
-				const float invD = 1.0f / ray.dir[i];
-				float       t1   = (aabb.min[i] - ray.origin[i]) * invD;
-				float       t2   = (aabb.max[i] - ray.origin[i]) * invD;
+				// 除算を避けるため前計算済みの invDir を使う
+				float t1 = (aabb.min[i] - ray.origin[i]) * ray.invDir[i];
+				float t2 = (aabb.max[i] - ray.origin[i]) * ray.invDir[i];
 				if (t1 > t2) std::swap(t1, t2);
 				tMin    = t1 > tMin ? t1 : tMin;
 				tMaxOut = t2 < tMaxOut ? t2 : tMaxOut;
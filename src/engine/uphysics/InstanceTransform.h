@@ -0,0 +1,69 @@
+#pragma once
+#include <cmath>
+
+#include <engine/uphysics/PhysicsTypes.h>
+
+namespace UPhysics {
+	// コライダーのローカル空間→ワールド空間のアフィン変換
+	// BLASはローカル空間のまま持ち、クエリ側をローカル空間に変換して走査します
+	// 行列は行ベクトル(v * M)で、平行移動は m[3] に入っています
+	struct InstanceTransform {
+		Mat4 localToWorld = Mat4::identity;
+		Mat4 worldToLocal = Mat4::identity;
+		bool isIdentity   = true; // 単位行列なら変換を省く
+
+		void Set(const Mat4& matrix) {
+			localToWorld = matrix;
+			isIdentity   = matrix == Mat4::identity;
+			worldToLocal = isIdentity ? Mat4::identity : matrix.Inverse();
+		}
+
+		[[nodiscard]] static Vec3 TransformPoint(
+			const Vec3& p, const Mat4& m
+		) {
+			return {
+				p.x * m.m[0][0] + p.y * m.m[1][0] + p.z * m.m[2][0] + m.m[3][0],
+				p.x * m.m[0][1] + p.y * m.m[1][1] + p.z * m.m[2][1] + m.m[3][1],
+				p.x * m.m[0][2] + p.y * m.m[1][2] + p.z * m.m[2][2] + m.m[3][2]
+			};
+		}
+
+		[[nodiscard]] static Vec3 TransformDir(const Vec3& d, const Mat4& m) {
+			return {
+				d.x * m.m[0][0] + d.y * m.m[1][0] + d.z * m.m[2][0],
+				d.x * m.m[0][1] + d.y * m.m[1][1] + d.z * m.m[2][1],
+				d.x * m.m[0][2] + d.y * m.m[1][2] + d.z * m.m[2][2]
+			};
+		}
+
+		// 各軸の広がり(半径)を変換先の軸に沿った広がりにする(回転しても収まる大きさ)
+		[[nodiscard]] static Vec3 TransformExtent(const Vec3& e, const Mat4& m) {
+			return {
+				e.x * std::abs(m.m[0][0]) + e.y * std::abs(m.m[1][0]) +
+				e.z * std::abs(m.m[2][0]),
+				e.x * std::abs(m.m[0][1]) + e.y * std::abs(m.m[1][1]) +
+				e.z * std::abs(m.m[2][1]),
+				e.x * std::abs(m.m[0][2]) + e.y * std::abs(m.m[1][2]) +
+				e.z * std::abs(m.m[2][2])
+			};
+		}
+
+		[[nodiscard]] static Unnamed::AABB TransformAABB(
+			const Unnamed::AABB& aabb, const Mat4& m
+		) {
+			const Vec3 center = TransformPoint(aabb.Center(), m);
+			const Vec3 extent = TransformExtent((aabb.max - aabb.min) * 0.5f, m);
+			return {center - extent, center + extent};
+		}
+
+		[[nodiscard]] Unnamed::Triangle ToWorld(
+			const Unnamed::Triangle& tri
+		) const {
+			return {
+				TransformPoint(tri.v0, localToWorld),
+				TransformPoint(tri.v1, localToWorld),
+				TransformPoint(tri.v2, localToWorld)
+			};
+		}
+	};
+}
@@ -0,0 +1,1016 @@
+﻿#include <engine/uphysics/PhysicsBenchmark.h>
+
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#include <core/jobsystem/JobSystem.h>
+
+#include <engine/Entity/Entity.h>
+#include <engine/subsystem/console/Log.h>
+
+#include <engine/uphysics/BVH4.h>
+#include <engine/uphysics/BVHBuilder.h>
+#include <engine/uphysics/CollisionDetection.h>
+
+#include <runtime/physics/core/UPhysics.h>
+
+namespace UPhysics::Benchmark {
+	namespace {
+		constexpr std::string_view kChannel = "UPhysics";
+
+		constexpr float    kWorldExtent     = 20000.0f; // 配置範囲(半径)
+		constexpr float    kPropExtent      = 256.0f;   // 1エンティティの大きさ
+		constexpr int      kTrisPerEntity   = 64;
+		constexpr int      kQueryCount      = 20000;
+		constexpr uint32_t kSeed            = 0x5EED1234u;
+		constexpr int      kCorruptCount    = 200; // 壊したキャッシュを読む回数
+		constexpr int      kCorruptTerrain  = 16; // 壊すキャッシュの地形の大きさ
+		constexpr int      kCorruptGrid     = 16; // 壊したキャッシュに撃つレイの本数(一辺)
+
+		struct Query {
+			Vec3 start;
+			Vec3 dir;
+			float length;
+		};
+
+		// 1エンティティ分の三角形スープを作る
+		std::vector<Unnamed::Triangle> MakeSoup(
+			std::mt19937& rng,
+			const Vec3&   center
+		) {
+			std::uniform_real_distribution offset(-kPropExtent, kPropExtent);
+			std::vector<Unnamed::Triangle> tris;
+			tris.reserve(kTrisPerEntity);
+			for (int i = 0; i < kTrisPerEntity; ++i) {
+				const Vec3 base = center + Vec3(
+					offset(rng), offset(rng), offset(rng)
+				);
+				tris.emplace_back(
+					base,
+					base + Vec3(offset(rng), offset(rng), offset(rng)) * 0.25f,
+					base + Vec3(offset(rng), offset(rng), offset(rng)) * 0.25f
+				);
+			}
+			return tris;
+		}
+
+		void BuildScene(Engine& engine, const int entityCount) {
+			std::mt19937                   rng(kSeed);
+			std::uniform_real_distribution pos(-kWorldExtent, kWorldExtent);
+			for (int i = 0; i < entityCount; ++i) {
+				engine.RegisterTriangles(
+					MakeSoup(rng, Vec3(pos(rng), pos(rng) * 0.1f, pos(rng))),
+					nullptr
+				);
+			}
+		}
+
+		std::vector<Query> MakeQueries() {
+			std::mt19937                   rng(kSeed ^ 0xA5A5A5A5u);
+			std::uniform_real_distribution pos(-kWorldExtent, kWorldExtent);
+			std::uniform_real_distribution unit(-1.0f, 1.0f);
+			std::uniform_real_distribution len(256.0f, 4096.0f);
+
+			std::vector<Query> queries(kQueryCount);
+			for (auto& q : queries) {
+				q.start = Vec3(pos(rng), pos(rng) * 0.1f, pos(rng));
+				q.dir   = Vec3(unit(rng), unit(rng) * 0.25f, unit(rng));
+				if (q.dir.SqrLength() < 1e-6f) {
+					q.dir = Vec3::forward;
+				}
+				q.dir.Normalize();
+				q.length = len(rng);
+			}
+			return queries;
+		}
+
+		// レイ/ボックス/スフィアキャストの結果が2つのエンジンで食い違った数
+		// スフィアのナローフェーズ(SAT)は開始位置で軸を選ぶ近似なので、誤検出した三角形が
+		// 刈り込まれるかどうかが木の形で変わる。木の形が違う同士では compareSphere を false にする
+		int CountMismatches(
+			const Engine&             reference,
+			const Engine&             engine,
+			const std::vector<Query>& queries,
+			const float               tolerance,
+			const bool                compareSphere = true
+		) {
+			int mismatches = 0;
+			for (const auto& q : queries) {
+				const Unnamed::Ray ray = {
+					.origin = q.start,
+					.dir = q.dir,
+					.invDir = Vec3::one / q.dir,
+					.tMin = 0.0f,
+					.tMax = q.length
+				};
+				const Unnamed::Box box = {
+					.center = q.start,
+					.halfSize = Vec3(16.0f, 36.0f, 16.0f)
+				};
+
+				Hit        expected[3];
+				Hit        actual[3];
+				const bool expectedHit[3] = {
+					reference.RayCast(ray, &expected[0]),
+					reference.BoxCast(box, q.dir, q.length, &expected[1]),
+					reference.SphereCast(
+						q.start, 16.0f, q.dir, q.length, &expected[2]
+					),
+				};
+				const bool actualHit[3] = {
+					engine.RayCast(ray, &actual[0]),
+					engine.BoxCast(box, q.dir, q.length, &actual[1]),
+					engine.SphereCast(
+						q.start, 16.0f, q.dir, q.length, &actual[2]
+					),
+				};
+
+				const int kindCount = compareSphere ? 3 : 2;
+				for (int k = 0; k < kindCount; ++k) {
+					if (expectedHit[k] != actualHit[k] ||
+						(expectedHit[k] &&
+							std::abs(expected[k].t - actual[k].t) > tolerance)) {
+						++mismatches;
+					}
+				}
+			}
+			return mismatches;
+		}
+
+		// 起伏のある地形メッシュ(大きなメッシュの代表として)
+		// gridSize x gridSize x 2 個の三角形を作る
+		std::vector<Unnamed::Triangle> MakeTerrain(const int gridSize) {
+			std::mt19937                   rng(kSeed);
+			std::uniform_real_distribution height(-64.0f, 64.0f);
+			std::vector<Unnamed::Triangle> tris;
+			tris.reserve(static_cast<size_t>(gridSize) * gridSize * 2);
+			const auto vertex = [&](const int x, const int z) {
+				const float fx = static_cast<float>(x);
+				const float fz = static_cast<float>(z);
+				return Vec3(
+					fx * 32.0f,
+					std::sin(fx * 0.05f) * std::cos(fz * 0.05f) * 512.0f,
+					fz * 32.0f
+				);
+			};
+			for (int z = 0; z < gridSize; ++z) {
+				for (int x = 0; x < gridSize; ++x) {
+					const Vec3 jitter(0.0f, height(rng), 0.0f);
+					const Vec3 v00 = vertex(x, z) + jitter;
+					const Vec3 v10 = vertex(x + 1, z);
+					const Vec3 v01 = vertex(x, z + 1);
+					const Vec3 v11 = vertex(x + 1, z + 1);
+					tris.emplace_back(v00, v10, v11);
+					tris.emplace_back(v00, v11, v01);
+				}
+			}
+			return tris;
+		}
+
+		double QueriesPerSec(
+			const size_t                              count,
+			const std::chrono::steady_clock::duration elapsed
+		) {
+			const double sec = std::chrono::duration<double>(elapsed).count();
+			return sec > 0.0 ? static_cast<double>(count) / sec : 0.0;
+		}
+
+		// クエリ/秒 と ヒット数を返す
+		template <class Fn>
+		std::pair<double, int> Measure(const std::vector<Query>& queries,
+		                               Fn&&                      fn) {
+			int        hits  = 0;
+			const auto begin = std::chrono::steady_clock::now();
+			for (const auto& q : queries) {
+				Hit hit;
+				hits += fn(q, hit) ? 1 : 0;
+			}
+			const auto end = std::chrono::steady_clock::now();
+
+			return {QueriesPerSec(queries.size(), end - begin), hits};
+		}
+	}
+
+	void RunBroadphase() {
+		const std::vector<Query> queries = MakeQueries();
+
+		for (const int entityCount : {10, 100, 1000}) {
+			Engine engine;
+			engine.Init();
+			BuildScene(engine, entityCount);
+
+			const auto ray = [&](const Query& q, Hit& hit) {
+				const Unnamed::Ray r = {
+					.origin = q.start,
+					.dir = q.dir,
+					.invDir = Vec3::one / q.dir,
+					.tMin = 0.0f,
+					.tMax = q.length
+				};
+				return engine.RayCast(r, &hit);
+			};
+			const auto box = [&](const Query& q, Hit& hit) {
+				const Unnamed::Box b = {
+					.center = q.start,
+					.halfSize = Vec3(16.0f, 36.0f, 16.0f)
+				};
+				return engine.BoxCast(b, q.dir, q.length, &hit);
+			};
+			const auto sphere = [&](const Query& q, Hit& hit) {
+				return engine.SphereCast(q.start, 16.0f, q.dir, q.length, &hit);
+			};
+
+			for (const bool useTLAS : {false, true}) {
+				engine.SetUseTLAS(useTLAS);
+				const auto [rayQps, rayHits]       = Measure(queries, ray);
+				const auto [boxQps, boxHits]       = Measure(queries, box);
+				const auto [sphereQps, sphereHits] = Measure(queries, sphere);
+
+				Msg(
+					kChannel,
+					"[{:>4} entities][{}] ray {:.0f} q/s ({} hits), "
+					"box {:.0f} q/s ({} hits), sphere {:.0f} q/s ({} hits)",
+					entityCount,
+					useTLAS ? "TLAS  " : "Linear",
+					rayQps, rayHits,
+					boxQps, boxHits,
+					sphereQps, sphereHits
+				);
+			}
+		}
+	}
+
+	void RunBatchQueries() {
+		constexpr int kEntityCount = 1000;
+
+		Engine engine;
+		engine.Init();
+		BuildScene(engine, kEntityCount);
+
+		const std::vector<Query> queries = MakeQueries();
+
+		std::vector<Unnamed::Ray> rays;
+		std::vector<SweepQuery>   sweeps;
+		rays.reserve(queries.size());
+		sweeps.reserve(queries.size());
+		for (size_t i = 0; i < queries.size(); ++i) {
+			const Query& q = queries[i];
+			rays.emplace_back(Unnamed::Ray{
+				.origin = q.start,
+				.dir = q.dir,
+				.invDir = Vec3::one / q.dir,
+				.tMin = 0.0f,
+				.tMax = q.length
+			});
+
+			// レイ/ボックス/スフィアを混ぜる
+			SweepQuery sweep = {
+				.shape = static_cast<SweepQuery::SHAPE>(i % 3),
+				.start = q.start,
+				.dir = q.dir,
+				.length = q.length,
+				.halfSize = Vec3(16.0f, 36.0f, 16.0f),
+				.radius = 16.0f
+			};
+			sweeps.emplace_back(sweep);
+		}
+
+		std::vector<Hit> hits(queries.size());
+
+		// 単発
+		auto begin      = std::chrono::steady_clock::now();
+		int  singleHits = 0;
+		for (const auto& ray : rays) {
+			Hit hit;
+			singleHits += engine.RayCast(ray, &hit) ? 1 : 0;
+		}
+		const double singleRayQps = QueriesPerSec(
+			rays.size(), std::chrono::steady_clock::now() - begin
+		);
+
+		begin               = std::chrono::steady_clock::now();
+		int singleSweepHits = 0;
+		for (const auto& sweep : sweeps) {
+			Hit  hit;
+			bool hitAny = false;
+			switch (sweep.shape) {
+			case SweepQuery::SHAPE::RAY:
+				hitAny = engine.RayCast(
+					{
+						.origin = sweep.start,
+						.dir = sweep.dir,
+						.invDir = Vec3::one / sweep.dir,
+						.tMin = 0.0f,
+						.tMax = sweep.length
+					},
+					&hit
+				);
+				break;
+			case SweepQuery::SHAPE::BOX:
+				hitAny = engine.BoxCast(
+					{.center = sweep.start, .halfSize = sweep.halfSize},
+					sweep.dir, sweep.length, &hit
+				);
+				break;
+			case SweepQuery::SHAPE::SPHERE:
+				hitAny = engine.SphereCast(
+					sweep.start, sweep.radius, sweep.dir, sweep.length, &hit
+				);
+				break;
+			}
+			singleSweepHits += hitAny ? 1 : 0;
+		}
+		const double singleSweepQps = QueriesPerSec(
+			sweeps.size(), std::chrono::steady_clock::now() - begin
+		);
+
+		// バッチ
+		begin                    = std::chrono::steady_clock::now();
+		const int    batchHits   = engine.RayCastBatch(rays, hits);
+		const double batchRayQps = QueriesPerSec(
+			rays.size(), std::chrono::steady_clock::now() - begin
+		);
+
+		begin                      = std::chrono::steady_clock::now();
+		const int    batchSweepHits = engine.SweepBatch(sweeps, hits);
+		const double batchSweepQps  = QueriesPerSec(
+			sweeps.size(), std::chrono::steady_clock::now() - begin
+		);
+
+		Msg(
+			kChannel,
+			"[{} entities, {} lanes] ray single {:.0f} q/s ({} hits) / "
+			"batch {:.0f} q/s ({} hits)",
+			kEntityCount, JobSystem::Get().MaxLanes(),
+			singleRayQps, singleHits,
+			batchRayQps, batchHits
+		);
+		Msg(
+			kChannel,
+			"[{} entities, {} lanes] sweep single {:.0f} q/s ({} hits) / "
+			"batch {:.0f} q/s ({} hits)",
+			kEntityCount, JobSystem::Get().MaxLanes(),
+			singleSweepQps, singleSweepHits,
+			batchSweepQps, batchSweepHits
+		);
+	}
+
+	void RunBVH4() {
+		constexpr int kNodeCount = 4096;
+		constexpr int kRayCount  = 256;
+
+		std::mt19937                   rng(kSeed);
+		std::uniform_real_distribution pos(-kWorldExtent, kWorldExtent);
+		std::uniform_real_distribution size(16.0f, kPropExtent * 4.0f);
+		std::uniform_real_distribution unit(-1.0f, 1.0f);
+
+		// 同じ箱を2分岐用(AABB)と4分岐用(SoA)の両方で持つ
+		std::vector<Unnamed::AABB> boxes(kNodeCount * 4);
+		std::vector<BVH4Node>      nodes4(kNodeCount);
+		for (int n = 0; n < kNodeCount; ++n) {
+			BVH4Node& node  = nodes4[n];
+			node.childCount = 4;
+			for (int c = 0; c < 4; ++c) {
+				const Vec3 center(pos(rng), pos(rng), pos(rng));
+				const Vec3 half(size(rng), size(rng), size(rng));
+
+				Unnamed::AABB& box = boxes[n * 4 + c];
+				box.min            = center - half;
+				box.max            = center + half;
+
+				node.minX[c] = box.min.x;
+				node.minY[c] = box.min.y;
+				node.minZ[c] = box.min.z;
+				node.maxX[c] = box.max.x;
+				node.maxY[c] = box.max.y;
+				node.maxZ[c] = box.max.z;
+			}
+		}
+
+		std::vector<Unnamed::Ray> rays(kRayCount);
+		for (auto& ray : rays) {
+			ray.origin = Vec3(pos(rng), pos(rng), pos(rng));
+			ray.dir    = Vec3(unit(rng), unit(rng), unit(rng));
+			if (ray.dir.SqrLength() < 1e-6f) {
+				ray.dir = Vec3::forward;
+			}
+			ray.dir.Normalize();
+			ray.invDir = Vec3::one / ray.dir;
+			ray.tMin   = 0.0f;
+			ray.tMax   = kWorldExtent * 4.0f;
+		}
+
+		const size_t boxTests = static_cast<size_t>(kNodeCount) * 4 * kRayCount;
+
+		// スカラー
+		auto begin      = std::chrono::steady_clock::now();
+		int  scalarHits = 0;
+		for (const auto& ray : rays) {
+			for (const auto& box : boxes) {
+				float t;
+				scalarHits += RayVsAABB(ray, box, t) ? 1 : 0;
+			}
+		}
+		const double scalarRate = QueriesPerSec(
+			boxTests, std::chrono::steady_clock::now() - begin
+		);
+
+		// SIMD
+		begin        = std::chrono::steady_clock::now();
+		int simdHits = 0;
+		for (const auto& ray : rays) {
+			const BVH4Ray ray4 = MakeBVH4Ray(ray.origin, ray.dir, Vec3::zero);
+			for (const auto& node : nodes4) {
+				alignas(16) float tNear[4];
+				simdHits += std::popcount(
+					RayVsBVH4Node(node, ray4, ray.tMin, ray.tMax, tNear)
+				);
+			}
+		}
+		const double simdRate = QueriesPerSec(
+			boxTests, std::chrono::steady_clock::now() - begin
+		);
+
+		Msg(
+			kChannel,
+			"node test: scalar {:.0f} box/s ({} hits) / "
+			"BVH4 SSE {:.0f} box/s ({} hits) x{:.2f}",
+			scalarRate, scalarHits,
+			simdRate, simdHits,
+			scalarRate > 0.0 ? simdRate / scalarRate : 0.0
+		);
+
+		// レイキャスト全体
+		Engine engine;
+		engine.Init();
+		BuildScene(engine, 1000);
+
+		const std::vector<Query> queries = MakeQueries();
+		const auto               ray     = [&](const Query& q, Hit& hit) {
+			const Unnamed::Ray r = {
+				.origin = q.start,
+				.dir = q.dir,
+				.invDir = Vec3::one / q.dir,
+				.tMin = 0.0f,
+				.tMax = q.length
+			};
+			return engine.RayCast(r, &hit);
+		};
+
+		for (const bool useBVH4 : {false, true}) {
+			engine.SetUseBVH4(useBVH4);
+			const auto [qps, hits] = Measure(queries, ray);
+			Msg(
+				kChannel,
+				"[1000 entities][{}] ray {:.0f} q/s ({} hits)",
+				useBVH4 ? "BVH4  " : "Binary",
+				qps, hits
+			);
+		}
+	}
+
+	bool RunRegistryStress() {
+		constexpr int kPersistentCount   = 200;
+		constexpr int kRoundCount        = 20;
+		constexpr int kTransientPerRound = 500;
+		constexpr int kFramesPerRound    = 8;
+		// 詰め直しが複数フレームにまたがるよう小さめにする
+		constexpr size_t kStepBudget = 2048;
+
+		// 永続コライダーは両方のエンジンに同じ三角形を登録する
+		std::mt19937                   rng(kSeed);
+		std::uniform_real_distribution pos(-kWorldExtent, kWorldExtent);
+		std::vector<std::vector<Unnamed::Triangle>> persistent;
+		persistent.reserve(kPersistentCount);
+		for (int i = 0; i < kPersistentCount; ++i) {
+			persistent.emplace_back(
+				MakeSoup(rng, Vec3(pos(rng), pos(rng) * 0.1f, pos(rng)))
+			);
+		}
+
+		Engine reference;
+		reference.Init();
+		for (const auto& soup : persistent) {
+			reference.RegisterTriangles(soup, nullptr);
+		}
+
+		Engine engine;
+		engine.Init();
+
+		std::mt19937                transientRng(kSeed ^ 0x0F0F0F0Fu);
+		std::vector<ColliderHandle> transients;
+		const auto                  addTransient = [&] {
+			transients.emplace_back(
+				engine.RegisterTriangles(
+					MakeSoup(
+						transientRng,
+						Vec3(
+							pos(transientRng),
+							pos(transientRng) * 0.1f,
+							pos(transientRng)
+						)
+					),
+					nullptr
+				)
+			);
+		};
+
+		// 最初のラウンドでは永続コライダーと一時コライダーを交互に登録してスロットを混ぜる
+		for (const auto& soup : persistent) {
+			addTransient();
+			engine.RegisterTriangles(soup, nullptr);
+		}
+
+		const std::vector<Query> queries = MakeQueries();
+		size_t                   persistentTris = 0;
+		for (const auto& soup : persistent) {
+			persistentTris += soup.size();
+		}
+
+		int mismatches = 0;
+		for (int round = 0; round < kRoundCount; ++round) {
+			engine.Update(0.0f);
+			for (int i = 0; i < kTransientPerRound; ++i) {
+				addTransient();
+			}
+
+			// 半分を即座に解除してからフレームを進める
+			std::ranges::shuffle(transients, transientRng);
+			for (size_t i = 0; i < transients.size() / 2; ++i) {
+				engine.Unregister(transients[i]);
+			}
+			for (int f = 0; f < kFramesPerRound; ++f) {
+				engine.StepCompaction(kStepBudget);
+			}
+
+			// 残りを解除し、TLASの再構築も詰め直しの完了も待たずに比較する
+			for (const ColliderHandle handle : transients) {
+				engine.Unregister(handle);
+				if (engine.IsValid(handle)) {
+					++mismatches;
+				}
+			}
+			transients.clear();
+			engine.StepCompaction(kStepBudget);
+
+			const size_t live =
+				engine.TriangleArenaSize() - engine.DeadTriangleCount();
+			if (live != persistentTris) {
+				Warning(
+					kChannel,
+					"round {}: live triangles {} != expected {}",
+					round, live, persistentTris
+				);
+				++mismatches;
+			}
+
+			mismatches += CountMismatches(reference, engine, queries, 0.0f);
+
+			DevMsg(
+				kChannel,
+				"round {}: arena {} tris, dead {} tris, mismatches {}",
+				round,
+				engine.TriangleArenaSize(),
+				engine.DeadTriangleCount(),
+				mismatches
+			);
+		}
+
+		// 登録・解除した直後のクエリ(Update を挟まない。TLASと線形走査で同じ結果になるはず)
+		for (const bool useTLAS : {true, false}) {
+			Engine fresh;
+			fresh.Init();
+			fresh.SetUseTLAS(useTLAS);
+			fresh.Update(0.0f);
+
+			const auto floorAt = [](const float y) {
+				return std::vector<Unnamed::Triangle>{
+					{Vec3(-64.0f, y, -64.0f), Vec3(-64.0f, y, 64.0f), Vec3(64.0f, y, 64.0f)},
+					{Vec3(-64.0f, y, -64.0f), Vec3(64.0f, y, 64.0f), Vec3(64.0f, y, -64.0f)},
+				};
+			};
+			const auto groundY = [&] {
+				Hit                hit;
+				const Unnamed::Ray down = {
+					.origin = Vec3(1.0f, 100.0f, 1.0f),
+					.dir = Vec3(0.0f, -1.0f, 0.0f),
+					.invDir = Vec3::one / Vec3(0.0f, -1.0f, 0.0f),
+					.tMin = 0.0f,
+					.tMax = 200.0f
+				};
+				return fresh.RayCast(down, &hit) ? hit.pos.y : FLT_MAX;
+			};
+
+			// 登録してすぐに撃つ
+			const ColliderHandle floor = fresh.RegisterTriangles(floorAt(0.0f), nullptr);
+			if (std::abs(groundY()) > 1e-3f) {
+				Warning(kChannel, "collider missing right after registration (TLAS {})", useTLAS);
+				++mismatches;
+			}
+
+			// 解除して同じスロットに別の高さで登録し直す
+			fresh.Unregister(floor);
+			fresh.RegisterTriangles(floorAt(10.0f), nullptr);
+			if (std::abs(groundY() - 10.0f) > 1e-3f) {
+				Warning(kChannel, "stale collider after slot reuse (TLAS {})", useTLAS);
+				++mismatches;
+			}
+		}
+
+		if (mismatches > 0) {
+			Warning(kChannel, "registry stress FAILED: {} mismatches", mismatches);
+			return false;
+		}
+		Msg(
+			kChannel,
+			"registry stress passed: {} colliders churned over {} rounds",
+			kPersistentCount + kRoundCount * kTransientPerRound,
+			kRoundCount
+		);
+		return true;
+	}
+
+	void RunBuild() {
+		// 500x500x2 = 50万三角形
+		const std::vector<Unnamed::Triangle> tris = MakeTerrain(500);
+
+		std::vector<FlatNode> nodes[2];
+		std::vector<uint32_t> triIndices[2];
+		for (int i = 0; i < 2; ++i) {
+			const bool parallel = i == 1;
+			BVHBuilder builder;
+			builder.SetParallel(parallel);
+			builder.Build(tris, nodes[i], triIndices[i]);
+
+			const BVHBuildStats& stats = builder.GetStats();
+			Msg(
+				kChannel,
+				"{:>8}: {} tris, {:.2f} ms, {} nodes, {} leaves, depth {}, SAH {:.2f}",
+				parallel ? "parallel" : "serial",
+				stats.triangleCount,
+				stats.buildMs,
+				stats.nodeCount,
+				stats.leafCount,
+				stats.maxDepth,
+				stats.sahCost
+			);
+		}
+
+		// 並列構築は直列と同じ木を作るはず
+		bool same = nodes[0].size() == nodes[1].size() &&
+			triIndices[0] == triIndices[1];
+		for (size_t i = 0; same && i < nodes[0].size(); ++i) {
+			const FlatNode& a = nodes[0][i];
+			const FlatNode& b = nodes[1][i];
+			same              = a.leftFirst == b.leftFirst &&
+				a.rightFirst == b.rightFirst &&
+				a.primCount == b.primCount &&
+				a.bounds.min == b.bounds.min &&
+				a.bounds.max == b.bounds.max;
+		}
+		if (!same) {
+			Warning(kChannel, "parallel build differs from serial build");
+		}
+		Msg(
+			kChannel,
+			"build workers: {}",
+			JobSystem::Get().MaxLanes()
+		);
+	}
+
+	bool RunMovingColliders() {
+		constexpr int kEntityCount = 500;
+		constexpr int kFrameCount  = 60;
+		// ローカル空間で変換してから判定するぶんの誤差を許す
+		constexpr float kTolerance = 1e-3f;
+
+		std::mt19937                   rng(kSeed);
+		std::uniform_real_distribution pos(-kWorldExtent, kWorldExtent);
+		std::uniform_real_distribution angle(-3.14159265f, 3.14159265f);
+		std::uniform_real_distribution scale(0.5f, 2.0f);
+
+		std::vector<std::vector<Unnamed::Triangle>> soups;
+		soups.reserve(kEntityCount);
+		for (int i = 0; i < kEntityCount; ++i) {
+			soups.emplace_back(MakeSoup(rng, Vec3::zero));
+		}
+
+		const auto randomTransform = [&] {
+			const float s = scale(rng);
+			return Mat4::Affine(
+				Vec3(s, s, s),
+				Vec3(angle(rng), angle(rng), angle(rng)),
+				Vec3(pos(rng), pos(rng) * 0.1f, pos(rng))
+			);
+		};
+		const auto bake = [](
+			const std::vector<Unnamed::Triangle>& soup, const Mat4& m
+		) {
+			InstanceTransform transform;
+			transform.Set(m);
+			std::vector<Unnamed::Triangle> world;
+			world.reserve(soup.size());
+			for (const auto& tri : soup) {
+				world.emplace_back(transform.ToWorld(tri));
+			}
+			return world;
+		};
+
+		// engine はローカル空間のBLAS + 行列、rebuilt は毎フレーム焼き込んで登録し直す
+		// (焼き込むと木の形が変わるので、スフィアは比較しない)
+		Engine engine;
+		Engine rebuilt;
+		engine.Init();
+		rebuilt.Init();
+
+		std::vector<Mat4>           transforms(kEntityCount);
+		std::vector<ColliderHandle> instanced(kEntityCount);
+		std::vector<ColliderHandle> baked(kEntityCount);
+		for (int i = 0; i < kEntityCount; ++i) {
+			transforms[i] = randomTransform();
+			instanced[i]  = engine.RegisterTriangles(
+				soups[i], nullptr, transforms[i]
+			);
+			baked[i] = rebuilt.RegisterTriangles(
+				bake(soups[i], transforms[i]), nullptr
+			);
+		}
+
+		const std::vector<Query> queries = MakeQueries();
+		int mismatches = CountMismatches(
+			rebuilt, engine, queries, kTolerance, false
+		);
+
+		// 全部を毎フレーム動かす
+		std::chrono::steady_clock::duration moveTime    = {};
+		std::chrono::steady_clock::duration rebuildTime = {};
+		for (int frame = 0; frame < kFrameCount; ++frame) {
+			for (auto& m : transforms) {
+				m = randomTransform();
+			}
+
+			auto begin = std::chrono::steady_clock::now();
+			for (int i = 0; i < kEntityCount; ++i) {
+				engine.SetTransform(instanced[i], transforms[i]);
+			}
+			engine.Update(0.0f);
+			moveTime += std::chrono::steady_clock::now() - begin;
+
+			begin = std::chrono::steady_clock::now();
+			for (int i = 0; i < kEntityCount; ++i) {
+				rebuilt.Unregister(baked[i]);
+				baked[i] = rebuilt.RegisterTriangles(
+					bake(soups[i], transforms[i]), nullptr
+				);
+			}
+			rebuilt.Update(0.0f);
+			rebuildTime += std::chrono::steady_clock::now() - begin;
+		}
+		mismatches += CountMismatches(
+			rebuilt, engine, queries, kTolerance, false
+		);
+
+		// 変形: 三角形を差し替えてリフィット
+		std::uniform_real_distribution wobble(-16.0f, 16.0f);
+		for (int i = 0; i < kEntityCount; ++i) {
+			for (auto& tri : soups[i]) {
+				const Vec3 offset(wobble(rng), wobble(rng), wobble(rng));
+				tri.v0 += offset;
+				tri.v1 += offset;
+				tri.v2 += offset;
+			}
+			if (!engine.RefitTriangles(instanced[i], soups[i])) {
+				++mismatches;
+			}
+			rebuilt.Unregister(baked[i]);
+			baked[i] = rebuilt.RegisterTriangles(
+				bake(soups[i], transforms[i]), nullptr
+			);
+		}
+		engine.Update(0.0f);
+		rebuilt.Update(0.0f);
+		mismatches += CountMismatches(
+			rebuilt, engine, queries, kTolerance, false
+		);
+
+		// 所有エンティティ: 回転・拡縮込みのワールド行列に追従し、破棄されたら外れる
+		{
+			Engine owned;
+			owned.Init();
+			Engine expected;
+			expected.Init();
+			const Engine empty;
+
+			const Vec3 center(pos(rng), 0.0f, pos(rng));
+			auto       entity = std::make_unique<Entity>("physics_owner");
+			entity->GetTransform()->SetLocalPos(center);
+			entity->GetTransform()->SetLocalRot(
+				Quaternion::Euler(angle(rng), angle(rng), angle(rng))
+			);
+			entity->GetTransform()->SetLocalScale(Vec3(2.0f, 0.5f, 1.5f));
+
+			owned.RegisterTriangles(soups[0], entity.get());
+			owned.Update(0.0f);
+			expected.RegisterTriangles(
+				bake(soups[0], entity->GetTransform()->GetWorldMat()), nullptr
+			);
+			// 周りからエンティティの中心に向けて撃つ
+			std::uniform_real_distribution unit(-1.0f, 1.0f);
+			std::vector<Query>             around(256);
+			int                            hits = 0;
+			for (auto& q : around) {
+				Vec3 offset(unit(rng), unit(rng), unit(rng));
+				if (offset.SqrLength() < 1e-6f) {
+					offset = Vec3::up;
+				}
+				offset.Normalize();
+				q.start = center + offset * (kPropExtent * 4.0f);
+				q.dir   = (center - q.start).Normalized();
+				q.length = kPropExtent * 8.0f;
+
+				Hit                hit;
+				const Unnamed::Ray ray = {
+					.origin = q.start,
+					.dir = q.dir,
+					.invDir = Vec3::one / q.dir,
+					.tMin = 0.0f,
+					.tMax = q.length
+				};
+				hits += expected.RayCast(ray, &hit) ? 1 : 0;
+			}
+			if (hits == 0) {
+				Warning(kChannel, "owner check: no ray reached the entity");
+				++mismatches;
+			}
+			mismatches += CountMismatches(
+				expected, owned, around, kTolerance, false
+			);
+
+			entity.reset();
+			owned.Update(0.0f); // 破棄したエンティティは読まない
+			mismatches += CountMismatches(empty, owned, around, 0.0f);
+		}
+
+		const auto perFrameMs = [&](const std::chrono::steady_clock::duration d) {
+			return std::chrono::duration<double, std::milli>(d).count() /
+				kFrameCount;
+		};
+		Msg(
+			kChannel,
+			"[{} moving entities] transform update {:.3f} ms/frame, "
+			"re-register {:.3f} ms/frame",
+			kEntityCount,
+			perFrameMs(moveTime),
+			perFrameMs(rebuildTime)
+		);
+
+		if (mismatches > 0) {
+			Warning(kChannel, "moving colliders FAILED: {} mismatches", mismatches);
+			return false;
+		}
+		Msg(kChannel, "moving colliders passed");
+		return true;
+	}
+
+	bool RunBVHCache() {
+		constexpr int kLoadCount = 8;
+
+		const std::vector<Unnamed::Triangle> tris = MakeTerrain(300);
+		const std::string                    key  = "benchmark/terrain#0";
+		// 実ファイルは無いので、ソースのスタンプは固定値で代用する
+		const Unnamed::FileStamp stamp = {
+			.lastWrite = std::chrono::system_clock::time_point(
+				std::chrono::seconds(kSeed)
+			),
+			.sizeInBytes = tris.size() * sizeof(Unnamed::Triangle)
+		};
+
+		const auto elapsedMs = [](const std::chrono::steady_clock::time_point begin) {
+			return std::chrono::duration<double, std::milli>(
+				std::chrono::steady_clock::now() - begin
+			).count();
+		};
+
+		// コールド: ビルドしてキャッシュに書き出す
+		Engine cold;
+		cold.Init();
+		auto                 begin  = std::chrono::steady_clock::now();
+		const ColliderHandle handle = cold.RegisterTriangles(tris, nullptr);
+		const double         buildMs = elapsedMs(begin);
+		begin = std::chrono::steady_clock::now();
+		if (!cold.SaveToCache(handle, key, stamp)) {
+			Warning(kChannel, "failed to write BVH cache");
+			return false;
+		}
+		const double saveMs = elapsedMs(begin);
+
+		// ウォーム: マップして登録するだけ
+		double warmMs = 0.0;
+		Engine warm;
+		warm.Init();
+		for (int i = 0; i < kLoadCount; ++i) {
+			Engine engine;
+			engine.Init();
+			begin       = std::chrono::steady_clock::now();
+			auto mapped = engine.GetBVHCache().Load(key, stamp);
+			if (!mapped) {
+				Warning(kChannel, "failed to load BVH cache");
+				return false;
+			}
+			engine.RegisterMapped(std::move(mapped), nullptr);
+			warmMs += elapsedMs(begin);
+		}
+		warmMs /= kLoadCount;
+		warm.RegisterMapped(warm.GetBVHCache().Load(key, stamp), nullptr);
+
+		// ソースが更新されたら使わない
+		Unnamed::FileStamp stale = stamp;
+		stale.sizeInBytes += 1;
+		int mismatches = warm.GetBVHCache().Load(key, stale) ? 1 : 0;
+
+		// 同じ木なのでスフィアも含めて完全に一致するはず
+		const std::vector<Query> queries = MakeQueries();
+		mismatches += CountMismatches(cold, warm, queries, 0.0f);
+
+		// 壊れたキャッシュ: 4バイトずつ書き換えたものを読み、読めたら走査してみる
+		// (番号が範囲外なら Load で弾くので、範囲外を読まずに終わればよい)
+		int accepted = 0;
+		{
+			const std::string        corruptKey = "benchmark/corrupt#0";
+			const auto               smallTris  = MakeTerrain(kCorruptTerrain);
+			const Unnamed::FileStamp smallStamp = {
+				.lastWrite = stamp.lastWrite,
+				.sizeInBytes = smallTris.size() * sizeof(Unnamed::Triangle)
+			};
+			Engine small;
+			small.Init();
+			if (!small.SaveToCache(small.RegisterTriangles(smallTris, nullptr), corruptKey, smallStamp)) {
+				Warning(kChannel, "failed to write BVH cache");
+				return false;
+			}
+
+			const std::filesystem::path path = small.GetBVHCache().PathFor(corruptKey);
+			std::vector<char>           original(std::filesystem::file_size(path));
+			std::ifstream(path, std::ios::binary).read(
+				original.data(), static_cast<std::streamsize>(original.size())
+			);
+
+			// 地形の真上から下に向けて撃つ(全ノードを降りていくように)
+			const float        step = kCorruptTerrain * 32.0f / kCorruptGrid;
+			std::vector<Query> down;
+			for (int z = 0; z < kCorruptGrid; ++z) {
+				for (int x = 0; x < kCorruptGrid; ++x) {
+					down.push_back({
+						.start = Vec3((x + 0.5f) * step, 1024.0f, (z + 0.5f) * step),
+						.dir = Vec3(0.0f, -1.0f, 0.0f),
+						.length = 2048.0f
+					});
+				}
+			}
+			std::mt19937                          rng(kSeed);
+			std::uniform_int_distribution<size_t> at(0, original.size() - sizeof(uint32_t));
+			for (int i = 0; i < kCorruptCount; ++i) {
+				std::vector<char> bytes   = original;
+				const uint32_t    garbage = static_cast<uint32_t>(rng());
+				std::memcpy(bytes.data() + at(rng), &garbage, sizeof(garbage));
+				std::ofstream(path, std::ios::binary | std::ios::trunc).write(
+					bytes.data(), static_cast<std::streamsize>(bytes.size())
+				);
+
+				if (auto mapped = small.GetBVHCache().Load(corruptKey, smallStamp)) {
+					++accepted;
+					Engine engine;
+					engine.Init();
+					engine.RegisterMapped(std::move(mapped), nullptr);
+					CountMismatches(small, engine, down, 0.0f); // 結果は比べない
+				}
+			}
+			std::filesystem::remove(path);
+		}
+
+		Msg(
+			kChannel,
+			"[{} tris] cold: build {:.2f} ms + save {:.2f} ms, warm: map {:.3f} ms ({:.1f}x), "
+			"corrupted caches accepted {}/{}",
+			tris.size(),
+			buildMs,
+			saveMs,
+			warmMs,
+			warmMs > 0.0 ? buildMs / warmMs : 0.0,
+			accepted,
+			kCorruptCount
+		);
+
+		if (mismatches > 0) {
+			Warning(kChannel, "BVH cache FAILED: {} mismatches", mismatches);
+			return false;
+		}
+		Msg(kChannel, "BVH cache passed");
+		return true;
+	}
+}
@@ -0,0 +1,34 @@
+﻿#pragma once
+
+namespace UPhysics::Benchmark {
+	// ブロードフェーズ(TLAS / 線形走査)のレイ・ボックス・スフィアキャストの
+	// スループットを 10 / 100 / 1000 エンティティで計測してログに出します
+	void RunBroadphase();
+
+	// 三角形スープに対してレイ/スイープを単発APIとバッチAPIで投げ、
+	// クエリ/秒を比較してログに出します
+	void RunBatchQueries();
+
+	// ノード判定(スカラー x4 / SSE BVH4)のスループットと、
+	// 2分岐 / 4分岐レイアウトでのレイキャストのスループットをログに出します
+	void RunBVH4();
+
+	// 数千個のコライダーの登録/解除と三角形領域の詰め直しを繰り返し、
+	// 解除後のキャスト結果が最初から登録しなかった場合と一致するかを検証します
+	// @return 全クエリが一致したらtrue
+	bool RunRegistryStress();
+
+	// 約50万三角形のメッシュのBVHを直列/並列で構築し、
+	// 構築時間と木の統計をログに出します(並列の結果が直列と一致するかも確認)
+	void RunBuild();
+
+	// 動くコライダーを行列の更新だけで動かした場合と、毎フレーム登録し直した場合の
+	// 1フレームあたりのコストを比べ、キャスト結果が一致するかを検証します(リフィットも含む)
+	// @return 全クエリが一致したらtrue
+	bool RunMovingColliders();
+
+	// 大きなメッシュのBVHをビルドしてキャッシュに書き出すまで(コールド)と、
+	// キャッシュをマップして登録するまで(ウォーム)の時間を比べ、キャスト結果の一致を検証します
+	// @return 全クエリが一致したらtrue
+	bool RunBVHCache();
+}
@@ -15,6 +15,25 @@ namespace UPhysics {
 		bool     allsolid   = false; // トレース全域で固体内だったか
 	};
 
+	// 登録したコライダーのハンドル
+	// スロットが再利用されても generation が一致しなければ無効として扱う
+	struct ColliderHandle {
+		uint32_t index      = UINT32_MAX;
+		uint32_t generation = 0;
+	};
+
+	// バッチクエリ用のスイープ
+	struct SweepQuery {
+		enum class SHAPE : uint8_t { RAY, BOX, SPHERE };
+
+		SHAPE shape = SHAPE::RAY;
+		Vec3  start;
+		Vec3  dir;
+		float length   = 0.0f;
+		Vec3  halfSize = Vec3::zero; // BOX のみ
+		float radius   = 0.0f;       // SPHERE のみ
+	};
+
 	// 形状情報
 	struct TriInfo {
 		Unnamed::AABB bounds;   // 境界
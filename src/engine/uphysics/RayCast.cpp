@@ -6,6 +6,10 @@ namespace UPhysics {
 		return nodeBounds;
 	}
 
+	Vec3 RayCast::NodeExpansion() const {
+		return Vec3::zero;
+	}
+
 	bool RayCast::TestTriangle(
 		const Unnamed::Triangle& tri,
 		const Vec3&     dir,
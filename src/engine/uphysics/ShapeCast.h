@@ -7,6 +7,9 @@ namespace UPhysics {
 		[[nodiscard]] virtual Unnamed::AABB ExpandNode(
 			const Unnamed::AABB& nodeBounds) const = 0;
 
+		// ExpandNodeで各軸に広げる量(SIMD走査用)
+		[[nodiscard]] virtual Vec3 NodeExpansion() const = 0;
+
 		virtual bool TestTriangle(
 			const Unnamed::Triangle& tri,
 			const Vec3&              dir,
@@ -73,6 +73,10 @@ namespace UPhysics {
 		};
 	}
 
+	Vec3 SphereCast::NodeExpansion() const {
+		return Vec3(radius + 1e-6f);
+	}
+
 	bool SphereCast::TestTriangle(
 		const Unnamed::Triangle& triangle,
 		const Vec3&     dir,
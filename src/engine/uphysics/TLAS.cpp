@@ -0,0 +1,111 @@
+﻿#include <engine/uphysics/TLAS.h>
+
+#include <algorithm>
+
+namespace UPhysics {
+	namespace {
+		constexpr uint32_t kTLASLeafSize = 2;
+	}
+
+	void TLAS::Build(const std::vector<RegisteredBVH>& blasSet) {
+		Clear();
+
+		const size_t n = blasSet.size();
+		mBounds.resize(n);
+		mCenters.resize(n);
+		mInstanceIndices.reserve(n);
+
+		for (size_t i = 0; i < n; ++i) {
+			const RegisteredBVH& blas = blasSet[i];
+			// 空きスロットと、三角形を持たない(ルートAABBが反転している)BLASは除外
+			if (!blas.alive || blas.Nodes().empty() || blas.triCount == 0) {
+				continue;
+			}
+			mBounds[i]  = blas.worldBounds;
+			mCenters[i] = mBounds[i].Center();
+			mInstanceIndices.emplace_back(static_cast<uint32_t>(i));
+		}
+
+		if (mInstanceIndices.empty()) {
+			return;
+		}
+
+		mNodes.reserve(mInstanceIndices.size() * 2);
+		Recurse(0, static_cast<uint32_t>(mInstanceIndices.size()));
+	}
+
+	void TLAS::Refit(const std::vector<RegisteredBVH>& blasSet) {
+		// Recurse は親を子より先に積むので、後ろから処理すれば子が先に確定する
+		for (size_t i = mNodes.size(); i-- > 0;) {
+			FlatNode& node = mNodes[i];
+			if (node.primCount != 0) {
+				Unnamed::AABB bounds;
+				for (uint32_t k = 0; k < node.primCount; ++k) {
+					const uint32_t instance = mInstanceIndices[node.leftFirst + k];
+					mBounds[instance]       = blasSet[instance].worldBounds;
+					bounds.Expand(mBounds[instance]);
+				}
+				node.bounds = bounds;
+			} else {
+				node.bounds = mNodes[node.leftFirst].bounds;
+				node.bounds.Expand(mNodes[node.rightFirst].bounds);
+			}
+		}
+	}
+
+	void TLAS::Clear() {
+		mNodes.clear();
+		mInstanceIndices.clear();
+		mBounds.clear();
+		mCenters.clear();
+	}
+
+	bool TLAS::Empty() const {
+		return mNodes.empty();
+	}
+
+	size_t TLAS::NodeCount() const {
+		return mNodes.size();
+	}
+
+	uint32_t TLAS::Recurse(const uint32_t start, const uint32_t end) {
+		const uint32_t nodeIndex = static_cast<uint32_t>(mNodes.size());
+		mNodes.emplace_back();
+
+		Unnamed::AABB bounds       = {};
+		Unnamed::AABB centerBounds = {};
+		for (uint32_t i = start; i < end; ++i) {
+			bounds.Expand(mBounds[mInstanceIndices[i]]);
+			centerBounds.Expand(mCenters[mInstanceIndices[i]]);
+		}
+		mNodes[nodeIndex].bounds = bounds;
+
+		const uint32_t count = end - start;
+		if (count <= kTLASLeafSize) {
+			mNodes[nodeIndex].leftFirst = start;
+			mNodes[nodeIndex].primCount = static_cast<uint16_t>(count);
+			return nodeIndex;
+		}
+
+		// 中心の最長軸で中央値分割する
+		// 深さが log2(n) に収まるので固定長スタックで走査できる
+		const int      axis = centerBounds.LongestAxis();
+		const uint32_t mid  = (start + end) / 2;
+		std::nth_element(
+			mInstanceIndices.begin() + start,
+			mInstanceIndices.begin() + mid,
+			mInstanceIndices.begin() + end,
+			[&](const uint32_t a, const uint32_t b) {
+				return (&mCenters[a].x)[axis] < (&mCenters[b].x)[axis];
+			}
+		);
+
+		const uint32_t left  = Recurse(start, mid);
+		const uint32_t right = Recurse(mid, end);
+
+		mNodes[nodeIndex].leftFirst  = left;
+		mNodes[nodeIndex].rightFirst = right;
+		mNodes[nodeIndex].primCount  = 0;
+		return nodeIndex;
+	}
+}
@@ -0,0 +1,69 @@
+﻿#pragma once
+#include <vector>
+
+#include <engine/uphysics/BVH.h>
+
+namespace UPhysics {
+	// トップレベルBVH
+	// エンティティごとのBVH(BLAS)のルートAABBを葉に持つBVHです。
+	// ブロードフェーズを線形走査から対数オーダーにするために使います。
+	class TLAS {
+	public:
+		static constexpr int kMaxStackDepth = 64;
+
+		void Build(const std::vector<RegisteredBVH>& blasSet);
+
+		/// @brief BLASの worldBounds が変わったときに、木の形を保ったままAABBだけ更新します
+		/// @details 動くコライダー向け。BLASの追加や削除の後は Build してください
+		void Refit(const std::vector<RegisteredBVH>& blasSet);
+		void Clear();
+
+		/// @brief ノードを深さ優先で走査します
+		/// @param nodeTest ノードのAABBを受け取り、潜るならtrueを返す
+		/// @param visit 葉に含まれるBLASのインデックスを受け取り、
+		///              走査を続けるならtrueを返す
+		template <class NodeTest, class LeafVisitor>
+		void Traverse(NodeTest&& nodeTest, LeafVisitor&& visit) const {
+			if (mNodes.empty()) {
+				return;
+			}
+
+			// ヒープ確保を避けるため固定長スタックで探索
+			uint32_t stack[kMaxStackDepth];
+			int      sp  = 0;
+			stack[sp++] = 0;
+
+			while (sp) {
+				const FlatNode& node = mNodes[stack[--sp]];
+				if (!nodeTest(node.bounds)) {
+					continue;
+				}
+
+				if (node.primCount == 0) {
+					stack[sp++] = node.leftFirst;
+					stack[sp++] = node.rightFirst;
+					continue;
+				}
+
+				for (uint32_t i = 0; i < node.primCount; ++i) {
+					if (!visit(mInstanceIndices[node.leftFirst + i])) {
+						return;
+					}
+				}
+			}
+		}
+
+		[[nodiscard]] bool   Empty() const;
+		[[nodiscard]] size_t NodeCount() const;
+
+	private:
+		uint32_t Recurse(uint32_t start, uint32_t end);
+
+		std::vector<FlatNode> mNodes;
+		std::vector<uint32_t> mInstanceIndices; // 葉から参照するBLASのインデックス
+
+		// 構築用
+		std::vector<Unnamed::AABB> mBounds;
+		std::vector<Vec3>          mCenters;
+	};
+}
@@ -89,11 +89,12 @@ struct VSOut {
 	float3 nrmWS:TEXCOORD1; 
 	float2 uv:TEXCOORD0;
 };
-VSOut VSMain(VSIn i) {
+VSOut VSMain(VSIn i, uint instanceID:SV_InstanceID) {
 	VSOut o;
-	float4 wpos = mul(float4(i.pos,1), gWorld);
+	float4x4 world = gInstances[instanceID].world;
+	float4 wpos = mul(float4(i.pos,1), world);
 	o.pos   = mul(wpos, gViewProj);
-	float3 nWS = mul(float4(i.nrm,0), gWorld).xyz;
+	float3 nWS = mul(float4(i.nrm,0), world).xyz;
 	o.nrmWS = normalize(nWS);
 	o.uv    = i.uv;
 	return o;
@@ -561,9 +561,7 @@ namespace Unnamed {
 		auto& bb = mBackBuffers[mBackBufferIndex];
 		auto& db = mDepthBuffers[mBackBufferIndex];
 
-		frameContext.commandList->OMSetRenderTargets(
-			1, &bb.rtv, TRUE, &db.dsv
-		);
+		BindFrameTargets(frameContext.commandList.Get(), mBackBufferIndex);
 		const FLOAT color[4] = {
 			clearColor.x, clearColor.y, clearColor.z, clearColor.w
 		};
@@ -575,23 +573,6 @@ namespace Unnamed {
 			db.dsv, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr
 		);
 
-		// ビューポート、シザーの設定
-		D3D12_VIEWPORT viewport;
-		viewport.TopLeftX = 0.0f;
-		viewport.TopLeftY = 0.0f;
-		viewport.Width    = static_cast<FLOAT>(mInfo.width);
-		viewport.Height   = static_cast<FLOAT>(mInfo.height);
-		viewport.MinDepth = 0.0f;
-		viewport.MaxDepth = 1.0f;
-		frameContext.commandList->RSSetViewports(1, &viewport);
-
-		D3D12_RECT scissorRect;
-		scissorRect.left   = 0;
-		scissorRect.top    = 0;
-		scissorRect.right  = static_cast<LONG>(mInfo.width);
-		scissorRect.bottom = static_cast<LONG>(mInfo.height);
-		frameContext.commandList->RSSetScissorRects(1, &scissorRect);
-
 		return {
 			.cmd = frameContext.commandList.Get(),
 			.alloc = frameContext.commandAllocator.Get(),
@@ -633,6 +614,50 @@ namespace Unnamed {
 		mBackBufferIndex = mSwapChain->GetCurrentBackBufferIndex();
 	}
 
+	void GraphicsDevice::BindFrameTargets(
+		ID3D12GraphicsCommandList* commandList, const uint32_t backIndex
+	) const {
+		const auto& bb = mBackBuffers[backIndex];
+		const auto& db = mDepthBuffers[backIndex];
+		commandList->OMSetRenderTargets(1, &bb.rtv, TRUE, &db.dsv);
+
+		// ビューポート、シザーの設定
+		D3D12_VIEWPORT viewport;
+		viewport.TopLeftX = 0.0f;
+		viewport.TopLeftY = 0.0f;
+		viewport.Width    = static_cast<FLOAT>(mInfo.width);
+		viewport.Height   = static_cast<FLOAT>(mInfo.height);
+		viewport.MinDepth = 0.0f;
+		viewport.MaxDepth = 1.0f;
+		commandList->RSSetViewports(1, &viewport);
+
+		D3D12_RECT scissorRect;
+		scissorRect.left   = 0;
+		scissorRect.top    = 0;
+		scissorRect.right  = static_cast<LONG>(mInfo.width);
+		scissorRect.bottom = static_cast<LONG>(mInfo.height);
+		commandList->RSSetScissorRects(1, &scissorRect);
+	}
+
+	void GraphicsDevice::ExecuteRecorded(
+		const FrameContext&                       ctx,
+		const std::span<ID3D12CommandList* const> recorded
+	) {
+		THROW(ctx.cmd->Close());
+
+		std::vector<ID3D12CommandList*> lists;
+		lists.reserve(recorded.size() + 1);
+		lists.emplace_back(ctx.cmd);
+		lists.insert(lists.end(), recorded.begin(), recorded.end());
+		mCommandQueue->ExecuteCommandLists(
+			static_cast<UINT>(lists.size()), lists.data()
+		);
+
+		// 実行に出した直後でもリストは同じアロケーターで開き直せる(アロケーターはリセットしない)
+		THROW(ctx.cmd->Reset(ctx.alloc, nullptr));
+		BindFrameTargets(ctx.cmd, ctx.backIndex);
+	}
+
 	GraphicsDevice::PerFrame GraphicsDevice::GetFrameBuffer(
 		const uint32_t frameIndex
 	) const {
@@ -731,6 +756,14 @@ namespace Unnamed {
 		return mSwapChain.Get();
 	}
 
+	uint32_t GraphicsDevice::Width() const noexcept {
+		return mInfo.width;
+	}
+
+	uint32_t GraphicsDevice::Height() const noexcept {
+		return mInfo.height;
+	}
+
 	DescriptorAllocator* GraphicsDevice::GetSrvAllocator() const {
 		return mSrvAllocator.get();
 	}
@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <d3d12.h>
 #include <dxgi1_6.h>
+#include <span>
 #include <vector>
 
 #include <engine/uresource/DescriptorAllocator.h>
@@ -55,6 +56,20 @@ namespace Unnamed {
 
 		void EndFrame(const FrameContext& ctx);
 
+		// バックバッファと深度バッファ、ビューポート、シザーを設定します
+		// 状態はコマンドリストをまたいで引き継がれないので、並列に記録するリストごとに呼んでください
+		void BindFrameTargets(
+			ID3D12GraphicsCommandList* commandList, uint32_t backIndex
+		) const;
+
+		/// @brief ctx.cmd をここで閉じ、recorded と続けて実行してから開き直します
+		/// @details ワーカーで記録したリストを、フレームの先頭(バリアやクリア、アップロード)の
+		/// 後に実行するためのものです。開き直した ctx.cmd には描画先を設定し直します
+		void ExecuteRecorded(
+			const FrameContext&                 ctx,
+			std::span<ID3D12CommandList* const> recorded
+		);
+
 		[[nodiscard]] PerFrame GetFrameBuffer(uint32_t frameIndex) const;
 
 		[[nodiscard]] FrameContext BeginImmediateFrame() const;
@@ -89,6 +104,9 @@ namespace Unnamed {
 		[[nodiscard]] ID3D12Device*    Device() const noexcept;
 		[[nodiscard]] IDXGISwapChain4* SwapChain() const noexcept;
 
+		[[nodiscard]] uint32_t Width() const noexcept;
+		[[nodiscard]] uint32_t Height() const noexcept;
+
 		[[nodiscard]] DescriptorAllocator* GetSrvAllocator() const;
 		[[nodiscard]] DescriptorAllocator* GetSamplerAllocator() const;
 		[[nodiscard]] DescriptorAllocator* GetRtvAllocator() const;
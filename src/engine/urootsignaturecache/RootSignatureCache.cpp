@@ -74,6 +74,13 @@ namespace Unnamed {
 				rootParam.ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
 			}
 			break;
+			case RootParamDesc::Kind::ROOT_SRV: {
+				rootParam.ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+				rootParam.Descriptor.ShaderRegister = param.cbvRegister;
+				rootParam.Descriptor.RegisterSpace = param.cbvSpace;
+				rootParam.ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+			}
+			break;
 			case RootParamDesc::Kind::ROOT32_BIT_CONST: {
 				rootParam.ParameterType =
 					D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
@@ -148,6 +155,7 @@ namespace Unnamed {
 		entry.hash              = hash;
 		entry.rootSignature     = std::move(rsObj);
 		entry.rootSignatureDesc = rs;
+		entry.sourceDesc        = desc;
 		uint32_t index          = static_cast<uint32_t>(mEntries.size());
 		mEntries.emplace_back(std::move(entry));
 		mHashToIndex[hash] = index;
@@ -167,6 +175,11 @@ namespace Unnamed {
 		return mEntries[rootSignature.id].rootSignatureDesc;
 	}
 
+	const RootSignatureDesc& RootSignatureCache::GetSourceDesc(
+		const RootSignatureHandle rootSignature) const {
+		return mEntries[rootSignature.id].sourceDesc;
+	}
+
 	size_t RootSignatureCache::Hash(const RootSignatureDesc& desc) {
 		std::hash<uint64_t> hash;
 		size_t              h = hash(desc.flags);
@@ -23,12 +23,13 @@ namespace Unnamed {
 	};
 
 	struct RootParamDesc {
-		enum class Kind { TABLE, ROOT_CBV, ROOT32_BIT_CONST };
+		// 値はパイプラインのマニフェストに保存されるので、追加は末尾に
+		enum class Kind { TABLE, ROOT_CBV, ROOT32_BIT_CONST, ROOT_SRV };
 
 		Kind                   kind = Kind::TABLE;
 		std::vector<RangeDesc> ranges; // TABLEの時に使用
 
-		// RootCBV用
+		// RootCBV/RootSRV用
 		UINT cbvRegister = 0;
 		UINT cbvSpace    = 0;
 
@@ -64,6 +65,8 @@ namespace Unnamed {
 		RootSignatureHandle GetOrCreate(const RootSignatureDesc& desc);
 		ID3D12RootSignature* Get(RootSignatureHandle handle) const;
 		D3D12_ROOT_SIGNATURE_DESC& GetDesc(RootSignatureHandle rootSignature);
+		// GetOrCreate に渡された記述(パイプラインのマニフェストに保存する用)
+		const RootSignatureDesc& GetSourceDesc(RootSignatureHandle rootSignature) const;
 
 	private:
 		static size_t Hash(const RootSignatureDesc& desc);
@@ -75,6 +78,7 @@ namespace Unnamed {
 			size_t                                      hash;
 			Microsoft::WRL::ComPtr<ID3D12RootSignature> rootSignature;
 			D3D12_ROOT_SIGNATURE_DESC                   rootSignatureDesc;
+			RootSignatureDesc                           sourceDesc;
 			std::vector<Entry>                          entries;
 			std::unordered_map<size_t, uint32_t>        hashToIndex;
 		};
@@ -2,7 +2,6 @@
 
 #include "UploadArena.h"
 
-#include <core/memory/MemUtil.h>
 #include <engine/subsystem/console/Log.h>
 #include <runtime/core/Properties.h>
 
@@ -53,7 +52,9 @@ namespace Unnamed {
 
 		mRetireFenceValues.assign(mFrames, 0);
 		mRetireFences.assign(mFrames, nullptr);
-		mFrameOffsets.assign(mFrames, 0);
+		for (auto& frame : mFrameOffsets) {
+			frame.Reset(mSizePerFrame);
+		}
 		mCurrentFrame = 0;
 		return true;
 	}
@@ -65,7 +66,9 @@ namespace Unnamed {
 			mBuffer.Reset();
 			mRetireFences.clear();
 			mRetireFenceValues.clear();
-			mFrameOffsets.clear();
+			for (auto& frame : mFrameOffsets) {
+				frame.Reset(0);
+			}
 			mFrames                = 0;
 			mSizePerFrame          = 0;
 			mBaseGPUVirtualAddress = 0;
@@ -83,7 +86,7 @@ namespace Unnamed {
 				return false;
 			}
 		}
-		mFrameOffsets[mCurrentFrame] = 0;
+		mFrameOffsets[mCurrentFrame].Reset(mSizePerFrame);
 		return true;
 	}
 
@@ -98,24 +101,40 @@ namespace Unnamed {
 	UploadArena::Slice UploadArena::Allocate(
 		const uint64_t size, const uint64_t alignment
 	) {
-		const uint32_t frameIndex = mCurrentFrame;
-		const uint64_t base       = mSizePerFrame * frameIndex;
-		const uint64_t offset     = MemUtil::AlignUp(
-			mFrameOffsets[frameIndex], alignment
+		return ToSlice(
+			mFrameOffsets[mCurrentFrame].Allocate(size, alignment), size,
+			alignment
 		);
-		if (offset + size > mSizePerFrame) {
+	}
+
+	UploadArena::Slice UploadArena::Allocate(
+		UploadBlockCursor& cursor, const uint64_t size, const uint64_t alignment
+	) {
+		return ToSlice(cursor.Allocate(size, alignment), size, alignment);
+	}
+
+	UploadBlockCursor UploadArena::CreateCursor(const uint64_t blockSize) {
+		return UploadBlockCursor(mFrameOffsets[mCurrentFrame], blockSize);
+	}
+
+	UploadArena::Slice UploadArena::ToSlice(
+		const uint64_t offset, const uint64_t size, const uint64_t alignment
+	) const {
+		const uint32_t frameIndex = mCurrentFrame;
+		if (offset == UploadSuballocator::kInvalidOffset) {
 			// 容量不足
 			Warning(
 				kChannel,
 				"アリーナの容量が足りません (size={}, alignment={}, frameIndex={}, used={}, capacity={})",
 				std::to_string(size), std::to_string(alignment),
 				std::to_string(frameIndex),
-				std::to_string(offset), std::to_string(mSizePerFrame)
+				std::to_string(mFrameOffsets[frameIndex].Used()),
+				std::to_string(mSizePerFrame)
 			);
 			return {};
 		}
-		mFrameOffsets[frameIndex] = offset + size;
-		Slice slice;
+		const uint64_t base = mSizePerFrame * frameIndex;
+		Slice          slice;
 		slice.cpu               = mMapped + base + offset;
 		slice.gpuVirtualAddress = mBaseGPUVirtualAddress + base + offset;
 		slice.offset            = base + offset;
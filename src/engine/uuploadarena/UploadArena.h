@@ -1,10 +1,15 @@
 ﻿#pragma once
+#include <array>
 #include <cstdint>
 #include <d3d12.h>
 #include <vector>
 
+#include <runtime/core/Properties.h>
+
 #include <wrl/client.h>
 
+#include "UploadSuballocator.h"
+
 namespace Unnamed {
 	class UploadArena {
 	public:
@@ -21,13 +26,25 @@ namespace Unnamed {
 			uint32_t backIndex, ID3D12Fence* fence,
 			uint64_t value
 		);
+
+		// スレッドセーフ
 		Slice Allocate(uint64_t size, uint64_t alignment);
+
+		// ワーカーごとのカーソルから切り出します(ブロックを取る時だけアトミック)
+		// カーソルは BeginFrame の後に CreateCursor() で作り、そのフレームの間だけ使ってください
+		Slice Allocate(UploadBlockCursor& cursor, uint64_t size, uint64_t alignment);
+		[[nodiscard]] UploadBlockCursor CreateCursor(
+			uint64_t blockSize = UploadBlockCursor::kDefaultBlockSize
+		);
+
 		[[nodiscard]] ID3D12Resource* Resource() const { return mBuffer.Get(); }
 		[[nodiscard]] uint64_t SizePerFrame() const { return mSizePerFrame; }
 		[[nodiscard]] uint32_t Frames() const { return mFrames; }
 
 	private:
+		Slice ToSlice(uint64_t offset, uint64_t size, uint64_t alignment) const;
 
+	private:
 		Microsoft::WRL::ComPtr<ID3D12Resource> mBuffer;
 		uint8_t*                               mMapped                = nullptr;
 		uint64_t                               mBaseGPUVirtualAddress = 0;
@@ -36,7 +53,8 @@ namespace Unnamed {
 		uint32_t mFrames       = 0;
 		uint32_t mCurrentFrame = 0;
 
-		std::vector<uint64_t> mFrameOffsets; // フレームごとのオフセット
+		// フレームごとのオフセット
+		std::array<UploadSuballocator, kFrameBufferCount> mFrameOffsets;
 		// フレームごとのフェンス
 		std::vector<Microsoft::WRL::ComPtr<ID3D12Fence>> mRetireFences;
 		std::vector<uint64_t>                            mRetireFenceValues;
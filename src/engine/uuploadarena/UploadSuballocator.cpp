@@ -0,0 +1,74 @@
+﻿#include <pch.h>
+
+//-----------------------------------------------------------------------------
+
+#include "UploadSuballocator.h"
+
+#include <core/memory/MemUtil.h>
+
+namespace Unnamed {
+	void UploadSuballocator::Reset(const uint64_t capacity) {
+		mCapacity = capacity;
+		mOffset.store(0, std::memory_order_relaxed);
+	}
+
+	uint64_t UploadSuballocator::Allocate(
+		const uint64_t size, const uint64_t alignment
+	) {
+		uint64_t current = mOffset.load(std::memory_order_relaxed);
+		for (;;) {
+			const uint64_t offset = MemUtil::AlignUp(current, alignment);
+			if (offset + size > mCapacity) {
+				return kInvalidOffset;
+			}
+			// 書き込む中身はコマンドリストの実行で同期されるので、オフセットは relaxed で十分
+			if (
+				mOffset.compare_exchange_weak(
+					current, offset + size, std::memory_order_relaxed
+				)
+			) {
+				return offset;
+			}
+		}
+	}
+
+	uint64_t UploadSuballocator::Used() const {
+		return mOffset.load(std::memory_order_relaxed);
+	}
+
+	UploadBlockCursor::UploadBlockCursor(
+		UploadSuballocator& source,
+		const uint64_t      blockSize
+	) : mSource(&source),
+	    mBlockSize(MemUtil::AlignUp(blockSize, kBlockAlignment)) {
+	}
+
+	uint64_t UploadBlockCursor::Allocate(
+		const uint64_t size, const uint64_t alignment
+	) {
+		if (mHead < mEnd) {
+			const uint64_t offset = MemUtil::AlignUp(mHead, alignment);
+			if (offset + size <= mEnd) {
+				mHead = offset + size;
+				return offset;
+			}
+		}
+
+		// ブロックに収まらない大きさは直接(今のブロックの残りはそのまま使い続ける)
+		if (size + alignment > mBlockSize) {
+			return mSource->Allocate(size, alignment);
+		}
+
+		const uint64_t block = mSource->Allocate(mBlockSize, kBlockAlignment);
+		if (block == UploadSuballocator::kInvalidOffset) {
+			// 末尾にブロック1つ分の空きが無くても、小さいものはまだ入るかもしれない
+			return mSource->Allocate(size, alignment);
+		}
+		++mBlockCount;
+
+		const uint64_t offset = MemUtil::AlignUp(block, alignment);
+		mHead                 = offset + size;
+		mEnd                  = block + mBlockSize;
+		return offset;
+	}
+}
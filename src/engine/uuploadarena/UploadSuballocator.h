@@ -0,0 +1,56 @@
+﻿#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace Unnamed {
+	/// @class UploadSuballocator
+	/// @brief アップロード領域1フレーム分のオフセットを前から配ります
+	/// @details オフセットの更新は CAS なので、複数スレッドから同時に Allocate できます。
+	/// デバイスを持たないので、CPUだけで確認できます
+	class UploadSuballocator {
+	public:
+		static constexpr uint64_t kInvalidOffset = UINT64_MAX;
+
+		// 空にします(GPUがこのフレームを使い終わってから、1スレッドで呼んでください)
+		void Reset(uint64_t capacity);
+
+		/// @brief スレッドセーフ
+		/// @return フレーム先頭からのオフセット。足りなければ kInvalidOffset
+		[[nodiscard]] uint64_t Allocate(uint64_t size, uint64_t alignment);
+
+		[[nodiscard]] uint64_t Used() const;
+		[[nodiscard]] uint64_t Capacity() const { return mCapacity; }
+
+	private:
+		std::atomic<uint64_t> mOffset   = 0;
+		uint64_t              mCapacity = 0;
+	};
+
+	/// @class UploadBlockCursor
+	/// @brief ワーカー1つが持つ切り出し口
+	/// @details ブロック単位でまとめて確保し、その中はアトミック無しで切り出します。
+	/// ブロックより大きいものと、ブロックを取れなくなった後は直接確保します
+	class UploadBlockCursor {
+	public:
+		static constexpr uint64_t kDefaultBlockSize = 64ull * 1024;
+		static constexpr uint64_t kBlockAlignment   = 256;
+
+		explicit UploadBlockCursor(
+			UploadSuballocator& source,
+			uint64_t            blockSize = kDefaultBlockSize
+		);
+
+		// @return フレーム先頭からのオフセット。足りなければ kInvalidOffset
+		[[nodiscard]] uint64_t Allocate(uint64_t size, uint64_t alignment);
+
+		// ブロックを取りに行った回数(アトミック操作の回数)
+		[[nodiscard]] uint32_t BlockCount() const { return mBlockCount; }
+
+	private:
+		UploadSuballocator* mSource     = nullptr;
+		uint64_t            mBlockSize  = 0;
+		uint64_t            mHead       = 0;
+		uint64_t            mEnd        = 0;
+		uint32_t            mBlockCount = 0;
+	};
+}
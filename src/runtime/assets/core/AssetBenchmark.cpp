@@ -0,0 +1,796 @@
+﻿#include <runtime/assets/core/AssetBenchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <engine/Animation/Animation.h>
+#include <engine/Animation/AnimationClip.h>
+#include <engine/subsystem/console/Log.h>
+
+#include <runtime/assets/core/UAssetManager.h>
+#include <runtime/assets/types/TextureAsset.h>
+#include <runtime/assets/loaders/AnimationLoader.h>
+#include <runtime/assets/loaders/CookedAnimationLoader.h>
+#include <runtime/assets/loaders/CookedMeshLoader.h>
+#include <runtime/assets/loaders/DirectXTexTextureLoader.h>
+#include <runtime/assets/loaders/MeshLoader.h>
+#include <runtime/assets/loaders/interface/IAssetLoader.h>
+
+namespace Unnamed::AssetBenchmark {
+	namespace {
+		constexpr std::string_view kChannel = "UAssetManager";
+
+		constexpr uint32_t kAssetCount     = 256;
+		constexpr uint32_t kOpsPerThread   = 200000;
+		constexpr size_t   kVertexCount    = 64;
+		constexpr auto     kReloadInterval = std::chrono::microseconds(100);
+
+		MeshAssetData MakeMesh() {
+			MeshAssetData mesh;
+			mesh.positions.assign(kVertexCount, Vec3::one);
+			return mesh;
+		}
+
+		std::string FormatName(const DXGI_FORMAT format) {
+			switch (format) {
+			case DXGI_FORMAT_R8G8B8A8_UNORM: return "RGBA8";
+			case DXGI_FORMAT_BC1_UNORM: return "BC1";
+			case DXGI_FORMAT_BC3_UNORM: return "BC3";
+			case DXGI_FORMAT_BC5_UNORM: return "BC5";
+			case DXGI_FORMAT_BC7_UNORM: return "BC7";
+			default: return std::format("DXGI_FORMAT({})",
+			                            static_cast<uint32_t>(format));
+			}
+		}
+
+		// 旧 AnimationManager が返していた Animation の大きさ(map のノードは中身だけ数える)
+		size_t AnimationBytes(const Animation& animation) {
+			size_t bytes = sizeof(Animation);
+			for (const auto& [name, node] : animation.nodeAnimations) {
+				bytes += sizeof(name) + name.capacity() + sizeof(node);
+				bytes += node.translate.keyFrames.capacity() * sizeof(KeyframeVec3);
+				bytes += node.rotate.keyFrames.capacity() * sizeof(KeyframeQuaternion);
+				bytes += node.scale.keyFrames.capacity() * sizeof(KeyframeVec3);
+			}
+			for (const auto& name : animation.nodeNames) {
+				bytes += sizeof(name) + name.capacity();
+			}
+			return bytes;
+		}
+
+		// 全チャンネルをフレームごとにサンプルして、ビット単位で同じか
+		bool SameClip(const AnimationClip& a, const AnimationClip& b) {
+			if (a.ChannelCount() != b.ChannelCount() ||
+				a.FrameCount() != b.FrameCount() ||
+				a.KeyCount() != b.KeyCount()) {
+				return false;
+			}
+			for (uint32_t frame = 0; frame < a.FrameCount(); ++frame) {
+				const float time = a.SampleRate() > 0.0f ?
+					                   static_cast<float>(frame) / a.SampleRate() :
+					                   0.0f;
+				for (uint32_t channel = 0; channel < a.ChannelCount(); ++channel) {
+					Vec3       ta, sa, tb, sb;
+					Quaternion ra, rb;
+					a.Sample(channel, time, ta, ra, sa);
+					b.Sample(channel, time, tb, rb, sb);
+					if (a.ChannelName(channel) != b.ChannelName(channel) ||
+						std::memcmp(&ta, &tb, sizeof(Vec3)) != 0 ||
+						std::memcmp(&ra, &rb, sizeof(Quaternion)) != 0 ||
+						std::memcmp(&sa, &sb, sizeof(Vec3)) != 0) {
+						return false;
+					}
+				}
+			}
+			return true;
+		}
+
+		// "bench://" のパスにメッシュを返すだけのローダー
+		class BenchLoader final : public IAssetLoader {
+		public:
+			bool CanLoad(
+				const std::string_view path, UASSET_TYPE* outType
+			) const override {
+				if (!path.starts_with("bench://")) {
+					return false;
+				}
+				if (outType) {
+					*outType = UASSET_TYPE::MESH;
+				}
+				return true;
+			}
+
+			LoadResult Load(const std::string& path) override {
+				if (onLoad) {
+					onLoad();
+				}
+				LoadResult r;
+				r.payload     = MakeMesh();
+				r.resolveName = path;
+				return r;
+			}
+
+			std::function<void()> onLoad; // 読み込み中に割り込ませる処理(確認用)
+		};
+
+		// リロードのローダーがロックの外で走り、読んでいる間に先を越されたら
+		// 古い結果を捨てるか確かめる
+		// @return 失敗した項目の数
+		int CountReloadLockFailures() {
+			UAssetManager manager;
+			auto          loader = std::make_unique<BenchLoader>();
+			BenchLoader*  hook   = loader.get();
+			manager.RegisterLoader(std::move(loader));
+			const AssetID id = manager.LoadFromFile("bench://reload", UASSET_TYPE::MESH);
+
+			// ロックを握ったままなら、別スレッドの書き込みはローダーが返るまで進まない
+			std::future<AssetID> writer;
+			bool                 unlocked = false;
+			hook->onLoad = [&] {
+				writer = std::async(std::launch::async, [&] {
+					return manager.Reserve("bench://other", UASSET_TYPE::MESH);
+				});
+				unlocked = writer.wait_for(std::chrono::seconds(1)) ==
+					std::future_status::ready;
+			};
+			manager.Reload(id);
+			writer.wait();
+
+			// 読んでいる間に別のリロードが公開したら、遅れて返った方は捨てる
+			const uint32_t version = manager.Meta(id).version;
+			bool           raced   = false;
+			hook->onLoad = [&] {
+				if (!std::exchange(raced, true)) {
+					manager.Reload(id);
+				}
+			};
+			const bool stalePublished = manager.Reload(id);
+			const bool bumpedOnce     = manager.Meta(id).version == version + 1;
+			hook->onLoad              = nullptr;
+
+			int failures = 0;
+			if (!unlocked) {
+				Warning(kChannel, "Reload held the manager lock while loading");
+				++failures;
+			}
+			if (stalePublished || !bumpedOnce) {
+				Warning(kChannel, "Reload published a result older than the current payload");
+				++failures;
+			}
+			return failures;
+		}
+
+		// 同じスロットを世代が一周するより多く使い回しても、古いIDが生き返らないか
+		bool StaleIdStaysInvalid() {
+			constexpr int kReuseCount = 300; // 8bitの世代が一周する以上
+
+			UAssetManager manager;
+			const AssetID first = manager.CreateRuntimeAsset(
+				UASSET_TYPE::MESH, "bench_wrap", MakeMesh()
+			);
+			for (int i = 0; i < kReuseCount; ++i) {
+				manager.UnloadUnused(); // 参照の無いランタイムアセットはスロットごと返る
+				manager.CreateRuntimeAsset(UASSET_TYPE::MESH, "bench_wrap", MakeMesh());
+				if (manager.IsValid(first)) {
+					Warning(kChannel, "stale asset id came back after {} reuses", i + 1);
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// 旧実装と同じく、全操作を1つの recursive_mutex で直列化するテーブル
+		class LegacyTable {
+		public:
+			explicit LegacyTable(const uint32_t count) : mNodes(count + 1) {
+				for (uint32_t id = 1; id <= count; ++id) {
+					mNodes[id].payload     = MakeMesh();
+					mNodes[id].meta.loaded = true;
+				}
+			}
+
+			void AddRef(const AssetID id) {
+				std::scoped_lock lock(mMutex);
+				if (id == kInvalidAssetID || id >= mNodes.size()) {
+					return;
+				}
+				mNodes[id].meta.strongRefs++;
+			}
+
+			void Release(const AssetID id) {
+				std::scoped_lock lock(mMutex);
+				if (id == kInvalidAssetID || id >= mNodes.size()) {
+					return;
+				}
+				auto& meta = mNodes[id].meta;
+				if (meta.strongRefs > 0) {
+					meta.strongRefs--;
+				}
+			}
+
+			const MeshAssetData* Get(const AssetID id) const {
+				std::scoped_lock lock(mMutex);
+				if (id == kInvalidAssetID || id >= mNodes.size()) {
+					return nullptr;
+				}
+				return std::get_if<MeshAssetData>(&mNodes[id].payload);
+			}
+
+			// 旧実装のリロードはペイロードを上書きするので、読み手が持つポインタが
+			// 壊れてしまう。ここではロックの取り方だけ再現してバージョンを進める
+			void Reload(const AssetID id) {
+				std::scoped_lock lock(mMutex);
+				mNodes[id].meta.version++;
+			}
+
+		private:
+			struct Node {
+				AssetMetaData meta;
+				AssetPayload  payload;
+			};
+
+			mutable std::recursive_mutex mMutex;
+			std::vector<Node>            mNodes;
+		};
+
+		struct Result {
+			double   opsPerSec = 0.0;
+			uint64_t failures  = 0;
+			uint64_t reloads   = 0;
+		};
+
+		/// @brief 読み手スレッドで read(id) を回し、その間書き手スレッドで reload(id) を続けます
+		/// @param read 1回分の AddRef / Get / Release。有効なペイロードが取れなければfalse
+		template <class ReadFn, class ReloadFn>
+		Result Measure(
+			const std::vector<AssetID>& ids,
+			const uint32_t              readerCount,
+			const ReadFn&               read,
+			const ReloadFn&             reload
+		) {
+			std::atomic<bool>     start    = false;
+			std::atomic<uint32_t> running  = readerCount;
+			std::atomic<uint64_t> failures = 0;
+			uint64_t              reloads  = 0;
+
+			std::vector<std::thread> readers;
+			readers.reserve(readerCount);
+			for (uint32_t t = 0; t < readerCount; ++t) {
+				readers.emplace_back([&, t] {
+					uint32_t state = 0x9E3779B9u * (t + 1);
+					uint64_t bad   = 0;
+					while (!start.load(std::memory_order_acquire)) {
+						std::this_thread::yield();
+					}
+					for (uint32_t i = 0; i < kOpsPerThread; ++i) {
+						// xorshift32
+						state ^= state << 13;
+						state ^= state >> 17;
+						state ^= state << 5;
+						if (!read(ids[state % ids.size()])) {
+							++bad;
+						}
+					}
+					failures.fetch_add(bad, std::memory_order_relaxed);
+					running.fetch_sub(1, std::memory_order_release);
+				});
+			}
+
+			const auto begin = std::chrono::steady_clock::now();
+			start.store(true, std::memory_order_release);
+
+			// このスレッドが書き手
+			uint32_t next = 0;
+			while (running.load(std::memory_order_acquire) > 0) {
+				reload(ids[next++ % ids.size()]);
+				++reloads;
+				std::this_thread::sleep_for(kReloadInterval);
+			}
+
+			for (auto& reader : readers) {
+				reader.join();
+			}
+			const double sec = std::chrono::duration<double>(
+				std::chrono::steady_clock::now() - begin
+			).count();
+
+			const double totalOps = static_cast<double>(kOpsPerThread) *
+				readerCount;
+			return {
+				.opsPerSec = sec > 0.0 ? totalOps / sec : 0.0,
+				.failures = failures.load(),
+				.reloads = reloads
+			};
+		}
+
+		template <class T>
+		bool SameBytes(const std::span<const T> a, const std::span<const T> b) {
+			return a.size() == b.size() &&
+				(a.empty() || std::memcmp(a.data(), b.data(), a.size_bytes()) == 0);
+		}
+
+		bool SameStreams(const MeshStreamView& a, const MeshStreamView& b) {
+			return SameBytes(a.positions, b.positions) &&
+				SameBytes(a.normals, b.normals) &&
+				SameBytes(a.tangents, b.tangents) &&
+				SameBytes(a.uv0, b.uv0) &&
+				SameBytes(a.color0, b.color0) &&
+				SameBytes(a.indices, b.indices) &&
+				SameBytes(a.submeshes, b.submeshes) &&
+				SameBytes(a.invBind, b.invBind) &&
+				SameBytes(a.joints, b.joints) &&
+				SameBytes(a.weights, b.weights);
+		}
+
+		// 数や範囲の合わないメッシュを焼いて、Map が弾くか確かめる
+		// @return 弾けなかった数(正しいメッシュを弾いた場合も数える)
+		int CountBadCookedMeshes(const std::filesystem::path& directory) {
+			MeshAssetData valid;
+			valid.positions = {Vec3::zero, Vec3::right, Vec3::up, Vec3::one};
+			valid.normals.assign(valid.positions.size(), Vec3::forward);
+			valid.uv0.assign(valid.positions.size(), Vec2(0.0f, 0.0f));
+			valid.indices = {0, 1, 2, 2, 1, 3};
+			valid.submeshes.resize(2);
+			valid.submeshes[0].indexCount  = 3;
+			valid.submeshes[1].indexOffset = 3;
+			valid.submeshes[1].indexCount  = 3;
+
+			const auto missingNormal = [](MeshAssetData& m) { m.normals.pop_back(); };
+			const auto missingUv     = [](MeshAssetData& m) { m.uv0.pop_back(); };
+			const auto shortTangents = [](MeshAssetData& m) {
+				m.tangents.assign(m.positions.size() - 1, Vec4(1, 0, 0, 1));
+			};
+			const auto indexOutOfRange = [](MeshAssetData& m) {
+				m.indices.back() = static_cast<uint32_t>(m.positions.size());
+			};
+			const auto submeshOutOfRange = [](MeshAssetData& m) {
+				m.submeshes.back().indexCount = 4;
+			};
+			const auto submeshOverflow = [](MeshAssetData& m) {
+				m.submeshes.back().indexOffset = UINT32_MAX;
+			};
+			const std::function<void(MeshAssetData&)> corruptions[] = {
+				missingNormal, missingUv, shortTangents,
+				indexOutOfRange, submeshOutOfRange, submeshOverflow,
+			};
+
+			const auto      path   = directory / "corrupt.umesh";
+			const FileStamp source = {};
+			int             failures = 0;
+			if (!CookedMeshLoader::Write(path, valid, source) ||
+				!CookedMeshLoader::Map(path, &source)) {
+				Warning(kChannel, "valid cooked mesh was rejected");
+				++failures;
+			}
+			for (const auto& corrupt : corruptions) {
+				MeshAssetData mesh = valid;
+				corrupt(mesh);
+				if (CookedMeshLoader::Write(path, mesh, source) &&
+					CookedMeshLoader::Map(path, &source)) {
+					++failures;
+				}
+			}
+			return failures;
+		}
+
+		// 読み込んだ後に実際にデータを触るところまでを計測に含める
+		float Touch(const MeshStreamView& s) {
+			float sum = 0.0f;
+			for (const Vec3& p : s.positions) {
+				sum += p.x;
+			}
+			for (const uint32_t i : s.indices) {
+				sum += static_cast<float>(i & 1);
+			}
+			return sum;
+		}
+	}
+
+	bool RunContention() {
+		const uint32_t readerCount = std::max(
+			4u, std::thread::hardware_concurrency()
+		);
+
+		// 旧実装
+		LegacyTable          legacy(kAssetCount);
+		std::vector<AssetID> legacyIds;
+		for (AssetID id = 1; id <= kAssetCount; ++id) {
+			legacyIds.emplace_back(id);
+		}
+		const Result legacyResult = Measure(
+			legacyIds, readerCount,
+			[&](const AssetID id) {
+				legacy.AddRef(id);
+				const MeshAssetData* mesh = legacy.Get(id);
+				const bool ok = mesh && mesh->positions.size() == kVertexCount;
+				legacy.Release(id);
+				return ok;
+			},
+			[&](const AssetID id) { legacy.Reload(id); }
+		);
+
+		// スロットテーブル
+		UAssetManager manager;
+		manager.RegisterLoader(std::make_unique<BenchLoader>());
+		std::vector<AssetID> ids;
+		for (uint32_t i = 0; i < kAssetCount; ++i) {
+			ids.emplace_back(manager.LoadFromFile(
+				std::format("bench://mesh_{}", i), UASSET_TYPE::MESH
+			));
+		}
+		const Result tableResult = Measure(
+			ids, readerCount,
+			[&](const AssetID id) {
+				manager.AddRef(id);
+				const auto* mesh = manager.Get<MeshAssetData>(id);
+				const bool  ok   = mesh && mesh->positions.size() == kVertexCount;
+				manager.Release(id);
+				return ok;
+			},
+			[&](const AssetID id) { manager.Reload(id); }
+		);
+		// 読み手が全員抜けたので退役したペイロードを解放できる
+		const size_t retired = manager.CollectRetired();
+
+		// 参照カウントが全て戻っているか
+		uint64_t leakedRefs = 0;
+		for (const AssetID id : ids) {
+			leakedRefs += manager.Meta(id).strongRefs;
+		}
+
+		Msg(
+			kChannel,
+			"[{} threads] mutex {:.2f} Mops/s ({} reloads) / "
+			"slot table {:.2f} Mops/s ({} reloads, {} retired) x{:.2f}",
+			readerCount,
+			legacyResult.opsPerSec / 1e6, legacyResult.reloads,
+			tableResult.opsPerSec / 1e6, tableResult.reloads, retired,
+			legacyResult.opsPerSec > 0.0 ?
+				tableResult.opsPerSec / legacyResult.opsPerSec :
+				0.0
+		);
+
+		const bool ok = tableResult.failures == 0 && leakedRefs == 0;
+		if (!ok) {
+			Warning(
+				kChannel,
+				"asset contention check failed: {} invalid reads, {} leaked refs",
+				tableResult.failures, leakedRefs
+			);
+		}
+		return ok && CountReloadLockFailures() == 0 && StaleIdStaysInvalid();
+	}
+
+	bool RunMeshLoad(const std::string& root) {
+		constexpr int kWarmIterations = 10;
+		const auto    cookDirectory   = std::filesystem::path("./cache/meshes_bench");
+
+		MeshLoader assimpLoader("");
+		MeshLoader cookingLoader(cookDirectory);
+
+		std::vector<std::string> paths;
+		std::error_code          ec;
+		for (const auto& entry :
+		     std::filesystem::recursive_directory_iterator(root, ec)) {
+			if (entry.is_regular_file() &&
+				assimpLoader.CanLoad(entry.path().string(), nullptr)) {
+				paths.emplace_back(entry.path().generic_string());
+			}
+		}
+		if (paths.empty()) {
+			Warning(kChannel, "No meshes found under '{}'.", root);
+			return false;
+		}
+
+		bool   ok          = true;
+		double assimpTotal = 0.0;
+		double cookedTotal = 0.0;
+		for (const auto& path : paths) {
+			const auto ms = [](const auto begin) {
+				return std::chrono::duration<double, std::milli>(
+					std::chrono::steady_clock::now() - begin
+				).count();
+			};
+
+			// Assimp のみ
+			auto       begin     = std::chrono::steady_clock::now();
+			LoadResult reference = assimpLoader.Load(path);
+			const auto* refMesh  = std::get_if<MeshAssetData>(&reference.payload);
+			float      sink      = refMesh ? Touch(refMesh->Streams()) : 0.0f;
+			const double assimpMs = ms(begin);
+			if (!refMesh) {
+				Warning(kChannel, "Failed to load '{}' with Assimp.", path);
+				continue;
+			}
+
+			// 焼く(初回読み込み)
+			std::filesystem::remove(cookingLoader.CookedPathFor(path), ec);
+			begin = std::chrono::steady_clock::now();
+			cookingLoader.Load(path);
+			const double cookMs = ms(begin);
+
+			// 焼いたものをマップする
+			double cookedMs = 0.0;
+			bool   same     = true;
+			for (int i = 0; i < kWarmIterations; ++i) {
+				begin             = std::chrono::steady_clock::now();
+				LoadResult cooked = cookingLoader.Load(path);
+				const auto* mesh  = std::get_if<MeshAssetData>(&cooked.payload);
+				sink += mesh ? Touch(mesh->Streams()) : 0.0f;
+				cookedMs += ms(begin);
+
+				same = same && mesh && mesh->mappedFile &&
+					SameStreams(mesh->Streams(), refMesh->Streams()) &&
+					mesh->morphTargets.size() == refMesh->morphTargets.size() &&
+					mesh->skin.jointNames == refMesh->skin.jointNames;
+			}
+			cookedMs /= kWarmIterations;
+
+			assimpTotal += assimpMs;
+			cookedTotal += cookedMs;
+			ok = ok && same;
+
+			const MeshStreamView streams = refMesh->Streams();
+			Msg(
+				kChannel,
+				"{}: {} verts / {} indices, assimp {:.2f} ms, cook {:.2f} ms, "
+				"cooked {:.3f} ms x{:.1f}{}",
+				path,
+				streams.positions.size(), streams.indices.size(),
+				assimpMs, cookMs, cookedMs,
+				cookedMs > 0.0 ? assimpMs / cookedMs : 0.0,
+				same ? "" : " (MISMATCH)"
+			);
+			DevMsg(kChannel, "checksum {}", sink);
+		}
+
+		Msg(
+			kChannel,
+			"{} meshes: assimp {:.2f} ms / cooked {:.3f} ms x{:.1f}",
+			paths.size(), assimpTotal, cookedTotal,
+			cookedTotal > 0.0 ? assimpTotal / cookedTotal : 0.0
+		);
+
+		const int accepted = CountBadCookedMeshes(cookDirectory);
+		if (accepted != 0) {
+			Warning(kChannel, "cooked mesh validation failed in {} cases", accepted);
+			ok = false;
+		}
+		std::filesystem::remove_all(cookDirectory, ec);
+		return ok;
+	}
+
+	bool RunTextureLoad(const std::string& root) {
+		constexpr int kWarmIterations = 5;
+		const auto    cookDirectory   = std::filesystem::path("./cache/textures_bench");
+
+		DirectXTexTextureLoader rgbaLoader("");
+		DirectXTexTextureLoader cookingLoader(cookDirectory);
+
+		std::vector<std::string> paths;
+		std::error_code          ec;
+		for (const auto& entry :
+		     std::filesystem::recursive_directory_iterator(root, ec)) {
+			if (entry.is_regular_file() &&
+				rgbaLoader.CanLoad(entry.path().string(), nullptr)) {
+				paths.emplace_back(entry.path().generic_string());
+			}
+		}
+		if (paths.empty()) {
+			Warning(kChannel, "No textures found under '{}'.", root);
+			return false;
+		}
+
+		const auto ms = [](const auto begin) {
+			return std::chrono::duration<double, std::milli>(
+				std::chrono::steady_clock::now() - begin
+			).count();
+		};
+
+		bool   ok         = true;
+		double rgbaTotal  = 0.0;
+		double bcTotal    = 0.0;
+		size_t rgbaBytes  = 0;
+		size_t bcBytes    = 0;
+		size_t compressed = 0;
+		for (const auto& path : paths) {
+			// 毎回RGBA8へ変換してミップを作る
+			auto        begin     = std::chrono::steady_clock::now();
+			LoadResult  reference = rgbaLoader.Load(path);
+			const auto* refTex    = std::get_if<TextureAssetData>(&reference.payload);
+			const double rgbaMs   = ms(begin);
+			if (!refTex) {
+				Warning(kChannel, "Failed to load '{}'.", path);
+				continue;
+			}
+
+			// 焼く(初回読み込み)
+			begin = std::chrono::steady_clock::now();
+			cookingLoader.Load(path);
+			const double cookMs = ms(begin);
+
+			// 焼いたものを読む
+			double     bcMs = 0.0;
+			LoadResult cooked;
+			for (int i = 0; i < kWarmIterations; ++i) {
+				begin  = std::chrono::steady_clock::now();
+				cooked = cookingLoader.Load(path);
+				bcMs += ms(begin);
+			}
+			bcMs /= kWarmIterations;
+			const auto* tex = std::get_if<TextureAssetData>(&cooked.payload);
+
+			// 解像度とミップ数は変わらないはず
+			const bool same = tex &&
+				tex->width == refTex->width && tex->height == refTex->height &&
+				tex->mips.size() == refTex->mips.size();
+			ok = ok && same;
+			if (!tex) {
+				continue;
+			}
+
+			const size_t refUpload = refTex->UploadBytes();
+			const size_t upload    = tex->UploadBytes();
+			rgbaTotal += rgbaMs;
+			bcTotal += bcMs;
+			rgbaBytes += refUpload;
+			bcBytes += upload;
+			compressed += tex->format != refTex->format ? 1 : 0;
+
+			Msg(
+				kChannel,
+				"{}: {}x{} {} mips, rgba8 {:.2f} ms / {} KiB, cook {:.2f} ms, "
+				"format {} {:.2f} ms / {} KiB{}",
+				path, refTex->width, refTex->height, refTex->mips.size(),
+				rgbaMs, refUpload / 1024, cookMs,
+				FormatName(tex->format), bcMs, upload / 1024,
+				same ? "" : " (MISMATCH)"
+			);
+		}
+
+		Msg(
+			kChannel,
+			"{} textures ({} compressed): rgba8 {:.2f} ms / {} KiB, "
+			"cooked {:.2f} ms / {} KiB",
+			paths.size(), compressed, rgbaTotal, rgbaBytes / 1024,
+			bcTotal, bcBytes / 1024
+		);
+		std::filesystem::remove_all(cookDirectory, ec);
+		return ok;
+	}
+
+	bool RunAnimationLoad(const std::string& root) {
+		constexpr int kWarmIterations = 10;
+		constexpr int kLegacyImports  = 3; // 名前の一覧、全アニメーション、名前指定でそれぞれ読み直していた
+		const auto    cookDirectory   = std::filesystem::path("./cache/animations_bench");
+
+		AnimationLoader cookingLoader(cookDirectory);
+
+		std::vector<std::string> paths;
+		std::error_code          ec;
+		for (const auto& entry :
+		     std::filesystem::recursive_directory_iterator(root, ec)) {
+			const std::string path = entry.path().generic_string();
+			if (entry.is_regular_file() &&
+				cookingLoader.CanLoad(AnimationLoader::AssetPathFor(path), nullptr)) {
+				paths.emplace_back(path);
+			}
+		}
+
+		const auto ms = [](const auto begin) {
+			return std::chrono::duration<double, std::milli>(
+				std::chrono::steady_clock::now() - begin
+			).count();
+		};
+
+		// リロードは共有のマネージャーを通す
+		UAssetManager manager;
+		manager.RegisterLoader(std::make_unique<AnimationLoader>(cookDirectory));
+
+		bool   ok          = true;
+		size_t fileCount   = 0;
+		double legacyTotal = 0.0;
+		double cookedTotal = 0.0;
+		size_t legacyBytes = 0;
+		size_t clipBytes   = 0;
+		for (const auto& path : paths) {
+			// Assimp で読んでキーフレームの Animation にするまで(旧実装の1回分)
+			std::vector<std::string> names;
+			std::vector<Animation>   animations;
+			auto                     begin = std::chrono::steady_clock::now();
+			if (!AnimationLoader::Import(path, names, animations)) {
+				continue; // アニメーションの無いモデル
+			}
+			const double importMs = ms(begin);
+
+			size_t fileLegacyBytes = 0;
+			for (const Animation& animation : animations) {
+				fileLegacyBytes += AnimationBytes(animation);
+			}
+
+			// 焼く(初回読み込み)
+			const std::string assetPath = AnimationLoader::AssetPathFor(path);
+			std::filesystem::remove(cookingLoader.CookedPathFor(path), ec);
+			begin = std::chrono::steady_clock::now();
+			cookingLoader.Load(assetPath);
+			const double cookMs = ms(begin);
+
+			// 焼いたものを読む
+			double cookedMs  = 0.0;
+			size_t fileBytes = 0;
+			bool   same      = true;
+			for (int i = 0; i < kWarmIterations; ++i) {
+				begin             = std::chrono::steady_clock::now();
+				LoadResult cooked = cookingLoader.Load(assetPath);
+				cookedMs += ms(begin);
+
+				const auto* data = std::get_if<AnimationAssetData>(&cooked.payload);
+				same             = same && data && data->names == names;
+				if (!same) {
+					break;
+				}
+				fileBytes = data->MemoryBytes();
+				if (i == 0) {
+					for (size_t c = 0; c < animations.size(); ++c) {
+						same = same && SameClip(*data->clips[c], AnimationClip(animations[c]));
+					}
+				}
+			}
+			cookedMs /= kWarmIterations;
+
+			// リロードしても、先に配ったハンドルは古いクリップを指したまま使える
+			const AssetID id       = manager.LoadFromFile(assetPath, UASSET_TYPE::ANIMATION);
+			const auto*   loaded   = manager.Get<AnimationAssetData>(id);
+			const auto    handle   = loaded ? loaded->clips.front() : nullptr;
+			const bool    reloaded = handle && manager.Reload(id);
+			manager.CollectRetired();
+			const auto* current = manager.Get<AnimationAssetData>(id);
+			const bool  swapped = reloaded && current &&
+				current->clips.front() != handle &&
+				SameClip(*current->clips.front(), *handle) &&
+				manager.Meta(id).version == 1;
+
+			++fileCount;
+			legacyTotal += importMs * kLegacyImports;
+			cookedTotal += cookedMs;
+			legacyBytes += fileLegacyBytes;
+			clipBytes += fileBytes;
+			ok = ok && same && swapped;
+
+			Msg(
+				kChannel,
+				"{}: {} clips, assimp {:.2f} ms x{} calls / {} KiB, cook {:.2f} ms, "
+				"cooked {:.3f} ms / {} KiB{}{}",
+				path, animations.size(),
+				importMs, kLegacyImports, fileLegacyBytes / 1024, cookMs,
+				cookedMs, fileBytes / 1024,
+				same ? "" : " (MISMATCH)",
+				swapped ? "" : " (RELOAD FAILED)"
+			);
+		}
+
+		if (fileCount == 0) {
+			Warning(kChannel, "No animations found under '{}'.", root);
+			return false;
+		}
+
+		Msg(
+			kChannel,
+			"{} files: legacy {:.2f} ms / {} KiB, cooked {:.3f} ms / {} KiB x{:.1f}",
+			fileCount, legacyTotal, legacyBytes / 1024, cookedTotal, clipBytes / 1024,
+			cookedTotal > 0.0 ? legacyTotal / cookedTotal : 0.0
+		);
+		std::filesystem::remove_all(cookDirectory, ec);
+		return ok;
+	}
+}
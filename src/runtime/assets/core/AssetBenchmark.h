@@ -0,0 +1,26 @@
+﻿#pragma once
+#include <string>
+
+namespace Unnamed::AssetBenchmark {
+	// 複数スレッドから AddRef / Get / Release を叩きつつ別スレッドでリロードを続け、
+	// 旧実装(全操作を1つの recursive_mutex で直列化)とスロットテーブルの
+	// スループットを比べてログに出します
+	// @return 新実装の読み出しが全て有効なペイロードを返したらtrue
+	bool RunContention();
+
+	// content/ 以下のメッシュを Assimp で読み込む場合と、焼いたもの(.umesh)を
+	// マップする場合の読み込み時間を比べてログに出します(ストリームの一致も確認)
+	// @return 全メッシュで焼いたものが Assimp の結果と一致したらtrue
+	bool RunMeshLoad(const std::string& root = "./content");
+
+	// content/ 以下のテクスチャを毎回RGBA8へ変換する場合と、焼いたBC圧縮DDSを
+	// 読む場合の読み込み時間とアップロードするバイト数を比べてログに出します
+	// @return 全テクスチャで解像度とミップ数が一致したらtrue
+	bool RunTextureLoad(const std::string& root = "./content");
+
+	// content/ 以下のモデルに入っているアニメーションを、旧 AnimationManager のように
+	// 呼び出しごとに Assimp で読み直す場合と、アセットとして1回だけ読み込み、焼いたもの(.uanim)を
+	// 読む場合の時間とメモリを比べてログに出します。リロード後も配ったクリップが使えるかも確認します
+	// @return 全ファイルで焼いたクリップが元と同じ値をサンプルし、リロードできたらtrue
+	bool RunAnimationLoad(const std::string& root = "./content");
+}
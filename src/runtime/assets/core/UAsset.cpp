@@ -1,4 +1,22 @@
 ﻿#include "UAsset.h"
 
 namespace Unnamed {
+	bool ReadFileStamp(const std::filesystem::path& path, FileStamp& outStamp) {
+		std::error_code ec;
+		const auto      writeTime = std::filesystem::last_write_time(path, ec);
+		if (ec) {
+			return false;
+		}
+		const uint64_t size = std::filesystem::file_size(path, ec);
+		if (ec) {
+			return false;
+		}
+
+		outStamp.lastWrite = std::chrono::time_point_cast<
+			std::chrono::system_clock::duration>(
+			std::chrono::file_clock::to_sys(writeTime)
+		);
+		outStamp.sizeInBytes = size;
+		return true;
+	}
 }
@@ -1,10 +1,12 @@
 ﻿#pragma once
 #include <chrono>
 #include <cstdint>
+#include <filesystem>
 #include <string>
 #include <variant>
 
 #include <runtime/assets/core/UAssetID.h>
+#include <runtime/assets/types/AnimationAsset.h>
 #include <runtime/assets/types/MaterialAsset.h>
 #include <runtime/assets/types/MeshAsset.h>
 #include <runtime/assets/types/RawFileAsset.h>
@@ -18,14 +20,19 @@ namespace Unnamed {
 		uint64_t                              sizeInBytes = 0;
 	};
 
+	/// @brief ファイルの更新時刻とサイズを取得します
+	/// @return ファイルが無ければfalse
+	bool ReadFileStamp(const std::filesystem::path& path, FileStamp& outStamp);
+
 	enum class UASSET_TYPE : uint8_t {
-		UNKNOWN  = 1 << 0,
-		TEXTURE  = 1 << 1,
-		SHADER   = 1 << 2,
-		MATERIAL = 1 << 3,
-		MESH     = 1 << 4,
-		SOUND    = 1 << 5,
-		RAWFILE  = 1 << 6,
+		UNKNOWN   = 1 << 0,
+		TEXTURE   = 1 << 1,
+		SHADER    = 1 << 2,
+		MATERIAL  = 1 << 3,
+		MESH      = 1 << 4,
+		SOUND     = 1 << 5,
+		RAWFILE   = 1 << 6,
+		ANIMATION = 1 << 7,
 	};
 
 	const char* ToString(UASSET_TYPE e);
@@ -42,7 +49,8 @@ namespace Unnamed {
 		MaterialAssetData,
 		MeshAssetData,
 		SoundAssetData,
-		RawFileAssetData
+		RawFileAssetData,
+		AnimationAssetData
 	>;
 
 	struct AssetMetaData {
@@ -0,0 +1,280 @@
+﻿#include <pch.h>
+
+//-----------------------------------------------------------------------------
+
+#include "UAssetLoadQueue.h"
+
+#include <runtime/assets/core/UAssetManager.h>
+
+namespace Unnamed {
+	constexpr std::string_view kChannel = "UAssetLoadQueue";
+
+	const char* ToString(const UASSET_LOAD_STATE e) {
+		switch (e) {
+		case UASSET_LOAD_STATE::QUEUED: return "QUEUED";
+		case UASSET_LOAD_STATE::LOADING: return "LOADING";
+		case UASSET_LOAD_STATE::READY: return "READY";
+		case UASSET_LOAD_STATE::FAILED: return "FAILED";
+		default: return "unknown";
+		}
+	}
+
+	AssetID AssetLoadHandle::ID() const {
+		return mLoad ? mLoad->id : kInvalidAssetID;
+	}
+
+	UASSET_LOAD_STATE AssetLoadHandle::State() const {
+		return mLoad ?
+			       mLoad->state.load(std::memory_order_acquire) :
+			       UASSET_LOAD_STATE::FAILED;
+	}
+
+	bool AssetLoadHandle::IsDone() const {
+		const UASSET_LOAD_STATE s = State();
+		return s == UASSET_LOAD_STATE::READY || s == UASSET_LOAD_STATE::FAILED;
+	}
+
+	UASSET_LOAD_STATE AssetLoadHandle::Wait() const {
+		if (!mLoad) {
+			return UASSET_LOAD_STATE::FAILED;
+		}
+		UASSET_LOAD_STATE s = mLoad->state.load(std::memory_order_acquire);
+		while (s != UASSET_LOAD_STATE::READY && s != UASSET_LOAD_STATE::FAILED) {
+			mLoad->state.wait(s);
+			s = mLoad->state.load(std::memory_order_acquire);
+		}
+		return s;
+	}
+
+	UAssetLoadQueue::UAssetLoadQueue(
+		UAssetManager& manager,
+		uint32_t       workerCount
+	) : mManager(manager) {
+		if (workerCount == 0) {
+			// ファイル待ちとデコードが混ざるので半分くらいで十分
+			workerCount = std::max(2u, std::thread::hardware_concurrency() / 2);
+		}
+
+		mWorkers.reserve(workerCount);
+		for (uint32_t i = 0; i < workerCount; ++i) {
+			mWorkers.emplace_back([this] { WorkerMain(); });
+		}
+	}
+
+	UAssetLoadQueue::~UAssetLoadQueue() {
+		{
+			std::lock_guard lock(mMutex);
+			mStop = true;
+		}
+		mWakeCv.notify_all();
+		for (auto& worker : mWorkers) {
+			if (worker.joinable()) {
+				worker.join();
+			}
+		}
+
+		// 待っている人を起こしてから終わる
+		std::lock_guard lock(mMutex);
+		while (!mInFlight.empty()) {
+			const auto load = mInFlight.begin()->second;
+			Finish(load, UASSET_LOAD_STATE::FAILED);
+		}
+	}
+
+	AssetLoadHandle UAssetLoadQueue::Enqueue(
+		const AssetID                    id,
+		const std::optional<UASSET_TYPE> type,
+		const UASSET_LOAD_PRIORITY       priority
+	) {
+		const bool loaded = mManager.IsLoaded(id);
+
+		std::lock_guard lock(mMutex);
+		if (const auto it = mInFlight.find(id); it != mInFlight.end()) {
+			Raise(it->second, priority);
+			return AssetLoadHandle(it->second);
+		}
+
+		auto load      = std::make_shared<AsyncAssetLoad>();
+		load->id       = id;
+		load->type     = type;
+		load->priority = priority;
+
+		if (loaded) {
+			load->state     = UASSET_LOAD_STATE::READY;
+			load->published = true;
+			return AssetLoadHandle(load);
+		}
+
+		mInFlight.emplace(id, load);
+		Push(load, priority);
+		return AssetLoadHandle(load);
+	}
+
+	void UAssetLoadQueue::SetPriority(
+		const AssetID              id,
+		const UASSET_LOAD_PRIORITY priority
+	) {
+		std::lock_guard lock(mMutex);
+		if (const auto it = mInFlight.find(id); it != mInFlight.end()) {
+			Raise(it->second, priority);
+		}
+	}
+
+	size_t UAssetLoadQueue::InFlightCount() const {
+		std::lock_guard lock(mMutex);
+		return mInFlight.size();
+	}
+
+	void UAssetLoadQueue::WorkerMain() {
+		// WIC のデコードに COM が要る
+		CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+		for (;;) {
+			std::shared_ptr<AsyncAssetLoad> load;
+			{
+				std::unique_lock lock(mMutex);
+				mWakeCv.wait(lock, [this] {
+					return mStop || !mQueue.empty();
+				});
+				if (mStop) {
+					break;
+				}
+				const Entry entry = mQueue.top();
+				mQueue.pop();
+
+				// 優先度を上げた時に積み直した古いエントリは読み飛ばす
+				if (entry.load->state.load() != UASSET_LOAD_STATE::QUEUED ||
+					entry.priority != entry.load->priority.load()) {
+					continue;
+				}
+				load = entry.load;
+				load->state.store(UASSET_LOAD_STATE::LOADING);
+			}
+
+			std::vector<AssetID> dependencies;
+			const bool           ok = mManager.LoadSlot(
+				load->id, load->type, &dependencies
+			);
+
+			// マネージャーへの問い合わせはキューのロックを取る前に済ませる
+			if (!ok) {
+				Warning(
+					kChannel,
+					"Failed to load: {}",
+					mManager.Meta(load->id).sourcePath
+				);
+				std::lock_guard lock(mMutex);
+				Finish(load, UASSET_LOAD_STATE::FAILED);
+				continue;
+			}
+			const std::vector<Dependency> pending = ResolveDependencies(
+				load->id, dependencies
+			);
+
+			std::lock_guard lock(mMutex);
+			load->published = true;
+			ScheduleDependencies(load, pending);
+			if (load->pendingDeps == 0) {
+				Finish(load, UASSET_LOAD_STATE::READY);
+			}
+		}
+
+		CoUninitialize();
+	}
+
+	std::vector<UAssetLoadQueue::Dependency> UAssetLoadQueue::ResolveDependencies(
+		const AssetID               id,
+		const std::vector<AssetID>& dependencies
+	) const {
+		std::vector<Dependency> pending;
+		pending.reserve(dependencies.size());
+		for (const AssetID dep : dependencies) {
+			if (dep == id || !mManager.IsValid(dep)) {
+				continue;
+			}
+			const AssetMetaData meta = mManager.Meta(dep);
+			if (meta.loaded || meta.sourcePath.empty()) {
+				continue;
+			}
+			pending.push_back({dep, meta.type});
+		}
+		return pending;
+	}
+
+	void UAssetLoadQueue::Push(
+		const std::shared_ptr<AsyncAssetLoad>& load,
+		const UASSET_LOAD_PRIORITY             priority
+	) {
+		mQueue.push({priority, mSequence++, load});
+		mWakeCv.notify_one();
+	}
+
+	void UAssetLoadQueue::Raise(
+		const std::shared_ptr<AsyncAssetLoad>& load,
+		const UASSET_LOAD_PRIORITY             priority
+	) {
+		if (priority <= load->priority.load()) {
+			return;
+		}
+		load->priority.store(priority);
+		// キュー待ちなら新しい優先度で積み直す(古いエントリは取り出した時に捨てる)
+		if (load->state.load() == UASSET_LOAD_STATE::QUEUED) {
+			Push(load, priority);
+		}
+	}
+
+	void UAssetLoadQueue::ScheduleDependencies(
+		const std::shared_ptr<AsyncAssetLoad>& load,
+		const std::vector<Dependency>&         dependencies
+	) {
+		const UASSET_LOAD_PRIORITY priority = load->priority.load();
+		for (const auto& [dep, type] : dependencies) {
+			std::shared_ptr<AsyncAssetLoad> depLoad;
+			if (const auto it = mInFlight.find(dep); it != mInFlight.end()) {
+				depLoad = it->second;
+				// 公開済みのものは待たない(循環依存でお互いを待たないように)
+				if (depLoad->published) {
+					continue;
+				}
+				Raise(depLoad, priority);
+			} else {
+				depLoad           = std::make_shared<AsyncAssetLoad>();
+				depLoad->id       = dep;
+				depLoad->priority = priority;
+				if (type != UASSET_TYPE::UNKNOWN) {
+					depLoad->type = type;
+				}
+				mInFlight.emplace(dep, depLoad);
+				Push(depLoad, priority);
+			}
+
+			depLoad->waiters.emplace_back(load);
+			++load->pendingDeps;
+		}
+	}
+
+	void UAssetLoadQueue::Finish(
+		const std::shared_ptr<AsyncAssetLoad>& load,
+		const UASSET_LOAD_STATE                state
+	) {
+		mInFlight.erase(load->id);
+		load->state.store(state, std::memory_order_release);
+		load->state.notify_all();
+
+		// 依存が読めなかった親は、待ちが解けた時に FAILED にする
+		// (ペイロードは公開済みなので、親自体は取り出せる)
+		auto waiters = std::move(load->waiters);
+		for (const auto& parent : waiters) {
+			parent->depFailed |= state == UASSET_LOAD_STATE::FAILED;
+			if (--parent->pendingDeps == 0 &&
+				parent->state.load() == UASSET_LOAD_STATE::LOADING) {
+				Finish(
+					parent,
+					parent->depFailed ?
+						UASSET_LOAD_STATE::FAILED :
+						UASSET_LOAD_STATE::READY
+				);
+			}
+		}
+	}
+}
@@ -0,0 +1,146 @@
+﻿#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <runtime/assets/core/UAsset.h>
+
+namespace Unnamed {
+	class UAssetManager;
+
+	enum class UASSET_LOAD_STATE : uint8_t {
+		QUEUED,  // キュー待ち
+		LOADING, // 読み込み中、または依存の完了待ち
+		READY,   // 自身と依存が全て読み込み済み
+		FAILED,  // 自身か依存のどれかが読み込めなかった
+	};
+
+	// 大きいほど先に読み込みます
+	enum class UASSET_LOAD_PRIORITY : uint8_t {
+		BACKGROUND,
+		NORMAL,
+		VISIBLE, // 画面に映っているもの
+	};
+
+	const char* ToString(UASSET_LOAD_STATE e);
+
+	// 1アセット分の非同期ロードの状態
+	struct AsyncAssetLoad {
+		AssetID                           id = kInvalidAssetID;
+		std::optional<UASSET_TYPE>        type;
+		std::atomic<UASSET_LOAD_STATE>    state    = UASSET_LOAD_STATE::QUEUED;
+		std::atomic<UASSET_LOAD_PRIORITY> priority = UASSET_LOAD_PRIORITY::NORMAL;
+
+		// 以下はキューのロックで保護
+		bool     published   = false; // ペイロードを公開済み(依存待ちのみ)
+		uint32_t pendingDeps = 0;
+		bool     depFailed   = false; // 依存のどれかが読み込めなかった
+		std::vector<std::shared_ptr<AsyncAssetLoad>> waiters; // これの完了を待つ親
+	};
+
+	/// @class AssetLoadHandle
+	/// @brief LoadAsync の結果。状態の問い合わせと完了待ちができます
+	class AssetLoadHandle {
+	public:
+		AssetLoadHandle() = default;
+		explicit AssetLoadHandle(std::shared_ptr<AsyncAssetLoad> load)
+			: mLoad(std::move(load)) {
+		}
+
+		[[nodiscard]] AssetID           ID() const;
+		[[nodiscard]] UASSET_LOAD_STATE State() const;
+		[[nodiscard]] bool              IsDone() const;
+
+		/// @brief READY か FAILED になるまで待ちます
+		/// @details ロードワーカー上(ローダーの中)から呼ぶとデッドロックします
+		UASSET_LOAD_STATE Wait() const;
+
+	private:
+		std::shared_ptr<AsyncAssetLoad> mLoad;
+	};
+
+	/// @class UAssetLoadQueue
+	/// @brief 優先度付きのアセット読み込みワーカー
+	/// @details ワーカーはマネージャーのロックを持たずにローダーを走らせます。
+	/// 読み込み後に LoadResult::dependencies を見て未ロードの依存を同じ優先度で積み、
+	/// 依存が全て揃った時点で READY にします。依存が1つでも読めなければ FAILED です。
+	/// マネージャーへの問い合わせはキューのロックの外で行います
+	class UAssetLoadQueue {
+	public:
+		/// @param workerCount ワーカー数。0ならハードウェアスレッド数の半分
+		explicit UAssetLoadQueue(UAssetManager& manager, uint32_t workerCount = 0);
+		~UAssetLoadQueue();
+
+		UAssetLoadQueue(const UAssetLoadQueue&)            = delete;
+		UAssetLoadQueue& operator=(const UAssetLoadQueue&) = delete;
+
+		// 既に読み込み中なら同じロードを返し、優先度だけ引き上げます
+		AssetLoadHandle Enqueue(
+			AssetID                    id,
+			std::optional<UASSET_TYPE> type,
+			UASSET_LOAD_PRIORITY       priority
+		);
+
+		void SetPriority(AssetID id, UASSET_LOAD_PRIORITY priority);
+
+		// キュー待ちと読み込み中の数
+		[[nodiscard]] size_t InFlightCount() const;
+
+	private:
+		struct Entry {
+			UASSET_LOAD_PRIORITY            priority;
+			uint64_t                        sequence; // 同じ優先度なら先着順
+			std::shared_ptr<AsyncAssetLoad> load;
+
+			bool operator<(const Entry& other) const {
+				if (priority != other.priority) {
+					return priority < other.priority;
+				}
+				return sequence > other.sequence;
+			}
+		};
+
+		// 読み込みが要る依存
+		struct Dependency {
+			AssetID     id;
+			UASSET_TYPE type;
+		};
+
+		void WorkerMain();
+
+		// ロックを持たずに呼ぶ(マネージャーに問い合わせる)
+		std::vector<Dependency> ResolveDependencies(
+			AssetID                     id,
+			const std::vector<AssetID>& dependencies
+		) const;
+
+		// 以下はロックを持った状態で呼ぶ
+		void Push(const std::shared_ptr<AsyncAssetLoad>& load,
+		          UASSET_LOAD_PRIORITY                   priority);
+		void Raise(const std::shared_ptr<AsyncAssetLoad>& load,
+		           UASSET_LOAD_PRIORITY                   priority);
+		void ScheduleDependencies(const std::shared_ptr<AsyncAssetLoad>& load,
+		                          const std::vector<Dependency>& dependencies);
+		void Finish(const std::shared_ptr<AsyncAssetLoad>& load,
+		            UASSET_LOAD_STATE                      state);
+
+	private:
+		UAssetManager& mManager;
+
+		std::vector<std::thread>   mWorkers;
+		mutable std::mutex         mMutex;
+		std::condition_variable    mWakeCv;
+		std::priority_queue<Entry> mQueue;
+		uint64_t                   mSequence = 0;
+		bool                       mStop     = false;
+
+		std::unordered_map<AssetID, std::shared_ptr<AsyncAssetLoad>> mInFlight;
+	};
+}
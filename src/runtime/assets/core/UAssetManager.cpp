@@ -3,6 +3,7 @@
 #include <pch.h>
 
 #include <filesystem>
+#include <utility>
 
 #include "UAsset.h"
 
@@ -21,12 +22,22 @@ namespace Unnamed {
 		case UASSET_TYPE::MATERIAL: return "MATERIAL";
 		case UASSET_TYPE::MESH: return "MESH";
 		case UASSET_TYPE::SOUND: return "SOUND";
+		case UASSET_TYPE::ANIMATION: return "ANIMATION";
 		default: return "unknown";
 		}
 	}
 
 	UAssetManager::UAssetManager() = default;
 
+	UAssetManager::~UAssetManager() {
+		// ワーカーがスロットを触らなくなってから解放する
+		mLoadQueue.reset();
+
+		for (auto& page : mPages) {
+			delete page.load(std::memory_order_relaxed);
+		}
+	}
+
 	/// @brief アセットローダーを登録します
 	/// @param loader 登録するローダー
 	void UAssetManager::RegisterLoader(std::unique_ptr<IAssetLoader> loader) {
@@ -41,55 +52,77 @@ namespace Unnamed {
 		const std::string&               path,
 		const std::optional<UASSET_TYPE> typeOpt
 	) {
-		std::scoped_lock lock(mMutex);
-		auto             deduced = UASSET_TYPE::UNKNOWN;
-		if (!typeOpt.has_value()) {
-			// 型がわかんねぇので、ローダーに読めるか確認させる
-			for (const auto& l : mLoaders) {
-				if (l->CanLoad(path, &deduced)) {
-					break;
-				}
+		AssetID id;
+		{
+			std::scoped_lock lock(mMutex);
+			id = FindByPath(path);
+			if (id != kInvalidAssetID && Resolve(id)->meta.loaded) {
+				return id;
+			}
+			// 不明の場合はスロットだけ作成
+			if (id == kInvalidAssetID) {
+				id = FindOrCreateSlotByPath(path, DeduceType(path, typeOpt));
 			}
-
-			Warning(
-				kChannel,
-				"型をチェックしました: {}",
-				ToString(deduced)
-			);
-		} else {
-			deduced = *typeOpt;
 		}
 
-		// 不明の場合はスロットだけ作成
-		const AssetID id = FindOrCreateSlotByPath(path, deduced);
-		Node&         n  = mNodes[id];
+		std::vector<AssetID> dependencies;
+		if (LoadSlot(id, typeOpt, &dependencies)) {
+			LoadDependencies(dependencies);
+		}
+		return id;
+	}
 
-		for (const auto& l : mLoaders) {
-			auto t = UASSET_TYPE::UNKNOWN;
-			if (!l->CanLoad(path, &t)) {
-				continue;
+	AssetLoadHandle UAssetManager::LoadAsync(
+		const std::string&               path,
+		const std::optional<UASSET_TYPE> typeOpt,
+		const UASSET_LOAD_PRIORITY       priority
+	) {
+		AssetID          id;
+		UAssetLoadQueue* queue;
+		{
+			std::scoped_lock lock(mMutex);
+			id = FindByPath(path);
+			if (id == kInvalidAssetID) {
+				id = FindOrCreateSlotByPath(path, DeduceType(path, typeOpt));
 			}
-			if (typeOpt.has_value() && t != deduced) {
-				continue;
+			if (!mLoadQueue) {
+				mLoadQueue = std::make_unique<UAssetLoadQueue>(*this);
 			}
+			queue = mLoadQueue.get();
+		}
+		// キューはマネージャーのロックを取るので、ロックの外で積む
+		return queue->Enqueue(id, typeOpt, priority);
+	}
 
-			LoadResult r     = l->Load(path);
-			n.payload        = std::move(r.payload);
-			n.meta.type      = (deduced == UASSET_TYPE::UNKNOWN) ? t : deduced;
-			n.meta.loaded    = true;
-			n.meta.fileStamp = r.stamp;
-			if (!r.resolveName.empty()) {
-				n.meta.name            = r.resolveName;
-				mNameToID[n.meta.name] = id;
-			}
+	void UAssetManager::SetLoadPriority(
+		const AssetID              id,
+		const UASSET_LOAD_PRIORITY priority
+	) {
+		UAssetLoadQueue* queue;
+		{
+			std::scoped_lock lock(mMutex);
+			queue = mLoadQueue.get();
+		}
+		if (queue) {
+			queue->SetPriority(id, priority);
+		}
+	}
 
-			// 依存の設定
-			SetDependencies(id, r.dependencies);
-			return id;
+	size_t UAssetManager::PendingLoadCount() const {
+		const UAssetLoadQueue* queue;
+		{
+			std::scoped_lock lock(mMutex);
+			queue = mLoadQueue.get();
 		}
+		return queue ? queue->InFlightCount() : 0;
+	}
 
-		n.meta.loaded = false;
-		return id;
+	AssetID UAssetManager::Reserve(
+		const std::string& path,
+		const UASSET_TYPE  type
+	) {
+		std::scoped_lock lock(mMutex);
+		return FindOrCreateSlotByPath(path, type);
 	}
 
 	template <class T>
@@ -100,13 +133,16 @@ namespace Unnamed {
 		const std::vector<AssetID>& dependencies
 	) {
 		std::scoped_lock lock(mMutex);
-		const AssetID    id    = AllocateID();
-		Node&            n     = mNodes[id];
-		n.meta.type            = type;
-		n.meta.name            = std::move(name);
-		n.meta.loaded          = true;
-		n.payload              = std::forward<T>(payload);
-		mNameToID[n.meta.name] = id;
+		const AssetID    id = AllocateID();
+		Slot&            n  = *Resolve(id);
+		n.meta.type         = type;
+		n.meta.name         = std::move(name);
+		n.meta.loaded       = true;
+		{
+			std::unique_lock lookup(mLookupMutex);
+			mNameToID[n.meta.name] = id;
+		}
+		Publish(n, AssetPayload(std::forward<T>(payload)));
 
 		SetDependencies(id, dependencies);
 		return id;
@@ -137,67 +173,84 @@ namespace Unnamed {
 		SoundAssetData&&, const std::vector<AssetID>&
 	);
 
+	template AssetID UAssetManager::CreateRuntimeAsset<AnimationAssetData>(
+		UASSET_TYPE, std::string,
+		AnimationAssetData&&, const std::vector<AssetID>&
+	);
+
 	void UAssetManager::AddRef(const AssetID id) {
-		std::scoped_lock lock(mMutex);
-		if (id == kInvalidAssetID || id >= mNextID) {
+		Slot* slot = Resolve(id);
+		if (!slot) {
 			return;
 		}
-		mNodes[id].meta.strongRefs++;
+		slot->strongRefs.fetch_add(1, std::memory_order_relaxed);
 	}
 
 	void UAssetManager::Release(const AssetID id) {
-		std::scoped_lock lock(mMutex);
-		if (id == kInvalidAssetID || id >= mNextID) {
+		Slot* slot = Resolve(id);
+		if (!slot) {
 			return;
 		}
-		auto& n = mNodes[id].meta;
-		if (n.strongRefs > 0) {
-			n.strongRefs--;
-		}
+		// 0を下回らないようにCASで減らす
+		uint32_t refs = slot->strongRefs.load(std::memory_order_relaxed);
+		while (refs > 0 && !slot->strongRefs.compare_exchange_weak(
+			refs, refs - 1, std::memory_order_release, std::memory_order_relaxed
+		)) {}
 	}
 
 	void UAssetManager::SetDependencies(
 		AssetID                     id,
 		const std::vector<AssetID>& dependencies
 	) {
-		if (id == kInvalidAssetID || id >= mNextID) {
+		std::scoped_lock lock(mMutex);
+		Slot*            n = Resolve(id);
+		if (!n) {
 			return;
 		}
-		Node& n = mNodes[id];
 
-		for (const auto dep : n.dependencies) {
-			if (dep == kInvalidAssetID || dep >= mNextID) {
-				continue;
+		// 古い逆辺を外す
+		for (const auto dep : n->dependencies) {
+			if (Slot* d = Resolve(dep)) {
+				std::erase(d->dependents, id);
 			}
-			auto& vec = mNodes[dep].dependencies;
-			std::erase(vec, id);
 		}
 
-		n.dependencies = dependencies;
+		n->dependencies = dependencies;
 
 		// 新しく逆辺を張る
-		for (const auto dep : n.dependencies) {
-			if (dep == kInvalidAssetID || dep >= mNextID) {
-				continue;
+		for (const auto dep : n->dependencies) {
+			if (Slot* d = Resolve(dep)) {
+				d->dependents.emplace_back(id);
 			}
-			mNodes[dep].dependents.emplace_back(id);
 		}
 	}
 
-	const AssetMetaData& UAssetManager::Meta(const AssetID id) const {
+	AssetMetaData UAssetManager::Meta(const AssetID id) const {
 		std::scoped_lock lock(mMutex);
-		UASSERT(id < mNextID);
-		return mNodes[id].meta;
+		const Slot*      slot = Resolve(id);
+		UASSERT(slot);
+		if (!slot) {
+			return {};
+		}
+		AssetMetaData meta = slot->meta;
+		meta.strongRefs    = slot->strongRefs.load(std::memory_order_relaxed);
+		return meta;
 	}
 
 	template <class T>
 	const T* UAssetManager::Get(const AssetID id) const {
-		std::scoped_lock lock(mMutex);
-		if (id == kInvalidAssetID || id >= mNextID) {
+		const Slot* slot = Resolve(id);
+		if (!slot) {
 			return nullptr;
 		}
-		const auto& v = mNodes[id].payload;
-		return std::get_if<T>(&const_cast<AssetPayload&>(v));
+		const AssetPayload* payload = slot->payload.load(
+			std::memory_order_acquire
+		);
+		// 読んでいる間にスロットが解放・再利用されていないか世代を見直す
+		if (!payload || slot->id.load(std::memory_order_acquire) != id) {
+			return nullptr;
+		}
+		return std::get_if<T>(payload);
 	}
 
 	template const TextureAssetData* UAssetManager::Get<TextureAssetData>(
@@ -216,56 +269,97 @@ namespace Unnamed {
 		AssetID id
 	) const;
 
-	const std::vector<AssetID>& UAssetManager::Dependencies(
+	template const AnimationAssetData* UAssetManager::Get<AnimationAssetData>(
+		AssetID id
+	) const;
+
+	std::vector<AssetID> UAssetManager::Dependencies(
 		const AssetID id) const {
 		std::scoped_lock lock(mMutex);
-		UASSERT(id < mNextID);
-		return mNodes[id].dependencies;
+		const Slot*      slot = Resolve(id);
+		UASSERT(slot);
+		return slot ? slot->dependencies : std::vector<AssetID>{};
 	}
 
-	const std::vector<AssetID>& UAssetManager::Dependents(
+	std::vector<AssetID> UAssetManager::Dependents(
 		const AssetID id) const {
 		std::scoped_lock lock(mMutex);
-		UASSERT(id < mNextID);
-		return mNodes[id].dependents;
+		const Slot*      slot = Resolve(id);
+		UASSERT(slot);
+		return slot ? slot->dependents : std::vector<AssetID>{};
+	}
+
+	bool UAssetManager::IsValid(const AssetID id) const {
+		return Resolve(id) != nullptr;
+	}
+
+	bool UAssetManager::IsLoaded(const AssetID id) const {
+		// ペイロードは読み込み済みの間だけ公開されている
+		const Slot* slot = Resolve(id);
+		return slot && slot->payload.load(std::memory_order_acquire) != nullptr;
 	}
 
 	bool UAssetManager::Reload(const AssetID id) {
-		std::scoped_lock lock(mMutex);
-		if (id == kInvalidAssetID || id >= mNextID) {
+		std::string   path;
+		IAssetLoader* loader = nullptr;
+		uint32_t      version;
+		{
+			std::scoped_lock lock(mMutex);
+			const Slot*      slot = Resolve(id);
+			if (!slot || slot->meta.sourcePath.empty()) {
+				return false;
+			}
+			path    = slot->meta.sourcePath;
+			version = slot->meta.version;
+
+			for (const auto& l : mLoaders) {
+				auto t = UASSET_TYPE::UNKNOWN;
+				if (!l->CanLoad(path, &t)) {
+					continue;
+				}
+				if (t != slot->meta.type && slot->meta.type != UASSET_TYPE::UNKNOWN) {
+					continue;
+				}
+				loader = l.get();
+				break;
+			}
+		}
+		if (!loader) {
 			return false;
 		}
-		Node& n = mNodes[id];
-		if (n.meta.sourcePath.empty()) {
+
+		// LoadSlot と同じく、パース/デコードはロックの外で行う
+		LoadResult r = loader->Load(path);
+		if (std::holds_alternative<std::monostate>(r.payload)) {
+			// 読み直しに失敗したら(保存途中のファイルなど)今のペイロードを使い続ける
+			Warning(kChannel, "Reload failed, keeping the previous payload: {}", path);
 			return false;
 		}
 
-		for (const auto& l : mLoaders) {
-			auto t = UASSET_TYPE::UNKNOWN;
-			if (!l->CanLoad(n.meta.sourcePath, &t)) {
-				continue;
+		std::vector<ReloadCallback> callbacks;
+		{
+			std::scoped_lock lock(mMutex);
+			// 読んでいる間にスロットが解放(世代が変わる)されたり、
+			// 他のスレッドが先に差し替えていたら、古い結果で上書きしない
+			Slot* slot = Resolve(id);
+			if (!slot || slot->meta.version != version) {
+				return false;
 			}
-			if (t != n.meta.type && n.meta.type != UASSET_TYPE::UNKNOWN) {
-				continue;
-			}
-
-			LoadResult r     = l->Load(n.meta.sourcePath);
-			n.payload        = std::move(r.payload);
+			Slot& n          = *slot;
 			n.meta.loaded    = true;
 			n.meta.fileStamp = r.stamp;
 			n.meta.version++;
+			Publish(n, std::move(r.payload));
 
 			SetDependencies(id, r.dependencies);
-
-			auto callbacks = mReloadCallbacks;
-
-			for (auto& cb : callbacks) {
-				cb(id);
-			}
-			return true;
+			callbacks = mReloadCallbacks;
 		}
+		LoadDependencies(r.dependencies);
 
-		return false;
+		for (auto& cb : callbacks) {
+			cb(id);
+		}
+		return true;
 	}
 
 	void UAssetManager::SubscribeReload(ReloadCallback callback) {
@@ -276,18 +370,22 @@ namespace Unnamed {
 	size_t UAssetManager::UnloadUnused() {
 		std::scoped_lock lock(mMutex);
 		size_t           freed = 0;
-		for (AssetID id = 1; id < mNextID; ++id) {
-			Node& n = mNodes[id];
+		for (uint32_t index = 1; index < mNextIndex; ++index) {
+			Slot& n = *SlotAt(index);
+			if (n.id.load(std::memory_order_relaxed) == kInvalidAssetID) {
+				continue;
+			}
 			if (!n.meta.loaded) {
 				continue;
 			}
-			if (n.meta.strongRefs > 0) {
+			if (n.strongRefs.load(std::memory_order_acquire) > 0) {
 				continue;
 			}
 
 			bool needed = false;
 			for (auto depBy : n.dependents) {
-				if (depBy < mNextID && mNodes[depBy].meta.strongRefs > 0) {
+				const Slot* d = Resolve(depBy);
+				if (d && d->strongRefs.load(std::memory_order_acquire) > 0) {
 					needed = true;
 					break;
 				}
@@ -297,21 +395,33 @@ namespace Unnamed {
 				continue;
 			}
 
-			n.payload     = std::monostate{};
+			Retire(n);
 			n.meta.loaded = false;
+
+			// ソースを持たないランタイムアセットは読み直せないのでスロットごと返す
+			if (n.meta.sourcePath.empty()) {
+				FreeSlot(n);
+			}
 			freed++;
 		}
 		return freed;
 	}
 
-	AssetID UAssetManager::FindByPath(const std::string_view path) const {
+	size_t UAssetManager::CollectRetired() {
 		std::scoped_lock lock(mMutex);
-		const auto       it = mPathToID.find(std::string(path));
+		const size_t     count = mRetired.size();
+		mRetired.clear();
+		return count;
+	}
+
+	AssetID UAssetManager::FindByPath(const std::string_view path) const {
+		std::shared_lock lock(mLookupMutex);
+		const auto       it = mPathToID.find(NormalizePath(std::string(path)));
 		return it != mPathToID.end() ? it->second : kInvalidAssetID;
 	}
 
 	AssetID UAssetManager::FindByName(const std::string_view name) const {
-		std::scoped_lock lock(mMutex);
+		std::shared_lock lock(mLookupMutex);
 		const auto       it = mNameToID.find(std::string(name));
 		return it != mNameToID.end() ? it->second : kInvalidAssetID;
 	}
@@ -319,19 +429,201 @@ namespace Unnamed {
 	std::vector<AssetID> UAssetManager::AllAssets() const {
 		std::scoped_lock     lock(mMutex);
 		std::vector<AssetID> ids;
-		ids.reserve(mNextID - 1);
-		for (AssetID id = 1; id < mNextID; ++id) {
-			ids.emplace_back(id);
+		ids.reserve(mNextIndex - 1);
+		for (uint32_t index = 1; index < mNextIndex; ++index) {
+			const AssetID id = SlotAt(index)->id.load(std::memory_order_relaxed);
+			if (id != kInvalidAssetID) {
+				ids.emplace_back(id);
+			}
 		}
 		return ids;
 	}
 
+	UAssetManager::Slot* UAssetManager::SlotAt(const uint32_t index) const {
+		SlotPage* page = mPages[index >> kPageShift].load(
+			std::memory_order_acquire
+		);
+		return page ? &page->slots[index & (kSlotsPerPage - 1)] : nullptr;
+	}
+
+	const UAssetManager::Slot* UAssetManager::Resolve(const AssetID id) const {
+		const uint32_t index = IndexOf(id);
+		if (index == 0) {
+			return nullptr;
+		}
+		const Slot* slot = SlotAt(index);
+		if (!slot || slot->id.load(std::memory_order_acquire) != id) {
+			return nullptr;
+		}
+		return slot;
+	}
+
+	UAssetManager::Slot* UAssetManager::Resolve(const AssetID id) {
+		return const_cast<Slot*>(std::as_const(*this).Resolve(id));
+	}
+
+	UASSET_TYPE UAssetManager::DeduceType(
+		const std::string&               path,
+		const std::optional<UASSET_TYPE> typeOpt
+	) const {
+		if (typeOpt.has_value()) {
+			return *typeOpt;
+		}
+
+		// 型がわかんねぇので、ローダーに読めるか確認させる
+		auto deduced = UASSET_TYPE::UNKNOWN;
+		for (const auto& l : mLoaders) {
+			if (l->CanLoad(path, &deduced)) {
+				break;
+			}
+		}
+
+		Warning(
+			kChannel,
+			"型をチェックしました: {}",
+			ToString(deduced)
+		);
+		return deduced;
+	}
+
+	bool UAssetManager::LoadSlot(
+		const AssetID                    id,
+		const std::optional<UASSET_TYPE> typeOpt,
+		std::vector<AssetID>*            outDependencies
+	) {
+		std::string   path;
+		UASSET_TYPE   deduced;
+		IAssetLoader* loader     = nullptr;
+		auto          loaderType = UASSET_TYPE::UNKNOWN;
+		{
+			std::scoped_lock lock(mMutex);
+			const Slot*      slot = Resolve(id);
+			if (!slot) {
+				return false;
+			}
+			path    = slot->meta.sourcePath;
+			deduced = typeOpt.value_or(slot->meta.type);
+
+			for (const auto& l : mLoaders) {
+				auto t = UASSET_TYPE::UNKNOWN;
+				if (!l->CanLoad(path, &t)) {
+					continue;
+				}
+				if (typeOpt.has_value() && t != deduced) {
+					continue;
+				}
+				loader     = l.get();
+				loaderType = t;
+				break;
+			}
+		}
+		if (!loader) {
+			return false;
+		}
+
+		// パース/デコードはロックの外で行う
+		LoadResult r = loader->Load(path);
+		if (std::holds_alternative<std::monostate>(r.payload)) {
+			return false;
+		}
+
+		std::scoped_lock lock(mMutex);
+		Slot*            slot = Resolve(id);
+		if (!slot) {
+			return false;
+		}
+		Slot& n          = *slot;
+		n.meta.type      = (deduced == UASSET_TYPE::UNKNOWN) ? loaderType : deduced;
+		n.meta.loaded    = true;
+		n.meta.fileStamp = r.stamp;
+		if (!r.resolveName.empty()) {
+			n.meta.name = r.resolveName;
+			std::unique_lock lookup(mLookupMutex);
+			mNameToID[n.meta.name] = id;
+		}
+		Publish(n, std::move(r.payload));
+
+		// 依存の設定
+		SetDependencies(id, r.dependencies);
+		if (outDependencies) {
+			*outDependencies = std::move(r.dependencies);
+		}
+		return true;
+	}
+
+	void UAssetManager::LoadDependencies(
+		const std::vector<AssetID>& dependencies
+	) {
+		// 読み込み済みのものは飛ばすので、循環していても止まる
+		for (const AssetID dep : dependencies) {
+			std::string                path;
+			std::optional<UASSET_TYPE> type;
+			{
+				std::scoped_lock lock(mMutex);
+				const Slot*      slot = Resolve(dep);
+				if (!slot || slot->meta.loaded || slot->meta.sourcePath.empty()) {
+					continue;
+				}
+				path = slot->meta.sourcePath;
+				if (slot->meta.type != UASSET_TYPE::UNKNOWN) {
+					type = slot->meta.type;
+				}
+			}
+			LoadFromFile(path, type);
+		}
+	}
+
 	AssetID UAssetManager::AllocateID() {
-		// 0は無効
-		if (mNextID >= mNodes.size()) {
-			mNodes.resize(static_cast<size_t>(mNextID) + 64);
+		uint32_t index;
+		if (!mFreeIndices.empty()) {
+			index = mFreeIndices.back();
+			mFreeIndices.pop_back();
+		} else {
+			// 0は無効
+			UASSERT(mNextIndex <= kIndexMask);
+			index = mNextIndex++;
+			auto& page = mPages[index >> kPageShift];
+			if (!page.load(std::memory_order_relaxed)) {
+				page.store(new SlotPage, std::memory_order_release);
+			}
+		}
+
+		Slot&         slot = *SlotAt(index);
+		const AssetID id   = (slot.generation << kIndexBits) | index;
+		slot.meta          = {};
+		slot.dependencies.clear();
+		slot.dependents.clear();
+		slot.strongRefs.store(0, std::memory_order_relaxed);
+		slot.id.store(id, std::memory_order_release);
+		return id;
+	}
+
+	void UAssetManager::FreeSlot(Slot& slot) {
+		const AssetID id = slot.id.load(std::memory_order_relaxed);
+
+		// 依存先から自分への逆辺を外す
+		for (const auto dep : slot.dependencies) {
+			if (Slot* d = Resolve(dep)) {
+				std::erase(d->dependents, id);
+			}
+		}
+
+		{
+			std::unique_lock lookup(mLookupMutex);
+			const auto       it = mNameToID.find(slot.meta.name);
+			if (it != mNameToID.end() && it->second == id) {
+				mNameToID.erase(it);
+			}
+		}
+
+		// 世代を進めて古いIDを無効化する
+		Retire(slot);
+		slot.id.store(kInvalidAssetID, std::memory_order_release);
+		slot.generation = (slot.generation + 1) & kGenerationMask;
+		// 世代が一周すると古いIDが生き返ってしまうので、使い切ったスロットは二度と使わない
+		if (slot.generation != 0) {
+			mFreeIndices.emplace_back(IndexOf(id));
 		}
-		return mNextID++;
 	}
 
 	AssetID UAssetManager::FindOrCreateSlotByPath(
@@ -339,40 +631,61 @@ namespace Unnamed {
 		const UASSET_TYPE  type
 	) {
 		const auto normalized = NormalizePath(path);
-		const auto it         = mPathToID.find(normalized);
-		if (it != mPathToID.end()) {
-			return it->second;
+		{
+			std::shared_lock lookup(mLookupMutex);
+			const auto       it = mPathToID.find(normalized);
+			if (it != mPathToID.end()) {
+				return it->second;
+			}
 		}
 
-		const AssetID id      = AllocateID();
-		mPathToID[normalized] = id;
+		const AssetID id = AllocateID();
 
-		Node& node           = mNodes[id];
+		Slot& node           = *Resolve(id);
 		node.meta.type       = type;
 		node.meta.sourcePath = normalized;
 		node.meta.loaded     = false;
 		node.meta.name       = fs::path(normalized).filename().string();
 
+		std::unique_lock lookup(mLookupMutex);
+		mPathToID[normalized]     = id;
 		mNameToID[node.meta.name] = id;
 		return id;
 	}
 
+	void UAssetManager::Publish(Slot& slot, AssetPayload&& payload) {
+		auto next = std::make_unique<AssetPayload>(std::move(payload));
+		slot.payload.store(next.get(), std::memory_order_release);
+		if (slot.owned) {
+			mRetired.emplace_back(std::move(slot.owned));
+		}
+		slot.owned = std::move(next);
+	}
+
+	void UAssetManager::Retire(Slot& slot) {
+		slot.payload.store(nullptr, std::memory_order_release);
+		if (slot.owned) {
+			mRetired.emplace_back(std::move(slot.owned));
+		}
+	}
+
 	void UAssetManager::RebuildDependents(AssetID id) {
 		std::scoped_lock lock(mMutex);
-		if (id == kInvalidAssetID || id >= mNextID) {
+		Slot*            slot = Resolve(id);
+		if (!slot) {
 			return;
 		}
 		// とりあえず全ノードからidを取り除く
-		for (AssetID i = 1; i < mNextID; ++i) {
-			auto& depBy = mNodes[i].dependents;
+		for (uint32_t i = 1; i < mNextIndex; ++i) {
+			auto& depBy = SlotAt(i)->dependents;
 			if (!depBy.empty()) {
 				std::erase(depBy, id);
 			}
 		}
 		// idの依存を見て各depの依存に追加する
-		for (const AssetID d : mNodes[id].dependencies) {
-			if (d == kInvalidAssetID || d >= mNextID) {
-				auto& depBy = mNodes[d].dependents;
+		for (const AssetID d : slot->dependencies) {
+			if (Slot* dep = Resolve(d)) {
+				auto& depBy = dep->dependents;
 				if (std::ranges::find(depBy, id) == depBy.end()) {
 					depBy.emplace_back(id);
 				}
@@ -382,15 +695,19 @@ namespace Unnamed {
 
 	void UAssetManager::RebuildAllDependents() {
 		std::scoped_lock lock(mMutex);
-		for (AssetID i = 1; i < mNextID; ++i) {
-			mNodes[i].dependents.clear();
+		for (uint32_t i = 1; i < mNextIndex; ++i) {
+			SlotAt(i)->dependents.clear();
 		}
-		for (AssetID i = 1; i < mNextID; ++i) {
-			for (const AssetID d : mNodes[i].dependencies) {
-				if (d == kInvalidAssetID || d >= mNextID) {
-					continue;
+		for (uint32_t i = 1; i < mNextIndex; ++i) {
+			const Slot&   slot = *SlotAt(i);
+			const AssetID id   = slot.id.load(std::memory_order_relaxed);
+			if (id == kInvalidAssetID) {
+				continue;
+			}
+			for (const AssetID d : slot.dependencies) {
+				if (Slot* dep = Resolve(d)) {
+					dep->dependents.emplace_back(id);
 				}
-				mNodes[d].dependents.emplace_back(i);
 			}
 		}
 	}
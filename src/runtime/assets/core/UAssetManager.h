@@ -1,10 +1,16 @@
 #pragma once
+#include <array>
+#include <atomic>
 #include <functional>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <unordered_map>
 #include <variant>
 
 #include <runtime/assets/core/UAsset.h>
+#include <runtime/assets/core/UAssetLoadQueue.h>
 
 namespace Unnamed {
 	struct ShaderAssetData;
@@ -15,19 +21,50 @@ namespace Unnamed {
 
 	/// @class UAssetManager
 	/// @brief アセットの管理を行うクラス
+	/// @details AssetID は下位24bitがスロット番号、上位8bitが世代です。
+	/// スロットはページ単位で確保して移動しないので、Get / AddRef / Release は
+	/// ロックを取らずに読めます。ロード・リロード・アンロードなどの書き込みは
+	/// mMutex で直列化し、新しいペイロードをアトミックに差し替えて公開します。
+	/// ローダー自体はロックの外で走るので、LoadAsync で並列に読み込めます
 	class UAssetManager {
 	public:
 		using AssetID        = uint32_t;
 		using ReloadCallback = std::function<void(AssetID id)>;
 
 		UAssetManager();
+		~UAssetManager();
+
+		UAssetManager(const UAssetManager&)            = delete;
+		UAssetManager& operator=(const UAssetManager&) = delete;
+
 		void RegisterLoader(std::unique_ptr<IAssetLoader> loader);
 
+		// 読み込み済みならそのまま返します。依存はこの呼び出しの中で読み込みます
 		AssetID LoadFromFile(
 			const std::string&         path,
 			std::optional<UASSET_TYPE> typeOpt = std::nullopt
 		);
 
+		/// @brief ワーカーで読み込みます
+		/// @details 依存(LoadResult::dependencies)も同じ優先度で積み、
+		/// 全て揃ったらハンドルが READY、どれかが読めなければ FAILED になります
+		AssetLoadHandle LoadAsync(
+			const std::string&         path,
+			std::optional<UASSET_TYPE> typeOpt  = std::nullopt,
+			UASSET_LOAD_PRIORITY       priority = UASSET_LOAD_PRIORITY::NORMAL
+		);
+
+		// 読み込み待ちのアセットの優先度を引き上げます(見えるようになった時など)
+		void SetLoadPriority(AssetID id, UASSET_LOAD_PRIORITY priority);
+
+		// キュー待ちと読み込み中の非同期ロードの数
+		size_t PendingLoadCount() const;
+
+		/// @brief スロットだけ確保してIDを返します(読み込みはしません)
+		/// @details ローダーが依存を見つけた時に使い、IDを LoadResult::dependencies に
+		/// 入れておくと、呼び出し元(同期/非同期)が続けて読み込みます
+		AssetID Reserve(const std::string& path, UASSET_TYPE type);
+
 		template <class T>
 		AssetID CreateRuntimeAsset(
 			UASSET_TYPE                 type,
@@ -36,6 +73,7 @@ namespace Unnamed {
 			const std::vector<AssetID>& dependencies = {}
 		);
 
+		// ロックフリー
 		void AddRef(AssetID id);
 		void Release(AssetID id);
 
@@ -44,49 +82,114 @@ namespace Unnamed {
 			const std::vector<AssetID>& dependencies
 		);
 
-		const AssetMetaData& Meta(AssetID id) const;
+		// ロックの外に参照を逃がさないよう、コピーを返します
+		AssetMetaData Meta(AssetID id) const;
+
+		/// @brief 公開中のペイロードを取得します(ロックフリー)
+		/// @details 返したポインタはリロード/アンロードで差し替えられた後も
+		/// CollectRetired() が呼ばれるまでは有効です
 		template <class T>
 		const T* Get(AssetID id) const;
 
-		const std::vector<AssetID>& Dependencies(AssetID id) const;
-		const std::vector<AssetID>& Dependents(AssetID id) const;
+		std::vector<AssetID> Dependencies(AssetID id) const;
+		std::vector<AssetID> Dependents(AssetID id) const;
+
+		// 世代まで一致する生きたスロットを指しているか
+		bool IsValid(AssetID id) const;
+		bool IsLoaded(AssetID id) const;
 
 		bool Reload(AssetID id);
 		void SubscribeReload(ReloadCallback callback);
 
 		size_t UnloadUnused();
 
+		// 差し替えで退役したペイロードを解放します
+		// Get() で得たポインタを誰も持っていないタイミング(フレーム境界など)で呼んでください
+		size_t CollectRetired();
+
 		AssetID FindByPath(std::string_view path) const;
 		AssetID FindByName(std::string_view name) const;
 
 		std::vector<AssetID> AllAssets() const;
 
 	private:
-		struct Node {
-			AssetMetaData        meta;
-			AssetPayload         payload;
-			std::vector<AssetID> dependencies;
-			std::vector<AssetID> dependents;
+		friend class UAssetLoadQueue;
+
+		static constexpr uint32_t kIndexBits      = 24;
+		static constexpr uint32_t kIndexMask      = (1u << kIndexBits) - 1u;
+		// 1スロットは kGenerationMask + 1 回まで使い回し、その後は空きに戻さない
+		static constexpr uint32_t kGenerationMask = 0xFFu;
+		static constexpr uint32_t kPageShift      = 10;
+		static constexpr uint32_t kSlotsPerPage   = 1u << kPageShift;
+		static constexpr uint32_t kMaxPages       = (kIndexMask + 1u) / kSlotsPerPage;
+
+		struct Slot {
+			// 読み手が触るもの(アトミック)
+			std::atomic<AssetID>             id         = kInvalidAssetID; // 空きなら無効
+			std::atomic<uint32_t>            strongRefs = 0;
+			std::atomic<const AssetPayload*> payload    = nullptr;
+
+			// 以下は mMutex で保護
+			uint32_t                      generation = 0;
+			std::unique_ptr<AssetPayload> owned; // payload の実体
+			AssetMetaData                 meta;
+			std::vector<AssetID>          dependencies;
+			std::vector<AssetID>          dependents;
 		};
 
+		struct SlotPage {
+			std::array<Slot, kSlotsPerPage> slots;
+		};
+
+		static uint32_t IndexOf(const AssetID id) { return id & kIndexMask; }
+
+		Slot*       SlotAt(uint32_t index) const;
+		const Slot* Resolve(AssetID id) const;
+		Slot*       Resolve(AssetID id);
+
+		UASSET_TYPE DeduceType(const std::string&         path,
+		                       std::optional<UASSET_TYPE> typeOpt) const;
+
+		// ロックの外でローダーを走らせ、結果を公開します
+		// @return ペイロードを読めたらtrue
+		bool LoadSlot(AssetID                    id,
+		              std::optional<UASSET_TYPE> typeOpt,
+		              std::vector<AssetID>*      outDependencies);
+
+		// まだ読み込まれていない依存をこのスレッドで読み込みます
+		void LoadDependencies(const std::vector<AssetID>& dependencies);
+
 		AssetID AllocateID();
+		void    FreeSlot(Slot& slot);
 		AssetID FindOrCreateSlotByPath(const std::string& path,
 		                               UASSET_TYPE        type);
 
+		// 新しいペイロードを公開し、古いものを退役リストに積みます
+		void Publish(Slot& slot, AssetPayload&& payload);
+		void Retire(Slot& slot);
+
 		void RebuildDependents(AssetID id);
 		void RebuildAllDependents();
 
 		static std::string NormalizePath(std::string path);
 
 	private:
-		mutable std::recursive_mutex mMutex;
-		std::vector<Node>            mNodes;
-		AssetID                      mNextID = 1;
+		mutable std::recursive_mutex mMutex; // 書き込み側
+
+		// ページはロックなしで読むので、確保後は解放するまで動かしません
+		std::array<std::atomic<SlotPage*>, kMaxPages> mPages = {};
+		uint32_t                                      mNextIndex = 1; // 0は無効
+		std::vector<uint32_t>                         mFreeIndices;
 
+		std::vector<std::unique_ptr<AssetPayload>> mRetired;
+
+		mutable std::shared_mutex                mLookupMutex;
 		std::unordered_map<std::string, AssetID> mPathToID;
 		std::unordered_map<std::string, AssetID> mNameToID;
 
 		std::vector<std::unique_ptr<IAssetLoader>> mLoaders;
 		std::vector<ReloadCallback>                mReloadCallbacks;
+
+		std::unique_ptr<UAssetLoadQueue> mLoadQueue; // 最初の LoadAsync で作る
 	};
 }
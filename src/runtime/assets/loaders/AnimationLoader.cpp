@@ -0,0 +1,183 @@
+﻿#include <pch.h>
+
+//-----------------------------------------------------------------------------
+
+#include "AnimationLoader.h"
+
+#include <format>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+
+#include <engine/Animation/Animation.h>
+#include <engine/Animation/AnimationClip.h>
+
+#include <runtime/assets/loaders/CookedAnimationLoader.h>
+
+namespace Unnamed {
+	static constexpr std::string_view kChannel = "AnimationLoader";
+
+	namespace {
+		// 右手系の Assimp から左手系へ。移動は X、回転は Y と Z の符号を反転する
+		Animation ConvertAnimation(const aiAnimation* source) {
+			const double ticksPerSecond = source->mTicksPerSecond;
+			const auto   seconds        = [&](const double ticks) {
+				return static_cast<float>(ticks / ticksPerSecond);
+			};
+
+			Animation animation;
+			animation.duration = seconds(source->mDuration);
+
+			for (uint32_t c = 0; c < source->mNumChannels; ++c) {
+				const aiNodeAnim* channel = source->mChannels[c];
+				NodeAnimation&    node    = animation.nodeAnimations[
+					channel->mNodeName.C_Str()
+				];
+				animation.nodeNames.emplace_back(channel->mNodeName.C_Str());
+
+				node.translate.keyFrames.reserve(channel->mNumPositionKeys);
+				for (uint32_t k = 0; k < channel->mNumPositionKeys; ++k) {
+					const aiVectorKey& key = channel->mPositionKeys[k];
+					node.translate.keyFrames.push_back({
+						seconds(key.mTime),
+						Vec3(-key.mValue.x, key.mValue.y, key.mValue.z)
+					});
+				}
+
+				node.rotate.keyFrames.reserve(channel->mNumRotationKeys);
+				for (uint32_t k = 0; k < channel->mNumRotationKeys; ++k) {
+					const aiQuatKey& key = channel->mRotationKeys[k];
+					node.rotate.keyFrames.push_back({
+						seconds(key.mTime),
+						Quaternion(key.mValue.x, -key.mValue.y, -key.mValue.z, key.mValue.w)
+					});
+				}
+
+				node.scale.keyFrames.reserve(channel->mNumScalingKeys);
+				for (uint32_t k = 0; k < channel->mNumScalingKeys; ++k) {
+					const aiVectorKey& key = channel->mScalingKeys[k];
+					node.scale.keyFrames.push_back({
+						seconds(key.mTime),
+						Vec3(key.mValue.x, key.mValue.y, key.mValue.z)
+					});
+				}
+			}
+			return animation;
+		}
+
+		bool IsModelExtension(const std::string& ext) {
+			return
+				ext == ".fbx" ||
+				ext == ".gltf" ||
+				ext == ".glb";
+		}
+	}
+
+	AnimationLoader::AnimationLoader(std::filesystem::path cookDirectory)
+		: mCookDirectory(std::move(cookDirectory)) {
+	}
+
+	bool AnimationLoader::CanLoad(
+		const std::string_view path, UASSET_TYPE* outType
+	) const {
+		const bool ok = path.ends_with(kPathSuffix) &&
+			IsModelExtension(StrUtil::ToLowerExt(SourcePathOf(path)));
+		if (outType) {
+			*outType = ok ? UASSET_TYPE::ANIMATION : UASSET_TYPE::UNKNOWN;
+		}
+		return ok;
+	}
+
+	LoadResult AnimationLoader::Load(const std::string& path) {
+		LoadResult        r      = {};
+		const std::string source = std::string(SourcePathOf(path));
+		r.resolveName            = std::filesystem::path(source).filename().string() +
+			std::string(kPathSuffix);
+
+		// ソースが変わっていなければ焼いたものをそのまま使う
+		const bool cook = !mCookDirectory.empty() && ReadFileStamp(source, r.stamp);
+		if (cook) {
+			if (auto cooked = CookedAnimationLoader::Read(CookedPathFor(source), &r.stamp)) {
+				cooked->sourcePath = source;
+				r.payload          = std::move(*cooked);
+				return r;
+			}
+		}
+
+		std::vector<std::string> names;
+		std::vector<Animation>   animations;
+		if (!Import(source, names, animations)) {
+			return r;
+		}
+
+		AnimationAssetData out = {};
+		out.sourcePath         = source;
+		out.names              = std::move(names);
+		out.clips.reserve(animations.size());
+		for (const Animation& animation : animations) {
+			out.clips.emplace_back(std::make_shared<const AnimationClip>(animation));
+		}
+
+		if (cook && !CookedAnimationLoader::Write(CookedPathFor(source), out, r.stamp)) {
+			Warning(kChannel, "Failed to cook animation: {}", source);
+		}
+
+		r.payload = std::move(out);
+		return r;
+	}
+
+	std::string AnimationLoader::AssetPathFor(const std::string_view sourcePath) {
+		return std::string(sourcePath) + std::string(kPathSuffix);
+	}
+
+	std::string_view AnimationLoader::SourcePathOf(const std::string_view assetPath) {
+		return assetPath.ends_with(kPathSuffix) ?
+			       assetPath.substr(0, assetPath.size() - kPathSuffix.size()) :
+			       assetPath;
+	}
+
+	std::filesystem::path AnimationLoader::CookedPathFor(
+		const std::string& sourcePath
+	) const {
+		// 同名のファイルがぶつからないようパスのハッシュを付ける
+		return mCookDirectory / std::format(
+			"{}_{:016x}{}",
+			std::filesystem::path(sourcePath).stem().string(),
+			std::hash<std::string>{}(sourcePath),
+			CookedAnimationLoader::kExtension
+		);
+	}
+
+	bool AnimationLoader::Import(
+		const std::string&        sourcePath,
+		std::vector<std::string>& outNames,
+		std::vector<Animation>&   outAnimations
+	) {
+		Assimp::Importer imp;
+		const aiScene*   scene = imp.ReadFile(sourcePath, 0);
+		if (!scene || scene->mNumAnimations == 0) {
+			Error(
+				kChannel,
+				"No animations in '{}': {}",
+				sourcePath,
+				scene ? "empty." : imp.GetErrorString()
+			);
+			return false;
+		}
+
+		outNames.clear();
+		outAnimations.clear();
+		outNames.reserve(scene->mNumAnimations);
+		outAnimations.reserve(scene->mNumAnimations);
+		for (uint32_t i = 0; i < scene->mNumAnimations; ++i) {
+			const aiAnimation* animation = scene->mAnimations[i];
+			std::string        name      = animation->mName.C_Str();
+			if (name.empty()) {
+				name = "Animation_" + std::to_string(i);
+			}
+			outNames.emplace_back(std::move(name));
+			outAnimations.emplace_back(ConvertAnimation(animation));
+		}
+		return true;
+	}
+}
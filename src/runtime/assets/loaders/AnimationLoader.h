@@ -0,0 +1,53 @@
+﻿#pragma once
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "interface/IAssetLoader.h"
+
+struct Animation;
+
+namespace Unnamed {
+	//-------------------------------------------------------------------------
+	// Purpose: モデルファイルに入っているアニメーションのローダー
+	// メッシュと同じファイルを指すので、アセットのパスは AssetPathFor() で
+	// "<ソースのパス>#animations" にしてメッシュのスロットと分けます。
+	// 初回は Assimp で1回だけ読み込んでファイル内の全アニメーションを
+	// AnimationClip にし、焼いたもの(.uanim)を書き出します。
+	// 以降ソースが変わるまでは焼いたものを読むだけです
+	//-------------------------------------------------------------------------
+	class AnimationLoader : public IAssetLoader {
+	public:
+		static constexpr std::string_view kPathSuffix = "#animations";
+
+		/// @param cookDirectory 焼いたアニメーション(.uanim)の置き場所。空なら焼かずに毎回 Assimp で読み込みます
+		explicit AnimationLoader(
+			std::filesystem::path cookDirectory = "./cache/animations"
+		);
+
+		bool CanLoad(
+			std::string_view path, UASSET_TYPE* outType
+		) const override;
+
+		LoadResult Load(const std::string& path) override;
+
+		[[nodiscard]] static std::string AssetPathFor(std::string_view sourcePath);
+		[[nodiscard]] static std::string_view SourcePathOf(std::string_view assetPath);
+
+		[[nodiscard]] std::filesystem::path CookedPathFor(
+			const std::string& sourcePath
+		) const;
+
+		/// @brief ファイルを Assimp で1回だけ読み、入っている全アニメーションを変換します
+		/// @details 名前の無いアニメーションは "Animation_<番号>" になります
+		/// @return 読めなかったか、アニメーションが1つも無ければfalse
+		static bool Import(
+			const std::string&        sourcePath,
+			std::vector<std::string>& outNames,
+			std::vector<Animation>&   outAnimations
+		);
+
+	private:
+		std::filesystem::path mCookDirectory;
+	};
+}
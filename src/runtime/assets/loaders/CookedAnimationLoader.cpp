@@ -0,0 +1,186 @@
+﻿#include <pch.h>
+
+//-----------------------------------------------------------------------------
+
+#include "CookedAnimationLoader.h"
+
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <span>
+#include <thread>
+
+#include <core/io/MappedFile.h>
+
+#include <engine/Animation/AnimationClip.h>
+
+namespace Unnamed {
+	static constexpr std::string_view kChannel = "CookedAnimationLoader";
+
+	namespace {
+		constexpr uint32_t kMagic   = 0x4D4E4155; // "UANM"
+		constexpr uint32_t kVersion = 1;
+
+		struct Header {
+			uint32_t magic;
+			uint32_t version;
+			int64_t  sourceWriteTime; // ナノ秒
+			uint64_t sourceSize;
+
+			uint32_t clipCount;
+			uint32_t reserved;
+			uint64_t fileSize;
+		};
+
+		int64_t ToNanoseconds(const FileStamp& stamp) {
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				stamp.lastWrite.time_since_epoch()
+			).count();
+		}
+	}
+
+	bool CookedAnimationLoader::CanLoad(
+		const std::string_view path, UASSET_TYPE* outType
+	) const {
+		const bool ok = StrUtil::ToLowerExt(path) == kExtension;
+		if (outType) {
+			*outType = ok ? UASSET_TYPE::ANIMATION : UASSET_TYPE::UNKNOWN;
+		}
+		return ok;
+	}
+
+	LoadResult CookedAnimationLoader::Load(const std::string& path) {
+		LoadResult r         = {};
+		auto       animation = Read(path);
+		if (!animation) {
+			Error(kChannel, "Failed to read cooked animation: {}", path);
+			return r;
+		}
+		animation->sourcePath = path;
+
+		r.payload     = std::move(*animation);
+		r.resolveName = std::filesystem::path(path).filename().string();
+		ReadFileStamp(path, r.stamp);
+		return r;
+	}
+
+	bool CookedAnimationLoader::Write(
+		const std::filesystem::path& path,
+		const AnimationAssetData&    animation,
+		const FileStamp&             source
+	) {
+		// ヘッダーの後ろに (名前の長さ, 名前, クリップ) をクリップの数だけ並べる
+		std::vector<uint8_t> body;
+		for (size_t i = 0; i < animation.clips.size(); ++i) {
+			const std::string& name   = animation.names[i];
+			const auto         length = static_cast<uint32_t>(name.size());
+			const auto         head   = reinterpret_cast<const uint8_t*>(&length);
+			body.insert(body.end(), head, head + sizeof(length));
+			body.insert(body.end(), name.begin(), name.end());
+			animation.clips[i]->Serialize(body);
+		}
+
+		Header header          = {};
+		header.magic           = kMagic;
+		header.version         = kVersion;
+		header.sourceWriteTime = ToNanoseconds(source);
+		header.sourceSize      = source.sizeInBytes;
+		header.clipCount       = static_cast<uint32_t>(animation.clips.size());
+		header.fileSize        = sizeof(Header) + body.size();
+
+		std::error_code ec;
+		std::filesystem::create_directories(path.parent_path(), ec);
+
+		std::filesystem::path temp = path;
+		temp += std::format( // 並列に書いてもぶつからないようにスレッドごとに分ける
+			".{:x}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id())
+		);
+		{
+			std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+			if (!out) {
+				Warning(
+					kChannel, "Failed to write cooked animation '{}'.",
+					temp.string()
+				);
+				return false;
+			}
+			out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			out.write(
+				reinterpret_cast<const char*>(body.data()),
+				static_cast<std::streamsize>(body.size())
+			);
+			if (!out) {
+				return false;
+			}
+		}
+
+		std::filesystem::rename(temp, path, ec);
+		if (ec) {
+			std::filesystem::remove(temp, ec);
+			return false;
+		}
+		return true;
+	}
+
+	std::optional<AnimationAssetData> CookedAnimationLoader::Read(
+		const std::filesystem::path& path,
+		const FileStamp*             source
+	) {
+		MappedFile file;
+		if (!file.Open(path) || file.Size() < sizeof(Header)) {
+			return std::nullopt;
+		}
+
+		Header header;
+		std::memcpy(&header, file.Data(), sizeof(header));
+		if (
+			header.magic != kMagic ||
+			header.version != kVersion ||
+			header.fileSize != file.Size()
+		) {
+			return std::nullopt;
+		}
+		if (source && (
+			header.sourceWriteTime != ToNanoseconds(*source) ||
+			header.sourceSize != source->sizeInBytes
+		)) {
+			return std::nullopt;
+		}
+
+		std::span body(
+			reinterpret_cast<const uint8_t*>(file.Data()) + sizeof(Header),
+			file.Size() - sizeof(Header)
+		);
+
+		AnimationAssetData animation;
+		animation.names.reserve(header.clipCount);
+		animation.clips.reserve(header.clipCount);
+		for (uint32_t i = 0; i < header.clipCount; ++i) {
+			uint32_t length;
+			if (body.size() < sizeof(length)) {
+				break;
+			}
+			std::memcpy(&length, body.data(), sizeof(length));
+			body = body.subspan(sizeof(length));
+			if (body.size() < length) {
+				break;
+			}
+			animation.names.emplace_back(
+				reinterpret_cast<const char*>(body.data()), length
+			);
+			body = body.subspan(length);
+
+			auto clip = std::make_shared<AnimationClip>();
+			if (!clip->Deserialize(body)) {
+				break;
+			}
+			animation.clips.emplace_back(std::move(clip));
+		}
+
+		if (animation.clips.size() != header.clipCount || !body.empty()) {
+			Warning(kChannel, "Cooked animation '{}' is corrupted.", path.string());
+			return std::nullopt;
+		}
+		return animation;
+	}
+}
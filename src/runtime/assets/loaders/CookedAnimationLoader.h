@@ -0,0 +1,40 @@
+﻿#pragma once
+#include <filesystem>
+#include <optional>
+
+#include "interface/IAssetLoader.h"
+
+namespace Unnamed {
+	//-------------------------------------------------------------------------
+	// Purpose: 焼いたアニメーション(.uanim)のローダー
+	// 1ファイル分の全クリップを AnimationClip::Serialize した形で並べたバイナリで、
+	// 読み込み時は Assimp もキーの間引きも通さずにクリップへ戻すだけです
+	//-------------------------------------------------------------------------
+	class CookedAnimationLoader : public IAssetLoader {
+	public:
+		static constexpr std::string_view kExtension = ".uanim";
+
+		bool CanLoad(
+			std::string_view path, UASSET_TYPE* outType
+		) const override;
+
+		LoadResult Load(const std::string& path) override;
+
+		/// @brief アニメーションを焼いて書き出します
+		/// @param source ソースファイルのスタンプ。Read() で古くなっていないかの確認に使います
+		/// @details 一時ファイルに書いてから置き換えるので、書き込み中に落ちても壊れたファイルは残りません
+		static bool Write(
+			const std::filesystem::path& path,
+			const AnimationAssetData&    animation,
+			const FileStamp&             source
+		);
+
+		/// @brief 焼いたアニメーションを読み込みます
+		/// @param source nullでなければ、焼いた時のスタンプと一致するか確認します
+		/// @return 無い、古い、形式が違うなどで使えなければnullopt
+		static std::optional<AnimationAssetData> Read(
+			const std::filesystem::path& path,
+			const FileStamp*             source = nullptr
+		);
+	};
+}
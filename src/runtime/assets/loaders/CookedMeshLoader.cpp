@@ -0,0 +1,441 @@
+﻿#include <pch.h>
+
+//-----------------------------------------------------------------------------
+
+#include "CookedMeshLoader.h"
+
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <thread>
+#include <type_traits>
+
+#include <core/io/MappedFile.h>
+#include <core/memory/MemUtil.h>
+
+#include <runtime/assets/types/MeshAsset.h>
+
+namespace Unnamed {
+	static constexpr std::string_view kChannel = "CookedMeshLoader";
+
+	namespace {
+		constexpr uint32_t kMagic   = 0x48534D55; // "UMSH"
+		constexpr uint32_t kVersion = 1;
+		// 各セクションの先頭をこれに揃える(SIMDでそのまま読めるように)
+		constexpr uint64_t kSectionAlignment = 16;
+
+		static_assert(std::is_trivially_copyable_v<Vec2>);
+		static_assert(std::is_trivially_copyable_v<Vec3>);
+		static_assert(std::is_trivially_copyable_v<Vec4>);
+		static_assert(std::is_trivially_copyable_v<MeshSubmesh>);
+		// Mat4 はコピーコンストラクタを持つが中身は float[4][4] だけ
+		static_assert(std::is_standard_layout_v<Mat4>);
+		static_assert(sizeof(Mat4) == sizeof(float) * 16);
+
+		enum SECTION : uint32_t {
+			SECTION_POSITIONS,
+			SECTION_NORMALS,
+			SECTION_TANGENTS,
+			SECTION_UV0,
+			SECTION_COLOR0,
+			SECTION_INDICES,
+			SECTION_SUBMESHES,
+			SECTION_INV_BIND,
+			SECTION_JOINTS,
+			SECTION_WEIGHTS,
+			SECTION_MORPH_POSITIONS, // [ターゲット][頂点]
+			SECTION_MORPH_NORMALS,   // [ターゲット][頂点]
+			SECTION_NAMES,           // ジョイント名 → モーフ名 (uint32 長さ + 文字列)
+			SECTION_COUNT,
+		};
+
+		struct Section {
+			uint64_t offset;
+			uint64_t count; // 要素数(SECTION_NAMES はバイト数)
+		};
+
+		struct Header {
+			uint32_t magic;
+			uint32_t version;
+			int64_t  sourceWriteTime; // ナノ秒
+			uint64_t sourceSize;
+
+			// 構造体のサイズが変わったら焼き直す
+			uint32_t vec3Size;
+			uint32_t submeshSize;
+
+			uint32_t jointCount;
+			uint32_t morphTargetCount;
+			uint32_t hasSkin;
+			uint32_t hasMorphTarget;
+
+			float boundsMin[3];
+			float boundsMax[3];
+
+			Section  sections[SECTION_COUNT];
+			uint64_t fileSize;
+		};
+
+		int64_t ToNanoseconds(const FileStamp& stamp) {
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				stamp.lastWrite.time_since_epoch()
+			).count();
+		}
+
+		// マップした領域のセクションを型付きで参照する
+		template <class T>
+		bool View(
+			const MappedFile&   file,
+			const Section&      section,
+			std::span<const T>& out
+		) {
+			if (section.count > file.Size() / sizeof(T)) {
+				return false;
+			}
+			const uint64_t bytes = section.count * sizeof(T);
+			if (section.offset % alignof(T) != 0 ||
+				section.offset > file.Size() ||
+				bytes > file.Size() - section.offset) {
+				return false;
+			}
+			out = {
+				reinterpret_cast<const T*>(file.Data() + section.offset),
+				static_cast<size_t>(section.count)
+			};
+			return true;
+		}
+
+		// 描画側は頂点ごとに法線とUVを読むので、数とインデックスの範囲をここで確かめる
+		bool IsConsistent(const MeshStreamView& s) {
+			// 頂点ごとのストリームは空か頂点数と同じ(法線とUVは必須)
+			const size_t vertexCount = s.positions.size();
+			const auto   perVertex   = [&](const size_t count) {
+				return count == 0 || count == vertexCount;
+			};
+			if (
+				s.normals.size() != vertexCount ||
+				s.uv0.size() != vertexCount ||
+				!perVertex(s.tangents.size()) ||
+				!perVertex(s.color0.size()) ||
+				!perVertex(s.joints.size()) ||
+				s.weights.size() != s.joints.size()
+			) {
+				return false;
+			}
+
+			// インデックスが頂点をはみ出さない(分岐なしで最大値だけ取る)
+			uint32_t maxIndex = 0;
+			for (const uint32_t index : s.indices) {
+				maxIndex = std::max(maxIndex, index);
+			}
+			if (!s.indices.empty() && maxIndex >= vertexCount) {
+				return false;
+			}
+
+			// サブメッシュがインデックスバッファをはみ出さない
+			for (const MeshSubmesh& submesh : s.submeshes) {
+				const uint64_t end = static_cast<uint64_t>(submesh.indexOffset) +
+					submesh.indexCount;
+				if (end > s.indices.size()) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		void AppendName(std::vector<char>& names, const std::string& name) {
+			const auto length = static_cast<uint32_t>(name.size());
+			const auto head   = reinterpret_cast<const char*>(&length);
+			names.insert(names.end(), head, head + sizeof(length));
+			names.insert(names.end(), name.begin(), name.end());
+		}
+
+		bool ReadName(
+			std::span<const char>& names,
+			std::string&           out
+		) {
+			uint32_t length;
+			if (names.size() < sizeof(length)) {
+				return false;
+			}
+			std::memcpy(&length, names.data(), sizeof(length));
+			names = names.subspan(sizeof(length));
+			if (names.size() < length) {
+				return false;
+			}
+			out.assign(names.data(), length);
+			names = names.subspan(length);
+			return true;
+		}
+	}
+
+	bool CookedMeshLoader::CanLoad(
+		const std::string_view path, UASSET_TYPE* outType
+	) const {
+		const bool ok = StrUtil::ToLowerExt(path) == kExtension;
+		if (outType) {
+			*outType = ok ? UASSET_TYPE::MESH : UASSET_TYPE::UNKNOWN;
+		}
+		return ok;
+	}
+
+	LoadResult CookedMeshLoader::Load(const std::string& path) {
+		LoadResult r = {};
+		auto       mesh = Map(path);
+		if (!mesh) {
+			Error(kChannel, "Failed to map cooked mesh: {}", path);
+			return r;
+		}
+		mesh->sourcePath = path;
+
+		r.payload     = std::move(*mesh);
+		r.resolveName = std::filesystem::path(path).filename().string();
+		ReadFileStamp(path, r.stamp);
+		return r;
+	}
+
+	bool CookedMeshLoader::Write(
+		const std::filesystem::path& path,
+		const MeshAssetData&         mesh,
+		const FileStamp&             source
+	) {
+		const MeshStreamView streams = mesh.Streams();
+
+		// モーフは全頂点ぶんに揃えて1本に詰める
+		// (複数メッシュのファイルでは先に読んだターゲットが短いので、差分ゼロで埋める)
+		const size_t      vertexCount = streams.positions.size();
+		std::vector<Vec3> morphPositions;
+		std::vector<Vec3> morphNormals;
+		morphPositions.reserve(mesh.morphTargets.size() * vertexCount);
+		morphNormals.reserve(mesh.morphTargets.size() * vertexCount);
+		for (const auto& target : mesh.morphTargets) {
+			if (target.positions.size() > vertexCount ||
+				target.normals.size() > vertexCount) {
+				Warning(
+					kChannel,
+					"Morph target '{}' has more vertices than the mesh.",
+					target.name
+				);
+				return false;
+			}
+			morphPositions.insert(
+				morphPositions.end(),
+				target.positions.begin(), target.positions.end()
+			);
+			morphPositions.resize(morphPositions.size() + vertexCount -
+			                      target.positions.size(), Vec3::zero);
+			morphNormals.insert(
+				morphNormals.end(),
+				target.normals.begin(), target.normals.end()
+			);
+			morphNormals.resize(morphNormals.size() + vertexCount -
+			                    target.normals.size(), Vec3::zero);
+		}
+
+		std::vector<char> names;
+		for (const auto& name : mesh.skin.jointNames) {
+			AppendName(names, name);
+		}
+		for (const auto& target : mesh.morphTargets) {
+			AppendName(names, target.name);
+		}
+
+		Header header           = {};
+		header.magic            = kMagic;
+		header.version          = kVersion;
+		header.sourceWriteTime  = ToNanoseconds(source);
+		header.sourceSize       = source.sizeInBytes;
+		header.vec3Size         = sizeof(Vec3);
+		header.submeshSize      = sizeof(MeshSubmesh);
+		header.jointCount       = static_cast<uint32_t>(mesh.skin.jointNames.size());
+		header.morphTargetCount = static_cast<uint32_t>(mesh.morphTargets.size());
+		header.hasSkin          = mesh.hasSkin ? 1 : 0;
+		header.hasMorphTarget   = mesh.hasMorphTarget ? 1 : 0;
+		header.boundsMin[0]     = mesh.meshBounds.min.x;
+		header.boundsMin[1]     = mesh.meshBounds.min.y;
+		header.boundsMin[2]     = mesh.meshBounds.min.z;
+		header.boundsMax[0]     = mesh.meshBounds.max.x;
+		header.boundsMax[1]     = mesh.meshBounds.max.y;
+		header.boundsMax[2]     = mesh.meshBounds.max.z;
+
+		struct Payload {
+			const void* data;
+			size_t      count;
+			size_t      bytes;
+		};
+		const auto payloadOf = [](const auto& range) {
+			return Payload{range.data(), range.size(), range.size_bytes()};
+		};
+		const Payload payloads[SECTION_COUNT] = {
+			payloadOf(streams.positions),
+			payloadOf(streams.normals),
+			payloadOf(streams.tangents),
+			payloadOf(streams.uv0),
+			payloadOf(streams.color0),
+			payloadOf(streams.indices),
+			payloadOf(streams.submeshes),
+			payloadOf(streams.invBind),
+			payloadOf(streams.joints),
+			payloadOf(streams.weights),
+			payloadOf(std::span<const Vec3>(morphPositions)),
+			payloadOf(std::span<const Vec3>(morphNormals)),
+			payloadOf(std::span<const char>(names)),
+		};
+
+		// ヘッダーの後ろに各セクションをアライメントを揃えて並べる
+		uint64_t offset = sizeof(Header);
+		for (uint32_t i = 0; i < SECTION_COUNT; ++i) {
+			offset                    = MemUtil::AlignUp(offset, kSectionAlignment);
+			header.sections[i].offset = offset;
+			header.sections[i].count  = payloads[i].count;
+			offset += payloads[i].bytes;
+		}
+		header.fileSize = offset;
+
+		std::error_code ec;
+		std::filesystem::create_directories(path.parent_path(), ec);
+
+		// 同じメッシュを並列に焼いても一時ファイルがぶつからないようにスレッドごとに分ける
+		std::filesystem::path temp = path;
+		temp += std::format(
+			".{:x}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id())
+		);
+		{
+			std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+			if (!out) {
+				Warning(
+					kChannel, "Failed to write cooked mesh '{}'.",
+					temp.string()
+				);
+				return false;
+			}
+
+			const auto write = [&](const uint64_t at, const void* data,
+			                       const size_t   bytes) {
+				// パディングをゼロで埋める
+				static constexpr char kZero[kSectionAlignment] = {};
+				const uint64_t        pos = static_cast<uint64_t>(out.tellp());
+				out.write(kZero, static_cast<std::streamsize>(at - pos));
+				out.write(
+					static_cast<const char*>(data),
+					static_cast<std::streamsize>(bytes)
+				);
+			};
+			write(0, &header, sizeof(header));
+			for (uint32_t i = 0; i < SECTION_COUNT; ++i) {
+				write(
+					header.sections[i].offset,
+					payloads[i].data, payloads[i].bytes
+				);
+			}
+			if (!out) {
+				return false;
+			}
+		}
+
+		std::filesystem::rename(temp, path, ec);
+		if (ec) {
+			// 置き換えられなくても古いファイルはスタンプで弾かれるので、次の読み込みで焼き直す
+			Warning(
+				kChannel, "Failed to replace cooked mesh '{}': {}",
+				path.string(), ec.message()
+			);
+			std::filesystem::remove(temp, ec);
+			return false;
+		}
+		return true;
+	}
+
+	std::optional<MeshAssetData> CookedMeshLoader::Map(
+		const std::filesystem::path& path,
+		const FileStamp*             source
+	) {
+		auto file = std::make_shared<MappedFile>();
+		if (!file->Open(path) || file->Size() < sizeof(Header)) {
+			return std::nullopt;
+		}
+
+		const auto& header = *reinterpret_cast<const Header*>(file->Data());
+		if (
+			header.magic != kMagic ||
+			header.version != kVersion ||
+			header.vec3Size != sizeof(Vec3) ||
+			header.submeshSize != sizeof(MeshSubmesh) ||
+			header.fileSize != file->Size()
+		) {
+			return std::nullopt;
+		}
+		if (source && (
+			header.sourceWriteTime != ToNanoseconds(*source) ||
+			header.sourceSize != source->sizeInBytes
+		)) {
+			return std::nullopt;
+		}
+
+		MeshAssetData         mesh;
+		MeshStreamView&       s = mesh.mappedStreams;
+		std::span<const Vec3> morphPositions;
+		std::span<const Vec3> morphNormals;
+		std::span<const char> names;
+
+		const Section* sec = header.sections;
+		if (
+			!View(*file, sec[SECTION_POSITIONS], s.positions) ||
+			!View(*file, sec[SECTION_NORMALS], s.normals) ||
+			!View(*file, sec[SECTION_TANGENTS], s.tangents) ||
+			!View(*file, sec[SECTION_UV0], s.uv0) ||
+			!View(*file, sec[SECTION_COLOR0], s.color0) ||
+			!View(*file, sec[SECTION_INDICES], s.indices) ||
+			!View(*file, sec[SECTION_SUBMESHES], s.submeshes) ||
+			!View(*file, sec[SECTION_INV_BIND], s.invBind) ||
+			!View(*file, sec[SECTION_JOINTS], s.joints) ||
+			!View(*file, sec[SECTION_WEIGHTS], s.weights) ||
+			!View(*file, sec[SECTION_MORPH_POSITIONS], morphPositions) ||
+			!View(*file, sec[SECTION_MORPH_NORMALS], morphNormals) ||
+			!View(*file, sec[SECTION_NAMES], names)
+		) {
+			Warning(kChannel, "Cooked mesh '{}' is corrupted.", path.string());
+			return std::nullopt;
+		}
+
+		const size_t vertexCount = s.positions.size();
+		const size_t morphValues = static_cast<size_t>(header.morphTargetCount) *
+			vertexCount;
+		if (morphPositions.size() != morphValues ||
+			morphNormals.size() != morphValues ||
+			!IsConsistent(s)) {
+			Warning(kChannel, "Cooked mesh '{}' is corrupted.", path.string());
+			return std::nullopt;
+		}
+
+		// 名前とモーフは数が少ないのでコピーして持つ
+		mesh.skin.jointNames.resize(header.jointCount);
+		for (auto& name : mesh.skin.jointNames) {
+			if (!ReadName(names, name)) {
+				return std::nullopt;
+			}
+		}
+		mesh.morphTargets.resize(header.morphTargetCount);
+		for (size_t t = 0; t < mesh.morphTargets.size(); ++t) {
+			auto& target = mesh.morphTargets[t];
+			if (!ReadName(names, target.name)) {
+				return std::nullopt;
+			}
+			const auto deltas = morphPositions.subspan(t * vertexCount, vertexCount);
+			const auto normal = morphNormals.subspan(t * vertexCount, vertexCount);
+			target.positions.assign(deltas.begin(), deltas.end());
+			target.normals.assign(normal.begin(), normal.end());
+		}
+
+		mesh.hasSkin        = header.hasSkin != 0;
+		mesh.hasMorphTarget = header.hasMorphTarget != 0;
+		mesh.meshBounds.min = Vec3(
+			header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]
+		);
+		mesh.meshBounds.max = Vec3(
+			header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]
+		);
+		mesh.mappedFile = std::move(file);
+		return mesh;
+	}
+}
@@ -0,0 +1,40 @@
+﻿#pragma once
+#include <filesystem>
+#include <optional>
+
+#include "interface/IAssetLoader.h"
+
+namespace Unnamed {
+	//-------------------------------------------------------------------------
+	// Purpose: 焼いたメッシュ(.umesh)のローダー
+	// MeshAssetData の各ストリームを16バイト境界に揃えて並べたバイナリで、
+	// 読み込み時はファイルをマップして MeshAssetData::mappedStreams が直接指します
+	//-------------------------------------------------------------------------
+	class CookedMeshLoader : public IAssetLoader {
+	public:
+		static constexpr std::string_view kExtension = ".umesh";
+
+		bool CanLoad(
+			std::string_view path, UASSET_TYPE* outType
+		) const override;
+
+		LoadResult Load(const std::string& path) override;
+
+		/// @brief メッシュを焼いて書き出します
+		/// @param source ソースファイルのスタンプ。Map() で古くなっていないかの確認に使います
+		/// @details 一時ファイルに書いてから置き換えるので、書き込み中に落ちても壊れたファイルは残りません
+		static bool Write(
+			const std::filesystem::path& path,
+			const MeshAssetData&         mesh,
+			const FileStamp&             source
+		);
+
+		/// @brief 焼いたメッシュをマップします
+		/// @param source nullでなければ、焼いた時のスタンプと一致するか確認します
+		/// @return 無い、古い、形式が違うなどで使えなければnullopt
+		static std::optional<MeshAssetData> Map(
+			const std::filesystem::path& path,
+			const FileStamp*             source = nullptr
+		);
+	};
+}
@@ -10,10 +10,122 @@
 
 #include <DirectXTex.h>
 #include <filesystem>
+#include <format>
+
+#include <runtime/assets/types/TextureAsset.h>
 
 namespace Unnamed {
 	constexpr std::string_view kChannel = "DirectXTexTextureLoader";
 
+	namespace {
+		// 焼き方を変えたら上げる(以前 BC5 で焼いたノーマルマップを作り直させる)
+		constexpr uint32_t kCookVersion = 2;
+
+		// 焼いたファイル名の "<stem>_<パスのハッシュ>_" の部分
+		std::string CookedPrefix(const std::string& path) {
+			return std::format(
+				"{}_{:016x}_",
+				std::filesystem::path(path).stem().string(),
+				std::hash<std::string>{}(path)
+			);
+		}
+
+		// 焼く形式を選ぶ。BCはトップレベルが4の倍数でないと作れないので、その時は焼かない
+		// ノーマルマップも BC5 にはしない(Zを復元するシェーダーが無いので、カラーと同じ形式で焼く)
+		DXGI_FORMAT SelectCookFormat(
+			const DirectX::ScratchImage& img,
+			const bool                   preferBC7
+		) {
+			const auto& meta = img.GetMetadata();
+			if (meta.width % 4 != 0 || meta.height % 4 != 0) {
+				return DXGI_FORMAT_UNKNOWN;
+			}
+			if (preferBC7) {
+				return DXGI_FORMAT_BC7_UNORM;
+			}
+			return img.IsAlphaAllOpaque() ?
+				       DXGI_FORMAT_BC1_UNORM :
+				       DXGI_FORMAT_BC3_UNORM;
+		}
+
+		// ScratchImage の各ミップをそのままの形式で詰める
+		TextureAssetData ToAssetData(
+			const DirectX::ScratchImage& img,
+			const std::string&           path
+		) {
+			const auto& meta = img.GetMetadata();
+
+			TextureAssetData out = {};
+			out.width            = static_cast<uint32_t>(meta.width);
+			out.height           = static_cast<uint32_t>(meta.height);
+			out.format           = meta.format;
+			out.isSRGB           = DirectX::IsSRGB(meta.format);
+			out.sourcePath       = path;
+
+			out.mips.resize(meta.mipLevels);
+			for (size_t m = 0; m < meta.mipLevels; ++m) {
+				const DirectX::Image* im  = img.GetImage(m, 0, 0);
+				TextureMip            mip = {};
+				mip.width                 = static_cast<uint32_t>(im->width);
+				mip.height                = static_cast<uint32_t>(im->height);
+				mip.rowPitch              = im->rowPitch;
+				mip.rowCount              = static_cast<uint32_t>(
+					DirectX::ComputeScanlines(meta.format, im->height)
+				);
+				mip.bytes.assign(
+					im->pixels,
+					im->pixels + mip.rowPitch * mip.rowCount
+				);
+				out.mips[m] = std::move(mip);
+			}
+			return out;
+		}
+
+		// 一時ファイルに書いてから置き換え、同じソースの古いものを消す
+		bool SaveCooked(
+			const DirectX::ScratchImage& img,
+			const std::filesystem::path& cookedPath,
+			const std::string&           prefix
+		) {
+			std::error_code ec;
+			const auto      directory = cookedPath.parent_path();
+			std::filesystem::create_directories(directory, ec);
+
+			auto tmp = cookedPath;
+			tmp += ".tmp";
+			if (FAILED(
+				DirectX::SaveToDDSFile(
+					img.GetImages(), img.GetImageCount(), img.GetMetadata(),
+					DirectX::DDS_FLAGS_NONE, tmp.wstring().c_str()
+				)
+			)) {
+				std::filesystem::remove(tmp, ec);
+				return false;
+			}
+			std::filesystem::rename(tmp, cookedPath, ec);
+			if (ec) {
+				std::filesystem::remove(tmp, ec);
+				return false;
+			}
+
+			for (const auto& entry :
+			     std::filesystem::directory_iterator(directory, ec)) {
+				const std::string name = entry.path().filename().string();
+				if (entry.path() != cookedPath && name.starts_with(prefix)) {
+					std::filesystem::remove(entry.path(), ec);
+				}
+			}
+			return true;
+		}
+	}
+
+	DirectXTexTextureLoader::DirectXTexTextureLoader(
+		std::filesystem::path cookDirectory,
+		const bool            preferBC7
+	) : mCookDirectory(std::move(cookDirectory)),
+	    mPreferBC7(preferBC7) {
+	}
+
 	bool DirectXTexTextureLoader::CanLoad(
 		std::string_view path,
 		UASSET_TYPE*     outType
@@ -37,7 +149,8 @@ namespace Unnamed {
 	LoadResult DirectXTexTextureLoader::Load(
 		const std::string& path
 	) {
-		LoadResult r = {};
+		LoadResult r  = {};
+		r.resolveName = std::filesystem::path(path).filename().string();
 		using namespace DirectX;
 
 		ScratchImage img;
@@ -46,6 +159,29 @@ namespace Unnamed {
 
 		std::wstring wPath = StrUtil::ToWString(path);
 		std::string  ext   = StrUtil::ToLowerExt(path);
+
+		// HDRはBC6Hを使うまではRGBA8のまま
+		const bool hasStamp = ReadFileStamp(path, r.stamp);
+		const bool cook     = !mCookDirectory.empty() && ext != ".hdr" &&
+			hasStamp;
+
+		// ソースが変わっていなければ焼いたものを変換なしで使う
+		std::filesystem::path cookedPath;
+		if (cook) {
+			cookedPath = CookedPathFor(path, r.stamp);
+			if (std::error_code ec; std::filesystem::exists(cookedPath, ec)) {
+				hr = LoadFromDDSFile(
+					cookedPath.wstring().c_str(), DDS_FLAGS_NONE, &meta, img
+				);
+				if (SUCCEEDED(hr) && IsCompressed(meta.format)) {
+					r.payload = ToAssetData(img, path);
+					return r;
+				}
+				Warning(kChannel, "Ignoring broken cooked texture: {}",
+				        cookedPath.string());
+			}
+		}
+
 		if (ext == ".dds") {
 			hr = LoadFromDDSFile(
 				wPath.c_str(), DDS_FLAGS_NONE, &meta, img
@@ -60,11 +196,17 @@ namespace Unnamed {
 			return r;
 		}
 
+		// 既に圧縮済みのDDSはそのまま使う
+		if (IsCompressed(meta.format) && meta.dimension ==
+			TEX_DIMENSION_TEXTURE2D && meta.arraySize == 1) {
+			r.payload = ToAssetData(img, path);
+			return r;
+		}
+
 		// RGBAへ変換
 		constexpr DXGI_FORMAT kTarget = DXGI_FORMAT_R8G8B8A8_UNORM;
-		ScratchImage          converted;
-		const Image*          base = nullptr;
 		if (meta.format != kTarget) {
+			ScratchImage converted;
 			hr = Convert(
 				img.GetImages(),
 				img.GetImageCount(),
@@ -78,7 +220,6 @@ namespace Unnamed {
 				Error(kChannel, "Failed to convert texture: {}", path);
 				return r;
 			}
-			base = converted.GetImage(0, 0, 0);
 			meta = converted.GetMetadata();
 			img  = std::move(converted);
 		}
@@ -97,38 +238,51 @@ namespace Unnamed {
 			}
 		}
 
-		TextureAssetData out = {};
-		out.width            = static_cast<uint32_t>(meta.width);
-		out.height           = static_cast<uint32_t>(meta.height);
-		out.sourcePath       = path;
-
-		out.mips.resize(meta.mipLevels);
-		for (size_t m = 0; m < meta.mipLevels; ++m) {
-			const Image* im  = img.GetImage(m, 0, 0);
-			TextureMip   mip = {};
-			mip.width        = static_cast<uint32_t>(im->width);
-			mip.height       = static_cast<uint32_t>(im->height);
-			mip.rowPitch     = size_t(mip.width) * 4; // RGBA8
-			mip.bytes.resize(mip.rowPitch * mip.height);
-
-			for (uint32_t y = 0; y < mip.height; ++y) {
-				memcpy(
-					mip.bytes.data() + y * mip.rowPitch,
-					im->pixels + y * im->rowPitch,
-					std::min(mip.rowPitch,
-					         static_cast<size_t>(im->rowPitch)
-					)
+		// BC圧縮して焼く。焼けなければRGBA8のまま返す
+		if (cook) {
+			const DXGI_FORMAT format = SelectCookFormat(img, mPreferBC7);
+			if (format != DXGI_FORMAT_UNKNOWN) {
+				TEX_COMPRESS_FLAGS flags = TEX_COMPRESS_PARALLEL;
+				if (format == DXGI_FORMAT_BC7_UNORM) {
+					flags |= TEX_COMPRESS_BC7_QUICK;
+				}
+
+				ScratchImage compressed;
+				hr = Compress(
+					img.GetImages(), img.GetImageCount(), meta,
+					format, flags, TEX_THRESHOLD_DEFAULT, compressed
 				);
+				if (SUCCEEDED(hr)) {
+					if (!SaveCooked(compressed, cookedPath, CookedPrefix(path))) {
+						Warning(kChannel, "Failed to cook texture: {}", path);
+					}
+					r.payload = ToAssetData(compressed, path);
+					return r;
+				}
+				Warning(kChannel, "Failed to compress texture: {}", path);
 			}
-			out.mips[m] = std::move(mip);
-		}
-
-		r.payload     = std::move(out);
-		r.resolveName = std::filesystem::path(path).filename().string();
-		if (std::error_code ec; std::filesystem::exists(path, ec)) {
-			r.stamp.sizeInBytes = std::filesystem::file_size(path, ec);
 		}
 
+		r.payload = ToAssetData(img, path);
 		return r;
 	}
+
+	std::filesystem::path DirectXTexTextureLoader::CookedPathFor(
+		const std::string& path, const FileStamp& stamp
+	) const {
+		// 同名のファイルがぶつからないようパスのハッシュを、
+		// 古くなったものを使わないようスタンプと設定、焼き方の版のハッシュを付ける
+		const int64_t writeTime = std::chrono::duration_cast<
+			std::chrono::nanoseconds>(
+			stamp.lastWrite.time_since_epoch()
+		).count();
+		const size_t stampHash = std::hash<std::string>{}(
+			std::format(
+				"{}:{}:{}:{}", writeTime, stamp.sizeInBytes, mPreferBC7, kCookVersion
+			)
+		);
+		return mCookDirectory / std::format(
+			"{}{:016x}.dds", CookedPrefix(path), stampHash
+		);
+	}
 }
@@ -1,13 +1,36 @@
 ﻿#pragma once
+#include <filesystem>
+
 #include "interface/IAssetLoader.h"
 
 namespace Unnamed {
+	//-------------------------------------------------------------------------
+	// Purpose: DirectXTex でテクスチャを読み込むローダー
+	// 初回はミップを生成してBC圧縮したDDSを焼き、以降ソースが変わるまでは
+	// 焼いたものを変換なしでそのまま返します(形式は TextureAssetData::format)
+	//-------------------------------------------------------------------------
 	class DirectXTexTextureLoader : public IAssetLoader {
 	public:
+		/// @param cookDirectory 焼いたDDSの置き場所。空なら焼かずに毎回RGBA8へ変換します
+		/// @param preferBC7 カラーを BC1/BC3 ではなく BC7 で焼きます(高画質だが焼くのが遅い)
+		explicit DirectXTexTextureLoader(
+			std::filesystem::path cookDirectory = "./cache/textures",
+			bool                  preferBC7     = false
+		);
+
 		bool CanLoad(
 			std::string_view path,
 			UASSET_TYPE*     outType
 		) const override;
 		LoadResult Load(const std::string& path) override;
+
+		// ソースのパスとスタンプから焼いたファイルのパスを決めます
+		[[nodiscard]] std::filesystem::path CookedPathFor(
+			const std::string& path, const FileStamp& stamp
+		) const;
+
+	private:
+		std::filesystem::path mCookDirectory;
+		bool                  mPreferBC7 = false;
 	};
 }
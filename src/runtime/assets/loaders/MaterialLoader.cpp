@@ -54,22 +54,24 @@ namespace Unnamed {
 		// Body/Metaのロード
 		if (json.contains("programBody") && json["programBody"].is_string()) {
 			const std::string body = json["programBody"].get<std::string>();
-			m.programBody          = mAssetManager->LoadFromFile(
+			m.programBody          = mAssetManager->Reserve(
 				body, UASSET_TYPE::RAWFILE
 			);
+			result.dependencies.emplace_back(m.programBody);
 		}
 		if (json.contains("programMeta") && json["programMeta"].is_string()) {
 			const std::string meta = json["programMeta"].get<std::string>();
-			m.programMeta          = mAssetManager->LoadFromFile(
+			m.programMeta          = mAssetManager->Reserve(
 				meta, UASSET_TYPE::RAWFILE
 			);
+			result.dependencies.emplace_back(m.programMeta);
 		}
 
 		// シェーダー
 		if (json.contains("shader")) {
 			if (json["shader"].is_string()) {
 				std::string shaderPath = json["shader"].get<std::string>();
-				AssetID     sid        = mAssetManager->LoadFromFile(
+				AssetID     sid        = mAssetManager->Reserve(
 					shaderPath, UASSET_TYPE::SHADER
 				);
 				m.shader = sid;
@@ -77,21 +79,21 @@ namespace Unnamed {
 			} else if (json["shader"].is_object()) {
 				const auto& sj = json["shader"];
 				if (sj.contains("vs")) {
-					AssetID vs = mAssetManager->LoadFromFile(
+					AssetID vs = mAssetManager->Reserve(
 						sj["vs"].get<std::string>(), UASSET_TYPE::SHADER
 					);
 					m.shaderVS = vs;
 					result.dependencies.emplace_back(vs);
 				}
 				if (sj.contains("ps")) {
-					AssetID ps = mAssetManager->LoadFromFile(
+					AssetID ps = mAssetManager->Reserve(
 						sj["ps"].get<std::string>(), UASSET_TYPE::SHADER
 					);
 					m.shaderPS = ps;
 					result.dependencies.emplace_back(ps);
 				}
 				if (sj.contains("gs")) {
-					AssetID gs = mAssetManager->LoadFromFile(
+					AssetID gs = mAssetManager->Reserve(
 						sj["gs"].get<std::string>(), UASSET_TYPE::SHADER
 					);
 					m.shaderGS = gs;
@@ -127,7 +129,7 @@ namespace Unnamed {
 		if (json.contains("textures") && json["textures"].is_object()) {
 			for (auto& [slot, val] : json["textures"].items()) {
 				auto    texPath = val.get<std::string>();
-				AssetID tid     = mAssetManager->LoadFromFile(
+				AssetID tid     = mAssetManager->Reserve(
 					texPath, UASSET_TYPE::TEXTURE);
 				m.textureSlots[slot] = tid;
 				result.dependencies.emplace_back(tid);
@@ -5,11 +5,13 @@
 #include "MeshLoader.h"
 
 #include <filesystem>
+#include <format>
 
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 
+#include <runtime/assets/loaders/CookedMeshLoader.h>
 #include <runtime/assets/types/MeshAsset.h>
 
 namespace Unnamed {
@@ -239,6 +241,10 @@ namespace Unnamed {
 		}
 	}
 
+	MeshLoader::MeshLoader(std::filesystem::path cookDirectory)
+		: mCookDirectory(std::move(cookDirectory)) {
+	}
+
 	bool MeshLoader::CanLoad(
 		const std::string_view path, UASSET_TYPE* outType
 	) const {
@@ -256,7 +262,19 @@ namespace Unnamed {
 	}
 
 	LoadResult MeshLoader::Load(const std::string& path) {
-		LoadResult    r   = {};
+		LoadResult r  = {};
+		r.resolveName = std::filesystem::path(path).filename().string();
+
+		// ソースが変わっていなければ焼いたものをそのまま使う
+		const bool cook = !mCookDirectory.empty() && ReadFileStamp(path, r.stamp);
+		if (cook) {
+			if (auto cooked = CookedMeshLoader::Map(CookedPathFor(path), &r.stamp)) {
+				cooked->sourcePath = path;
+				r.payload          = std::move(*cooked);
+				return r;
+			}
+		}
+
 		MeshAssetData out = {};
 		out.sourcePath    = path;
 
@@ -315,11 +333,23 @@ namespace Unnamed {
 			}
 		}
 
-		r.payload     = std::move(out);
-		r.resolveName = std::filesystem::path(path).filename().string();
-		if (std::error_code ec; std::filesystem::exists(path, ec)) {
-			r.stamp.sizeInBytes = std::filesystem::file_size(path, ec);
+		if (cook && !CookedMeshLoader::Write(CookedPathFor(path), out, r.stamp)) {
+			Warning(kChannel, "Failed to cook mesh: {}", path);
 		}
+
+		r.payload = std::move(out);
 		return r;
 	}
+
+	std::filesystem::path MeshLoader::CookedPathFor(
+		const std::string& path
+	) const {
+		// 同名のファイルがぶつからないようパスのハッシュを付ける
+		return mCookDirectory / std::format(
+			"{}_{:016x}{}",
+			std::filesystem::path(path).stem().string(),
+			std::hash<std::string>{}(path),
+			CookedMeshLoader::kExtension
+		);
+	}
 }
@@ -1,13 +1,29 @@
 ﻿#pragma once
+#include <filesystem>
+
 #include "interface/IAssetLoader.h"
 
 namespace Unnamed {
 	class MeshLoader : public IAssetLoader {
 	public:
+		/// @param cookDirectory 焼いたメッシュ(.umesh)の置き場所
+		/// 初回は Assimp で読み込んで焼き、以降ソースが変わるまでは焼いたものをマップします。
+		/// 空なら焼かずに毎回 Assimp で読み込みます
+		explicit MeshLoader(
+			std::filesystem::path cookDirectory = "./cache/meshes"
+		);
+
 		bool CanLoad(
 			std::string_view path, UASSET_TYPE* outType
 		) const override;
 
 		LoadResult Load(const std::string& path) override;
+
+		[[nodiscard]] std::filesystem::path CookedPathFor(
+			const std::string& path
+		) const;
+
+	private:
+		std::filesystem::path mCookDirectory;
 	};
 }
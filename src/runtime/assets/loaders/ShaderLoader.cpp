@@ -50,7 +50,7 @@ namespace Unnamed {
 				std::filesystem::path incp = (base / inc).lexically_normal();
 				if (std::filesystem::exists(incp)) {
 					AssetID dep = mAssetManager ?
-						              mAssetManager->LoadFromFile(
+						              mAssetManager->Reserve(
 							              incp.string(), UASSET_TYPE::SHADER) :
 						              kInvalidAssetID;
 					if (dep != kInvalidAssetID) {
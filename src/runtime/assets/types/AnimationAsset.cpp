@@ -0,0 +1,25 @@
+﻿#include "AnimationAsset.h"
+
+#include <engine/Animation/AnimationClip.h>
+
+namespace Unnamed {
+	std::shared_ptr<const AnimationClip> AnimationAssetData::Find(
+		const std::string_view name
+	) const {
+		for (size_t i = 0; i < names.size(); ++i) {
+			if (names[i] == name) {
+				return clips[i];
+			}
+		}
+		return nullptr;
+	}
+
+	size_t AnimationAssetData::MemoryBytes() const {
+		size_t bytes = 0;
+		for (size_t i = 0; i < clips.size(); ++i) {
+			bytes += sizeof(std::string) + names[i].capacity();
+			bytes += clips[i] ? clips[i]->MemoryBytes() : 0;
+		}
+		return bytes;
+	}
+}
@@ -0,0 +1,25 @@
+﻿#pragma once
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class AnimationClip;
+
+namespace Unnamed {
+	// 1ファイル分のアニメーション
+	// クリップは読み込み後に変更しないので、shared_ptr をそのままハンドルとして配れます。
+	// リロードすると新しいペイロードに差し替わり、配ったハンドルは古いクリップを指したままです
+	struct AnimationAssetData {
+		std::vector<std::string>                          names; // ファイル内の順
+		std::vector<std::shared_ptr<const AnimationClip>> clips; // names と同じ並び
+
+		std::string sourcePath;
+
+		// 無ければnull
+		[[nodiscard]] std::shared_ptr<const AnimationClip> Find(std::string_view name) const;
+
+		// クリップと名前の分
+		[[nodiscard]] size_t MemoryBytes() const;
+	};
+}
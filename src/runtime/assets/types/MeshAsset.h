@@ -1,9 +1,14 @@
 ﻿#pragma once
+#include <array>
 #include <cstdint>
+#include <memory>
+#include <span>
 #include <vector>
 
 #include <engine/uprimitive/UPrimitives.h>
 
+class MappedFile;
+
 namespace Unnamed {
 	struct MeshSubmesh {
 		uint32_t indexOffset   = 0;
@@ -27,6 +32,22 @@ namespace Unnamed {
 		std::vector<Vec3> normals;
 	};
 
+	// 頂点ストリームとインデックスの読み取り専用ビュー
+	struct MeshStreamView {
+		std::span<const Vec3> positions;
+		std::span<const Vec3> normals;
+		std::span<const Vec4> tangents;
+		std::span<const Vec2> uv0;
+		std::span<const Vec4> color0;
+
+		std::span<const uint32_t>    indices;
+		std::span<const MeshSubmesh> submeshes;
+
+		std::span<const Mat4>                    invBind;
+		std::span<const std::array<uint16_t, 4>> joints;
+		std::span<const std::array<float, 4>>    weights;
+	};
+
 	struct MeshAssetData {
 		std::vector<uint8_t> bytes;
 
@@ -47,5 +68,29 @@ namespace Unnamed {
 		std::vector<MeshMorphTarget> morphTargets;
 
 		std::string sourcePath;
+
+		// 焼いたメッシュ(.umesh)を読んだ場合はファイルをマップしたまま持ち、
+		// 上の vector は空のまま mappedStreams がマップした領域を直接指します
+		std::shared_ptr<const MappedFile> mappedFile;
+		MeshStreamView                    mappedStreams;
+
+		// どちらの読み方でも同じように使えるビュー
+		[[nodiscard]] MeshStreamView Streams() const {
+			if (mappedFile) {
+				return mappedStreams;
+			}
+			return {
+				.positions = positions,
+				.normals = normals,
+				.tangents = tangents,
+				.uv0 = uv0,
+				.color0 = color0,
+				.indices = indices,
+				.submeshes = submeshes,
+				.invBind = skin.invBind,
+				.joints = skin.joints,
+				.weights = skin.weights,
+			};
+		}
 	};
 }
@@ -1,4 +1,5 @@
 ﻿#pragma once
+#include <dxgiformat.h>
 #include <string>
 #include <vector>
 
@@ -7,7 +8,8 @@ namespace Unnamed {
 		std::vector<uint8_t> bytes;
 		uint32_t             width    = 0;
 		uint32_t             height   = 0;
-		size_t               rowPitch = 0;
+		size_t               rowPitch = 0; // 1行(ブロック圧縮なら4x4ブロック1列)のバイト数
+		uint32_t             rowCount = 0; // 行数。ブロック圧縮なら (height + 3) / 4
 	};
 
 	struct TextureAssetData {
@@ -16,6 +18,20 @@ namespace Unnamed {
 		uint32_t                width  = 0;
 		uint32_t                height = 0;
 		bool                    isSRGB = false;
+		DXGI_FORMAT             format = DXGI_FORMAT_R8G8B8A8_UNORM; // mips の形式
 		std::string             sourcePath;
+
+		/// @brief 全ミップをアップロードバッファに並べた時のバイト数
+		/// @param pitchAlignment 行ピッチの揃え(D3D12_TEXTURE_DATA_PITCH_ALIGNMENT)
+		[[nodiscard]] size_t UploadBytes(const size_t pitchAlignment = 256) const {
+			size_t total = 0;
+			for (const auto& mip : mips) {
+				const size_t pitch =
+					(mip.rowPitch + pitchAlignment - 1) / pitchAlignment *
+					pitchAlignment;
+				total += pitch * mip.rowCount;
+			}
+			return total;
+		}
 	};
 }
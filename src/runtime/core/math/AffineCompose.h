@@ -0,0 +1,69 @@
+#pragma once
+
+#include <xmmintrin.h>
+
+#include <runtime/core/math/Mat4.h>
+#include <runtime/core/math/Quaternion.h>
+#include <runtime/core/math/Vec3.h>
+
+// 階層を親から順に計算する時の、行列1つ分の処理
+namespace Math {
+	// S * R * T を直接組み立てます(Mat4::FromQuaternion と同じ右手系の行列)
+	inline void ComposeLocal(
+		const Vec3&       t,
+		const Quaternion& q,
+		const Vec3&       s,
+		float             (&out)[4][4]
+	) {
+		const float xx = q.x * q.x * 2.0f;
+		const float yy = q.y * q.y * 2.0f;
+		const float zz = q.z * q.z * 2.0f;
+		const float xy = q.x * q.y * 2.0f;
+		const float xz = q.x * q.z * 2.0f;
+		const float yz = q.y * q.z * 2.0f;
+		const float wx = q.w * q.x * 2.0f;
+		const float wy = q.w * q.y * 2.0f;
+		const float wz = q.w * q.z * 2.0f;
+
+		out[0][0] = (1.0f - (yy + zz)) * s.x;
+		out[0][1] = (xy + wz) * s.x;
+		out[0][2] = (xz - wy) * s.x;
+		out[0][3] = 0.0f;
+
+		out[1][0] = (xy - wz) * s.y;
+		out[1][1] = (1.0f - (xx + zz)) * s.y;
+		out[1][2] = (yz + wx) * s.y;
+		out[1][3] = 0.0f;
+
+		out[2][0] = (xz + wy) * s.z;
+		out[2][1] = (yz - wx) * s.z;
+		out[2][2] = (1.0f - (xx + yy)) * s.z;
+		out[2][3] = 0.0f;
+
+		out[3][0] = t.x;
+		out[3][1] = t.y;
+		out[3][2] = t.z;
+		out[3][3] = 1.0f;
+	}
+
+	// out = local * parent (行ベクトルなので、行ごとに親の行を重み付けして足す)
+	// out は parent と別のものを渡してください
+	inline void MultiplyRows(
+		const float (&local)[4][4],
+		const Mat4& parent,
+		Mat4&       out
+	) {
+		const __m128 p0 = _mm_loadu_ps(parent.m[0]);
+		const __m128 p1 = _mm_loadu_ps(parent.m[1]);
+		const __m128 p2 = _mm_loadu_ps(parent.m[2]);
+		const __m128 p3 = _mm_loadu_ps(parent.m[3]);
+
+		for (int row = 0; row < 4; ++row) {
+			__m128 r = _mm_mul_ps(_mm_set1_ps(local[row][0]), p0);
+			r        = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(local[row][1]), p1));
+			r        = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(local[row][2]), p2));
+			r        = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(local[row][3]), p3));
+			_mm_storeu_ps(out.m[row], r);
+		}
+	}
+}
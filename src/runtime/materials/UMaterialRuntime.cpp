@@ -4,7 +4,11 @@
 
 #include "UMaterialRuntime.h"
 
+#include <array>
 #include <filesystem>
+#include <functional>
+
+#include <core/jobsystem/JobSystem.h>
 
 #include <engine/uprogrambuilder/UProgramBuilder.h>
 #include <engine/urenderer/GraphicsDevice.h>
@@ -29,6 +33,27 @@ namespace Unnamed {
 		return s;
 	}
 
+	using ShaderCompileJobs = std::array<std::function<const ShaderBlob*()>, 2>;
+
+	// VS/PS を並列に取得します(呼び出し元のスレッドも参加します)
+	static void CompileShaders(
+		const ShaderCompileJobs& jobs,
+		const ShaderBlob*&       outVS,
+		const ShaderBlob*&       outPS
+	) {
+		std::array<const ShaderBlob*, 2> blobs = {};
+		JobSystem::Get().ParallelFor(
+			jobs.size(), 1,
+			[&](const size_t begin, const size_t end, uint32_t) {
+				for (size_t i = begin; i < end; ++i) {
+					blobs[i] = jobs[i] ? jobs[i]() : nullptr;
+				}
+			}
+		);
+		outVS = blobs[0];
+		outPS = blobs[1];
+	}
+
 	struct MaterialCBData {
 		Vec4     BaseColor; // 16
 		float    Metallic;  // 4
@@ -115,8 +140,10 @@ namespace Unnamed {
 		}
 
 		// シェーダーの取得
+		// VSとPSは独立しているので並列にコンパイルする(キャッシュに当たればすぐ返る)
 		const ShaderBlob* vs      = nullptr;
 		const ShaderBlob* ps      = nullptr;
+		ShaderCompileJobs compile = {};
 		auto              defines = m->defines;
 
 		if (m->programBody != kInvalidAssetID) {
@@ -143,32 +170,37 @@ namespace Unnamed {
 				.target = "ps_6_0"
 			};
 
-			vs = shaderLibrary->GetOrCompileFromString(
-				gen.hlsl, vKeyVS, ("#VS" + pbi.bodyPath).c_str()
-			);
-			ps = shaderLibrary->GetOrCompileFromString(
-				gen.hlsl, vKeyPS, ("#PS" + pbi.bodyPath).c_str()
-			);
-		} else {
-			if (m->shader != kInvalidAssetID) {
-				vs = shaderLibrary->GetOrCompile(
-					{m->shader, defines, m->entryVS, "vs_6_0"}
+			compile[0] = [&, vKeyVS] {
+				return shaderLibrary->GetOrCompileFromString(
+					gen.hlsl, vKeyVS, ("#VS" + pbi.bodyPath).c_str()
 				);
-				ps = shaderLibrary->GetOrCompile(
-					{m->shader, defines, m->entryPS, "ps_6_0"}
+			};
+			compile[1] = [&, vKeyPS] {
+				return shaderLibrary->GetOrCompileFromString(
+					gen.hlsl, vKeyPS, ("#PS" + pbi.bodyPath).c_str()
 				);
-			} else {
-				if (m->shaderVS != kInvalidAssetID) {
-					vs = shaderLibrary->GetOrCompile(
-						{m->shaderVS, defines, m->entryVS, "vs_6_0"}
+			};
+			CompileShaders(compile, vs, ps);
+		} else {
+			const AssetID shaderVS =
+				m->shader != kInvalidAssetID ? m->shader : m->shaderVS;
+			const AssetID shaderPS =
+				m->shader != kInvalidAssetID ? m->shader : m->shaderPS;
+			if (shaderVS != kInvalidAssetID) {
+				compile[0] = [&] {
+					return shaderLibrary->GetOrCompile(
+						{shaderVS, defines, m->entryVS, "vs_6_0"}
 					);
-				}
-				if (m->shaderPS != kInvalidAssetID) {
-					ps = shaderLibrary->GetOrCompile(
-						{m->shaderPS, defines, m->entryPS, "ps_6_0"}
+				};
+			}
+			if (shaderPS != kInvalidAssetID) {
+				compile[1] = [&] {
+					return shaderLibrary->GetOrCompile(
+						{shaderPS, defines, m->entryPS, "ps_6_0"}
 					);
-				}
+				};
 			}
+			CompileShaders(compile, vs, ps);
 		}
 
 		if (!vs || !ps) {
@@ -200,6 +232,12 @@ namespace Unnamed {
 		pObjectCB.cbvSpace      = 0;
 		rs.params.emplace_back(pObjectCB);
 
+		RootParamDesc pInstances = {};
+		pInstances.kind          = RootParamDesc::Kind::ROOT_SRV;
+		pInstances.cbvRegister   = 1; // t1
+		pInstances.cbvSpace      = 0;
+		rs.params.emplace_back(pInstances);
+
 		StaticSamplerDesc s0 = {};
 		s0.desc              = LinerWrap();
 		s0.reg               = 0; // s0
@@ -224,6 +262,8 @@ namespace Unnamed {
 		rootParams.materialCB = 1;
 		rootParams.frameCB    = 2;
 		rootParams.objectCB   = 3;
+		// 生成したプログラムだけが gInstances を読む
+		rootParams.instances = m->programBody != kInvalidAssetID ? 4 : UINT_MAX;
 
 		static const D3D12_INPUT_ELEMENT_DESC kStdMeshLayout[] = {
 			{
@@ -450,21 +490,24 @@ namespace Unnamed {
 
 	bool UMaterialRuntime::IsGPUReady() const { return mGPUReady; }
 
-	void UMaterialRuntime::Apply(
-		ID3D12GraphicsCommandList*   commandList,
-		const RenderResourceManager* renderResourceManager,
-		const uint32_t               backIndex,
-		float                        timeSec
+	void UMaterialRuntime::RequestTextureMips(
+		RenderResourceManager* renderResourceManager,
+		const float            screenPixels
 	) const {
-		for (auto& slot : mTextureSlots) {
-			if (slot.name == "MainTex" && slot.handle.IsValid()) {
-				commandList->SetGraphicsRootDescriptorTable(
-					0, renderResourceManager->GetSrvGPU(slot.handle));
-				break;
+		for (const auto& slot : mTextureSlots) {
+			if (slot.handle.IsValid()) {
+				renderResourceManager->RequestTextureMip(
+					slot.handle, screenPixels
+				);
 			}
 		}
+	}
 
-		// CBV(b0) 固定CBに書き込んでオフセットを指定
+	D3D12_GPU_VIRTUAL_ADDRESS UMaterialRuntime::WriteConstants(
+		const uint32_t backIndex,
+		float          timeSec
+	) {
+		// CBV(b0) 固定CBのこのフレームの領域に書き込む
 		MaterialCBData cb = {};
 		cb.BaseColor      = mBaseColor;
 		cb.Metallic       = mMetallic;
@@ -511,9 +554,24 @@ namespace Unnamed {
 			mFramesInFlight);
 		memcpy(mCBMapped + offset, &cb, sizeof(cb));
 
-		const auto gpuVA = mCB->GetGPUVirtualAddress() + offset;
+		return mCB->GetGPUVirtualAddress() + offset;
+	}
+
+	void UMaterialRuntime::Bind(
+		ID3D12GraphicsCommandList*      commandList,
+		const RenderResourceManager*    renderResourceManager,
+		const D3D12_GPU_VIRTUAL_ADDRESS materialCB
+	) const {
+		for (auto& slot : mTextureSlots) {
+			if (slot.name == "MainTex" && slot.handle.IsValid()) {
+				commandList->SetGraphicsRootDescriptorTable(
+					0, renderResourceManager->GetSrvGPU(slot.handle));
+				break;
+			}
+		}
+
 		commandList->SetGraphicsRootConstantBufferView(
-			rootParams.materialCB, gpuVA
+			rootParams.materialCB, materialCB
 		);
 	}
 
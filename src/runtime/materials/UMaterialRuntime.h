@@ -45,6 +45,7 @@ namespace Unnamed {
 			UINT materialCB = UINT_MAX;
 			UINT frameCB    = UINT_MAX;
 			UINT objectCB   = UINT_MAX;
+			UINT instances  = UINT_MAX; // UINT_MAX ならシェーダーがインスタンス描画に非対応
 		};
 
 		RootParamIndices rootParams;
@@ -73,15 +74,24 @@ namespace Unnamed {
 
 		[[nodiscard]] bool IsGPUReady() const;
 
-		void Apply(
+		// 固定CBのこのフレームの領域に書き込み、そのGPUアドレスを返します(描画スレッドから)
+		D3D12_GPU_VIRTUAL_ADDRESS WriteConstants(uint32_t backIndex, float timeSec);
+
+		// テクスチャと WriteConstants で書いたCBを積みます。何も書き換えないのでワーカーから呼べます
+		void Bind(
 			ID3D12GraphicsCommandList*   commandList,
 			const RenderResourceManager* renderResourceManager,
-			uint32_t                     backIndex,
-			float                        timeSec
+			D3D12_GPU_VIRTUAL_ADDRESS    materialCB
 		) const;
 		void Release(RenderResourceManager* renderResourceManager,
 		             ID3D12Fence*           fence, uint64_t value);
 
+		// 画面上の大きさ(ピクセル)からテクスチャに必要なミップを要求します
+		void RequestTextureMips(
+			RenderResourceManager* renderResourceManager,
+			float                  screenPixels
+		) const;
+
 		// デバッグ用
 		void EnableMipOscillation(bool enable, float speedHz = 1.0f) {
 			dbgForceMip  = enable;
@@ -143,7 +153,7 @@ namespace Unnamed {
 		float dbgSpeedHz   = 1.5f;
 		int   dbgFixedMip  = -1;
 
-		mutable int mPrevLoggedMip = -999;
+		int mPrevLoggedMip = -999;
 
 		uint32_t mMainTexMipCount = 1;
 	};
@@ -1,8 +1,12 @@
 #include "UPhysics.h"
 
 #include <pch.h>
+#include <atomic>
+#include <ranges>
 #include <vector>
 
+#include <core/jobsystem/JobSystem.h>
+
 #include <engine/Camera/CameraManager.h>
 #include <engine/Components/Camera/CameraComponent.h>
 #include <engine/Components/ColliderComponent/MeshColliderComponent.h>
@@ -16,11 +20,66 @@
 #include <engine/uphysics/SphereCast.h>
 
 namespace UPhysics {
+	namespace {
+		// 1レーンがまとめて処理するクエリ数
+		constexpr size_t kBatchGrainSize = 64;
+
+		// 1フレームで詰め直す三角形の最大数
+		constexpr size_t kCompactionBudget = 65536;
+		// 穴がこれ未満なら詰め直さない
+		constexpr size_t kCompactionMinDead = 4096;
+
+		// クエリ列をワーカーに分割して処理する
+		template <class Query, class Fn>
+		int RunBatch(
+			const std::span<const Query> queries,
+			const std::span<Hit>         outHits,
+			Fn&&                         single
+		) {
+			UASSERT(outHits.size() >= queries.size());
+
+			std::atomic<int> hitCount = 0;
+			JobSystem::Get().ParallelFor(
+				queries.size(), kBatchGrainSize,
+				[&](const size_t begin, const size_t end, uint32_t) {
+					int localHits = 0;
+					for (size_t i = begin; i < end; ++i) {
+						Hit hit;
+						if (single(queries[i], &hit)) {
+							++localHits;
+						} else {
+							hit = Hit{};
+						}
+						outHits[i] = hit;
+					}
+					hitCount.fetch_add(localHits, std::memory_order_relaxed);
+				}
+			);
+			return hitCount.load();
+		}
+	}
+
+	Engine::~Engine() {
+		// 残っているエンティティが破棄されたエンジンを解除しに来ないように
+		for (const auto& owner : mOwnerHandles | std::views::keys) {
+			owner->SetUPhysicsEngine(nullptr);
+		}
+	}
+
 	void Engine::Init() {
 		// なんかする
 	}
 
-	void Engine::Update(float) const {
+	void Engine::Update(float) {
+		// 動いたエンティティの行列を拾う
+		SyncOwnerTransforms();
+
+		// 登録・解除・移動したスロットをTLASに反映する(クエリが無いフレームでも溜めない)
+		FlushTLAS();
+
+		// 解除で空いた三角形領域を少しずつ詰める
+		StepCompaction(kCompactionBudget);
+
 #ifdef _DEBUG
 		const auto camera = CameraManager::GetActiveCamera();
 		if (camera) {
@@ -86,123 +145,517 @@ namespace UPhysics {
 			return;
 		}
 
-		const auto transform = meshCollider->GetOwner()->GetTransform();
+		const auto transform  = meshCollider->GetOwner()->GetTransform();
+		const auto staticMesh = meshCollider->GetStaticMesh();
+		const Mat4 world      = transform->GetWorldMat();
+
+		// メッシュのパス(StaticMeshの名前)とサブメッシュ番号をキャッシュのキーにする
+		Unnamed::FileStamp stamp;
+		const bool         cacheable = mUseBVHCache &&
+			BVHCache::StampOf(staticMesh->GetName(), stamp);
+
+		const auto& subMeshes = staticMesh->GetSubMeshes();
+		for (size_t subMeshIndex = 0; subMeshIndex < subMeshes.size(); ++
+		     subMeshIndex) {
+			const auto&       subMesh  = subMeshes[subMeshIndex];
+			const std::string cacheKey = std::format(
+				"{}#{}", staticMesh->GetName(), subMeshIndex
+			);
+
+			// キャッシュが新しければマップして使う(三角形の変換もビルドも不要)
+			if (cacheable) {
+				if (auto mapped = mBVHCache.Load(cacheKey, stamp)) {
+					const size_t triCount = mapped->triangles.size();
+					RegisterMapped(std::move(mapped), entity, world);
+					DevMsg(
+						"UPhysics",
+						"Registered entity '{}' with {} triangles. (BVH cache)",
+						subMesh->GetName(),
+						triCount
+					);
+					continue;
+				}
+			}
 
-		for (
-			const auto& subMesh : meshCollider->GetStaticMesh()->GetSubMeshes()
-			) {
 			auto tris = subMesh->GetPolygons();
 
 
 			std::vector<Unnamed::Triangle> triangles;
 
 			// UPhysics::Triangleに変換 TODO: すべてのTriangleをUPhysics::Triangleに変更する
+			// BLASはローカル空間のまま持ち、ワールド行列はインスタンスに持たせる
 			for (auto tri : tris) {
-				tri.v0 += transform->GetLocalPos();
-				tri.v1 += transform->GetLocalPos();
-				tri.v2 += transform->GetLocalPos();
-
 				triangles.emplace_back(
 					tri.v0, tri.v1, tri.v2
 				);
 			}
 
-			// BVHを構築
-			BVHBuilder            bvhBuilder;
-			std::vector<FlatNode> nodes;
-			std::vector<uint32_t> triIndices;
-
-			size_t triStart = mTriangles.size();
-
-			bvhBuilder.Build(triangles, nodes, triIndices);
-
-			size_t triCount = triangles.size();
-
-			// インデックスにグローバルオフセットを追加
-			AddGlobalOffset(
-				triIndices,
-				static_cast<uint32_t>(mTriangles.size())
-			);
-
-			// メンバに突っ込む
-			mBVHs.emplace_back(
-				RegisteredBVH{
-					.nodes = std::move(nodes),
-					.triIndices = std::move(triIndices),
-					.triStart = triStart,
-					.triCount = triCount,
-					.owner = entity
-				}
-			);
-			mTriangles.insert(
-				mTriangles.end(),
-				triangles.begin(),
-				triangles.end()
+			const ColliderHandle handle = RegisterTriangles(
+				triangles, entity, world
 			);
+			if (cacheable) {
+				SaveToCache(handle, cacheKey, stamp);
+			}
 
 			DevMsg(
 				"UPhysics",
-				"Registered entity '{}' with {} triangles.",
+				"Registered entity '{}' with {} triangles. (build {:.2f} ms, {} nodes, depth {}, SAH {:.2f})",
 				subMesh->GetName(),
-				subMesh->GetPolygons().size()
+				subMesh->GetPolygons().size(),
+				mLastBuildStats.buildMs,
+				mLastBuildStats.nodeCount,
+				mLastBuildStats.maxDepth,
+				mLastBuildStats.sahCost
 			);
 		}
 	}
 
-	void Engine::UnregisterEntity(const Entity* entity) {
-		if (mBVHs.empty()) {
+	void Engine::SyncOwnerTransforms() {
+		for (const auto& [owner, handles] : mOwnerHandles) {
+			const Mat4 world = owner->GetTransform()->GetWorldMat();
+			for (const ColliderHandle handle : handles) {
+				RegisteredBVH& bvh = mBVHs[handle.index];
+				// 止まっているものは比較だけで済む
+				if (bvh.transform.localToWorld == world) {
+					continue;
+				}
+				bvh.transform.Set(world);
+				UpdateWorldBounds(bvh);
+				mTLASRefit   = true;
+				mTLASPending = true;
+			}
+		}
+	}
+
+	void Engine::FlushTLAS() const {
+		if (!mUseTLAS || !mTLASPending.load(std::memory_order_acquire)) {
 			return;
 		}
 
-		struct DelRange {
-			size_t start, count;
+		std::lock_guard lock(mTLASMutex);
+		if (mTLASDirty) {
+			mTLAS.Build(mBVHs);
+		} else if (mTLASRefit) {
+			// 動いただけなら木の形はそのままでAABBを更新する
+			mTLAS.Refit(mBVHs);
+		}
+		mTLASDirty = false;
+		mTLASRefit = false;
+		mTLASPending.store(false, std::memory_order_release);
+	}
+
+	ColliderHandle Engine::RegisterTriangles(
+		const std::vector<Unnamed::Triangle>& triangles,
+		Entity*                               owner,
+		const Mat4&                           localToWorld
+	) {
+		// BVHを構築
+		BVHBuilder            bvhBuilder;
+		std::vector<FlatNode> nodes;
+		std::vector<uint32_t> triIndices;
+
+		bvhBuilder.SetParallel(mParallelBuild);
+		bvhBuilder.Build(triangles, nodes, triIndices);
+		mLastBuildStats = bvhBuilder.GetStats();
+
+		std::vector<BVH4Node> nodes4;
+		BVHBuilder::CollapseBVH4(nodes, nodes4);
+
+		// 空きスロットを再利用する
+		uint32_t slot;
+		if (!mFreeSlots.empty()) {
+			slot = mFreeSlots.back();
+			mFreeSlots.pop_back();
+		} else {
+			slot = static_cast<uint32_t>(mBVHs.size());
+			mBVHs.emplace_back();
+		}
+
+		// triIndicesはtriStartからの相対なので、詰め直しでは triStart だけ直せばよい
+		RegisteredBVH& bvh = mBVHs[slot];
+		bvh.nodes          = std::move(nodes);
+		bvh.nodes4         = std::move(nodes4);
+		bvh.triIndices     = std::move(triIndices);
+		bvh.triStart       = mTriangles.size();
+		bvh.triCount       = triangles.size();
+		bvh.owner          = owner;
+		bvh.alive          = true;
+		bvh.transform.Set(localToWorld);
+		UpdateWorldBounds(bvh);
+
+		mTriangles.insert(
+			mTriangles.end(),
+			triangles.begin(),
+			triangles.end()
+		);
+
+		const ColliderHandle handle = {
+			.index = slot,
+			.generation = bvh.generation
 		};
-		std::vector<DelRange> ranges;
+		if (owner) {
+			mOwnerHandles[owner].emplace_back(handle);
+			owner->SetUPhysicsEngine(this);
+		}
+
+		// ルートAABBが増えたので、次のクエリか Update でTLASを作り直す
+		// (まとめて登録した時に登録ごとに作り直さないよう遅らせる)
+		mTLASDirty   = true;
+		mTLASPending = true;
+
+		return handle;
+	}
+
+	ColliderHandle Engine::RegisterMapped(
+		std::shared_ptr<const MappedBVH> mapped,
+		Entity*                          owner,
+		const Mat4&                      localToWorld
+	) {
+		uint32_t slot;
+		if (!mFreeSlots.empty()) {
+			slot = mFreeSlots.back();
+			mFreeSlots.pop_back();
+		} else {
+			slot = static_cast<uint32_t>(mBVHs.size());
+			mBVHs.emplace_back();
+		}
+
+		// 三角形領域は使わないので triStart は 0 (ヒットの triIndex はコライダー内の番号)
+		RegisteredBVH& bvh = mBVHs[slot];
+		bvh.triStart       = 0;
+		bvh.triCount       = mapped->triangles.size();
+		bvh.mapped         = std::move(mapped);
+		bvh.owner          = owner;
+		bvh.alive          = true;
+		bvh.transform.Set(localToWorld);
+		UpdateWorldBounds(bvh);
+
+		const ColliderHandle handle = {
+			.index = slot,
+			.generation = bvh.generation
+		};
+		if (owner) {
+			mOwnerHandles[owner].emplace_back(handle);
+			owner->SetUPhysicsEngine(this);
+		}
 
-		std::erase_if(
-			mBVHs,
-			[&](const RegisteredBVH& bvh) {
-				if (bvh.owner != entity) {
-					return false;
+		mTLASDirty   = true;
+		mTLASPending = true;
+
+		return handle;
+	}
+
+	bool Engine::SaveToCache(
+		const ColliderHandle      handle,
+		const std::string&        key,
+		const Unnamed::FileStamp& stamp
+	) const {
+		if (!IsValid(handle)) {
+			return false;
+		}
+
+		const RegisteredBVH& bvh = mBVHs[handle.index];
+		return mBVHCache.Save(
+			key,
+			stamp,
+			bvh.Nodes(),
+			bvh.Nodes4(),
+			bvh.TriIndices(),
+			TrianglesOf(bvh)
+		);
+	}
+
+	void Engine::SetUseBVHCache(const bool useCache) {
+		mUseBVHCache = useCache;
+	}
+
+	bool Engine::UseBVHCache() const {
+		return mUseBVHCache;
+	}
+
+	const BVHCache& Engine::GetBVHCache() const {
+		return mBVHCache;
+	}
+
+	void Engine::UnregisterEntity(Entity* entity) {
+		const auto it = mOwnerHandles.find(entity);
+		if (it == mOwnerHandles.end()) {
+			return;
+		}
+
+		const std::vector<ColliderHandle> handles = std::move(it->second);
+		mOwnerHandles.erase(it);
+		entity->SetUPhysicsEngine(nullptr);
+		for (const ColliderHandle handle : handles) {
+			Unregister(handle);
+		}
+	}
+
+	void Engine::Unregister(const ColliderHandle handle) {
+		if (!IsValid(handle)) {
+			return;
+		}
+
+		RegisteredBVH& bvh = mBVHs[handle.index];
+
+		// 所有者からの逆引きを消す(UnregisterEntity経由なら既に消えている)
+		if (bvh.owner) {
+			const auto it = mOwnerHandles.find(bvh.owner);
+			if (it != mOwnerHandles.end()) {
+				std::erase_if(it->second, [&](const ColliderHandle& h) {
+					return h.index == handle.index &&
+						h.generation == handle.generation;
+				});
+				if (it->second.empty()) {
+					mOwnerHandles.erase(it);
+					bvh.owner->SetUPhysicsEngine(nullptr);
 				}
-				ranges.emplace_back(bvh.triStart, bvh.triCount);
-				return true;
 			}
-		);
+		}
 
-		if (ranges.empty()) {
+		// 三角形は穴として残し、StepCompactionで詰める
+		if (!bvh.mapped) {
+			mDeadTriangles += bvh.triCount;
+		}
+
+		bvh.mapped     = nullptr;
+		bvh.nodes      = {};
+		bvh.nodes4     = {};
+		bvh.triIndices = {};
+		bvh.triCount   = 0;
+		bvh.owner      = nullptr;
+		bvh.alive      = false;
+		bvh.transform  = {};
+		++bvh.generation;
+
+		mFreeSlots.emplace_back(handle.index);
+
+		// 作り直すまでTLASに残っていても、走査時にaliveで弾く
+		mTLASDirty   = true;
+		mTLASPending = true;
+	}
+
+	void Engine::SetTransform(
+		const ColliderHandle handle,
+		const Mat4&          localToWorld
+	) {
+		if (!IsValid(handle)) {
 			return;
 		}
 
-		std::ranges::sort(ranges, [](auto& a, auto& b) {
-			return a.start > b.start;
-			});
+		RegisteredBVH& bvh = mBVHs[handle.index];
+		bvh.transform.Set(localToWorld);
+		UpdateWorldBounds(bvh);
+		mTLASRefit   = true;
+		mTLASPending = true;
+	}
 
-		for (auto& [start, count] : ranges) {
-			mTriangles.erase(
-				mTriangles.begin() + static_cast<long long>(start),
-				mTriangles.begin() + static_cast<long long>(start + count)
+	bool Engine::RefitTriangles(
+		const ColliderHandle                     handle,
+		const std::span<const Unnamed::Triangle> localTriangles
+	) {
+		if (!IsValid(handle)) {
+			return false;
+		}
+
+		RegisteredBVH& bvh = mBVHs[handle.index];
+		if (bvh.mapped) {
+			Warning("UPhysics", "RefitTriangles: cached colliders are read-only.");
+			return false;
+		}
+		if (localTriangles.size() != bvh.triCount) {
+			Warning(
+				"UPhysics",
+				"RefitTriangles: triangle count mismatch ({} != {}).",
+				localTriangles.size(),
+				bvh.triCount
 			);
+			return false;
+		}
+
+		std::ranges::copy(
+			localTriangles,
+			mTriangles.begin() + static_cast<ptrdiff_t>(bvh.triStart)
+		);
+		BVHBuilder::Refit(
+			bvh.nodes,
+			bvh.nodes4,
+			std::span(mTriangles).subspan(bvh.triStart, bvh.triCount),
+			bvh.triIndices
+		);
+		UpdateWorldBounds(bvh);
+		mTLASRefit   = true;
+		mTLASPending = true;
+		return true;
+	}
+
+	void Engine::UpdateWorldBounds(RegisteredBVH& bvh) {
+		if (bvh.Nodes().empty() || bvh.triCount == 0) {
+			bvh.worldBounds = {};
+			return;
+		}
+
+		const Unnamed::AABB& local = bvh.Nodes()[0].bounds;
+		bvh.worldBounds            = bvh.transform.isIdentity
+			                             ? local
+			                             : InstanceTransform::TransformAABB(
+				                             local,
+				                             bvh.transform.localToWorld
+			                             );
+	}
 
+	bool Engine::IsValid(const ColliderHandle handle) const {
+		return handle.index < mBVHs.size() &&
+			mBVHs[handle.index].alive &&
+			mBVHs[handle.index].generation == handle.generation;
+	}
+
+	void Engine::StepCompaction(const size_t triangleBudget) {
+		if (!mCompaction.active) {
+			// 穴が十分大きくなるまでは何もしない
+			if (
+				mDeadTriangles < kCompactionMinDead ||
+				mDeadTriangles * 4 < mTriangles.size()
+			) {
+				return;
+			}
+			BeginCompaction();
+		}
+
+		size_t moved = 0;
+		while (
+			mCompaction.cursor < mCompaction.order.size() &&
+			moved < triangleBudget
+		) {
+			const ColliderHandle handle =
+				mCompaction.order[mCompaction.cursor++];
+			// 詰め直し中に解除されたもの
+			if (!IsValid(handle)) {
+				continue;
+			}
+
+			RegisteredBVH& bvh = mBVHs[handle.index];
+			if (bvh.triStart != mCompaction.write) {
+				// triStart順に処理しているので書き込み先は常に手前にある
+				std::copy(
+					mTriangles.begin() + static_cast<ptrdiff_t>(bvh.triStart),
+					mTriangles.begin() + static_cast<ptrdiff_t>(
+						bvh.triStart + bvh.triCount),
+					mTriangles.begin() + static_cast<ptrdiff_t>(
+						mCompaction.write)
+				);
+				bvh.triStart = mCompaction.write;
+				moved += bvh.triCount;
+			}
+			mCompaction.write += bvh.triCount;
+		}
+
+		if (mCompaction.cursor == mCompaction.order.size()) {
+			FinishCompaction();
+		}
+	}
+
+	size_t Engine::TriangleArenaSize() const {
+		return mTriangles.size();
+	}
+
+	size_t Engine::DeadTriangleCount() const {
+		return mDeadTriangles;
+	}
+
+	void Engine::BeginCompaction() {
+		mCompaction.active = true;
+		mCompaction.cursor = 0;
+		mCompaction.write  = 0;
+		mCompaction.end    = mTriangles.size();
+		mCompaction.order.clear();
+
+		for (uint32_t i = 0; i < mBVHs.size(); ++i) {
+			// キャッシュ由来のものは三角形領域を使っていない
+			if (mBVHs[i].alive && !mBVHs[i].mapped) {
+				mCompaction.order.emplace_back(i, mBVHs[i].generation);
+			}
+		}
+		std::ranges::sort(
+			mCompaction.order,
+			[this](const ColliderHandle& a, const ColliderHandle& b) {
+				return mBVHs[a.index].triStart < mBVHs[b.index].triStart;
+			}
+		);
+	}
+
+	void Engine::FinishCompaction() {
+		// 詰め直し中に登録されたものは end 以降に追加されているので、まとめて前に寄せる
+		const size_t tailCount = mTriangles.size() - mCompaction.end;
+		const size_t shift     = mCompaction.end - mCompaction.write;
+		if (shift > 0) {
 			for (auto& bvh : mBVHs) {
-				if (bvh.triStart > start) {
-					bvh.triStart -= count;
-					for (uint32_t& id : bvh.triIndices) {
-						if (id >= start) {
-							id -= static_cast<uint32_t>(count);
-						}
-					}
+				if (bvh.alive && !bvh.mapped &&
+					bvh.triStart >= mCompaction.end) {
+					bvh.triStart -= shift;
 				}
 			}
+			std::copy(
+				mTriangles.begin() + static_cast<ptrdiff_t>(mCompaction.end),
+				mTriangles.end(),
+				mTriangles.begin() + static_cast<ptrdiff_t>(mCompaction.write)
+			);
 		}
+		mTriangles.resize(mCompaction.write + tailCount);
+
+		// 詰め直し中に解除されたぶんは次回に回す
+		size_t liveTriangles = 0;
+		for (const auto& bvh : mBVHs) {
+			if (bvh.alive && !bvh.mapped) {
+				liveTriangles += bvh.triCount;
+			}
+		}
+		mDeadTriangles = mTriangles.size() - liveTriangles;
+
+		mCompaction.active = false;
+		mCompaction.order.clear();
+	}
+
+	void Engine::SetUseTLAS(const bool useTLAS) {
+		mUseTLAS = useTLAS;
+	}
+
+	bool Engine::UseTLAS() const {
+		return mUseTLAS;
+	}
+
+	void Engine::SetUseBVH4(const bool useBVH4) {
+		mUseBVH4 = useBVH4;
+	}
+
+	bool Engine::UseBVH4() const {
+		return mUseBVH4;
+	}
+
+	void Engine::SetParallelBuild(const bool parallel) {
+		mParallelBuild = parallel;
+	}
+
+	bool Engine::ParallelBuild() const {
+		return mParallelBuild;
+	}
+
+	const BVHBuildStats& Engine::LastBuildStats() const {
+		return mLastBuildStats;
 	}
 
 	bool Engine::RayCast(const Unnamed::Ray& ray, Hit* outHit) const {
-		UPhysics::RayCast cast;
-		cast.start = ray.origin;
-		cast.invDir = ray.invDir;
-		return CastBVH(cast, ray.origin, ray.dir, ray.tMax, outHit, mBVHs,
-			mTriangles);
+		FlushTLAS();
+		return Sweep(
+			SweepQuery{
+				.shape = SweepQuery::SHAPE::RAY,
+				.start = ray.origin,
+				.dir = ray.dir,
+				.length = ray.tMax
+			},
+			outHit,
+			true
+		);
 	}
 
 	bool Engine::BoxCast(
@@ -211,30 +664,17 @@ namespace UPhysics {
 		const float         length,
 		Hit* outHit
 	) const {
-		Vec3  dirN = dir;
-		float len = length;
-
-		float dirLen = dirN.Length();
-		if (dirLen > 1e-6f) {
-			dirN /= dirLen;
-			if (fabs(len - dirLen) < 1e-4f)
-				len = dirLen;
-		}
-		else {
-			return false; // ゼロ方向なら衝突無し
-		}
-
-		UPhysics::BoxCast caster;
-		caster.box = box;
-		caster.half = box.halfSize;
-
-		return CastBVH(
-			caster,
-			box.center,
-			dirN,
-			len,
+		FlushTLAS();
+		return Sweep(
+			SweepQuery{
+				.shape = SweepQuery::SHAPE::BOX,
+				.start = box.center,
+				.dir = dir,
+				.length = length,
+				.halfSize = box.halfSize
+			},
 			outHit,
-			mBVHs, mTriangles
+			true
 		);
 	}
 
@@ -245,66 +685,145 @@ namespace UPhysics {
 		const float length,
 		Hit* outHit
 	) const {
-		UPhysics::SphereCast cast;
-		cast.center = start;
-		cast.radius = radius;
+		FlushTLAS();
+		return Sweep(
+			SweepQuery{
+				.shape = SweepQuery::SHAPE::SPHERE,
+				.start = start,
+				.dir = dir,
+				.length = length,
+				.radius = radius
+			},
+			outHit,
+			true
+		);
+	}
 
-		return CastBVH(cast, start, dir, length, outHit, mBVHs, mTriangles);
+	int Engine::RayCastBatch(
+		const std::span<const Unnamed::Ray> rays,
+		const std::span<Hit>                outHits
+	) const {
+		FlushTLAS();
+		return RunBatch(
+			rays, outHits,
+			[this](const Unnamed::Ray& ray, Hit* outHit) {
+				return Sweep(
+					SweepQuery{
+						.shape = SweepQuery::SHAPE::RAY,
+						.start = ray.origin,
+						.dir = ray.dir,
+						.length = ray.tMax
+					},
+					outHit,
+					false
+				);
+			}
+		);
+	}
+
+	int Engine::SweepBatch(
+		const std::span<const SweepQuery> queries,
+		const std::span<Hit>              outHits
+	) const {
+		FlushTLAS();
+		return RunBatch(
+			queries, outHits,
+			[this](const SweepQuery& query, Hit* outHit) {
+				return Sweep(query, outHit, false);
+			}
+		);
+	}
+
+	bool Engine::Sweep(
+		const SweepQuery& query,
+		Hit*              outHit,
+		const bool        debugDraw
+	) const {
+		switch (query.shape) {
+		case SweepQuery::SHAPE::RAY: {
+			UPhysics::RayCast cast;
+			cast.start = query.start;
+			cast.invDir = Vec3::one / query.dir;
+			return CastBVH(
+				cast, query.start, query.dir, query.length, outHit, debugDraw
+			);
+		}
+		case SweepQuery::SHAPE::BOX: {
+			Vec3  dirN = query.dir;
+			float len = query.length;
+
+			float dirLen = dirN.Length();
+			if (dirLen > 1e-6f) {
+				dirN /= dirLen;
+				if (fabs(len - dirLen) < 1e-4f)
+					len = dirLen;
+			}
+			else {
+				return false; // ゼロ方向なら衝突無し
+			}
+
+			UPhysics::BoxCast caster;
+			caster.box = {.center = query.start, .halfSize = query.halfSize};
+			caster.half = query.halfSize;
+
+			return CastBVH(caster, query.start, dirN, len, outHit, debugDraw);
+		}
+		case SweepQuery::SHAPE::SPHERE: {
+			UPhysics::SphereCast cast;
+			cast.center = query.start;
+			cast.radius = query.radius;
+
+			return CastBVH(
+				cast, query.start, query.dir, query.length, outHit, debugDraw
+			);
+		}
+		}
+		return false;
 	}
 
 	bool Engine::BoxOverlap(
 		const Unnamed::Box& box,
 		Hit* outHit
 	) const {
-		if (mBVHs.empty() || mTriangles.empty()) {
+		if (mBVHs.empty()) {
 			return false;
 		}
+		FlushTLAS();
 
-		// ブロードフェーズ：ボックスのAABBと各BVHのルートAABBの重なりをチェック
-		std::vector<const RegisteredBVH*> filtered;
-		Unnamed::AABB                     boxAABB;
+		Unnamed::AABB boxAABB;
 		boxAABB.min = box.center - box.halfSize;
 		boxAABB.max = box.center + box.halfSize;
 
-		for (const auto& bvh : mBVHs) {
-			const Unnamed::AABB& rootBounds = bvh.nodes[0].bounds;
-			// AABB同士の重なり判定
-			if (boxAABB.max.x >= rootBounds.min.x && boxAABB.min.x <= rootBounds
-				.max.x &&
-				boxAABB.max.y >= rootBounds.min.y && boxAABB.min.y <= rootBounds
-				.max.y &&
-				boxAABB.max.z >= rootBounds.min.z && boxAABB.min.z <= rootBounds
-				.max.z) {
-				filtered.emplace_back(&bvh);
-			}
-		}
-
-		if (filtered.empty()) {
-			return false;
-		}
-
 		// ナローフェーズ：詳細な重なり判定
 		float    minPenetration = FLT_MAX;
 		uint32_t hitTri = UINT32_MAX;
 		Vec3     hitNormal;
 		Vec3     hitPos;
-		uint32_t stack[64];
 
-		for (auto* bvh : filtered) {
-			int sp = 0;
+		// ブロードフェーズ：ボックスのAABBと重なるBLASだけを探索する
+		ForEachOverlappingBVH(boxAABB, [&](const RegisteredBVH& bvh) {
+			// ノードはローカル空間なので、ボックスのAABBをローカルに持ち込んで刈り込む
+			const Unnamed::AABB queryAABB = bvh.transform.isIdentity
+				                                ? boxAABB
+				                                : InstanceTransform::TransformAABB(
+					                                boxAABB,
+					                                bvh.transform.worldToLocal
+				                                );
+
+			const auto nodes      = bvh.Nodes();
+			const auto triIndices = bvh.TriIndices();
+			const auto tris       = TrianglesOf(bvh);
+
+			uint32_t stack[64];
+			int      sp = 0;
 			stack[sp++] = 0; // ルートノードからスタート
 
 			while (sp) {
 				const uint32_t index = stack[--sp];
-				const auto& node = bvh->nodes[index];
+				const auto& node = nodes[index];
 
 				// ノードのAABBとボックスの重なり判定
-				if (!(boxAABB.max.x >= node.bounds.min.x && boxAABB.min.x <=
-					node.bounds.max.x &&
-					boxAABB.max.y >= node.bounds.min.y && boxAABB.min.y <= node.
-					bounds.max.y &&
-					boxAABB.max.z >= node.bounds.min.z && boxAABB.min.z <= node.
-					bounds.max.z)) {
+				if (!AABBOverlap(queryAABB, node.bounds)) {
 					continue; // 重なりなし
 				}
 
@@ -317,8 +836,15 @@ namespace UPhysics {
 					// 葉ノード：三角形との詳細判定
 					uint32_t first = node.leftFirst;
 					for (uint32_t i = 0; i < node.primCount; ++i) {
-						uint32_t triIdx = bvh->triIndices[first + i];
-						const Unnamed::Triangle& tri = mTriangles[triIdx];
+						const uint32_t local  = triIndices[first + i];
+						const uint32_t triIdx = static_cast<uint32_t>(
+							bvh.triStart + local
+						);
+						const Unnamed::Triangle tri = bvh.transform.isIdentity
+							                              ? tris[local]
+							                              : bvh.transform.ToWorld(
+								                              tris[local]
+							                              );
 
 						Vec3  separationAxis;
 						float penetrationDepth;
@@ -338,7 +864,8 @@ namespace UPhysics {
 					}
 				}
 			}
-		}
+			return true;
+		});
 
 		if (hitTri == UINT32_MAX) {
 			return false; // 重なりなし
@@ -360,51 +887,39 @@ namespace UPhysics {
 		int                 maxHits
 	) const {
 		int hitCount = 0;
-		if (mBVHs.empty() || mTriangles.empty() || maxHits <= 0) {
+		if (mBVHs.empty() || maxHits <= 0) {
 			return hitCount;
 		}
+		FlushTLAS();
 
-		// ブロードフェーズ：ボックスのAABBと各BVHのルートAABBの重なりをチェック
-		std::vector<const RegisteredBVH*> filtered;
-		Unnamed::AABB                     boxAABB;
+		Unnamed::AABB boxAABB;
 		boxAABB.min = box.center - box.halfSize;
 		boxAABB.max = box.center + box.halfSize;
 
-		for (const auto& bvh : mBVHs) {
-			const Unnamed::AABB& rootBounds = bvh.nodes[0].bounds;
-			// AABB同士の重なり判定
-			if (boxAABB.max.x >= rootBounds.min.x && boxAABB.min.x <= rootBounds
-				.max.x &&
-				boxAABB.max.y >= rootBounds.min.y && boxAABB.min.y <= rootBounds
-				.max.y &&
-				boxAABB.max.z >= rootBounds.min.z && boxAABB.min.z <= rootBounds
-				.max.z) {
-				filtered.emplace_back(&bvh);
-			}
-		}
-
-		if (filtered.empty()) {
-			return hitCount; // 重なりなし
-		}
-
-		// ナローフェーズ：詳細な重なり判定
-		uint32_t stack[64];
-
-		for (auto* bvh : filtered) {
-			int sp = 0;
+		// ブロードフェーズ：ボックスのAABBと重なるBLASだけを探索する
+		ForEachOverlappingBVH(boxAABB, [&](const RegisteredBVH& bvh) {
+			// ノードはローカル空間なので、ボックスのAABBをローカルに持ち込んで刈り込む
+			const Unnamed::AABB queryAABB = bvh.transform.isIdentity
+				                                ? boxAABB
+				                                : InstanceTransform::TransformAABB(
+					                                boxAABB,
+					                                bvh.transform.worldToLocal
+				                                );
+
+			const auto nodes      = bvh.Nodes();
+			const auto triIndices = bvh.TriIndices();
+			const auto tris       = TrianglesOf(bvh);
+
+			uint32_t stack[64];
+			int      sp = 0;
 			stack[sp++] = 0; // ルートノードからスタート
 
 			while (sp && hitCount < maxHits) {
 				const uint32_t index = stack[--sp];
-				const auto& node = bvh->nodes[index];
+				const auto& node = nodes[index];
 
 				// ノードのAABBとボックスの重なり判定
-				if (!(boxAABB.max.x >= node.bounds.min.x && boxAABB.min.x <=
-					node.bounds.max.x &&
-					boxAABB.max.y >= node.bounds.min.y && boxAABB.min.y <= node.
-					bounds.max.y &&
-					boxAABB.max.z >= node.bounds.min.z && boxAABB.min.z <= node.
-					bounds.max.z)) {
+				if (!AABBOverlap(queryAABB, node.bounds)) {
 					continue; // 重なりなし
 				}
 
@@ -418,8 +933,15 @@ namespace UPhysics {
 					uint32_t first = node.leftFirst;
 					for (uint32_t i = 0; i < node.primCount && hitCount <
 						maxHits; ++i) {
-						uint32_t triIdx = bvh->triIndices[first + i];
-						const Unnamed::Triangle& tri = mTriangles[triIdx];
+						const uint32_t local  = triIndices[first + i];
+						const uint32_t triIdx = static_cast<uint32_t>(
+							bvh.triStart + local
+						);
+						const Unnamed::Triangle tri = bvh.transform.isIdentity
+							                              ? tris[local]
+							                              : bvh.transform.ToWorld(
+								                              tris[local]
+							                              );
 
 						Vec3  separationAxis;
 						float penetrationDepth;
@@ -442,17 +964,29 @@ namespace UPhysics {
 					}
 				}
 			}
-		}
+			// 最大数に達したら打ち切り
+			return hitCount < maxHits;
+		});
 
 		return hitCount;
 	}
 
-	void Engine::AddGlobalOffset(
-		std::vector<uint32_t>& indices,
-		const uint32_t         base
-	) {
-		for (uint32_t& index : indices) {
-			index += base;
+	std::span<const Unnamed::Triangle> Engine::TrianglesOf(
+		const RegisteredBVH& bvh
+	) const {
+		if (bvh.mapped) {
+			return bvh.mapped->triangles;
 		}
+		return std::span(mTriangles).subspan(bvh.triStart, bvh.triCount);
+	}
+
+	bool Engine::AABBOverlap(
+		const Unnamed::AABB& a,
+		const Unnamed::AABB& b
+	) {
+		return
+			a.max.x >= b.min.x && a.min.x <= b.max.x &&
+			a.max.y >= b.min.y && a.min.y <= b.max.y &&
+			a.max.z >= b.min.z && a.min.z <= b.max.z;
 	}
 }
@@ -1,19 +1,34 @@
 #pragma once
+#include <atomic>
+#include <bit>
 #include <cmath>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
 #include <engine/Debug/Debug.h>
 #include <engine/uphysics/BVH.h>
 #include <engine/uphysics/BVHBuilder.h>
+#include <engine/uphysics/BVHCache.h>
 #include <engine/uphysics/CollisionDetection.h>
+#include <engine/uphysics/TLAS.h>
 
 namespace UPhysics {
 	// 物理エンジン
 	class Engine {
 	public:
+		Engine() = default;
+		~Engine();
+
+		Engine(const Engine&)            = delete;
+		Engine& operator=(const Engine&) = delete;
+
 		void Init();
-		void Update(float deltaTime) const;
+		void Update(float deltaTime);
 
 		void RegisterEntity(Entity* entity);
-		void UnregisterEntity(const Entity* entity);
+		// エンティティの破棄時にも呼ばれます(登録先はエンティティが覚えている)
+		void UnregisterEntity(Entity* entity);
 
 		bool RayCast(
 			const Unnamed::Ray& ray,
@@ -45,21 +60,128 @@ namespace UPhysics {
 			int                 maxHits
 		) const;
 
+		/// @brief 複数のレイをワーカースレッドに分割して判定します
+		/// @param rays 判定するレイ
+		/// @param outHits rays と同じ要素数。ヒットしなかった要素は Hit{} (t == FLT_MAX)
+		/// @return ヒットした数
+		int RayCastBatch(
+			std::span<const Unnamed::Ray> rays,
+			std::span<Hit>                outHits
+		) const;
+
+		/// @brief 複数のスイープ(レイ/ボックス/スフィア)をワーカースレッドに分割して判定します
+		/// @param queries 判定するスイープ
+		/// @param outHits queries と同じ要素数。ヒットしなかった要素は Hit{} (t == FLT_MAX)
+		/// @return ヒットした数
+		int SweepBatch(
+			std::span<const SweepQuery> queries,
+			std::span<Hit>              outHits
+		) const;
+
+		/// @brief 三角形群を直接登録します
+		/// @details メッシュコンポーネントを介さずに登録したい場合(手続き生成やベンチマーク)に使います
+		/// @param triangles ローカル空間の三角形
+		/// @param owner 登録元のエンティティ(UnregisterEntityのキー)。nullptr可。
+		///              指定した場合は Update でエンティティのワールド行列(回転・拡縮込み)に追従し、
+		///              エンティティが破棄されると登録も解除されます
+		/// @param localToWorld ローカル空間からワールド空間への変換
+		/// @return 登録したコライダーのハンドル。TLASは次のクエリか Update でまとめて作り直します
+		ColliderHandle RegisterTriangles(
+			const std::vector<Unnamed::Triangle>& triangles,
+			Entity*                               owner,
+			const Mat4&                           localToWorld = Mat4::identity
+		);
+
+		/// @brief キャッシュから読み込んだBLASを登録します
+		/// @details マップした領域をそのまま走査に使うので、ビルドも三角形のコピーもしません。
+		///          キャッシュ由来のコライダーのヒットの triIndex はコライダー内の番号になります
+		ColliderHandle RegisterMapped(
+			std::shared_ptr<const MappedBVH> mapped,
+			Entity*                          owner,
+			const Mat4&                      localToWorld = Mat4::identity
+		);
+
+		/// @brief 登録済みコライダーのBLASをキャッシュに書き出します
+		bool SaveToCache(
+			ColliderHandle            handle,
+			const std::string&        key,
+			const Unnamed::FileStamp& stamp
+		) const;
+
+		/// @brief RegisterEntity でディスクキャッシュを使うか
+		void SetUseBVHCache(bool useCache);
+		[[nodiscard]] bool UseBVHCache() const;
+
+		[[nodiscard]] const BVHCache& GetBVHCache() const;
+
+		/// @brief コライダーを動かします
+		/// @details BVHは作り直さず、行列とワールドAABBを差し替えるだけです。
+		///          TLASへの反映は次のクエリか Update でまとめて行います
+		void SetTransform(ColliderHandle handle, const Mat4& localToWorld);
+
+		/// @brief 変形したメッシュの三角形を差し替え、BVHをリフィットします
+		/// @param localTriangles 登録時と同じ数・同じ並びのローカル空間の三角形
+		/// @return 三角形の数が違うなどで差し替えられなかったらfalse
+		bool RefitTriangles(
+			ColliderHandle                     handle,
+			std::span<const Unnamed::Triangle> localTriangles
+		);
+
+		/// @brief コライダーを登録解除します
+		/// @details スロットを空けるだけの定数時間の処理です。
+		///          三角形領域の詰め直しは Update で数フレームに分けて行います
+		void Unregister(ColliderHandle handle);
+
+		[[nodiscard]] bool IsValid(ColliderHandle handle) const;
+
+		/// @brief 解除済み三角形の詰め直しを進めます
+		/// @param triangleBudget このステップで移動してよい三角形の最大数
+		void StepCompaction(size_t triangleBudget);
+
+		// 三角形領域の大きさ(解除済みの穴を含む)
+		[[nodiscard]] size_t TriangleArenaSize() const;
+		// 三角形領域のうち解除済みの穴の大きさ
+		[[nodiscard]] size_t DeadTriangleCount() const;
+
+		/// @brief ブロードフェーズにTLASを使うか(falseで全BLASを線形走査)
+		void SetUseTLAS(bool useTLAS);
+		[[nodiscard]] bool UseTLAS() const;
+
+		/// @brief BLASの探索に4分岐SIMDレイアウトを使うか(falseで2分岐のスカラー走査)
+		void SetUseBVH4(bool useBVH4);
+		[[nodiscard]] bool UseBVH4() const;
+
+		/// @brief BVHの構築を並列に行うか(結果は直列と同じ)
+		void SetParallelBuild(bool parallel);
+		[[nodiscard]] bool ParallelBuild() const;
+
+		// 最後に登録したコライダーのBVH構築統計
+		[[nodiscard]] const BVHBuildStats& LastBuildStats() const;
+
 	private:
+		// BLAS走査用のクエリ(インスタンスのローカル空間)
+		struct BLASQuery {
+			Unnamed::Ray ray;
+			BVH4Ray      ray4;
+			Vec3         expand; // ノードを膨らませる量
+		};
+
+		// 4分岐走査のスタック深さ(1段で最大3つ積むので2分岐より深く取る)
+		static constexpr int kBVH4StackSize = 128;
+
+		// debugDraw: ワーカースレッドから呼ぶ場合はデバッグ描画できないのでfalse
+		bool Sweep(const SweepQuery& query, Hit* outHit, bool debugDraw) const;
+
 		template <class CastType>
-		static bool CastBVH(
-			const CastType&                       cast,
-			const Vec3&                           start,
-			const Vec3&                           dir,
-			float                                 length,
-			Hit*                                  outHit,
-			const std::vector<RegisteredBVH>&     bvhSet,
-			const std::vector<Unnamed::Triangle>& allTriangles
-		) {
-			// まずは各BVHのルートのAABBとレイが交差するかを確認
-			// してなきゃ意味ないからね! これが噂のブロードフェーズ!
-			std::vector<const RegisteredBVH*> filtered;
-			const Unnamed::Ray                broadRay = {
+		bool CastBVH(
+			const CastType& cast,
+			const Vec3&     start,
+			const Vec3&     dir,
+			float           length,
+			Hit*            outHit,
+			const bool      debugDraw
+		) const {
+			const Unnamed::Ray broadRay = {
 				.origin = start,
 				.dir = dir,
 				.invDir = Vec3::one / dir,
@@ -74,58 +196,92 @@ namespace UPhysics {
 				dirNormalized = Vec3::zero;
 			}
 
-			for (const auto& bvh : bvhSet) {
-				Unnamed::AABB root = cast.ExpandNode(bvh.nodes[0].bounds);
-				float         t    = 1.0f;
-				if (RayVsAABB(broadRay, root, t)) {
-					filtered.emplace_back(&bvh);
-				}
-			}
-
-			if (filtered.empty()) {
-				// 交差しなかった...
-				return false;
-			}
-
-			// 本格的に探索する
 			// 一番近い衝突のTOI (TOI: Time of Impact 衝突までの時間[0.0f ～ 1.0f])
 			float    bestTOI = 1.0f;
 			uint32_t hitTri  = UINT32_MAX; // ヒットした三角形のインデックス
 			Vec3     hitNormal;            // ヒットした法線
-			uint32_t stack[64];            // スタックを使ってBVHを探索(深さ優先探索)
 
-			// ブロードフェーズで検知されたBVHを探索する
-			for (auto* bvh : filtered) {
-				int sp      = 0;
+			// ワールド空間のクエリ(TLASと、変換を持たないBLASで使う)
+			const BLASQuery worldQuery = {
+				.ray = broadRay,
+				.ray4 = MakeBVH4Ray(start, dir, cast.NodeExpansion()),
+				.expand = cast.NodeExpansion()
+			};
+
+			// 現在の最良TOIでAABBを刈り込む
+			const auto hitsBounds = [&](
+				const Unnamed::AABB& bounds, const BLASQuery& query
+			) {
+				Unnamed::Ray pruneRay = query.ray;
+				pruneRay.tMax         = bestTOI * length;
+				float tBox            = bestTOI;
+				return RayVsAABB(
+					pruneRay,
+					{bounds.min - query.expand, bounds.max + query.expand},
+					tBox
+				);
+			};
+
+			// 葉の三角形を判定する。判定自体はワールド空間で行うので、
+			// 形状(ボックスの向きなど)はインスタンスの変換の影響を受けない
+			const auto testTriangle = [&](
+				const RegisteredBVH&                     bvh,
+				const std::span<const Unnamed::Triangle> tris,
+				const uint32_t                           local
+			) {
+				float toi;
+				Vec3  nrm;
+				bool  hit;
+				if (bvh.transform.isIdentity) {
+					hit = cast.TestTriangle(tris[local], dir, length, toi, nrm);
+				} else {
+					hit = cast.TestTriangle(
+						bvh.transform.ToWorld(tris[local]),
+						dir, length, toi, nrm
+					);
+				}
+				if (hit && toi < bestTOI) {
+					// TOIが更新されたら、以降の刈り込みが厳しくなる
+					bestTOI   = toi;
+					hitTri    = static_cast<uint32_t>(bvh.triStart + local);
+					hitNormal = nrm;
+				}
+			};
+
+			// BLASを探索する
+			const auto castBLAS = [&](
+				const RegisteredBVH& bvh, const BLASQuery& query
+			) {
+				const auto nodes      = bvh.Nodes();
+				const auto triIndices = bvh.TriIndices();
+				const auto tris       = TrianglesOf(bvh);
+
+				uint32_t stack[64]; // スタックを使ってBVHを探索(深さ優先探索)
+				int      sp = 0;
 				stack[sp++] = 0; // ルートノードからスタート
 
 				while (sp) {
 					const uint32_t index = stack[--sp];
-					const auto&    node  = bvh->nodes[index];
+					const auto&    node  = nodes[index];
 
 #ifdef _DEBUG
-					Vec3 center = (node.bounds.min + node.bounds.max) *
-						0.5f;
-					const Vec3 size = node.bounds.max - node.bounds.min;
-					Debug::DrawBox(
-						center,
-						Quaternion::identity,
-						size,
-						Vec4::orange
-					);
+					if (debugDraw) {
+						Vec3 center = (node.bounds.min + node.bounds.max) *
+							0.5f;
+						const Vec3 size = node.bounds.max - node.bounds.min;
+						Debug::DrawBox(
+							center,
+							Quaternion::identity,
+							size,
+							Vec4::orange
+						);
+					}
+#else
+					(void)debugDraw;
 #endif
 
 					// 現在の最良TOIを使った早期終了
-					Unnamed::Ray pruneRay = broadRay;
-					pruneRay.tMax         = bestTOI * length;
-					float tBox            = bestTOI;
-					if (
-						!RayVsAABB(
-							pruneRay,
-							cast.ExpandNode(node.bounds),
-							tBox
-						)
-					) {
+					if (!hitsBounds(node.bounds, query)) {
 						continue; // 残念!
 					}
 
@@ -136,21 +292,140 @@ namespace UPhysics {
 					} else {
 						uint32_t first = node.leftFirst;
 						for (uint32_t i = 0; i < node.primCount; ++i) {
-							uint32_t triIdx = bvh->triIndices[first + i];
-							float    toi;
-							Vec3     nrm;
-							if (cast.TestTriangle(
-								allTriangles[triIdx], dir, length,
-								toi, nrm)) {
-								if (toi < bestTOI) {
-									bestTOI   = toi;
-									hitTri    = triIdx;
-									hitNormal = nrm;
-									// TOIが更新されたら、より厳しい早期終了を設定
-									pruneRay.tMax = bestTOI * length;
-								}
+							testTriangle(bvh, tris, triIndices[first + i]);
+						}
+					}
+				}
+			};
+
+			// 4分岐レイアウトでBLASを探索する
+			// 子4つのAABBをSSEでまとめて判定し、近い順に積む
+			const auto castBLAS4 = [&](
+				const RegisteredBVH& bvh, const BLASQuery& query
+			) {
+				const auto nodes4     = bvh.Nodes4();
+				const auto triIndices = bvh.TriIndices();
+				const auto tris       = TrianglesOf(bvh);
+
+				uint32_t stack[kBVH4StackSize];
+				int      sp = 0;
+				stack[sp++] = 0;
+
+				while (sp) {
+					const BVH4Node& node = nodes4[stack[--sp]];
+
+					alignas(16) float tNear[4];
+					uint32_t          mask = RayVsBVH4Node(
+						node, query.ray4, 0.0f, bestTOI * length, tNear
+					);
+
+					uint32_t innerChild[4];
+					float    innerT[4];
+					int      innerCount = 0;
+					while (mask) {
+						const int i = std::countr_zero(mask);
+						mask &= mask - 1;
+
+#ifdef _DEBUG
+						if (debugDraw) {
+							const Vec3 min(node.minX[i], node.minY[i], node.minZ[i]);
+							const Vec3 max(node.maxX[i], node.maxY[i], node.maxZ[i]);
+							Debug::DrawBox(
+								(min + max) * 0.5f,
+								Quaternion::identity,
+								max - min,
+								Vec4::orange
+							);
+						}
+#endif
+
+						if (node.primCount[i] == 0) {
+							// 進入距離で挿入ソート
+							int j = innerCount++;
+							while (j > 0 && innerT[j - 1] < tNear[i]) {
+								innerChild[j] = innerChild[j - 1];
+								innerT[j]     = innerT[j - 1];
+								--j;
 							}
+							innerChild[j] = node.child[i];
+							innerT[j]     = tNear[i];
+							continue;
+						}
+
+						const uint32_t first = node.child[i];
+						for (uint32_t k = 0; k < node.primCount[i]; ++k) {
+							testTriangle(bvh, tris, triIndices[first + k]);
+						}
+					}
+
+					// 遠い順に並んでいるので、近い子が最後(スタックの先頭)に積まれる
+					for (int j = 0; j < innerCount; ++j) {
+						stack[sp++] = innerChild[j];
+					}
+				}
+			};
+
+			const auto castAny = [&](const RegisteredBVH& bvh) {
+				// 動くコライダーはクエリをローカル空間に持ち込む
+				// (アフィン変換なので t はワールド空間と同じ値になる)
+				BLASQuery localQuery;
+				if (!bvh.transform.isIdentity) {
+					const Mat4& toLocal = bvh.transform.worldToLocal;
+					const Vec3  origin  = InstanceTransform::TransformPoint(
+						start, toLocal
+					);
+					const Vec3 localDir = InstanceTransform::TransformDir(
+						dir, toLocal
+					);
+					localQuery.ray = {
+						.origin = origin,
+						.dir = localDir,
+						.invDir = Vec3::one / localDir,
+						.tMin = 0.0f,
+						.tMax = length
+					};
+					localQuery.expand = InstanceTransform::TransformExtent(
+						worldQuery.expand, toLocal
+					);
+					localQuery.ray4 = MakeBVH4Ray(
+						origin, localDir, localQuery.expand
+					);
+				}
+				const BLASQuery& query = bvh.transform.isIdentity
+					                         ? worldQuery
+					                         : localQuery;
+
+				if (mUseBVH4 && !bvh.Nodes4().empty()) {
+					castBLAS4(bvh, query);
+				} else {
+					castBLAS(bvh, query);
+				}
+			};
+
+			// まずは各BVHのルートのAABBとレイが交差するかを確認
+			// してなきゃ意味ないからね! これが噂のブロードフェーズ!
+			if (mUseTLAS) {
+				mTLAS.Traverse(
+					[&](const Unnamed::AABB& bounds) {
+						return hitsBounds(bounds, worldQuery);
+					},
+					[&](const uint32_t instance) {
+						// 解除済みのスロットはTLASの再構築まで残っている
+						if (mBVHs[instance].alive) {
+							castAny(mBVHs[instance]);
 						}
+						return true;
+					}
+				);
+			} else {
+				for (const auto& bvh : mBVHs) {
+					if (!bvh.alive || bvh.triCount == 0) {
+						continue;
+					}
+					Unnamed::AABB root = cast.ExpandNode(bvh.worldBounds);
+					float         t    = 1.0f;
+					if (RayVsAABB(broadRay, root, t)) {
+						castAny(bvh);
 					}
 				}
 			}
@@ -180,13 +455,94 @@ namespace UPhysics {
 			return true;
 		}
 
-		static void AddGlobalOffset(std::vector<uint32_t>& indices,
-		                            uint32_t               base);
+		/// @brief AABBと重なるBLASを列挙します
+		/// @param visit BLASを受け取り、列挙を続けるならtrueを返す
+		template <class Visitor>
+		void ForEachOverlappingBVH(
+			const Unnamed::AABB& aabb,
+			Visitor&&            visit
+		) const {
+			if (mUseTLAS) {
+				mTLAS.Traverse(
+					[&](const Unnamed::AABB& bounds) {
+						return AABBOverlap(aabb, bounds);
+					},
+					[&](const uint32_t instance) {
+						const RegisteredBVH& bvh = mBVHs[instance];
+						return !bvh.alive || visit(bvh);
+					}
+				);
+				return;
+			}
+
+			for (const auto& bvh : mBVHs) {
+				if (!bvh.alive || bvh.triCount == 0) {
+					continue;
+				}
+				if (AABBOverlap(aabb, bvh.worldBounds) && !visit(bvh)) {
+					return;
+				}
+			}
+		}
+
+		static bool AABBOverlap(
+			const Unnamed::AABB& a,
+			const Unnamed::AABB& b
+		);
+
+		// コライダーの三角形(triIndices の参照先)
+		[[nodiscard]] std::span<const Unnamed::Triangle> TrianglesOf(
+			const RegisteredBVH& bvh
+		) const;
+
+		// 所有エンティティのワールド行列に追従する
+		void SyncOwnerTransforms();
+
+		// 登録・解除・移動をTLASに反映する。クエリの入口で呼ぶので const
+		// (登録と解除はクエリと同時には呼べないので、反映の競合だけロックで防ぐ)
+		void FlushTLAS() const;
+
+		// ローカルのルートAABBからワールドAABBを求め直す
+		static void UpdateWorldBounds(RegisteredBVH& bvh);
+
+		void BeginCompaction();
+		void FinishCompaction();
 
 		std::vector<Unnamed::Triangle> mTriangles;
 		std::vector<FlatNode>          mNodes;
 		std::vector<uint32_t>          mTriIndices;
 
+		// コライダーのスロット。解除しても詰めずに空きリストで再利用する
 		std::vector<RegisteredBVH> mBVHs;
+		std::vector<uint32_t>      mFreeSlots;
+
+		std::unordered_map<Entity*, std::vector<ColliderHandle>>
+		mOwnerHandles;
+
+		mutable TLAS              mTLAS;
+		mutable std::mutex        mTLASMutex;
+		mutable std::atomic<bool> mTLASPending = false; // 下のどちらかが立っている
+		mutable bool              mTLASDirty   = false; // 登録・解除したスロットがTLASに反映されていない
+		mutable bool              mTLASRefit   = false; // 動いたコライダーのAABBがTLASに反映されていない
+		bool                      mUseTLAS     = true;
+		bool                      mUseBVH4     = true;
+
+		bool          mParallelBuild = true;
+		BVHBuildStats mLastBuildStats;
+
+		BVHCache mBVHCache;
+		bool     mUseBVHCache = true;
+
+		// mTriangles の詰め直し(数フレームに分けて進める)
+		struct Compaction {
+			bool                        active = false;
+			std::vector<ColliderHandle> order;      // triStart順の生存コライダー
+			size_t                      cursor = 0; // 次に処理するorderの位置
+			size_t                      write  = 0; // 次に詰める先
+			size_t                      end    = 0; // 開始時点の領域の終端
+		};
+
+		Compaction mCompaction;
+		size_t     mDeadTriangles = 0;
 	};
 }
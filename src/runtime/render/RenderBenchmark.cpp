@@ -0,0 +1,1003 @@
+﻿#include <runtime/render/RenderBenchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <engine/subsystem/console/Log.h>
+
+#include <core/jobsystem/JobSystem.h>
+
+#include <engine/uuploadarena/UploadSuballocator.h>
+
+#include <runtime/core/math/Math.h>
+#include <runtime/render/batching/RenderBatching.h>
+#include <runtime/render/culling/RenderCulling.h>
+#include <runtime/render/pipeline/PipelineManifest.h>
+#include <runtime/render/pipeline/PipelinePrecompiler.h>
+#include <runtime/render/resources/ShaderCache.h>
+
+namespace Unnamed::RenderBenchmark {
+	namespace {
+		constexpr std::string_view kChannel = "RenderBenchmark";
+
+		constexpr uint32_t kParallelRequests = 8;
+		constexpr auto     kCompileTime      = std::chrono::milliseconds(20);
+
+		constexpr uint32_t kPipelineCount = 64;
+		constexpr auto     kPsoTime       = std::chrono::milliseconds(2);
+
+		constexpr uint32_t kCollectIterations = 20;
+		constexpr size_t   kCollectGrainSize  = 256; // URenderSubsystem と同じ
+		constexpr uint32_t kBenchMeshes       = 8;
+		constexpr uint32_t kBenchPsos         = 8;
+		constexpr uint32_t kBenchMaterials    = 64;
+		constexpr float    kSceneExtent       = 200.0f;
+
+		// URenderSubsystem の CollectSource / RenderItem 相当
+		struct BenchSource {
+			Mat4     local;
+			uint32_t mesh;
+			uint32_t pso;
+			uint32_t material;
+		};
+
+		struct BenchItem {
+			Mat4     world;
+			uint32_t mesh     = 0;
+			float    depthVS  = 0.0f;
+			uint64_t sortKey  = 0;
+			uint32_t pso      = 0;
+			uint32_t material = 0;
+			uint32_t source   = 0;
+		};
+
+		struct BenchMesh {
+			Vec3 min;
+			Vec3 max;
+		};
+
+		// 決まった並びの乱数(実行ごとに同じシーン)
+		class BenchRandom {
+		public:
+			float Next(const float lo, const float hi) {
+				mState = mState * 6364136223846793005ULL + 1442695040888963407ULL;
+				const float t = static_cast<float>(mState >> 40) /
+					static_cast<float>(1ull << 24);
+				return lo + (hi - lo) * t;
+			}
+
+		private:
+			uint64_t mState = 0x853c49e6748fea9bULL;
+		};
+
+		constexpr uint32_t kBatchProps     = 10000;
+		constexpr uint32_t kBatchMeshes    = 16;
+		constexpr uint32_t kBatchMaterials = 8;
+		constexpr uint32_t kBatchLimit     = 1024; // URenderSubsystem と同じ
+
+		constexpr uint64_t kMockArenaSize  = 16ull * 1024 * 1024; // UEngine と同じ
+		constexpr uint32_t kMockItems      = 100000;
+		constexpr uint32_t kMockBatchLimit = 1024;
+		constexpr uint32_t kMockMinBatches = 64; // URenderSubsystem と同じ
+		constexpr uint32_t kMockIterations = 20;
+
+		// 偽のコマンドリスト: 描画コマンドを覚えるだけ
+		struct MockDraw {
+			uint32_t batch;
+			uint64_t instances; // アップロード領域のオフセット
+			uint32_t count;
+		};
+
+		// 偽のアップロード領域(マップしたメモリの代わり)
+		struct MockUploadMemory {
+			UploadSuballocator   allocator;
+			std::vector<uint8_t> bytes;
+		};
+
+		// URenderSubsystem::RecordBatches の代わり(ワールド行列を並べて描画を積む)
+		bool RecordMock(
+			const std::vector<Mat4>&      worlds,
+			const std::vector<DrawBatch>& batches,
+			const DrawRange&              range,
+			MockUploadMemory&             memory,
+			UploadBlockCursor&            cursor,
+			std::vector<MockDraw>&        out
+		) {
+			for (uint32_t b = 0; b < range.batchCount; ++b) {
+				const uint32_t   index  = range.firstBatch + b;
+				const DrawBatch& batch  = batches[index];
+				const uint64_t   offset = cursor.Allocate(sizeof(Mat4) * batch.count, 256);
+				if (offset == UploadSuballocator::kInvalidOffset) {
+					return false;
+				}
+				std::memcpy(memory.bytes.data() + offset, &worlds[batch.first],
+				            sizeof(Mat4) * batch.count);
+				out.emplace_back(MockDraw{index, offset, batch.count});
+			}
+			return true;
+		}
+
+		// バッチが keys を先頭から隙間なく覆っているか
+		bool CoversInOrder(
+			const std::vector<DrawBatch>& batches, const size_t count
+		) {
+			uint32_t next = 0;
+			for (const auto& b : batches) {
+				if (b.first != next || b.count == 0) {
+					return false;
+				}
+				next += b.count;
+			}
+			return next == count;
+		}
+
+		double MillisecondsSince(const std::chrono::steady_clock::time_point start) {
+			return std::chrono::duration<double, std::milli>(
+				std::chrono::steady_clock::now() - start
+			).count();
+		}
+
+		std::string ReadText(const std::filesystem::path& path) {
+			std::ifstream      file(path, std::ios::binary);
+			std::ostringstream ss;
+			ss << file.rdbuf();
+			return ss.str();
+		}
+
+		void WriteText(const std::filesystem::path& path, const std::string& text) {
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			file << text;
+		}
+
+		// #include "..." を仮想ファイルの場所から解決して中身を連結するだけのコンパイラ
+		class FakeCompiler final : public IShaderCompiler {
+		public:
+			ShaderCompileResult Compile(
+				const std::string&      source,
+				const ShaderVariantKey& key,
+				const std::string&      virtualName
+			) override {
+				++compiles;
+				std::this_thread::sleep_for(kCompileTime);
+				if (throwOnCompile) {
+					throw std::runtime_error("fake compiler failure");
+				}
+
+				ShaderCompileResult result;
+				std::string         output = key.entryPoint + ";" + key.target;
+				for (const auto& define : key.defines) {
+					output += ";" + define;
+				}
+
+				const auto base = std::filesystem::path(virtualName).parent_path();
+				std::istringstream lines(source);
+				for (std::string line; std::getline(lines, line);) {
+					constexpr std::string_view kInclude = "#include \"";
+					if (!line.starts_with(kInclude)) {
+						output += line;
+						continue;
+					}
+					const auto end  = line.find('"', kInclude.size());
+					const auto path = (base / line.substr(
+						kInclude.size(), end - kInclude.size()
+					)).string();
+					if (!std::filesystem::exists(path)) {
+						result.errors = "cannot open include: " + path;
+						return result;
+					}
+					output += ReadText(path);
+					result.includes.emplace_back(path);
+				}
+
+				result.bytecode.assign(output.begin(), output.end());
+				result.succeeded = true;
+				return result;
+			}
+
+			[[nodiscard]] std::string_view Identity() const override {
+				return "fake;v1";
+			}
+
+			std::atomic<uint32_t> compiles       = 0;
+			std::atomic<bool>     throwOnCompile = false; // DXC の THROW 相当
+		};
+
+		bool Expect(const bool condition, const std::string_view what) {
+			if (condition) {
+				Msg(kChannel, "  ok   {}", what);
+			} else {
+				Warning(kChannel, "  FAIL {}", what);
+			}
+			return condition;
+		}
+	}
+
+	bool RunShaderCache() {
+		namespace fs = std::filesystem;
+
+		const fs::path root = fs::temp_directory_path() / "unnamed_shader_cache_check";
+		std::error_code ec;
+		fs::remove_all(root, ec);
+		fs::create_directories(root / "src", ec);
+
+		const fs::path   include = root / "src" / "Common.hlsli";
+		const fs::path   shader  = root / "src" / "Test.hlsl";
+		const fs::path   dir     = root / "cache";
+		const std::string source =
+			"#include \"Common.hlsli\"\nfloat4 main() : SV_Target { return Color; }\n";
+		WriteText(include, "static const float4 Color = 1;\n");
+
+		const ShaderVariantKey key = {
+			.asset = kInvalidAssetID, .defines = {"USE_FOG"},
+			.entryPoint = "main", .target = "ps_6_0"
+		};
+		const std::string virtualName = shader.string();
+
+		FakeCompiler compiler;
+		bool         ok = true;
+
+		Msg(kChannel, "ShaderCache check ({})", root.string());
+
+		// コールド → メモリ
+		ShaderCache::Bytecode first;
+		{
+			ShaderCache cache(compiler, dir);
+			std::string errors;
+			first = cache.GetOrCompile(source, key, virtualName, &errors);
+			ok &= Expect(first && compiler.compiles == 1, "cold compile");
+			const auto again = cache.GetOrCompile(source, key, virtualName);
+			ok &= Expect(
+				again == first && compiler.compiles == 1 &&
+				cache.GetStats().memoryHits == 1,
+				"memory hit"
+			);
+			ok &= Expect(fs::exists(cache.PathFor(
+				             cache.KeyOf(source, key, virtualName))),
+			             "entry written to disk");
+		}
+
+		// 作り直したキャッシュ(次回起動相当) → ディスク
+		{
+			ShaderCache cache(compiler, dir);
+			const auto  bytecode = cache.GetOrCompile(source, key, virtualName);
+			ok &= Expect(
+				bytecode && *bytecode == *first && compiler.compiles == 1 &&
+				cache.GetStats().diskHits == 1,
+				"disk hit after restart"
+			);
+		}
+
+		// インクルードを書き換えたらコンパイルし直す
+		WriteText(include, "static const float4 Color = 0.5;\n");
+		{
+			ShaderCache cache(compiler, dir);
+			const auto  bytecode = cache.GetOrCompile(source, key, virtualName);
+			ok &= Expect(
+				bytecode && *bytecode != *first && compiler.compiles == 2 &&
+				cache.GetStats().diskHits == 0,
+				"recompile after include change"
+			);
+
+			ShaderVariantKey other = key;
+			other.defines          = {"USE_FOG=0"};
+			ok &= Expect(
+				cache.KeyOf(source, other, virtualName) !=
+				cache.KeyOf(source, key, virtualName),
+				"defines change the key"
+			);
+			const auto variant = cache.GetOrCompile(source, other, virtualName);
+			ok &= Expect(
+				variant && *variant != *bytecode && compiler.compiles == 3,
+				"define variant compiles separately"
+			);
+		}
+
+		// 壊れたエントリ(数が大きすぎる、途中で切れている)は読まずにコンパイルし直す
+		{
+			const ShaderCache probe(compiler, dir);
+			const fs::path    entry = probe.PathFor(probe.KeyOf(source, key, virtualName));
+			std::string       bytes = ReadText(entry);
+			constexpr size_t kIncludeCountOffset = 16; // magic, version, key の後
+			const uint32_t   huge                = 0xFFFFFFFFu;
+			std::memcpy(bytes.data() + kIncludeCountOffset, &huge, sizeof(huge));
+			WriteText(entry, bytes.substr(0, bytes.size() / 2));
+
+			ShaderCache    cache(compiler, dir);
+			const uint32_t before   = compiler.compiles;
+			const auto     bytecode = cache.GetOrCompile(source, key, virtualName);
+			ok &= Expect(
+				bytecode && compiler.compiles - before == 1 &&
+				cache.GetStats().diskHits == 0,
+				"corrupt entry rejected"
+			);
+		}
+
+		// コンパイラーが例外を投げても、次の要求でやり直せる
+		{
+			ShaderCache cache(compiler, {});
+			compiler.throwOnCompile = true;
+			bool threw              = false;
+			try {
+				cache.GetOrCompile(source, key, virtualName);
+			} catch (const std::exception&) {
+				threw = true;
+			}
+			compiler.throwOnCompile = false;
+			const auto bytecode     = cache.GetOrCompile(source, key, virtualName);
+			ok &= Expect(threw && bytecode != nullptr, "retry after compiler exception");
+		}
+
+		// 同じキーを並列に要求しても1回だけコンパイルする(メモリのみ)
+		{
+			ShaderCache cache(compiler, {});
+			const uint32_t before = compiler.compiles;
+
+			std::vector<ShaderCache::Bytecode> results(kParallelRequests);
+			std::vector<std::thread>           threads;
+			for (uint32_t i = 0; i < kParallelRequests; ++i) {
+				threads.emplace_back([&, i] {
+					results[i] = cache.GetOrCompile(source, key, virtualName);
+				});
+			}
+			for (auto& thread : threads) {
+				thread.join();
+			}
+
+			bool same = true;
+			for (const auto& r : results) {
+				same &= r && r == results[0];
+			}
+			ok &= Expect(
+				same && compiler.compiles - before == 1,
+				std::format("{} parallel requests, 1 compile", kParallelRequests)
+			);
+		}
+
+		fs::remove_all(root, ec);
+
+		if (ok) {
+			Msg(kChannel, "ShaderCache check passed");
+		} else {
+			Warning(kChannel, "ShaderCache check failed");
+		}
+		return ok;
+	}
+
+	bool RunPipelineLibrary() {
+		namespace fs = std::filesystem;
+
+		const fs::path path = fs::temp_directory_path() /
+			"unnamed_pipeline_check" / "pipelines.upl";
+		std::error_code ec;
+		fs::remove_all(path.parent_path(), ec);
+
+		bool ok = true;
+		Msg(kChannel, "Pipeline library check ({})", path.string());
+
+		// マニフェスト
+		{
+			PipelineManifest manifest;
+			const std::vector<uint8_t> vs = {1, 2, 3};
+			const std::vector<uint8_t> ps = {4, 5, 6, 7};
+			manifest.AddBlob(100, vs);
+			manifest.AddBlob(200, ps);
+			manifest.AddBlob(300, vs); // どこからも参照しない
+			for (uint64_t hash = 1; hash <= 3; ++hash) {
+				manifest.Add({
+					.hash = hash,
+					.desc = std::vector<uint8_t>(hash * 8, static_cast<uint8_t>(hash)),
+					.blobs = {100, 200}
+				});
+			}
+			ok &= Expect(!manifest.Add({.hash = 2}), "duplicate record rejected");
+			ok &= Expect(manifest.Save(path) && !manifest.IsDirty(), "save");
+
+			PipelineManifest loaded;
+			const bool       read = loaded.Load(path);
+			bool             same = read && loaded.Records().size() == 3;
+			for (size_t i = 0; same && i < 3; ++i) {
+				const auto& a = manifest.Records()[i];
+				const auto& b = loaded.Records()[i];
+				same &= a.hash == b.hash && a.desc == b.desc && a.blobs == b.blobs;
+			}
+			ok &= Expect(same, "records round-trip in order");
+			ok &= Expect(
+				loaded.BlobCount() == 2 && loaded.FindBlob(200) &&
+				*loaded.FindBlob(200) == ps,
+				"only referenced blobs are saved"
+			);
+
+			// 使われないセッションが続いたら捨てる
+			loaded.MarkUsed(1);
+			for (uint32_t i = 0; i <= PipelineManifest::kMaxUnusedSessions; ++i) {
+				loaded.MarkUsed(1);
+				loaded.EndSession();
+			}
+			ok &= Expect(
+				loaded.Records().size() == 1 && loaded.Contains(1) &&
+				!loaded.Contains(2),
+				"unused records expire"
+			);
+
+			// 壊れたファイル
+			const auto bytes = ReadText(path);
+			WriteText(path, bytes.substr(0, bytes.size() - 5));
+			ok &= Expect(
+				!loaded.Load(path) && loaded.Records().empty(),
+				"truncated manifest rejected"
+			);
+			// 先頭レコードのブロブ数 (ヘッダ 16 + ブロブ 19 + 20 + hash/unused/descSize 16)
+			auto huge = bytes;
+			huge.replace(71, sizeof(uint32_t), sizeof(uint32_t), '\xFF');
+			WriteText(path, huge);
+			ok &= Expect(!loaded.Load(path), "oversized blob count rejected");
+			WriteText(path, "garbage");
+			ok &= Expect(!loaded.Load(path), "bad magic rejected");
+		}
+
+		// 先行作成のスケジューリング
+		{
+			std::vector<std::atomic<uint32_t>> created(kPipelineCount);
+			const auto create = [&](const size_t index) {
+				std::this_thread::sleep_for(kPsoTime);
+				++created[index];
+				return index % 16 != 15; // いくつかは失敗させる
+			};
+
+			const auto start = std::chrono::steady_clock::now();
+
+			PipelinePrecompiler precompiler(kPipelineCount, create);
+			precompiler.Start(JobSystem::Get());
+
+			// 描画側が後ろから要求する(未着手なら横取り、作成中なら待つ)
+			bool results = true;
+			for (size_t i = kPipelineCount; i-- > kPipelineCount / 2;) {
+				results &= precompiler.Acquire(i) == (i % 16 != 15);
+			}
+			precompiler.Wait();
+
+			const double ms = std::chrono::duration<double, std::milli>(
+				std::chrono::steady_clock::now() - start
+			).count();
+
+			bool once = true;
+			for (const auto& c : created) {
+				once &= c.load() == 1;
+			}
+			const auto stats = precompiler.GetStats();
+			ok &= Expect(once, "every pipeline created exactly once");
+			ok &= Expect(results, "acquire reports success and failure");
+			ok &= Expect(
+				stats.byWorkers + stats.byCaller == kPipelineCount &&
+				stats.failed == kPipelineCount / 16 &&
+				precompiler.Finished() == kPipelineCount,
+				std::format(
+					"workers {}, caller {}, waited {}, failed {} in {:.1f} ms (serial {} ms)",
+					stats.byWorkers, stats.byCaller, stats.waited, stats.failed, ms,
+					kPipelineCount * kPsoTime.count()
+				)
+			);
+		}
+
+		// キャンセルしても残りは Acquire / Wait で作れる
+		{
+			std::vector<std::atomic<uint32_t>> created(kPipelineCount);
+			PipelinePrecompiler                precompiler(
+				kPipelineCount, [&](const size_t index) {
+					std::this_thread::sleep_for(kPsoTime);
+					++created[index];
+					return true;
+				}
+			);
+			precompiler.Start(JobSystem::Get(), 1);
+			precompiler.Cancel();
+			precompiler.Wait();
+
+			bool once = true;
+			for (const auto& c : created) {
+				once &= c.load() == 1;
+			}
+			ok &= Expect(once && precompiler.Finished() == kPipelineCount,
+			             "cancelled precompile finishes on the caller");
+		}
+
+		fs::remove_all(path.parent_path(), ec);
+
+		if (ok) {
+			Msg(kChannel, "Pipeline library check passed");
+		} else {
+			Warning(kChannel, "Pipeline library check failed");
+		}
+		return ok;
+	}
+
+	bool RunCollect(const uint32_t count) {
+		// シーン
+		BenchRandom            random;
+		std::vector<BenchMesh> meshes(kBenchMeshes);
+		for (auto& mesh : meshes) {
+			const float size = random.Next(0.5f, 4.0f);
+			mesh.min         = Vec3(-size, -size * 0.5f, -size);
+			mesh.max         = Vec3(size, size * 1.5f, size);
+		}
+
+		std::vector<BenchSource> sources(count);
+		for (auto& src : sources) {
+			src.local = Mat4::Affine(
+				Vec3::one * random.Next(0.5f, 2.0f),
+				Vec3(0.0f, random.Next(0.0f, 6.28f), 0.0f),
+				Vec3(
+					random.Next(-kSceneExtent, kSceneExtent),
+					random.Next(-10.0f, 10.0f),
+					random.Next(-kSceneExtent, kSceneExtent)
+				)
+			);
+			src.mesh     = static_cast<uint32_t>(random.Next(0.0f, kBenchMeshes - 0.01f));
+			src.pso      = static_cast<uint32_t>(random.Next(0.0f, kBenchPsos - 0.01f));
+			src.material = static_cast<uint32_t>(random.Next(0.0f, kBenchMaterials - 0.01f));
+		}
+
+		// 原点から +Z を見るカメラ
+		const Mat4 view     = Mat4::identity;
+		const Mat4 proj     = Mat4::PerspectiveFovMat(1.0472f, 16.0f / 9.0f, 0.1f, 1000.0f);
+		const Mat4 viewProj = view * proj;
+		const Mat4 parent   = Mat4::identity;
+
+		const auto depthOf = [&](const Mat4& world) {
+			return (Vec4(world.m[3][0], world.m[3][1], world.m[3][2], 1.0f) * view).z;
+		};
+
+		// 旧実装: 全件を1スレッドで積んで比較ソート
+		std::vector<BenchItem> legacy;
+		double                 legacyMs = 0.0;
+		for (uint32_t iter = 0; iter < kCollectIterations; ++iter) {
+			const auto start = std::chrono::steady_clock::now();
+			legacy.clear();
+			for (const auto& src : sources) {
+				BenchItem it;
+				it.world    = src.local * parent;
+				it.mesh     = src.mesh;
+				it.depthVS  = depthOf(it.world);
+				it.pso      = src.pso;
+				it.material = src.material;
+				legacy.emplace_back(it);
+			}
+			std::ranges::sort(
+				legacy,
+				[](const BenchItem& a, const BenchItem& b) {
+					if (a.pso != b.pso) {
+						return a.pso < b.pso;
+					}
+					if (a.material != b.material) {
+						return a.material < b.material;
+					}
+					return a.depthVS < b.depthVS;
+				}
+			);
+			legacyMs += MillisecondsSince(start);
+		}
+
+		// 新実装
+		auto&                               jobs  = JobSystem::Get();
+		const uint32_t                      lanes = jobs.MaxLanes();
+		std::vector<std::vector<BenchItem>> laneItems(lanes);
+		std::vector<BenchItem>              items;
+		std::vector<BenchItem>              sorted;
+		std::vector<RenderSortKey>          keys;
+		std::vector<RenderSortKey>          scratch;
+		const Frustum                       frustum = Frustum::FromViewProj(viewProj);
+		double                              collectMs = 0.0;
+		double                              sortMs    = 0.0;
+		for (uint32_t iter = 0; iter < kCollectIterations; ++iter) {
+			const auto start = std::chrono::steady_clock::now();
+			for (auto& lane : laneItems) {
+				lane.clear();
+			}
+			jobs.ParallelFor(
+				sources.size(), kCollectGrainSize,
+				[&](const size_t begin, const size_t end, const uint32_t lane) {
+					auto& out = laneItems[lane];
+					for (size_t i = begin; i < end; ++i) {
+						const auto& src   = sources[i];
+						const Mat4  world = src.local * parent;
+						const auto& mesh  = meshes[src.mesh];
+						if (!frustum.Intersects(mesh.min, mesh.max, world)) {
+							continue;
+						}
+						BenchItem it;
+						it.world    = world;
+						it.mesh     = src.mesh;
+						it.depthVS  = depthOf(world);
+						it.pso      = src.pso;
+						it.material = src.material;
+						it.sortKey  = MakeRenderSortKey(
+							it.pso, it.material, it.mesh, it.depthVS
+						);
+						it.source   = static_cast<uint32_t>(i);
+						out.emplace_back(it);
+					}
+				}
+			);
+			items.clear();
+			for (auto& lane : laneItems) {
+				items.insert(items.end(), lane.begin(), lane.end());
+			}
+			collectMs += MillisecondsSince(start);
+
+			const auto sortStart = std::chrono::steady_clock::now();
+			keys.resize(items.size());
+			for (size_t i = 0; i < items.size(); ++i) {
+				keys[i] = {items[i].sortKey, static_cast<uint32_t>(i)};
+			}
+			RadixSort(keys, scratch);
+			sorted.clear();
+			sorted.reserve(items.size());
+			for (const auto& k : keys) {
+				sorted.emplace_back(items[k.index]);
+			}
+			sortMs += MillisecondsSince(sortStart);
+		}
+
+		// 確認: キーの順に並んでいて、中心が画面内のものは全て残っている
+		bool ordered = true;
+		for (size_t i = 1; i < sorted.size(); ++i) {
+			ordered &= sorted[i - 1].sortKey <= sorted[i].sortKey;
+		}
+		std::vector<uint8_t> kept(sources.size(), 0);
+		for (const auto& it : sorted) {
+			kept[it.source] = 1;
+		}
+		bool conservative = true;
+		for (size_t i = 0; i < sources.size(); ++i) {
+			const Mat4& local = sources[i].local;
+			const Vec4  clip  = Vec4(local.m[3][0], local.m[3][1], local.m[3][2], 1.0f) *
+				viewProj;
+			if (clip.w > 0.0f && std::abs(clip.x) <= clip.w &&
+				std::abs(clip.y) <= clip.w && clip.z >= 0.0f && clip.z <= clip.w) {
+				conservative &= kept[i] != 0;
+			}
+		}
+
+		const double legacyAvg  = legacyMs / kCollectIterations;
+		const double collectAvg = collectMs / kCollectIterations;
+		const double sortAvg    = sortMs / kCollectIterations;
+		Msg(kChannel, "Collect {} items ({} lanes, {} iterations)", count, lanes,
+		    kCollectIterations);
+		Msg(kChannel, "  legacy : {:.3f} ms ({} items, comparison sort)",
+		    legacyAvg, legacy.size());
+		Msg(kChannel,
+		    "  culled : {:.3f} ms (collect {:.3f} + radix sort {:.3f}), {} visible, {} culled",
+		    collectAvg + sortAvg, collectAvg, sortAvg, sorted.size(),
+		    count - sorted.size());
+		Msg(kChannel, "  speedup: {:.2f}x", legacyAvg / (collectAvg + sortAvg));
+
+		const bool ok = Expect(ordered, "radix sort order") &
+			Expect(conservative, "no visible item culled");
+		return ok;
+	}
+
+	bool RunDrawBatching() {
+		bool ok = true;
+
+		const auto key = [](const uint32_t mesh, const uint32_t material,
+		                    const uint32_t pso, const bool instanced = true) {
+			return DrawBatchKey{
+				.mesh = MakeDrawBatchMesh(mesh, 1),
+				.material = material,
+				.pso = pso,
+				.instanced = instanced
+			};
+		};
+		const auto same = [](const std::vector<DrawBatch>&          batches,
+		                     std::initializer_list<DrawBatch> expected) {
+			return std::ranges::equal(
+				batches, expected,
+				[](const DrawBatch& a, const DrawBatch& b) {
+					return a.first == b.first && a.count == b.count;
+				}
+			);
+		};
+
+		std::vector<DrawBatchKey> keys;
+		std::vector<DrawBatch>    batches;
+
+		BuildDrawBatches(keys, kBatchLimit, batches);
+		ok &= Expect(batches.empty(), "empty list");
+
+		keys = {
+			key(1, 1, 1), key(1, 1, 1), key(1, 1, 1),
+			key(2, 1, 1), key(2, 1, 1), key(1, 1, 1)
+		};
+		BuildDrawBatches(keys, kBatchLimit, batches);
+		ok &= Expect(same(batches, {{0, 3}, {3, 2}, {5, 1}}),
+		             "consecutive runs merge, separated runs do not");
+
+		keys = {key(1, 1, 1), key(1, 2, 1), key(1, 2, 2), key(1, 2, 2)};
+		BuildDrawBatches(keys, kBatchLimit, batches);
+		ok &= Expect(same(batches, {{0, 1}, {1, 1}, {2, 2}}),
+		             "material and PSO changes split");
+
+		keys = {
+			key(1, 1, 1, false), key(1, 1, 1, false), key(1, 1, 1), key(1, 1, 1)
+		};
+		BuildDrawBatches(keys, kBatchLimit, batches);
+		ok &= Expect(same(batches, {{0, 1}, {1, 1}, {2, 2}}),
+		             "non-instanced materials draw one by one");
+
+		keys.assign(2500, key(3, 3, 3));
+		BuildDrawBatches(keys, kBatchLimit, batches);
+		ok &= Expect(same(batches, {{0, 1024}, {1024, 1024}, {2048, 452}}),
+		             "batches split at the instance limit");
+
+		keys.assign(3, key(3, 3, 3));
+		keys[1].mesh = MakeDrawBatchMesh(3, 2);
+		BuildDrawBatches(keys, kBatchLimit, batches);
+		ok &= Expect(batches.size() == 3, "mesh generation is part of the key");
+
+		// 同じ小物を並べたシーン: 描画と同じ順(PSO → マテリアル → メッシュ → 深度)に並べてからまとめる
+		BenchRandom                random;
+		std::vector<RenderSortKey> sortKeys(kBatchProps);
+		std::vector<RenderSortKey> scratch;
+		std::vector<DrawBatchKey>  props(kBatchProps);
+		for (uint32_t i = 0; i < kBatchProps; ++i) {
+			// マテリアルごとに使うメッシュは2種類(同じ棚に同じ小物が並ぶ想定)
+			const auto material = static_cast<uint32_t>(
+				random.Next(0.0f, kBatchMaterials - 0.01f));
+			const uint32_t mesh = (material * 2 + (random.Next(0.0f, 1.0f) < 0.8f ? 0 : 1))
+				% kBatchMeshes;
+			props[i]    = key(mesh, material, material % 4);
+			sortKeys[i] = {
+				MakeRenderSortKey(material % 4, material, mesh, random.Next(1.0f, 500.0f)),
+				i
+			};
+		}
+		RadixSort(sortKeys, scratch);
+		keys.clear();
+		for (const auto& k : sortKeys) {
+			keys.emplace_back(props[k.index]);
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		BuildDrawBatches(keys, kBatchLimit, batches);
+		const double elapsed = MillisecondsSince(start);
+		ok &= Expect(CoversInOrder(batches, keys.size()), "scene batches cover every item");
+
+		// 最少の描画回数(PSO・マテリアル・メッシュの組み合わせごとに上限まで)
+		std::vector<DrawBatchKey> ideal = keys;
+		std::ranges::stable_sort(
+			ideal,
+			[](const DrawBatchKey& a, const DrawBatchKey& b) {
+				if (a.pso != b.pso) {
+					return a.pso < b.pso;
+				}
+				if (a.material != b.material) {
+					return a.material < b.material;
+				}
+				return a.mesh < b.mesh;
+			}
+		);
+		std::vector<DrawBatch> idealBatches;
+		BuildDrawBatches(ideal, kBatchLimit, idealBatches);
+
+		ok &= Expect(batches.size() == idealBatches.size(),
+		             "sort key keeps identical meshes adjacent");
+
+		Msg(kChannel, "Batching {} props ({} meshes, {} materials): {} draws -> {} draws in {:.3f} ms",
+		    kBatchProps, kBatchMeshes, kBatchMaterials, keys.size(),
+		    batches.size(), elapsed);
+
+		return ok;
+	}
+
+	bool RunParallelRecording() {
+		bool  ok   = true;
+		auto& jobs = JobSystem::Get();
+
+		// 並列の切り出し: カーソルと直接の確保を混ぜて、重なりとアラインメントを確認
+		{
+			constexpr uint32_t kTasks    = 64;
+			constexpr uint32_t kPerTask  = 500;
+			constexpr uint64_t kCapacity = 256ull * 1024 * 1024; // オフセットだけなのでメモリは取らない
+			struct Range {
+				uint64_t begin;
+				uint64_t end;
+				uint64_t alignment;
+			};
+
+			UploadSuballocator allocator;
+			allocator.Reset(kCapacity);
+			std::vector<std::vector<Range>> perTask(kTasks);
+			std::atomic<uint32_t>           failures = 0;
+			jobs.ParallelFor(
+				kTasks, 1,
+				[&](const size_t begin, const size_t end, uint32_t) {
+					for (size_t t = begin; t < end; ++t) {
+						UploadBlockCursor cursor(allocator);
+						uint64_t          seed = 0x9E3779B97F4A7C15ull * (t + 1);
+						for (uint32_t i = 0; i < kPerTask; ++i) {
+							seed                     = seed * 6364136223846793005ull + 1;
+							const uint64_t size      = 16 + (seed >> 33) % 4096;
+							const uint64_t alignment = (seed >> 20) & 1 ? 256 : 16;
+							// たまにブロックより大きいもの、たまにカーソルを通さないもの
+							const uint64_t bytes  = (seed >> 40) % 97 == 0 ? size * 32 : size;
+							const bool     direct = (seed >> 50) % 13 == 0;
+							const uint64_t offset = direct ?
+								                        allocator.Allocate(bytes, alignment) :
+								                        cursor.Allocate(bytes, alignment);
+							if (offset == UploadSuballocator::kInvalidOffset) {
+								++failures;
+								continue;
+							}
+							perTask[t].emplace_back(Range{offset, offset + bytes, alignment});
+						}
+					}
+				}
+			);
+
+			std::vector<Range> all;
+			for (const auto& task : perTask) {
+				all.insert(all.end(), task.begin(), task.end());
+			}
+			std::ranges::sort(all, {}, &Range::begin);
+			bool disjoint = true;
+			bool aligned  = true;
+			for (size_t i = 0; i < all.size(); ++i) {
+				aligned &= all[i].begin % all[i].alignment == 0;
+				aligned &= all[i].end <= kCapacity;
+				if (i > 0) {
+					disjoint &= all[i - 1].end <= all[i].begin;
+				}
+			}
+			ok &= Expect(failures == 0 && all.size() == kTasks * kPerTask,
+			             "parallel allocations all succeed");
+			ok &= Expect(disjoint, "parallel allocations do not overlap");
+			ok &= Expect(aligned, "parallel allocations are aligned and in bounds");
+
+			// 使い切り
+			UploadSuballocator small;
+			small.Reset(64ull * 1024);
+			UploadBlockCursor tiny(small, 48ull * 1024);
+			const uint64_t    a = tiny.Allocate(1024, 256);       // ブロックを取る
+			const uint64_t    b = tiny.Allocate(40ull * 1024, 256); // ブロック内
+			const uint64_t    c = tiny.Allocate(8ull * 1024, 256);  // 次のブロックは取れないので直接
+			const uint64_t    d = tiny.Allocate(32ull * 1024, 256); // もう入らない
+			ok &= Expect(
+				a == 0 && b == 1024 && c == 48ull * 1024 &&
+				d == UploadSuballocator::kInvalidOffset && tiny.BlockCount() == 1,
+				"cursor falls back to direct allocation near the end"
+			);
+		}
+
+		// 分割
+		{
+			std::vector<DrawBatch> batches(1000, DrawBatch{0, 1});
+			std::vector<DrawRange> ranges;
+			PartitionDrawBatches(batches, 8, 64, ranges);
+			uint32_t next     = 0;
+			bool     covered  = ranges.size() == 8;
+			uint32_t smallest = UINT32_MAX;
+			uint32_t largest  = 0;
+			for (const auto& r : ranges) {
+				covered &= r.firstBatch == next;
+				next += r.batchCount;
+				smallest = std::min(smallest, r.batchCount);
+				largest  = std::max(largest, r.batchCount);
+			}
+			ok &= Expect(covered && next == 1000 && largest - smallest <= 1,
+			             "partition covers batches evenly");
+
+			batches.resize(100);
+			PartitionDrawBatches(batches, 8, 64, ranges);
+			ok &= Expect(ranges.size() == 1 && ranges[0].batchCount == 100,
+			             "small frames stay on one list");
+
+			batches.clear();
+			PartitionDrawBatches(batches, 8, 64, ranges);
+			ok &= Expect(ranges.empty(), "empty frame has no ranges");
+		}
+
+		// 偽のバックエンドで記録: 1スレッドと並列で同じ描画列になるか
+		BenchRandom               random;
+		std::vector<Mat4>         worlds(kMockItems);
+		std::vector<DrawBatchKey> keys(kMockItems);
+		for (uint32_t i = 0; i < kMockItems; ++i) {
+			worlds[i] = Mat4::Translate(
+				Vec3(random.Next(-100.0f, 100.0f), 0.0f, random.Next(-100.0f, 100.0f))
+			);
+			// 小物の並び: 同じメッシュが数個から数十個続く
+			keys[i] = {
+				.mesh      = MakeDrawBatchMesh(i / 24, 1),
+				.material  = i / 96,
+				.pso       = i / 4096,
+				.instanced = (i / 24) % 5 != 0
+			};
+		}
+		std::vector<DrawBatch> batches;
+		BuildDrawBatches(keys, kMockBatchLimit, batches);
+
+		const uint32_t         lanes = jobs.MaxLanes();
+		std::vector<DrawRange> ranges;
+		PartitionDrawBatches(batches, std::max(lanes, 4u), kMockMinBatches, ranges);
+
+		MockUploadMemory serialMemory;
+		serialMemory.bytes.resize(kMockArenaSize);
+		MockUploadMemory parallelMemory;
+		parallelMemory.bytes.resize(kMockArenaSize);
+
+		std::vector<MockDraw>              serial;
+		std::vector<std::vector<MockDraw>> lists(ranges.size());
+		double                             serialMs   = 0.0;
+		double                             parallelMs = 0.0;
+		bool                               recorded   = true;
+		for (uint32_t iter = 0; iter < kMockIterations; ++iter) {
+			serialMemory.allocator.Reset(kMockArenaSize);
+			serial.clear();
+			const auto serialStart = std::chrono::steady_clock::now();
+			{
+				UploadBlockCursor cursor(serialMemory.allocator);
+				recorded &= RecordMock(
+					worlds, batches, {0, static_cast<uint32_t>(batches.size())},
+					serialMemory, cursor, serial
+				);
+			}
+			serialMs += MillisecondsSince(serialStart);
+
+			parallelMemory.allocator.Reset(kMockArenaSize);
+			std::atomic<bool> parallelOk    = true;
+			const auto        parallelStart = std::chrono::steady_clock::now();
+			jobs.ParallelFor(
+				ranges.size(), 1,
+				[&](const size_t begin, const size_t end, uint32_t) {
+					for (size_t r = begin; r < end; ++r) {
+						lists[r].clear();
+						UploadBlockCursor cursor(parallelMemory.allocator);
+						if (!RecordMock(worlds, batches, ranges[r], parallelMemory,
+						                cursor, lists[r])) {
+							parallelOk = false;
+						}
+					}
+				}
+			);
+			parallelMs += MillisecondsSince(parallelStart);
+			recorded &= parallelOk;
+		}
+		ok &= Expect(recorded, "mock recording fits in the arena");
+
+		// 実行: リストを範囲の順につなぐ
+		std::vector<MockDraw> executed;
+		for (const auto& list : lists) {
+			executed.insert(executed.end(), list.begin(), list.end());
+		}
+		bool sameOrder = executed.size() == serial.size();
+		bool sameData  = sameOrder;
+		for (size_t i = 0; sameOrder && i < executed.size(); ++i) {
+			const MockDraw& p = executed[i];
+			const MockDraw& s = serial[i];
+			sameOrder &= p.batch == s.batch && p.count == s.count;
+			sameData &= std::memcmp(
+				parallelMemory.bytes.data() + p.instances,
+				serialMemory.bytes.data() + s.instances,
+				sizeof(Mat4) * p.count
+			) == 0;
+		}
+		ok &= Expect(sameOrder, "parallel lists execute in serial order");
+		ok &= Expect(sameData, "instance data matches serial recording");
+
+		Msg(kChannel,
+		    "Recording {} items in {} batches: serial {:.3f} ms, {} lists on {} lanes {:.3f} ms, arena used {} KB",
+		    kMockItems, batches.size(), serialMs / kMockIterations,
+		    ranges.size(), lanes, parallelMs / kMockIterations,
+		    parallelMemory.allocator.Used() / 1024);
+		return ok;
+	}
+}
@@ -0,0 +1,34 @@
+﻿#pragma once
+#include <cstdint>
+
+namespace Unnamed::RenderBenchmark {
+	// 偽のコンパイラで ShaderCache の動作を確認してログに出します
+	// (メモリ/ディスクのヒット、インクルード変更での再コンパイル、
+	// 定義違いのキー、同じキーを並列に要求した時の重複排除)
+	// @return 全て期待通りならtrue
+	bool RunShaderCache();
+
+	// パイプラインのマニフェストの読み書き(往復・壊れたファイル・古いレコードの破棄)と、
+	// 先行作成のスケジューリング(ワーカーと横取りで各項目がちょうど1回作られるか)を
+	// デバイス無しで確認してログに出します
+	// @return 全て期待通りならtrue
+	bool RunPipelineLibrary();
+
+	// 描画アイテムの収集を、旧実装(1スレッドで全件 + 3キーの比較ソート)と
+	// 新実装(チャンクごとに並列で視錐台カリング + 64bitキーの基数ソート)で比べてログに出します
+	// CPUだけで、count 個のアイテムをカメラの周りにばらまきます
+	// @return 新実装が見えるものを落とさず、キーの順に並んでいればtrue
+	bool RunCollect(uint32_t count);
+
+	// インスタンス描画のまとめ方(連続した同じメッシュ・マテリアル・PSO、
+	// 非対応マテリアル、上限での分割)を確認し、同じ小物を並べたシーンで
+	// 描画回数がどれだけ減るかをログに出します
+	// @return 全て期待通りならtrue
+	bool RunDrawBatching();
+
+	// 並列記録の部品をデバイス無しで確認してログに出します
+	// (アップロード領域の並列の切り出しで重なり・はみ出しが無いか、バッチの分割、
+	// 偽のコマンドリストに範囲ごとに記録して順番通りにつないだ結果が1スレッドと同じか)
+	// @return 全て期待通りならtrue
+	bool RunParallelRecording();
+}
@@ -0,0 +1,68 @@
+﻿#include <pch.h>
+
+//-----------------------------------------------------------------------------
+
+#include "RenderBatching.h"
+
+#include <algorithm>
+
+namespace Unnamed {
+	uint64_t MakeDrawBatchMesh(const uint32_t id, const uint32_t gen) {
+		return static_cast<uint64_t>(gen) << 32 | id;
+	}
+
+	void BuildDrawBatches(
+		const std::span<const DrawBatchKey> keys,
+		const uint32_t                      maxInstances,
+		std::vector<DrawBatch>&             out
+	) {
+		out.clear();
+		if (keys.empty()) {
+			return;
+		}
+
+		const uint32_t limit = std::max(maxInstances, 1u);
+		DrawBatch      batch = {0, 1};
+		for (uint32_t i = 1; i < static_cast<uint32_t>(keys.size()); ++i) {
+			const DrawBatchKey& head = keys[batch.first];
+			const DrawBatchKey& k    = keys[i];
+			if (
+				head.instanced && k.instanced &&
+				k.mesh == head.mesh && k.material == head.material &&
+				k.pso == head.pso && batch.count < limit
+			) {
+				++batch.count;
+				continue;
+			}
+			out.emplace_back(batch);
+			batch = {i, 1};
+		}
+		out.emplace_back(batch);
+	}
+
+	void PartitionDrawBatches(
+		const std::span<const DrawBatch> batches,
+		const uint32_t                   maxRanges,
+		const uint32_t                   minBatchesPerRange,
+		std::vector<DrawRange>&          out
+	) {
+		out.clear();
+		const auto total = static_cast<uint32_t>(batches.size());
+		if (total == 0) {
+			return;
+		}
+
+		const uint32_t byWork = total / std::max(minBatchesPerRange, 1u);
+		const uint32_t ranges = std::clamp(byWork, 1u, std::max(maxRanges, 1u));
+
+		// 余りは先頭の範囲に1つずつ配る
+		const uint32_t base  = total / ranges;
+		const uint32_t extra = total % ranges;
+		uint32_t       first = 0;
+		for (uint32_t i = 0; i < ranges; ++i) {
+			const uint32_t count = base + (i < extra ? 1 : 0);
+			out.emplace_back(DrawRange{first, count});
+			first += count;
+		}
+	}
+}
@@ -0,0 +1,49 @@
+﻿#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Unnamed {
+	// 1回のインスタンス描画にまとめられるかを決める値
+	struct DrawBatchKey {
+		uint64_t mesh        = 0; // MeshHandle の id と世代
+		uint32_t material    = 0;
+		uint32_t pso         = 0;
+		bool     instanced = false; // シェーダーがインスタンスバッファを読むか
+	};
+
+	// 並べ替え済みのアイテムの [first, first + count) を1回で描きます
+	struct DrawBatch {
+		uint32_t first = 0;
+		uint32_t count = 0;
+	};
+
+	// 1つのコマンドリストに記録するバッチの範囲
+	struct DrawRange {
+		uint32_t firstBatch = 0;
+		uint32_t batchCount = 0;
+	};
+
+	[[nodiscard]] uint64_t MakeDrawBatchMesh(uint32_t id, uint32_t gen);
+
+	/// @brief 連続していて、メッシュ・マテリアル・PSO が同じアイテムをまとめます
+	/// @details instanced でないものは1つずつ描きます。
+	/// 並びは変えないので、描画順(ソートキーの順)はそのまま残ります
+	/// @param maxInstances 1バッチのインスタンス数の上限(アップロード1回分の大きさ)
+	void BuildDrawBatches(
+		std::span<const DrawBatchKey> keys,
+		uint32_t                      maxInstances,
+		std::vector<DrawBatch>&       out
+	);
+
+	/// @brief バッチを並列に記録するため、連続した範囲に分けます
+	/// @details 範囲ごとにバッチ数がほぼ同じになるよう分け、順番は保ちます。
+	/// 少なすぎる範囲はコマンドリストを分ける分だけ損なので、
+	/// 範囲数は batches.size() / minBatchesPerRange までに抑えます(最低1つ)
+	void PartitionDrawBatches(
+		std::span<const DrawBatch> batches,
+		uint32_t                   maxRanges,
+		uint32_t                   minBatchesPerRange,
+		std::vector<DrawRange>&    out
+	);
+}
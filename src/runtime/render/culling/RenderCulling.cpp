@@ -0,0 +1,148 @@
+﻿#include <pch.h>
+
+//-----------------------------------------------------------------------------
+
+#include "RenderCulling.h"
+
+#include <array>
+#include <bit>
+#include <cmath>
+
+namespace Unnamed {
+	namespace {
+		constexpr uint32_t kPsoBits      = 16;
+		constexpr uint32_t kMaterialBits = 20;
+		constexpr uint32_t kMeshBits     = 12;
+		constexpr uint32_t kDepthBits    = 16;
+		static_assert(kPsoBits + kMaterialBits + kMeshBits + kDepthBits == 64);
+
+		constexpr uint32_t kRadixBits   = 8;
+		constexpr uint32_t kRadixSize   = 1u << kRadixBits;
+		constexpr uint32_t kRadixPasses = 64 / kRadixBits;
+	}
+
+	Frustum Frustum::FromViewProj(const Mat4& viewProj) {
+		// clip.j = dot(v, 列j)
+		const auto column = [&](const int j, float out[4]) {
+			for (int i = 0; i < 4; ++i) {
+				out[i] = viewProj.m[i][j];
+			}
+		};
+		float c0[4], c1[4], c2[4], c3[4];
+		column(0, c0);
+		column(1, c1);
+		column(2, c2);
+		column(3, c3);
+
+		Frustum f;
+		for (int i = 0; i < 4; ++i) {
+			f.planes[0][i] = c3[i] + c0[i]; // 左
+			f.planes[1][i] = c3[i] - c0[i]; // 右
+			f.planes[2][i] = c3[i] + c1[i]; // 下
+			f.planes[3][i] = c3[i] - c1[i]; // 上
+			f.planes[4][i] = c2[i];         // 近
+			f.planes[5][i] = c3[i] - c2[i]; // 遠
+		}
+		return f;
+	}
+
+	bool Frustum::Intersects(
+		const Vec3& localMin, const Vec3& localMax, const Mat4& world
+	) const {
+		const float lc[3] = {
+			(localMin.x + localMax.x) * 0.5f,
+			(localMin.y + localMax.y) * 0.5f,
+			(localMin.z + localMax.z) * 0.5f
+		};
+		const float le[3] = {
+			(localMax.x - localMin.x) * 0.5f,
+			(localMax.y - localMin.y) * 0.5f,
+			(localMax.z - localMin.z) * 0.5f
+		};
+
+		// 中心は変換し、半径は行列の絶対値で広げる
+		float c[3], e[3];
+		for (int j = 0; j < 3; ++j) {
+			c[j] = world.m[3][j];
+			e[j] = 0.0f;
+			for (int i = 0; i < 3; ++i) {
+				c[j] += lc[i] * world.m[i][j];
+				e[j] += le[i] * std::abs(world.m[i][j]);
+			}
+		}
+
+		for (const auto& p : planes) {
+			const float distance = p[0] * c[0] + p[1] * c[1] + p[2] * c[2] + p[3];
+			const float radius   = std::abs(p[0]) * e[0] + std::abs(p[1]) * e[1] +
+				std::abs(p[2]) * e[2];
+			if (distance + radius < 0.0f) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	uint64_t MakeRenderSortKey(
+		const uint32_t psoId, const uint32_t materialKey, const uint32_t meshId,
+		const float    depthVS
+	) {
+		// 正の浮動小数点数はビット列の大小が値の大小と同じ(符号ビットは0なので捨てる)
+		const float    depth     = depthVS > 0.0f ? depthVS : 0.0f;
+		const uint64_t depthBits = std::bit_cast<uint32_t>(depth) >> (32 - 1 - kDepthBits);
+
+		return static_cast<uint64_t>(psoId & ((1u << kPsoBits) - 1))
+			<< (kMaterialBits + kMeshBits + kDepthBits) |
+			static_cast<uint64_t>(materialKey & ((1u << kMaterialBits) - 1))
+			<< (kMeshBits + kDepthBits) |
+			static_cast<uint64_t>(meshId & ((1u << kMeshBits) - 1))
+			<< kDepthBits |
+			depthBits;
+	}
+
+	void RadixSort(
+		std::vector<RenderSortKey>& keys,
+		std::vector<RenderSortKey>& scratch
+	) {
+		const size_t count = keys.size();
+		scratch.resize(count);
+		if (count < 2) {
+			return;
+		}
+
+		// 全パスのヒストグラムを1回の走査で作る
+		std::array<std::array<uint32_t, kRadixSize>, kRadixPasses> histograms = {};
+		for (const auto& k : keys) {
+			for (uint32_t pass = 0; pass < kRadixPasses; ++pass) {
+				++histograms[pass][(k.key >> (pass * kRadixBits)) & (kRadixSize - 1)];
+			}
+		}
+
+		RenderSortKey* src = keys.data();
+		RenderSortKey* dst = scratch.data();
+		for (uint32_t pass = 0; pass < kRadixPasses; ++pass) {
+			auto& histogram = histograms[pass];
+
+			// 全要素が同じ桁なら並びは変わらない
+			const uint32_t digit = (src[0].key >> (pass * kRadixBits)) & (kRadixSize - 1);
+			if (histogram[digit] == count) {
+				continue;
+			}
+
+			uint32_t offset = 0;
+			for (auto& h : histogram) {
+				const uint32_t n = h;
+				h                = offset;
+				offset += n;
+			}
+			for (size_t i = 0; i < count; ++i) {
+				const uint32_t d = (src[i].key >> (pass * kRadixBits)) & (kRadixSize - 1);
+				dst[histogram[d]++] = src[i];
+			}
+			std::swap(src, dst);
+		}
+
+		if (src != keys.data()) {
+			keys.swap(scratch);
+		}
+	}
+}
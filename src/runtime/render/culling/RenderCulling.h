@@ -0,0 +1,44 @@
+﻿#pragma once
+#include <cstdint>
+#include <vector>
+
+#include <runtime/core/math/Math.h>
+
+namespace Unnamed {
+	/// @brief 視錐台(ワールド空間の6平面)
+	/// @details 平面は ax + by + cz + d >= 0 が内側です
+	struct Frustum {
+		float planes[6][4] = {};
+
+		// 行ベクトル(v * M)の viewProj から作ります(D3Dのクリップ空間 0 <= z <= w)
+		static Frustum FromViewProj(const Mat4& viewProj);
+
+		/// @brief ローカル空間のAABBを world で変換したものが視錐台にかかるか
+		/// @details 変換後のAABBを包むAABBで判定するので、保守的(見えるものは落とさない)です
+		[[nodiscard]] bool Intersects(
+			const Vec3& localMin, const Vec3& localMax, const Mat4& world
+		) const;
+	};
+
+	// 描画順のキー
+	// [63..48] PSO / [47..28] マテリアル / [27..16] メッシュ / [15..0] ビュー空間の深度(手前から)
+	// メッシュを深度より上に置いて、同じメッシュとマテリアルが並ぶ(インスタンス描画にまとまる)ようにしています。
+	// マテリアルとメッシュは下位ビット(スロット番号)なので、まれに別のものと
+	// 同じ値になりますが、描画側で実際のキーを比べるので並びが混ざるだけです
+	struct RenderSortKey {
+		uint64_t key   = 0;
+		uint32_t index = 0; // 並べ替える前の位置
+	};
+
+	[[nodiscard]] uint64_t MakeRenderSortKey(
+		uint32_t psoId, uint32_t materialKey, uint32_t meshId, float depthVS
+	);
+
+	/// @brief キーの昇順に並べます(安定、LSDの基数ソート)
+	/// @details 全要素で同じ桁はパスを飛ばすので、上位が揃っていれば速くなります
+	/// @param scratch 作業用。同じ大きさに揃えます(フレームをまたいで使い回してください)
+	void RadixSort(
+		std::vector<RenderSortKey>& keys,
+		std::vector<RenderSortKey>& scratch
+	);
+}
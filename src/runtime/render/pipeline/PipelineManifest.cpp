@@ -0,0 +1,249 @@
+﻿#include <pch.h>
+
+//-----------------------------------------------------------------------------
+
+#include "PipelineManifest.h"
+
+#include <fstream>
+#include <unordered_set>
+
+namespace Unnamed {
+	namespace {
+		constexpr uint32_t kMagic   = 0x4D4C5055; // "UPLM"
+		constexpr uint32_t kVersion = 1;
+
+		struct Header {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t recordCount;
+			uint32_t blobCount;
+		};
+
+		template <class T>
+		bool ReadPod(std::ifstream& file, T& out) {
+			return static_cast<bool>(
+				file.read(reinterpret_cast<char*>(&out), sizeof(T))
+			);
+		}
+
+		template <class T>
+		void WritePod(std::ofstream& file, const T& value) {
+			file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+		}
+
+		// 壊れたファイルで巨大な確保をしないように
+		constexpr uint64_t kMaxBytes = 256ull * 1024 * 1024;
+
+		// ファイルの残りバイト数。サイズの欄はこれを超えられない
+		uint64_t Remaining(std::ifstream& file, const uint64_t fileSize) {
+			const auto pos = static_cast<uint64_t>(file.tellg());
+			return pos < fileSize ? fileSize - pos : 0;
+		}
+	}
+
+	bool PipelineManifest::Add(Record record) {
+		if (mHashToRecord.contains(record.hash)) {
+			return false;
+		}
+		record.used           = true;
+		record.unusedSessions = 0;
+		mHashToRecord.emplace(record.hash, mRecords.size());
+		mRecords.emplace_back(std::move(record));
+		mDirty = true;
+		return true;
+	}
+
+	void PipelineManifest::MarkUsed(const uint64_t hash) {
+		if (const auto it = mHashToRecord.find(hash); it != mHashToRecord.end()) {
+			mRecords[it->second].used = true;
+		}
+	}
+
+	void PipelineManifest::AddBlob(
+		const uint64_t                 hash,
+		const std::span<const uint8_t> bytes
+	) {
+		if (mBlobs.contains(hash)) {
+			return;
+		}
+		mBlobs.emplace(
+			hash,
+			std::make_shared<const std::vector<uint8_t>>(bytes.begin(), bytes.end())
+		);
+		mDirty = true;
+	}
+
+	bool PipelineManifest::Contains(const uint64_t hash) const {
+		return mHashToRecord.contains(hash);
+	}
+
+	PipelineManifest::Blob PipelineManifest::FindBlob(const uint64_t hash) const {
+		const auto it = mBlobs.find(hash);
+		return it != mBlobs.end() ? it->second : nullptr;
+	}
+
+	void PipelineManifest::Clear() {
+		mRecords.clear();
+		mHashToRecord.clear();
+		mBlobs.clear();
+		mDirty = false;
+	}
+
+	void PipelineManifest::EndSession() {
+		std::vector<Record> kept;
+		kept.reserve(mRecords.size());
+		for (auto& record : mRecords) {
+			const uint32_t unused = record.used ? 0 : record.unusedSessions + 1;
+			mDirty |= unused != record.unusedSessions;
+			if (unused > kMaxUnusedSessions) {
+				mDirty = true;
+				continue;
+			}
+			record.unusedSessions = unused;
+			record.used           = false;
+			kept.emplace_back(std::move(record));
+		}
+
+		mRecords = std::move(kept);
+		mHashToRecord.clear();
+		for (size_t i = 0; i < mRecords.size(); ++i) {
+			mHashToRecord.emplace(mRecords[i].hash, i);
+		}
+	}
+
+	bool PipelineManifest::Load(const std::filesystem::path& path) {
+		Clear();
+
+		std::error_code ec;
+		const uint64_t  fileSize = std::filesystem::file_size(path, ec);
+		std::ifstream   file(path, std::ios::binary);
+		if (ec || !file) {
+			return false;
+		}
+
+		Header header = {};
+		if (!ReadPod(file, header) || header.magic != kMagic ||
+			header.version != kVersion) {
+			return false;
+		}
+
+		for (uint32_t i = 0; i < header.blobCount; ++i) {
+			uint64_t hash = 0;
+			uint64_t size = 0;
+			if (!ReadPod(file, hash) || !ReadPod(file, size) || size > kMaxBytes ||
+				size > Remaining(file, fileSize)) {
+				Clear();
+				return false;
+			}
+			auto bytes = std::make_shared<std::vector<uint8_t>>(size);
+			if (!file.read(reinterpret_cast<char*>(bytes->data()),
+			               static_cast<std::streamsize>(size))) {
+				Clear();
+				return false;
+			}
+			mBlobs.emplace(hash, std::move(bytes));
+		}
+
+		for (uint32_t i = 0; i < header.recordCount; ++i) {
+			Record   record;
+			uint32_t descSize  = 0;
+			uint32_t blobCount = 0;
+			if (!ReadPod(file, record.hash) || !ReadPod(file, record.unusedSessions) ||
+				!ReadPod(file, descSize) || !ReadPod(file, blobCount) ||
+				descSize + uint64_t{ blobCount } * sizeof(uint64_t) >
+				Remaining(file, fileSize)) {
+				Clear();
+				return false;
+			}
+			record.desc.resize(descSize);
+			record.blobs.resize(blobCount);
+			file.read(reinterpret_cast<char*>(record.desc.data()), descSize);
+			file.read(reinterpret_cast<char*>(record.blobs.data()),
+			          static_cast<std::streamsize>(uint64_t{ blobCount } * sizeof(uint64_t)));
+			if (!file) {
+				Clear();
+				return false;
+			}
+
+			// ブロブが欠けているレコードは作れないので捨てる
+			bool complete = true;
+			for (const uint64_t blob : record.blobs) {
+				complete &= mBlobs.contains(blob);
+			}
+			if (complete && !mHashToRecord.contains(record.hash)) {
+				mHashToRecord.emplace(record.hash, mRecords.size());
+				mRecords.emplace_back(std::move(record));
+			}
+		}
+
+		mDirty = false;
+		return true;
+	}
+
+	bool PipelineManifest::Save(const std::filesystem::path& path) {
+		std::unordered_set<uint64_t> referenced;
+		for (const auto& record : mRecords) {
+			referenced.insert(record.blobs.begin(), record.blobs.end());
+		}
+
+		std::error_code ec;
+		if (path.has_parent_path()) {
+			std::filesystem::create_directories(path.parent_path(), ec);
+		}
+
+		auto tmp = path;
+		tmp += ".tmp";
+		{
+			std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+			if (!file) {
+				return false;
+			}
+
+			uint32_t blobCount = 0;
+			for (const uint64_t hash : referenced) {
+				blobCount += mBlobs.contains(hash) ? 1 : 0;
+			}
+
+			WritePod(file, Header{
+				         .magic = kMagic,
+				         .version = kVersion,
+				         .recordCount = static_cast<uint32_t>(mRecords.size()),
+				         .blobCount = blobCount
+			         });
+			for (const auto& [hash, blob] : mBlobs) {
+				if (!referenced.contains(hash)) {
+					continue;
+				}
+				WritePod(file, hash);
+				WritePod(file, static_cast<uint64_t>(blob->size()));
+				file.write(reinterpret_cast<const char*>(blob->data()),
+				           static_cast<std::streamsize>(blob->size()));
+			}
+			for (const auto& record : mRecords) {
+				WritePod(file, record.hash);
+				WritePod(file, record.unusedSessions);
+				WritePod(file, static_cast<uint32_t>(record.desc.size()));
+				WritePod(file, static_cast<uint32_t>(record.blobs.size()));
+				file.write(reinterpret_cast<const char*>(record.desc.data()),
+				           static_cast<std::streamsize>(record.desc.size()));
+				file.write(reinterpret_cast<const char*>(record.blobs.data()),
+				           static_cast<std::streamsize>(
+					           record.blobs.size() * sizeof(uint64_t)
+				           ));
+			}
+			if (!file) {
+				file.close();
+				std::filesystem::remove(tmp, ec);
+				return false;
+			}
+		}
+
+		std::filesystem::rename(tmp, path, ec);
+		if (ec) {
+			std::filesystem::remove(tmp, ec);
+			return false;
+		}
+		mDirty = false;
+		return true;
+	}
+}
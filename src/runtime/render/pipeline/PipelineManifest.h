@@ -0,0 +1,66 @@
+﻿#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace Unnamed {
+	/// @class PipelineManifest
+	/// @brief セッション中に作ったパイプラインの記録(ディスクに保存して次回起動時に先に作る)
+	/// @details レコードの中身(ステートのシリアライズ結果)は UPipelineCache が決めるので、
+	/// ここではハッシュ・バイト列・参照するブロブ(シェーダーのバイトコード)を
+	/// そのまま持つだけです。デバイス無しで読み書きできます。
+	/// シェーダーを書き換えると古いレコードは二度と使われないので、
+	/// kMaxUnusedSessions 回続けて使われなかったレコードは EndSession で捨てます
+	class PipelineManifest {
+	public:
+		static constexpr uint32_t kMaxUnusedSessions = 8;
+
+		using Blob = std::shared_ptr<const std::vector<uint8_t>>;
+
+		struct Record {
+			uint64_t              hash = 0; // PipelineDesc のハッシュ
+			std::vector<uint8_t>  desc;     // シリアライズしたステート
+			std::vector<uint64_t> blobs;    // 参照するブロブのハッシュ
+
+			uint32_t unusedSessions = 0;     // 続けて使われなかったセッション数
+			bool     used           = false; // このセッションで使ったか(保存しない)
+		};
+
+		// 既にあれば何もせずfalse。追加したものは使用済みになります
+		bool Add(Record record);
+		void MarkUsed(uint64_t hash);
+		void AddBlob(uint64_t hash, std::span<const uint8_t> bytes);
+
+		[[nodiscard]] bool Contains(uint64_t hash) const;
+		[[nodiscard]] Blob FindBlob(uint64_t hash) const;
+
+		// 初めて見た順(次回起動時もこの順に作ります)
+		[[nodiscard]] const std::vector<Record>& Records() const { return mRecords; }
+		[[nodiscard]] size_t BlobCount() const { return mBlobs.size(); }
+
+		// 最後に読み書きしてから追加されたか
+		[[nodiscard]] bool IsDirty() const { return mDirty; }
+
+		void Clear();
+
+		/// @brief セッションの終わりに呼びます
+		/// @details 使われなかったレコードの数を数え、上限を超えたものを捨てます
+		void EndSession();
+
+		/// @brief 読み込みます。形式やバージョンが違えば空のままfalse
+		bool Load(const std::filesystem::path& path);
+
+		/// @brief 一時ファイルに書いてから置き換えます
+		/// @details 参照されていないブロブは書きません
+		bool Save(const std::filesystem::path& path);
+
+	private:
+		std::vector<Record>                  mRecords;
+		std::unordered_map<uint64_t, size_t> mHashToRecord;
+		std::unordered_map<uint64_t, Blob>   mBlobs;
+		bool                                 mDirty = false;
+	};
+}
@@ -0,0 +1,135 @@
+﻿#include <pch.h>
+
+//-----------------------------------------------------------------------------
+
+#include "PipelinePrecompiler.h"
+
+#include <algorithm>
+
+#include <core/jobsystem/JobSystem.h>
+
+namespace Unnamed {
+	PipelinePrecompiler::PipelinePrecompiler(
+		const size_t count,
+		CreateFn     create
+	) : mCount(count),
+	    mCreate(std::move(create)),
+	    mStates(std::make_unique<std::atomic<PRECOMPILE_STATE>[]>(count)) {
+		for (size_t i = 0; i < count; ++i) {
+			mStates[i].store(PRECOMPILE_STATE::PENDING, std::memory_order_relaxed);
+		}
+	}
+
+	PipelinePrecompiler::~PipelinePrecompiler() {
+		// ジョブが this を触らなくなるまで待つ
+		Cancel();
+		WaitWorkers();
+	}
+
+	void PipelinePrecompiler::Start(JobSystem& jobSystem, uint32_t maxJobs) {
+		if (maxJobs == 0) {
+			// 他の ParallelFor を止めないよう、全部は使わない
+			maxJobs = std::max(1u, jobSystem.WorkerCount() / 2);
+		}
+		const auto jobs = static_cast<uint32_t>(
+			std::min<size_t>(maxJobs, mCount)
+		);
+		{
+			std::lock_guard lock(mRunningMutex);
+			mRunning += jobs;
+		}
+		for (uint32_t i = 0; i < jobs; ++i) {
+			jobSystem.Submit([this] { WorkerLoop(); });
+		}
+	}
+
+	bool PipelinePrecompiler::Acquire(const size_t index) {
+		if (index >= mCount) {
+			return false;
+		}
+
+		if (TryCreate(index, false)) {
+			return mStates[index].load() == PRECOMPILE_STATE::DONE;
+		}
+
+		PRECOMPILE_STATE state = mStates[index].load(std::memory_order_acquire);
+		if (state == PRECOMPILE_STATE::CREATING) {
+			++mWaited;
+			while (state == PRECOMPILE_STATE::CREATING) {
+				mStates[index].wait(state);
+				state = mStates[index].load(std::memory_order_acquire);
+			}
+		}
+		return state == PRECOMPILE_STATE::DONE;
+	}
+
+	void PipelinePrecompiler::Cancel() {
+		mCancelled.store(true);
+	}
+
+	void PipelinePrecompiler::Wait() {
+		WaitWorkers();
+		// キャンセルで取り残されたものはここで作り、呼び出し元で作成中のものは待つ
+		for (size_t i = 0; i < mCount; ++i) {
+			Acquire(i);
+		}
+	}
+
+	PRECOMPILE_STATE PipelinePrecompiler::State(const size_t index) const {
+		return mStates[index].load(std::memory_order_acquire);
+	}
+
+	PipelinePrecompiler::Stats PipelinePrecompiler::GetStats() const {
+		return {
+			.byWorkers = mByWorkers.load(),
+			.byCaller = mByCaller.load(),
+			.waited = mWaited.load(),
+			.failed = mFailed.load()
+		};
+	}
+
+	void PipelinePrecompiler::WorkerLoop() {
+		while (!mCancelled.load(std::memory_order_relaxed)) {
+			const size_t index = mCursor.fetch_add(1);
+			if (index >= mCount) {
+				break;
+			}
+			// 横取りされていたら次へ
+			TryCreate(index, true);
+		}
+
+		// 待っている側はロックを取るまで this を壊せないので、通知までロックの中で行う
+		std::lock_guard lock(mRunningMutex);
+		if (--mRunning == 0) {
+			mRunningCv.notify_all();
+		}
+	}
+
+	void PipelinePrecompiler::WaitWorkers() {
+		std::unique_lock lock(mRunningMutex);
+		mRunningCv.wait(lock, [this] { return mRunning == 0; });
+	}
+
+	bool PipelinePrecompiler::TryCreate(const size_t index, const bool onWorker) {
+		PRECOMPILE_STATE expected = PRECOMPILE_STATE::PENDING;
+		if (!mStates[index].compare_exchange_strong(
+			expected, PRECOMPILE_STATE::CREATING, std::memory_order_acq_rel
+		)) {
+			return false;
+		}
+
+		const bool ok = mCreate(index);
+		++(onWorker ? mByWorkers : mByCaller);
+		if (!ok) {
+			++mFailed;
+		}
+
+		mStates[index].store(
+			ok ? PRECOMPILE_STATE::DONE : PRECOMPILE_STATE::FAILED,
+			std::memory_order_release
+		);
+		mStates[index].notify_all();
+		++mFinished;
+		return true;
+	}
+}
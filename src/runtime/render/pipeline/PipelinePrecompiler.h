@@ -0,0 +1,90 @@
+﻿#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+class JobSystem;
+
+namespace Unnamed {
+	enum class PRECOMPILE_STATE : uint8_t {
+		PENDING,  // まだ誰も手を付けていない
+		CREATING, // どこかのスレッドが作成中
+		DONE,
+		FAILED,
+	};
+
+	/// @class PipelinePrecompiler
+	/// @brief 起動時にパイプラインをワーカーで先に作るスケジューラー
+	/// @details 先頭から順にワーカーが取っていきます。描画側が Acquire で
+	/// まだ誰も手を付けていないものを要求したらその場で作り(横取り)、
+	/// 作成中なら終わるまで待ちます。どの項目も作成は1回だけです
+	class PipelinePrecompiler {
+	public:
+		// index 番目を作ります。ワーカーと呼び出し元のどちらからも呼ばれます
+		using CreateFn = std::function<bool(size_t index)>;
+
+		struct Stats {
+			uint32_t byWorkers = 0; // ワーカーが作った数
+			uint32_t byCaller  = 0; // Acquire の呼び出し元で作った数
+			uint32_t waited    = 0; // 作成中で待った回数
+			uint32_t failed    = 0;
+		};
+
+		PipelinePrecompiler(size_t count, CreateFn create);
+		~PipelinePrecompiler();
+
+		PipelinePrecompiler(const PipelinePrecompiler&)            = delete;
+		PipelinePrecompiler& operator=(const PipelinePrecompiler&) = delete;
+
+		/// @brief ワーカーに積みます
+		/// @param maxJobs 同時に使うワーカー数の上限。0ならワーカー数の半分
+		void Start(JobSystem& jobSystem, uint32_t maxJobs = 0);
+
+		/// @brief index 番目を使えるようにします
+		/// @return 作成に成功していればtrue
+		bool Acquire(size_t index);
+
+		// 残りをワーカーに取らせないようにします(Acquire はその場で作ります)
+		void Cancel();
+
+		// 全項目が終わるまで待ちます(ワーカーが取らなかったものは呼び出し元で作ります)
+		void Wait();
+
+		[[nodiscard]] size_t           Count() const { return mCount; }
+		[[nodiscard]] size_t           Finished() const { return mFinished.load(); }
+		[[nodiscard]] PRECOMPILE_STATE State(size_t index) const;
+		[[nodiscard]] Stats            GetStats() const;
+
+	private:
+		void WorkerLoop();
+
+		// ワーカーのジョブが全て抜けるまで待ちます
+		void WaitWorkers();
+
+		// PENDING → CREATING を取れたら作って結果を書きます
+		bool TryCreate(size_t index, bool onWorker);
+
+	private:
+		size_t   mCount = 0;
+		CreateFn mCreate;
+
+		std::unique_ptr<std::atomic<PRECOMPILE_STATE>[]> mStates;
+
+		std::atomic<size_t>   mCursor    = 0; // ワーカーが次に見る位置
+		std::atomic<size_t>   mFinished  = 0;
+		std::atomic<bool>     mCancelled = false;
+
+		// 走っているワーカーのジョブ。終了の通知後に this を触らないよう mutex で守る
+		std::mutex              mRunningMutex;
+		std::condition_variable mRunningCv;
+		uint32_t                mRunning = 0;
+
+		std::atomic<uint32_t> mByWorkers = 0;
+		std::atomic<uint32_t> mByCaller  = 0;
+		std::atomic<uint32_t> mWaited    = 0;
+		std::atomic<uint32_t> mFailed    = 0;
+	};
+}
@@ -2,30 +2,297 @@
 
 #include "UPipelineCache.h"
 
+#include <chrono>
+#include <cstring>
+#include <span>
+
+#include <core/jobsystem/JobSystem.h>
+
 #include "engine/urenderer/GraphicsDevice.h"
 #include "engine/urootsignaturecache/RootSignatureDebugDump.h"
 
+#include "runtime/render/pipeline/PipelinePrecompiler.h"
 #include "runtime/render/resources/DebugDumpShader.h"
 
 namespace Unnamed {
-	static void HashCombine(size_t& h, const size_t v) {
-		h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
-	}
+	constexpr std::string_view kChannel = "UPipelineCache";
 
-	static size_t MemHash(const void* p, size_t n) {
-		const uint8_t* s = static_cast<const uint8_t*>(p);
-		size_t         h = 14695981039346656037ULL;
-		for (size_t i = 0; i < n; ++i) {
-			h ^= s[i];
-			h *= 1099511628211ULL;
+	namespace {
+		// 記述のエンコードを変えたら上げる(古いレコードは読み捨てます)
+		constexpr uint32_t kStateVersion = 1;
+		constexpr size_t   kMaxCount     = 4096;
+
+		uint64_t Fnv1a64(const void* data, const size_t size,
+		                 uint64_t    h = 0xcbf29ce484222325ULL) {
+			const auto* p = static_cast<const uint8_t*>(data);
+			for (size_t i = 0; i < size; ++i) {
+				h ^= p[i];
+				h *= 0x100000001b3ULL;
+			}
+			return h;
+		}
+
+		class StateWriter {
+		public:
+			static constexpr bool kReading = false;
+
+			template <class T>
+			void operator()(const T& value) {
+				static_assert(std::is_trivially_copyable_v<T>);
+				const auto* p = reinterpret_cast<const uint8_t*>(&value);
+				bytes.insert(bytes.end(), p, p + sizeof(T));
+			}
+
+			void Count(size_t& count) {
+				(*this)(static_cast<uint32_t>(count));
+			}
+
+			void String(std::string& s) {
+				size_t size = s.size();
+				Count(size);
+				bytes.insert(bytes.end(), s.begin(), s.end());
+			}
+
+			std::vector<uint8_t> bytes;
+		};
+
+		class StateReader {
+		public:
+			static constexpr bool kReading = true;
+
+			explicit StateReader(const std::vector<uint8_t>& bytes)
+				: mBytes(bytes) {
+			}
+
+			template <class T>
+			void operator()(T& value) {
+				static_assert(std::is_trivially_copyable_v<T>);
+				if (!Take(sizeof(T))) {
+					return;
+				}
+				std::memcpy(&value, mBytes.data() + mOffset - sizeof(T), sizeof(T));
+			}
+
+			void Count(size_t& count) {
+				uint32_t value = 0;
+				(*this)(value);
+				if (value > kMaxCount) {
+					ok = false;
+					value = 0;
+				}
+				count = value;
+			}
+
+			void String(std::string& s) {
+				size_t size = 0;
+				Count(size);
+				if (!Take(size)) {
+					return;
+				}
+				s.assign(
+					reinterpret_cast<const char*>(mBytes.data()) + mOffset - size,
+					size
+				);
+			}
+
+			[[nodiscard]] bool AtEnd() const { return mOffset == mBytes.size(); }
+
+			bool ok = true;
+
+		private:
+			bool Take(const size_t size) {
+				if (!ok || mBytes.size() - mOffset < size) {
+					ok = false;
+					return false;
+				}
+				mOffset += size;
+				return true;
+			}
+
+			const std::vector<uint8_t>& mBytes;
+			size_t                      mOffset = 0;
+		};
+
+		// 読み書きで同じ順序になるよう、両方をこの関数で行います
+		// パディングを含めないよう、構造体はメンバーごとに並べます
+		template <class Ar>
+		void SerializeState(
+			Ar&                       ar,
+			PipelineDesc&             desc,
+			std::vector<std::string>& semantics,
+			RootSignatureDesc&        rs
+		) {
+			uint32_t version = kStateVersion;
+			ar(version);
+			if (version != kStateVersion) {
+				if constexpr (Ar::kReading) {
+					ar.ok = false;
+				}
+				return;
+			}
+
+			ar(desc.numRt);
+			if (desc.numRt > 8) {
+				if constexpr (Ar::kReading) {
+					ar.ok = false;
+				}
+				return;
+			}
+			for (UINT i = 0; i < desc.numRt; ++i) {
+				ar(desc.rtv[i]);
+			}
+			ar(desc.dsv);
+			ar(desc.topology);
+			ar(desc.sample.Count);
+			ar(desc.sample.Quality);
+
+			auto& blend = desc.blend;
+			ar(blend.AlphaToCoverageEnable);
+			ar(blend.IndependentBlendEnable);
+			for (auto& rt : blend.RenderTarget) {
+				ar(rt.BlendEnable);
+				ar(rt.LogicOpEnable);
+				ar(rt.SrcBlend);
+				ar(rt.DestBlend);
+				ar(rt.BlendOp);
+				ar(rt.SrcBlendAlpha);
+				ar(rt.DestBlendAlpha);
+				ar(rt.BlendOpAlpha);
+				ar(rt.LogicOp);
+				ar(rt.RenderTargetWriteMask);
+			}
+
+			auto& raster = desc.rasterizer;
+			ar(raster.FillMode);
+			ar(raster.CullMode);
+			ar(raster.FrontCounterClockwise);
+			ar(raster.DepthBias);
+			ar(raster.DepthBiasClamp);
+			ar(raster.SlopeScaledDepthBias);
+			ar(raster.DepthClipEnable);
+			ar(raster.MultisampleEnable);
+			ar(raster.AntialiasedLineEnable);
+			ar(raster.ForcedSampleCount);
+			ar(raster.ConservativeRaster);
+
+			auto& depth = desc.depth;
+			ar(depth.DepthEnable);
+			ar(depth.DepthWriteMask);
+			ar(depth.DepthFunc);
+			ar(depth.StencilEnable);
+			ar(depth.StencilReadMask);
+			ar(depth.StencilWriteMask);
+			for (auto* face : {&depth.FrontFace, &depth.BackFace}) {
+				ar(face->StencilFailOp);
+				ar(face->StencilDepthFailOp);
+				ar(face->StencilPassOp);
+				ar(face->StencilFunc);
+			}
+
+			size_t inputCount = desc.inputLayout.size();
+			ar.Count(inputCount);
+			desc.inputLayout.resize(inputCount);
+			semantics.resize(inputCount);
+			for (size_t i = 0; i < inputCount; ++i) {
+				auto& e = desc.inputLayout[i];
+				if constexpr (!Ar::kReading) {
+					semantics[i] = e.semantic ? e.semantic : "";
+				}
+				ar.String(semantics[i]);
+				ar(e.index);
+				ar(e.format);
+				ar(e.offset);
+			}
+
+			// ルートシグネチャ(ハンドルは実行ごとに変わるので記述を持つ)
+			ar(rs.flags);
+			size_t paramCount = rs.params.size();
+			ar.Count(paramCount);
+			rs.params.resize(paramCount);
+			for (auto& param : rs.params) {
+				ar(param.kind);
+				ar(param.cbvRegister);
+				ar(param.cbvSpace);
+				ar(param.num32Bit);
+				ar(param.constRegister);
+				ar(param.constSpace);
+				size_t rangeCount = param.ranges.size();
+				ar.Count(rangeCount);
+				param.ranges.resize(rangeCount);
+				for (auto& range : param.ranges) {
+					ar(range.type);
+					ar(range.baseRegister);
+					ar(range.count);
+					ar(range.space);
+				}
+			}
+			size_t samplerCount = rs.staticSamplers.size();
+			ar.Count(samplerCount);
+			rs.staticSamplers.resize(samplerCount);
+			for (auto& sampler : rs.staticSamplers) {
+				ar(sampler.reg);
+				ar(sampler.space);
+				ar(sampler.desc.Filter);
+				ar(sampler.desc.AddressU);
+				ar(sampler.desc.AddressV);
+				ar(sampler.desc.AddressW);
+				ar(sampler.desc.MipLODBias);
+				ar(sampler.desc.MaxAnisotropy);
+				ar(sampler.desc.ComparisonFunc);
+				for (auto& c : sampler.desc.BorderColor) {
+					ar(c);
+				}
+				ar(sampler.desc.MinLOD);
+				ar(sampler.desc.MaxLOD);
+			}
+		}
+
+		double MillisecondsSince(
+			const std::chrono::steady_clock::time_point start
+		) {
+			return std::chrono::duration<double, std::milli>(
+				std::chrono::steady_clock::now() - start
+			).count();
 		}
-		return h;
 	}
 
 	UPipelineCache::UPipelineCache(
-		GraphicsDevice* graphicsDevice, RootSignatureCache* rootSignatureCache
+		GraphicsDevice*       graphicsDevice,
+		RootSignatureCache*   rootSignatureCache,
+		std::filesystem::path manifestPath
 	) : mGraphicsDevice(graphicsDevice),
-	    mRootSignatureCache(rootSignatureCache) {
+	    mRootSignatureCache(rootSignatureCache),
+	    mManifestPath(std::move(manifestPath)) {
+		if (!mManifestPath.empty() && mManifest.Load(mManifestPath)) {
+			DevMsg(
+				kChannel,
+				"Loaded pipeline manifest: {} pipelines, {} shaders",
+				mManifest.Records().size(), mManifest.BlobCount()
+			);
+		}
+	}
+
+	UPipelineCache::~UPipelineCache() {
+		const PipelineCacheStats stats = Stats();
+
+		// ワーカーが mPrepared を触らなくなってから片付ける
+		mPrecompiler.reset();
+
+		Msg(
+			kChannel,
+			"hits {}, precompiled hits {}, misses {} ({:.2f} ms, max {:.2f} ms), precompiled {}/{} ({:.2f} ms on workers)",
+			stats.hits, stats.precompiledHits, stats.misses, stats.missMs,
+			stats.missMaxMs, stats.precompiled,
+			stats.precompiled + stats.failed + stats.pending, stats.precompileMs
+		);
+
+		if (!mManifestPath.empty()) {
+			mManifest.EndSession();
+			if (mManifest.IsDirty() && !SaveManifest()) {
+				Warning(kChannel, "Failed to save pipeline manifest: {}",
+				        mManifestPath.string());
+			}
+		}
 	}
 
 	PsoHandle UPipelineCache::GetOrCreate(const PipelineDesc& desc) {
@@ -33,77 +300,68 @@ namespace Unnamed {
 			return {};
 		}
 
-		const size_t hash = Hash(desc);
+		const std::vector<uint8_t> encoded = Encode(desc);
+		const uint64_t             hash    = Hash(
+			encoded, desc.vs->hash, desc.ps->hash
+		);
 		if (const auto it = mHashToIndex.find(hash); it != mHashToIndex.end()) {
+			++mHits;
 			return PsoHandle{it->second};
 		}
 
-		std::vector<D3D12_INPUT_ELEMENT_DESC> ild;
-		ild.reserve(desc.inputLayout.size());
-		for (auto& e : desc.inputLayout) {
-			D3D12_INPUT_ELEMENT_DESC ie = {};
-			ie.SemanticName = e.semantic;
-			ie.SemanticIndex = e.index;
-			ie.Format = e.format;
-			ie.InputSlot = 0;
-			ie.AlignedByteOffset = e.offset;
-			ie.InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
-			ie.InstanceDataStepRate = 0;
-			ild.emplace_back(ie);
+		// 起動時に作り始めたもの(作成中なら待ち、未着手ならここで作る)
+		if (const auto it = mPreparedIndex.find(hash);
+			mPrecompiler && it != mPreparedIndex.end()) {
+			const uint32_t index = it->second;
+			mPreparedIndex.erase(it);
+			if (mPrecompiler->Acquire(index) && mPrepared[index].pso) {
+				++mPrecompiledHits;
+				mManifest.MarkUsed(hash);
+				return Insert(hash, std::move(mPrepared[index].pso));
+			}
+			// 作れなかったら下でもう一度作ってエラーを出す
 		}
 
-		D3D12_GRAPHICS_PIPELINE_STATE_DESC pso = {};
-		pso.pRootSignature = mRootSignatureCache->Get(desc.rootSignature);
-		pso.VS = {
+		const D3D12_SHADER_BYTECODE vsCode = {
 			.pShaderBytecode = desc.vs->blob->GetBufferPointer(),
 			.BytecodeLength = desc.vs->blob->GetBufferSize()
 		};
-		pso.PS = {
+		const D3D12_SHADER_BYTECODE psCode = {
 			.pShaderBytecode = desc.ps->blob->GetBufferPointer(),
 			.BytecodeLength = desc.ps->blob->GetBufferSize()
 		};
-		//pso.GS                         = {desc.gs->GetBufferPointer(), desc.gs->GetBufferSize()};
-		pso.BlendState            = desc.blend;
-		pso.RasterizerState       = desc.rasterizer;
-		pso.DepthStencilState     = desc.depth;
-		pso.SampleMask            = UINT_MAX;
-		pso.InputLayout           = {ild.data(), static_cast<UINT>(ild.size())};
-		pso.IBStripCutValue       = D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_DISABLED;
-		pso.PrimitiveTopologyType = desc.topology;
-		pso.NumRenderTargets      = desc.numRt;
-		for (UINT i = 0; i < desc.numRt; ++i) {
-			pso.RTVFormats[i] = desc.rtv[i];
-		}
-		pso.DSVFormat  = desc.dsv;
-		pso.SampleDesc = desc.sample;
 
 #ifdef _DEBUG
 		auto& rsDesc = mRootSignatureCache->GetDesc(desc.rootSignature);
 		DumpRootSignatureDesc(rsDesc, "RS before PSO");
-		DumpShaderResources(pso.VS, "VS");
-		ValidateRSvsShader(rsDesc, pso.VS, D3D12_SHADER_VISIBILITY_VERTEX,
+		DumpShaderResources(vsCode, "VS");
+		ValidateRSvsShader(rsDesc, vsCode, D3D12_SHADER_VISIBILITY_VERTEX,
 		                   "VS");
-		if (pso.PS.pShaderBytecode) {
-			DumpShaderResources(pso.PS, "PS");
-			ValidateRSvsShader(rsDesc, pso.PS, D3D12_SHADER_VISIBILITY_PIXEL,
+		if (psCode.pShaderBytecode) {
+			DumpShaderResources(psCode, "PS");
+			ValidateRSvsShader(rsDesc, psCode, D3D12_SHADER_VISIBILITY_PIXEL,
 			                   "PS");
 		}
 #endif
 
+		const auto start = std::chrono::steady_clock::now();
+
 		Microsoft::WRL::ComPtr<ID3D12PipelineState> psoObj;
-		THROW(
-			mGraphicsDevice->Device()->CreateGraphicsPipelineState(
-				&pso, IID_PPV_ARGS(&psoObj)
-			)
+		const HRESULT                               hr = CreatePso(
+			mGraphicsDevice->Device(),
+			mRootSignatureCache->Get(desc.rootSignature),
+			desc, vsCode, psCode, psoObj
 		);
+		THROW(hr);
 
-		Entry entry    = {};
-		entry.hash     = hash;
-		entry.pso      = std::move(psoObj);
-		uint32_t index = static_cast<uint32_t>(mEntries.size());
-		mEntries.emplace_back(std::move(entry));
-		mHashToIndex[hash] = index;
-		return PsoHandle{index};
+		const double ms = MillisecondsSince(start);
+		++mMisses;
+		mMissMs += ms;
+		mMissMaxMs = std::max(mMissMaxMs, ms);
+		DevMsg(kChannel, "Created PSO on demand in {:.2f} ms", ms);
+
+		Record(hash, encoded, desc);
+		return Insert(hash, std::move(psoObj));
 	}
 
 	ID3D12PipelineState* UPipelineCache::Get(const PsoHandle handle) const {
@@ -113,56 +371,203 @@ namespace Unnamed {
 		return mEntries[handle.id].pso.Get();
 	}
 
-	size_t UPipelineCache::Hash(const PipelineDesc& desc) {
-		constexpr std::hash<uint64_t>    hashInt;
-		constexpr std::hash<std::string> hashString;
-		size_t                           h = hashInt(desc.rootSignature.id);
-		for (UINT i = 0; i < desc.numRt; ++i) {
-			HashCombine(h, hashInt(static_cast<uint64_t>(desc.rtv[i])));
+	void UPipelineCache::Precompile() {
+		if (mPrecompiler || mManifest.Records().empty()) {
+			return;
 		}
 
-		HashCombine(h, hashInt(desc.dsv));
-		HashCombine(h, hashInt(desc.topology));
-		HashCombine(h, hashInt(desc.sample.Count));
-		HashCombine(h, hashInt(desc.sample.Quality));
+		// ルートシグネチャはキャッシュがスレッドセーフではないのでここで作る
+		const auto& records = mManifest.Records();
+		mPrepared.reserve(records.size());
+		for (const auto& record : records) {
+			if (record.blobs.size() != 2) {
+				continue;
+			}
 
-		// State
-		HashCombine(h, MemHash(&desc.blend, sizeof(desc.blend)));
-		HashCombine(h, MemHash(&desc.rasterizer, sizeof(desc.rasterizer)));
-		HashCombine(h, MemHash(&desc.depth, sizeof(desc.depth)));
+			Prepared          prepared;
+			RootSignatureDesc rs;
+			StateReader       reader(record.desc);
+			SerializeState(reader, prepared.desc, prepared.semantics, rs);
+			if (!reader.ok || !reader.AtEnd()) {
+				continue;
+			}
 
-		// InputLayout
-		for (auto& e : desc.inputLayout) {
-			HashCombine(h, hashString(e.semantic ? e.semantic : ""));
-			HashCombine(h, hashInt(e.index));
-			HashCombine(h, hashInt(static_cast<uint64_t>(e.format)));
-			HashCombine(h, hashInt(e.offset));
-		}
-
-		// Shader
-		if (desc.vs && desc.vs->blob) {
-			HashCombine(h, hashInt(desc.vs->blob->GetBufferSize()));
-			HashCombine(
-				h,
-				hashInt(
-					reinterpret_cast<uintptr_t>(
-						desc.vs->blob->GetBufferPointer()
-					)
-				)
+			const RootSignatureHandle root = mRootSignatureCache->GetOrCreate(rs);
+			prepared.hash                  = record.hash;
+			prepared.rootSignature         = mRootSignatureCache->Get(root);
+			prepared.desc.rootSignature    = root;
+			prepared.vs                    = mManifest.FindBlob(record.blobs[0]);
+			prepared.ps                    = mManifest.FindBlob(record.blobs[1]);
+			if (!prepared.rootSignature || !prepared.vs || !prepared.ps) {
+				continue;
+			}
+
+			mPreparedIndex.emplace(
+				prepared.hash, static_cast<uint32_t>(mPrepared.size())
 			);
+			mPrepared.emplace_back(std::move(prepared));
+		}
+
+		// 移動し終えてから文字列を指す
+		for (auto& prepared : mPrepared) {
+			for (size_t i = 0; i < prepared.semantics.size(); ++i) {
+				prepared.desc.inputLayout[i].semantic =
+					prepared.semantics[i].c_str();
+			}
+		}
+
+		ID3D12Device* device = mGraphicsDevice->Device();
+		mPrecompiler         = std::make_unique<PipelinePrecompiler>(
+			mPrepared.size(),
+			[this, device](const size_t index) {
+				Prepared&  prepared = mPrepared[index];
+				const auto start    = std::chrono::steady_clock::now();
+
+				const HRESULT hr = CreatePso(
+					device, prepared.rootSignature, prepared.desc,
+					{prepared.vs->data(), prepared.vs->size()},
+					{prepared.ps->data(), prepared.ps->size()},
+					prepared.pso
+				);
+
+				mPrecompileMicros += static_cast<uint64_t>(
+					MillisecondsSince(start) * 1000.0
+				);
+				return SUCCEEDED(hr);
+			}
+		);
+		mPrecompiler->Start(JobSystem::Get());
+
+		Msg(kChannel, "Precompiling {} pipelines", mPrepared.size());
+	}
+
+	bool UPipelineCache::SaveManifest() {
+		if (mManifestPath.empty()) {
+			return false;
 		}
-		if (desc.ps && desc.ps->blob) {
-			HashCombine(h, hashInt(desc.ps->blob->GetBufferSize()));
-			HashCombine(
-				h,
-				hashInt(
-					reinterpret_cast<uintptr_t>(
-						desc.ps->blob->GetBufferPointer()
-					)
-				)
+		return mManifest.Save(mManifestPath);
+	}
+
+	PipelineCacheStats UPipelineCache::Stats() const {
+		PipelineCacheStats stats;
+		stats.hits            = mHits;
+		stats.precompiledHits = mPrecompiledHits;
+		stats.misses          = mMisses;
+		stats.missMs          = mMissMs;
+		stats.missMaxMs       = mMissMaxMs;
+		stats.precompileMs    = static_cast<double>(mPrecompileMicros.load()) /
+			1000.0;
+		if (mPrecompiler) {
+			const auto p      = mPrecompiler->GetStats();
+			stats.precompiled = p.byWorkers + p.byCaller - p.failed;
+			stats.failed      = p.failed;
+			stats.pending     = static_cast<uint32_t>(
+				mPrecompiler->Count() - mPrecompiler->Finished()
 			);
 		}
+		return stats;
+	}
 
-		return h;
+	std::vector<uint8_t> UPipelineCache::Encode(const PipelineDesc& desc) const {
+		PipelineDesc             copy = desc;
+		std::vector<std::string> semantics;
+		RootSignatureDesc        rs = mRootSignatureCache->GetSourceDesc(
+			desc.rootSignature
+		);
+		StateWriter writer;
+		SerializeState(writer, copy, semantics, rs);
+		return std::move(writer.bytes);
+	}
+
+	uint64_t UPipelineCache::Hash(
+		const std::vector<uint8_t>& encoded,
+		const uint64_t              vsHash,
+		const uint64_t              psHash
+	) {
+		uint64_t h = Fnv1a64(encoded.data(), encoded.size());
+		h          = Fnv1a64(&vsHash, sizeof(vsHash), h);
+		return Fnv1a64(&psHash, sizeof(psHash), h);
+	}
+
+	HRESULT UPipelineCache::CreatePso(
+		ID3D12Device*                                device,
+		ID3D12RootSignature*                         rootSignature,
+		const PipelineDesc&                          desc,
+		const D3D12_SHADER_BYTECODE                  vs,
+		const D3D12_SHADER_BYTECODE                  ps,
+		Microsoft::WRL::ComPtr<ID3D12PipelineState>& outPso
+	) {
+		std::vector<D3D12_INPUT_ELEMENT_DESC> ild;
+		ild.reserve(desc.inputLayout.size());
+		for (auto& e : desc.inputLayout) {
+			D3D12_INPUT_ELEMENT_DESC ie = {};
+			ie.SemanticName = e.semantic;
+			ie.SemanticIndex = e.index;
+			ie.Format = e.format;
+			ie.InputSlot = 0;
+			ie.AlignedByteOffset = e.offset;
+			ie.InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
+			ie.InstanceDataStepRate = 0;
+			ild.emplace_back(ie);
+		}
+
+		D3D12_GRAPHICS_PIPELINE_STATE_DESC pso = {};
+		pso.pRootSignature = rootSignature;
+		pso.VS             = vs;
+		pso.PS             = ps;
+		//pso.GS                         = {desc.gs->GetBufferPointer(), desc.gs->GetBufferSize()};
+		pso.BlendState            = desc.blend;
+		pso.RasterizerState       = desc.rasterizer;
+		pso.DepthStencilState     = desc.depth;
+		pso.SampleMask            = UINT_MAX;
+		pso.InputLayout           = {ild.data(), static_cast<UINT>(ild.size())};
+		pso.IBStripCutValue       = D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_DISABLED;
+		pso.PrimitiveTopologyType = desc.topology;
+		pso.NumRenderTargets      = desc.numRt;
+		for (UINT i = 0; i < desc.numRt; ++i) {
+			pso.RTVFormats[i] = desc.rtv[i];
+		}
+		pso.DSVFormat  = desc.dsv;
+		pso.SampleDesc = desc.sample;
+
+		// ID3D12Device はフリースレッドなのでワーカーからも呼べる
+		return device->CreateGraphicsPipelineState(&pso, IID_PPV_ARGS(&outPso));
+	}
+
+	void UPipelineCache::Record(
+		const uint64_t              hash,
+		const std::vector<uint8_t>& encoded,
+		const PipelineDesc&         desc
+	) {
+		if (mManifestPath.empty()) {
+			return;
+		}
+		const auto blobBytes = [](const ShaderBlob* blob) {
+			return std::span(
+				static_cast<const uint8_t*>(blob->blob->GetBufferPointer()),
+				blob->blob->GetBufferSize()
+			);
+		};
+		mManifest.AddBlob(desc.vs->hash, blobBytes(desc.vs));
+		mManifest.AddBlob(desc.ps->hash, blobBytes(desc.ps));
+		mManifest.Add({
+			.hash = hash,
+			.desc = encoded,
+			.blobs = {desc.vs->hash, desc.ps->hash}
+		});
+		mManifest.MarkUsed(hash);
+	}
+
+	PsoHandle UPipelineCache::Insert(
+		const uint64_t                              hash,
+		Microsoft::WRL::ComPtr<ID3D12PipelineState> pso
+	) {
+		Entry entry    = {};
+		entry.hash     = hash;
+		entry.pso      = std::move(pso);
+		uint32_t index = static_cast<uint32_t>(mEntries.size());
+		mEntries.emplace_back(std::move(entry));
+		mHashToIndex[hash] = index;
+		return PsoHandle{index};
 	}
 }
@@ -1,10 +1,14 @@
 ﻿#pragma once
+#include <atomic>
+#include <filesystem>
+#include <memory>
 
 #include <d3d12.h>
 #include <d3dx12.h>
 
 #include <engine/urootsignaturecache/RootSignatureCache.h>
 
+#include "runtime/render/pipeline/PipelineManifest.h"
 #include "runtime/render/resources/ShaderLibrary.h"
 
 namespace Unnamed {
@@ -41,28 +45,106 @@ namespace Unnamed {
 		uint32_t id = UINT32_MAX;
 	};
 
+	struct PipelineCacheStats {
+		uint32_t hits            = 0; // 作成済みのものを返した
+		uint32_t precompiledHits = 0; // 起動時に先に作ったものを初めて返した
+		uint32_t misses          = 0; // 描画中に同期で作った
+		uint32_t precompiled     = 0; // 先に作り終えた数
+		uint32_t pending         = 0; // 先に作る予定でまだ終わっていない数
+		uint32_t failed          = 0; // 先に作れなかった数
+		double   missMs          = 0.0; // 同期で作った時間の合計
+		double   missMaxMs       = 0.0;
+		double   precompileMs    = 0.0; // ワーカーで作った時間の合計
+	};
+
+	class PipelinePrecompiler;
+
+	/// @class UPipelineCache
+	/// @brief PSOのキャッシュ
+	/// @details セッション中に作ったパイプラインは記述とシェーダーのバイトコードごと
+	/// マニフェストに記録し、次回起動時に Precompile() でワーカーから先に作ります。
+	/// ハッシュは記述の内容とバイトコードの内容から作るので実行をまたいで同じです。
+	/// GetOrCreate / Get はレンダースレッドから呼んでください
 	class UPipelineCache {
 	public:
+		/// @param manifestPath 空ならマニフェストを読み書きしません
 		explicit UPipelineCache(
-			GraphicsDevice*     graphicsDevice,
-			RootSignatureCache* rootSignatureCache
+			GraphicsDevice*       graphicsDevice,
+			RootSignatureCache*   rootSignatureCache,
+			std::filesystem::path manifestPath = "./cache/pipelines.upl"
 		);
+		~UPipelineCache();
+
 		PsoHandle            GetOrCreate(const PipelineDesc& desc);
 		ID3D12PipelineState* Get(PsoHandle handle) const;
 
+		/// @brief マニフェストにあるパイプラインをワーカーで作り始めます
+		/// @details 作成中のものを GetOrCreate で要求すると終わるまで待ち、
+		/// まだ手が付いていなければその場で作ります
+		void Precompile();
+
+		bool SaveManifest();
+
+		[[nodiscard]] PipelineCacheStats Stats() const;
+
 	private:
-		static size_t Hash(const PipelineDesc& desc);
+		struct Entry {
+			uint64_t                                    hash;
+			Microsoft::WRL::ComPtr<ID3D12PipelineState> pso;
+		};
+
+		// マニフェストから復元した、先に作るパイプライン
+		struct Prepared {
+			uint64_t                                    hash = 0;
+			PipelineDesc                                desc;
+			std::vector<std::string>                    semantics; // desc.inputLayout が指す
+			ID3D12RootSignature*                        rootSignature = nullptr;
+			PipelineManifest::Blob                      vs;
+			PipelineManifest::Blob                      ps;
+			Microsoft::WRL::ComPtr<ID3D12PipelineState> pso; // 作った側が書く
+		};
+
+		// 記述とルートシグネチャの記述をバイト列にします(ハッシュとマニフェストに使う)
+		std::vector<uint8_t> Encode(const PipelineDesc& desc) const;
+		static uint64_t      Hash(const std::vector<uint8_t>& encoded,
+		                          uint64_t vsHash, uint64_t psHash);
+
+		static HRESULT CreatePso(
+			ID3D12Device*                                device,
+			ID3D12RootSignature*                         rootSignature,
+			const PipelineDesc&                          desc,
+			D3D12_SHADER_BYTECODE                        vs,
+			D3D12_SHADER_BYTECODE                        ps,
+			Microsoft::WRL::ComPtr<ID3D12PipelineState>& outPso
+		);
+
+		// マニフェストに記録します
+		void Record(uint64_t                    hash,
+		            const std::vector<uint8_t>& encoded,
+		            const PipelineDesc&         desc);
+
+		PsoHandle Insert(uint64_t hash, Microsoft::WRL::ComPtr<ID3D12PipelineState> pso);
 
 	private:
 		GraphicsDevice*     mGraphicsDevice;
 		RootSignatureCache* mRootSignatureCache;
 
-		struct Entry {
-			size_t                                      hash;
-			Microsoft::WRL::ComPtr<ID3D12PipelineState> pso;
-		};
+		std::vector<Entry>                     mEntries;
+		std::unordered_map<uint64_t, uint32_t> mHashToIndex;
+
+		std::filesystem::path mManifestPath;
+		PipelineManifest      mManifest;
+
+		uint32_t mHits            = 0;
+		uint32_t mPrecompiledHits = 0;
+		uint32_t mMisses          = 0;
+		double   mMissMs          = 0.0;
+		double   mMissMaxMs       = 0.0;
+
+		std::atomic<uint64_t> mPrecompileMicros = 0;
 
-		std::vector<Entry>                   mEntries;
-		std::unordered_map<size_t, uint32_t> mHashToIndex;
+		std::vector<Prepared>                  mPrepared;
+		std::unordered_map<uint64_t, uint32_t> mPreparedIndex;
+		std::unique_ptr<PipelinePrecompiler>   mPrecompiler; // mPrepared より先に破棄する
 	};
 }
@@ -0,0 +1,202 @@
+﻿#include <pch.h>
+
+//-----------------------------------------------------------------------------
+
+#include "DxcShaderCompiler.h"
+
+#include <d3d12.h>
+
+namespace Unnamed {
+	constexpr std::string_view kChannel = "DxcShaderCompiler";
+
+	using namespace Microsoft::WRL;
+
+	namespace {
+		// 引数を変えたらバージョンも上げる(ディスクのキャッシュが無効になります)
+		constexpr std::string_view kIdentity = "dxc;-I.;-Zi;-Qembed_debug;-Od;-Zpr;v1";
+
+		//---------------------------------------------------------------------
+		// Purpose: 開いたインクルードファイルを記録する
+		// Compile の間だけスタックに置くので、参照カウントは見ません
+		//---------------------------------------------------------------------
+		class RecordingIncludeHandler final : public IDxcIncludeHandler {
+		public:
+			explicit RecordingIncludeHandler(IDxcIncludeHandler* inner)
+				: mInner(inner) {
+			}
+
+			HRESULT STDMETHODCALLTYPE LoadSource(
+				_In_ LPCWSTR                             pFilename,
+				_COM_Outptr_result_maybenull_ IDxcBlob** ppIncludeSource
+			) override {
+				const HRESULT hr = mInner->LoadSource(pFilename, ppIncludeSource);
+				if (SUCCEEDED(hr)) {
+					includes.emplace_back(StrUtil::ToString(pFilename));
+				}
+				return hr;
+			}
+
+			HRESULT STDMETHODCALLTYPE QueryInterface(
+				REFIID riid, void** ppvObject
+			) override {
+				if (!ppvObject) {
+					return E_POINTER;
+				}
+				if (
+					riid == __uuidof(IDxcIncludeHandler) ||
+					riid == __uuidof(IUnknown)
+				) {
+					*ppvObject = static_cast<IDxcIncludeHandler*>(this);
+					return S_OK;
+				}
+				*ppvObject = nullptr;
+				return E_NOINTERFACE;
+			}
+
+			ULONG STDMETHODCALLTYPE AddRef() override { return 1; }
+			ULONG STDMETHODCALLTYPE Release() override { return 1; }
+
+			std::vector<std::string> includes;
+
+		private:
+			IDxcIncludeHandler* mInner = nullptr;
+		};
+	}
+
+	DxcShaderCompiler::DxcShaderCompiler() = default;
+
+	DxcShaderCompiler::~DxcShaderCompiler() = default;
+
+	ShaderCompileResult DxcShaderCompiler::Compile(
+		const std::string&      source,
+		const ShaderVariantKey& key,
+		const std::string&      virtualName
+	) {
+		ShaderCompileResult result;
+
+		auto instance = Acquire();
+
+		DxcBuffer shaderSourceBuffer = {};
+		shaderSourceBuffer.Ptr       = source.data();
+		shaderSourceBuffer.Size      = source.size();
+		shaderSourceBuffer.Encoding  = DXC_CP_UTF8;
+
+		// 引数の文字列の寿命はここで持つ
+		std::vector<std::wstring> storage;
+		storage.reserve(key.defines.size() + 4);
+		storage.emplace_back(
+			virtualName.empty() ?
+				L"Generated.hlsl" :
+				StrUtil::ToWString(virtualName)
+		);
+		storage.emplace_back(StrUtil::ToWString(key.entryPoint));
+		storage.emplace_back(StrUtil::ToWString(key.target));
+
+		std::vector<LPCWSTR> arguments = {
+			storage[0].c_str(), // 仮想ファイル名(相対インクルードの基準)
+			L"-E", storage[1].c_str(), // エントリーポイントの指定。
+			L"-T", storage[2].c_str(), // ShaderProfileの設定
+			L"-I", L".", // 生成したシェーダーはカレントからのパスでインクルードする
+			DXC_ARG_DEBUG, L"-Qembed_debug", // デバッグ用の情報を埋め込む
+			DXC_ARG_SKIP_OPTIMIZATIONS, // 最適化を外しておく
+			DXC_ARG_PACK_MATRIX_ROW_MAJOR, // 行列のメモリレイアウトは行優先
+		};
+		for (const auto& define : key.defines) {
+			// 値の無い定義は1にする
+			storage.emplace_back(
+				StrUtil::ToWString(
+					define.find('=') == std::string::npos ? define + "=1" : define
+				)
+			);
+			arguments.emplace_back(L"-D");
+			arguments.emplace_back(storage.back().c_str());
+		}
+
+		RecordingIncludeHandler includeHandler(instance->includeHandler.Get());
+
+		ComPtr<IDxcResult> shaderResult;
+		THROW(
+			instance->compiler->Compile(
+				&shaderSourceBuffer,
+				arguments.data(),                      // 引数
+				static_cast<UINT32>(arguments.size()), // 引数の数
+				&includeHandler,                       // includeが含まれた諸々
+				IID_PPV_ARGS(&shaderResult)            // コンパイル結果
+			)
+		);
+
+		ComPtr<IDxcBlobUtf8> shaderError;
+		shaderResult->GetOutput(
+			DXC_OUT_ERRORS, IID_PPV_ARGS(&shaderError), nullptr
+		);
+		if (shaderError != nullptr && shaderError->GetStringLength() != 0) {
+			result.errors = shaderError->GetStringPointer();
+		}
+
+		HRESULT status = E_FAIL;
+		shaderResult->GetStatus(&status);
+
+		ComPtr<IDxcBlob> shaderBlob;
+		if (SUCCEEDED(status)) {
+			shaderResult->GetOutput(
+				DXC_OUT_OBJECT, IID_PPV_ARGS(&shaderBlob), nullptr
+			);
+		}
+
+		Return(std::move(instance));
+
+		if (!shaderBlob || shaderBlob->GetBufferSize() == 0) {
+			return result;
+		}
+
+		const auto* bytes = static_cast<const uint8_t*>(
+			shaderBlob->GetBufferPointer()
+		);
+		result.bytecode.assign(bytes, bytes + shaderBlob->GetBufferSize());
+		result.includes  = std::move(includeHandler.includes);
+		result.succeeded = true;
+
+		Msg(
+			kChannel,
+			"Shader compile success: entryPoint='{}', target='{}'",
+			key.entryPoint.c_str(), key.target.c_str()
+		);
+		return result;
+	}
+
+	std::string_view DxcShaderCompiler::Identity() const {
+		return kIdentity;
+	}
+
+	std::unique_ptr<DxcShaderCompiler::Instance> DxcShaderCompiler::Acquire() {
+		{
+			std::lock_guard lock(mMutex);
+			if (!mIdle.empty()) {
+				auto instance = std::move(mIdle.back());
+				mIdle.pop_back();
+				return instance;
+			}
+		}
+
+		auto instance = std::make_unique<Instance>();
+		THROW(
+			DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&instance->utils))
+		);
+		THROW(
+			DxcCreateInstance(
+				CLSID_DxcCompiler, IID_PPV_ARGS(&instance->compiler)
+			)
+		);
+		THROW(
+			instance->utils->CreateDefaultIncludeHandler(
+				&instance->includeHandler
+			)
+		);
+		return instance;
+	}
+
+	void DxcShaderCompiler::Return(std::unique_ptr<Instance> instance) {
+		std::lock_guard lock(mMutex);
+		mIdle.emplace_back(std::move(instance));
+	}
+}
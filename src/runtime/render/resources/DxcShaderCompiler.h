@@ -0,0 +1,44 @@
+﻿#pragma once
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <dxcapi.h>
+
+#include <runtime/render/resources/interface/IShaderCompiler.h>
+
+#include <wrl/client.h>
+
+namespace Unnamed {
+	/// @class DxcShaderCompiler
+	/// @brief DXCでのコンパイル
+	/// @details DXCのインスタンスは作るのが重いので、使い終わったものをプールして使い回します。
+	/// 1つのインスタンスは1スレッドでしか使わないので、並列にコンパイルできます
+	class DxcShaderCompiler : public IShaderCompiler {
+	public:
+		DxcShaderCompiler();
+		~DxcShaderCompiler() override;
+
+		ShaderCompileResult Compile(
+			const std::string&      source,
+			const ShaderVariantKey& key,
+			const std::string&      virtualName
+		) override;
+
+		[[nodiscard]] std::string_view Identity() const override;
+
+	private:
+		struct Instance {
+			Microsoft::WRL::ComPtr<IDxcUtils>          utils;
+			Microsoft::WRL::ComPtr<IDxcCompiler3>      compiler;
+			Microsoft::WRL::ComPtr<IDxcIncludeHandler> includeHandler;
+		};
+
+		std::unique_ptr<Instance> Acquire();
+		void                      Return(std::unique_ptr<Instance> instance);
+
+	private:
+		std::mutex                             mMutex;
+		std::vector<std::unique_ptr<Instance>> mIdle;
+	};
+}
@@ -13,6 +13,9 @@
 
 #include <d3dx12.h>
 
+#include <algorithm>
+#include <cmath>
+
 #include <engine/subsystem/console/Log.h>
 #include <engine/urenderer/GraphicsDevice.h>
 #include <engine/uuploadarena/UploadArena.h>
@@ -23,6 +26,48 @@ namespace Unnamed {
 	constexpr std::string_view kChannel = "RenderResourceManager";
 
 	namespace {
+		bool IsBlockCompressed(const DXGI_FORMAT format) {
+			return (format >= DXGI_FORMAT_BC1_TYPELESS &&
+					format <= DXGI_FORMAT_BC5_SNORM) ||
+				(format >= DXGI_FORMAT_BC6H_TYPELESS &&
+					format <= DXGI_FORMAT_BC7_UNORM_SRGB);
+		}
+
+		// 最大辺が tailSize 以下になる最初のミップ(無ければ0 = 全て常駐)
+		// BCはリソースの先頭ミップが4の倍数でないと作れない
+		uint32_t TailMip(const TextureAssetData& data, const uint32_t tailSize) {
+			const bool bc = IsBlockCompressed(data.format);
+			for (uint32_t m = 0; m < data.mips.size(); ++m) {
+				const auto& mip = data.mips[m];
+				if (bc && (mip.width % 4 != 0 || mip.height % 4 != 0)) {
+					break;
+				}
+				if (std::max(mip.width, mip.height) <= tailSize) {
+					return m;
+				}
+			}
+			return 0;
+		}
+
+		// residentMip から末尾までを持つリソース
+		D3D12_RESOURCE_DESC ResidentDesc(
+			const DXGI_FORMAT       format,
+			const TextureAssetData& data,
+			const uint32_t          residentMip
+		) {
+			D3D12_RESOURCE_DESC desc = {};
+			desc.Dimension           = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+			desc.Format              = format;
+			desc.Width               = data.mips[residentMip].width;
+			desc.Height              = data.mips[residentMip].height;
+			desc.DepthOrArraySize    = 1;
+			desc.MipLevels           = static_cast<UINT16>(
+				data.mips.size() - residentMip
+			);
+			desc.SampleDesc.Count = 1;
+			return desc;
+		}
+
 		D3D12_PLACED_SUBRESOURCE_FOOTPRINT CalcFootprint2D(
 			ID3D12Device*  device, const DXGI_FORMAT format,
 			const uint32_t w, const uint32_t         h,
@@ -97,23 +142,44 @@ namespace Unnamed {
 		texture.gen++;
 		texture.refs        = 1;
 		texture.sourceAsset = asset;
+		texture.w           = texAsset->width;
+		texture.h           = texAsset->height;
+		texture.format      = texAsset->mips.empty() ?
+			                      DXGI_FORMAT_R8G8B8A8_UNORM :
+			                      texAsset->format;
 
-
-		// リソースの作成
+		// ストリーミング中は末尾のミップだけ常駐させ、上位は要求が来てから読む
 		const uint32_t mipCount =
 			!texAsset->mips.empty() ?
 				static_cast<uint32_t>(texAsset->mips.size()) :
 				1;
-		const uint32_t w = texAsset->width;
-		const uint32_t h = texAsset->height;
+		const uint32_t firstMip =
+			mStreaming.enabled && !texAsset->mips.empty() ?
+				TailMip(*texAsset, mStreaming.tailSize) :
+				0;
+		const uint32_t levels = mipCount - firstMip;
+		texture.streamed      = mStreaming.enabled && !texAsset->mips.empty();
+		texture.mipCount      = mipCount;
+		texture.residentMip   = firstMip;
+		texture.requestedMip  = firstMip;
+		texture.tailMip       = firstMip;
+		texture.lastUsedFrame = mStreamingFrame;
+
+		// リソースの作成
+		const uint32_t w = firstMip ?
+			                   texAsset->mips[firstMip].width :
+			                   texAsset->width;
+		const uint32_t h = firstMip ?
+			                   texAsset->mips[firstMip].height :
+			                   texAsset->height;
 
 		D3D12_RESOURCE_DESC rd = {};
 		rd.Dimension           = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-		rd.Format              = DXGI_FORMAT_R8G8B8A8_UNORM;
+		rd.Format              = texture.format; // BCならブロック単位でコピーされる
 		rd.Width               = w;
 		rd.Height              = h;
 		rd.DepthOrArraySize    = 1;
-		rd.MipLevels           = static_cast<UINT16>(mipCount);
+		rd.MipLevels           = static_cast<UINT16>(levels);
 		rd.SampleDesc.Count    = 1;
 
 		D3D12_HEAP_PROPERTIES hp  = {D3D12_HEAP_TYPE_DEFAULT};
@@ -145,8 +211,8 @@ namespace Unnamed {
 				return {};
 			}
 		} else {
-			for (int m = static_cast<int>(mipCount) - 1; m >= 0; --m) {
-				const auto& mip = texAsset->mips[m];
+			for (int m = static_cast<int>(levels) - 1; m >= 0; --m) {
+				const auto& mip = texAsset->mips[firstMip + m];
 
 				D3D12_PLACED_SUBRESOURCE_FOOTPRINT fp      = {};
 				UINT                               numRows = 0;
@@ -156,15 +222,27 @@ namespace Unnamed {
 					&rd, static_cast<UINT>(m), 1, 0, &fp, &numRows, &rb, &total
 				);
 
+				// ブロック圧縮では numRows は4x4ブロックの行数
+				UASSERT(mip.bytes.size() >= mip.rowPitch * numRows);
+
 				constexpr uint64_t kAlign =
 					D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT;
 				auto slice = mArena->Allocate(
-					static_cast<uint64_t>(fp.Footprint.RowPitch) * mip.height,
+					static_cast<uint64_t>(fp.Footprint.RowPitch) * numRows,
 					kAlign);
 				if (!slice.cpu) {
 					// 読めなかったら保留してキューにぶち込む
 					for (int k = m; k >= 0; --k) {
-						const auto&      mip2 = texAsset->mips[k];
+						// ProcessDeferredMipUploads はシェーダーリソースから戻すので揃えておく
+						auto toPs = CD3DX12_RESOURCE_BARRIER::Transition(
+							texture.resource.Get(),
+							D3D12_RESOURCE_STATE_COPY_DEST,
+							D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+							static_cast<UINT>(k)
+						);
+						commandList->ResourceBarrier(1, &toPs);
+
+						const auto&      mip2 = texAsset->mips[firstMip + k];
 						PendingMipUpload p = {};
 						p.tex = {index, texture.gen};
 						p.mip = k;
@@ -180,7 +258,7 @@ namespace Unnamed {
 
 				// 行コピー
 				auto dst = static_cast<uint8_t*>(slice.cpu);
-				for (uint32_t y = 0; y < mip.height; ++y) {
+				for (uint32_t y = 0; y < numRows; ++y) {
 					memcpy(
 						dst + static_cast<size_t>(y) * fp.Footprint.RowPitch,
 						mip.bytes.data() + static_cast<size_t>(y) * mip.
@@ -215,15 +293,9 @@ namespace Unnamed {
 			}
 
 			// VRAMメモリを計算
-			texture.vramBytes = 0;
-			for (uint32_t m = 0; m < mipCount; ++m) {
-				const uint32_t mw = std::max<uint32_t>(1u, w >> m);
-				const uint32_t mh = std::max<uint32_t>(1u, h >> m);
-				texture.vramBytes +=
-					MemUtil::AlignUp(
-						static_cast<size_t>(mw) * 4, 256
-					) * mh;
-			}
+			texture.vramBytes = static_cast<size_t>(
+				dev->GetResourceAllocationInfo(0, 1, &rd).SizeInBytes
+			);
 		}
 
 		// SRVの作成
@@ -237,7 +309,7 @@ namespace Unnamed {
 		}
 
 		D3D12_SHADER_RESOURCE_VIEW_DESC sd = {};
-		sd.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		sd.Format = texture.format;
 		sd.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 		sd.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
 		sd.Texture2D.MipLevels = rd.MipLevels;
@@ -289,23 +361,22 @@ namespace Unnamed {
 			);
 
 			// 予算チェック
-			if (used + fp.Footprint.RowPitch * p.height > budget) {
+			const uint64_t bytes =
+				static_cast<uint64_t>(fp.Footprint.RowPitch) * numRows;
+			if (used + bytes > budget) {
 				break;
 			}
 
 			// Arena確保
 			constexpr uint64_t kAlign = D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT;
-			const auto         slice  = mArena->Allocate(
-				static_cast<uint64_t>(fp.Footprint.RowPitch * p.height),
-				kAlign
-			);
+			const auto         slice  = mArena->Allocate(bytes, kAlign);
 			if (!slice.cpu) {
 				break;
 			}
 
 			// 行コピー
 			auto dst = static_cast<uint8_t*>(slice.cpu);
-			for (uint32_t y = 0; y < p.height; ++y) {
+			for (uint32_t y = 0; y < numRows; ++y) {
 				memcpy(
 					dst + static_cast<size_t>(y) * fp.Footprint.RowPitch,
 					p.data->data() + static_cast<size_t>(y) * p.rowPitch,
@@ -341,12 +412,376 @@ namespace Unnamed {
 			);
 			commandList->ResourceBarrier(1, &toPs);
 
-			used += fp.Footprint.RowPitch * p.height;
+			used += bytes;
 
 			mDeferredMipUploads.erase(mDeferredMipUploads.begin() + i);
 		}
 	}
 
+	void RenderResourceManager::SetStreamingSettings(
+		const TextureStreamingSettings& settings
+	) {
+		std::scoped_lock lock(mMutex);
+		mStreaming = settings;
+	}
+
+	TextureStreamingSettings RenderResourceManager::StreamingSettings() const {
+		std::scoped_lock lock(mMutex);
+		return mStreaming;
+	}
+
+	void RenderResourceManager::RequestTextureMip(
+		const TextureHandle handle,
+		const float         screenPixels
+	) {
+		std::scoped_lock lock(mMutex);
+		if (!handle.IsValid() || handle.id >= mTextures.size()) {
+			return;
+		}
+		auto& texture = mTextures[handle.id];
+		if (!texture.alive || texture.gen != handle.gen || !texture.streamed) {
+			return;
+		}
+
+		// UVが0..1で貼られている前提で、1テクセルが1ピクセルになるミップ
+		const float texels = static_cast<float>(std::max(texture.w, texture.h));
+		const float ratio  = texels / std::max(screenPixels, 1.0f);
+		const auto  mip    = ratio <= 1.0f ?
+			                     0u :
+			                     static_cast<uint32_t>(std::floor(std::log2(ratio)));
+
+		texture.requestedMip  = std::min({texture.requestedMip, mip, texture.tailMip});
+		texture.lastUsedFrame = mStreamingFrame;
+	}
+
+	void RenderResourceManager::UpdateStreaming(
+		ID3D12GraphicsCommandList* commandList
+	) {
+		std::scoped_lock lock(mMutex);
+		ReleaseRetiredTextures();
+
+		// このフレームより前に RequestTextureMip されたものが「前のフレームで使われた」もの
+		const uint64_t frame        = ++mStreamingFrame;
+		size_t         uploadBudget = mStreaming.uploadBytesPerFrame;
+
+		const auto isStreamable = [this](const GpuTexture& t) {
+			if (!t.alive || !t.streamed || !t.resource) {
+				return false;
+			}
+			// 読み残しがあるものは今のリソースをそのまま写せないので待つ
+			const uint32_t index = static_cast<uint32_t>(&t - mTextures.data());
+			return std::ranges::none_of(
+				mDeferredMipUploads,
+				[&](const PendingMipUpload& p) {
+					return p.tex.id == index && p.tex.gen == t.gen;
+				}
+			);
+		};
+
+		// 無効にされたら全部のミップを戻す
+		if (!mStreaming.enabled) {
+			for (uint32_t i = 0; i < mTextures.size() && uploadBudget > 0; ++i) {
+				auto& t = mTextures[i];
+				if (!isStreamable(t) || t.residentMip == 0) {
+					continue;
+				}
+				if (const auto* data = mAssetManager->Get<TextureAssetData>(
+					t.sourceAsset)) {
+					RebuildResidency(i, *data, 0, uploadBudget, commandList);
+				}
+				t.requestedMip = 0;
+			}
+			return;
+		}
+
+		size_t residentBytes = 0;
+		for (const auto& t : mTextures) {
+			if (t.alive && t.streamed) {
+				residentBytes += t.vramBytes;
+			}
+		}
+
+		// 捨てる候補: 前のフレームで使われていないか、要求より多く持っているもの(古い順)
+		const auto evictTarget = [frame](const GpuTexture& t) {
+			return t.lastUsedFrame + 1 < frame ?
+				       t.tailMip :
+				       std::min(t.requestedMip, t.tailMip);
+		};
+		std::vector<uint32_t> victims;
+		for (uint32_t i = 0; i < mTextures.size(); ++i) {
+			const auto& t = mTextures[i];
+			if (isStreamable(t) && evictTarget(t) > t.residentMip) {
+				victims.emplace_back(i);
+			}
+		}
+		std::ranges::sort(
+			victims,
+			[this](const uint32_t a, const uint32_t b) {
+				return mTextures[a].lastUsedFrame < mTextures[b].lastUsedFrame;
+			}
+		);
+
+		// 上位ミップを捨ててVRAMを空ける。縮めるだけなのでアップロードは使わない
+		size_t     nextVictim = 0;
+		const auto evictUntil = [&](const size_t limit) {
+			while (residentBytes > limit && nextVictim < victims.size()) {
+				const uint32_t i = victims[nextVictim++];
+				auto&          t = mTextures[i];
+				const auto*    data = mAssetManager->Get<TextureAssetData>(
+					t.sourceAsset);
+				if (!data) {
+					continue;
+				}
+				const size_t before = t.vramBytes;
+				if (RebuildResidency(i, *data, evictTarget(t), uploadBudget,
+				                     commandList)) {
+					residentBytes -= std::min(before - t.vramBytes, residentBytes);
+				}
+			}
+		};
+		evictUntil(mStreaming.budgetBytes);
+
+		// 読み込む候補: 要求が常駐より詳細なもの。最近使われて、足りないミップが多いものから
+		std::vector<uint32_t> requests;
+		for (uint32_t i = 0; i < mTextures.size(); ++i) {
+			const auto& t = mTextures[i];
+			if (isStreamable(t) && t.lastUsedFrame + 1 >= frame &&
+				t.requestedMip < t.residentMip) {
+				requests.emplace_back(i);
+			}
+		}
+		std::ranges::sort(
+			requests,
+			[this](const uint32_t a, const uint32_t b) {
+				const auto& ta = mTextures[a];
+				const auto& tb = mTextures[b];
+				if (ta.lastUsedFrame != tb.lastUsedFrame) {
+					return ta.lastUsedFrame > tb.lastUsedFrame;
+				}
+				return ta.residentMip - ta.requestedMip >
+					tb.residentMip - tb.requestedMip;
+			}
+		);
+
+		for (const uint32_t i : requests) {
+			if (uploadBudget == 0) {
+				break;
+			}
+			auto&       t    = mTextures[i];
+			const auto* data = mAssetManager->Get<TextureAssetData>(t.sourceAsset);
+			if (!data) {
+				continue;
+			}
+
+			const size_t after = ResidencyBytes(t, *data, t.requestedMip);
+			if (after > t.vramBytes) {
+				evictUntil(mStreaming.budgetBytes - std::min(
+					after - t.vramBytes, mStreaming.budgetBytes));
+				if (residentBytes + (after - t.vramBytes) >
+					mStreaming.budgetBytes) {
+					continue; // 空けられなかった
+				}
+			}
+
+			const size_t before = t.vramBytes;
+			if (RebuildResidency(i, *data, t.requestedMip, uploadBudget,
+			                     commandList)) {
+				residentBytes = residentBytes - before + t.vramBytes;
+			}
+		}
+
+		// 次のフレームの要求を集め直す
+		for (auto& t : mTextures) {
+			if (t.alive && t.streamed) {
+				t.requestedMip = t.tailMip;
+			}
+		}
+	}
+
+	size_t RenderResourceManager::ResidencyBytes(
+		const GpuTexture&       texture,
+		const TextureAssetData& data,
+		const uint32_t          residentMip
+	) const {
+		const D3D12_RESOURCE_DESC rd = ResidentDesc(
+			texture.format, data, residentMip
+		);
+		return static_cast<size_t>(
+			mGd->Device()->GetResourceAllocationInfo(0, 1, &rd).SizeInBytes
+		);
+	}
+
+	bool RenderResourceManager::RebuildResidency(
+		const uint32_t             index,
+		const TextureAssetData&    data,
+		const uint32_t             newResidentMip,
+		size_t&                    uploadBudget,
+		ID3D12GraphicsCommandList* commandList
+	) {
+		auto&          texture = mTextures[index];
+		const uint32_t oldTop  = texture.residentMip;
+		const uint32_t newTop  = newResidentMip;
+		if (newTop == oldTop || newTop >= texture.mipCount ||
+			data.mips.size() != texture.mipCount) {
+			return false;
+		}
+
+		auto*                     dev = mGd->Device();
+		const D3D12_RESOURCE_DESC rd  = ResidentDesc(texture.format, data, newTop);
+
+		// 新しく読むミップの大きさを先に測る(予算が足りなければ何も作らずに諦める)
+		struct MipUpload {
+			uint32_t                           mip = 0;
+			D3D12_PLACED_SUBRESOURCE_FOOTPRINT fp  = {};
+			UINT                               numRows = 0;
+			UploadArena::Slice                 slice;
+		};
+		std::vector<MipUpload> uploads;
+		size_t                 uploadBytes = 0;
+		for (uint32_t m = newTop; m < oldTop; ++m) {
+			MipUpload u = {};
+			u.mip       = m;
+			UINT64 rb    = 0;
+			UINT64 total = 0;
+			dev->GetCopyableFootprints(
+				&rd, m - newTop, 1, 0, &u.fp, &u.numRows, &rb, &total
+			);
+			uploadBytes += static_cast<size_t>(total);
+			uploads.emplace_back(u);
+		}
+		if (uploadBytes > uploadBudget) {
+			return false;
+		}
+
+		auto* srvAlloc = mGd->GetSrvAllocator();
+		const uint32_t srvIndex = srvAlloc->Allocate();
+		if (srvIndex == UINT32_MAX) {
+			return false;
+		}
+
+		ComPtr<ID3D12Resource> resource;
+		D3D12_HEAP_PROPERTIES  hp = {D3D12_HEAP_TYPE_DEFAULT};
+		if (FAILED(
+			dev->CreateCommittedResource(
+				&hp, D3D12_HEAP_FLAG_NONE, &rd,
+				D3D12_RESOURCE_STATE_COPY_DEST, nullptr,
+				IID_PPV_ARGS(&resource)
+			)
+		)) {
+			srvAlloc->Free(srvIndex);
+			return false;
+		}
+
+		// アリーナはフレーム内で戻せないので、失敗しうる作成が済んでから切り出す
+		for (auto& u : uploads) {
+			u.slice = mArena->Allocate(
+				static_cast<uint64_t>(u.fp.Footprint.RowPitch) * u.numRows,
+				D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+			);
+			if (!u.slice.cpu) {
+				srvAlloc->Free(srvIndex);
+				return false;
+			}
+		}
+		uploadBudget -= uploadBytes;
+
+		// 両方に残るミップはGPU上でコピー
+		auto toCopySrc = CD3DX12_RESOURCE_BARRIER::Transition(
+			texture.resource.Get(),
+			D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+			D3D12_RESOURCE_STATE_COPY_SOURCE
+		);
+		commandList->ResourceBarrier(1, &toCopySrc);
+
+		for (uint32_t m = std::max(oldTop, newTop); m < texture.mipCount; ++m) {
+			D3D12_TEXTURE_COPY_LOCATION dstLoc = {};
+			dstLoc.pResource        = resource.Get();
+			dstLoc.Type             = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+			dstLoc.SubresourceIndex = m - newTop;
+
+			D3D12_TEXTURE_COPY_LOCATION srcLoc = {};
+			srcLoc.pResource        = texture.resource.Get();
+			srcLoc.Type             = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+			srcLoc.SubresourceIndex = m - oldTop;
+
+			commandList->CopyTextureRegion(&dstLoc, 0, 0, 0, &srcLoc, nullptr);
+		}
+
+		// 足りないミップはアセットから上げる
+		for (const auto& u : uploads) {
+			const auto& mip = data.mips[u.mip];
+			UASSERT(mip.bytes.size() >= mip.rowPitch * u.numRows);
+
+			auto dst = static_cast<uint8_t*>(u.slice.cpu);
+			for (uint32_t y = 0; y < u.numRows; ++y) {
+				memcpy(
+					dst + static_cast<size_t>(y) * u.fp.Footprint.RowPitch,
+					mip.bytes.data() + static_cast<size_t>(y) * mip.rowPitch,
+					std::min<size_t>(mip.rowPitch, u.fp.Footprint.RowPitch)
+				);
+			}
+
+			D3D12_TEXTURE_COPY_LOCATION dstLoc = {};
+			dstLoc.pResource        = resource.Get();
+			dstLoc.Type             = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+			dstLoc.SubresourceIndex = u.mip - newTop;
+
+			D3D12_TEXTURE_COPY_LOCATION srcLoc = {};
+			srcLoc.pResource              = mArena->Resource();
+			srcLoc.Type                   = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+			srcLoc.PlacedFootprint        = u.fp;
+			srcLoc.PlacedFootprint.Offset = u.slice.offset;
+
+			commandList->CopyTextureRegion(&dstLoc, 0, 0, 0, &srcLoc, nullptr);
+		}
+
+		auto toPs = CD3DX12_RESOURCE_BARRIER::Transition(
+			resource.Get(),
+			D3D12_RESOURCE_STATE_COPY_DEST,
+			D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE
+		);
+		commandList->ResourceBarrier(1, &toPs);
+
+		// 描画中のフレームが古いSRVを見ているので、SRVも新しく作って差し替える
+		D3D12_SHADER_RESOURCE_VIEW_DESC sd = {};
+		sd.Format                  = texture.format;
+		sd.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+		sd.ViewDimension           = D3D12_SRV_DIMENSION_TEXTURE2D;
+		sd.Texture2D.MipLevels     = rd.MipLevels;
+		dev->CreateShaderResourceView(
+			resource.Get(), &sd, srvAlloc->CPUHandle(srvIndex)
+		);
+
+		RetiredTexture retired = {};
+		retired.resource       = std::move(texture.resource);
+		retired.srvIndex       = texture.srvIndex;
+		mRetiredThisFrame.emplace_back(std::move(retired));
+
+		texture.resource    = std::move(resource);
+		texture.srvIndex    = srvIndex;
+		texture.residentMip = newTop;
+		texture.vramBytes   = static_cast<size_t>(
+			dev->GetResourceAllocationInfo(0, 1, &rd).SizeInBytes
+		);
+		return true;
+	}
+
+	void RenderResourceManager::ReleaseRetiredTextures() {
+		auto* srvAlloc = mGd->GetSrvAllocator();
+		std::erase_if(
+			mRetiredTextures,
+			[srvAlloc](const RetiredTexture& r) {
+				if (r.fence && r.fence->GetCompletedValue() < r.value) {
+					return false;
+				}
+				if (r.srvIndex != UINT32_MAX) {
+					srvAlloc->Free(r.srvIndex);
+				}
+				return true;
+			}
+		);
+	}
+
 	void RenderResourceManager::ReleaseTexture(
 		const TextureHandle handle,
 		ID3D12Fence*        fence,
@@ -420,7 +855,18 @@ namespace Unnamed {
 		ID3D12Fence* fence, const uint64_t value
 	) {
 		std::scoped_lock lock(mMutex);
-		if (!fence || mUploadsThisFrame.empty()) {
+		if (!fence) {
+			return;
+		}
+		// ストリーミングで差し替えたものはこのフレームの完了を待って解放する
+		for (auto& r : mRetiredThisFrame) {
+			r.fence = fence;
+			r.value = value;
+			mRetiredTextures.emplace_back(std::move(r));
+		}
+		mRetiredThisFrame.clear();
+
+		if (mUploadsThisFrame.empty()) {
 			return;
 		}
 		for (auto& u : mUploadsThisFrame) {
@@ -508,6 +954,29 @@ namespace Unnamed {
 		return total;
 	}
 
+	std::vector<TextureResidency> RenderResourceManager::TextureResidencyStats() const {
+		std::scoped_lock              lock(mMutex);
+		std::vector<TextureResidency> stats;
+		for (const auto& tex : mTextures) {
+			if (!tex.alive) {
+				continue;
+			}
+			TextureResidency r = {};
+			r.asset            = tex.sourceAsset;
+			r.width            = tex.w;
+			r.height           = tex.h;
+			r.mipCount         = tex.mipCount;
+			r.residentMip      = tex.residentMip;
+			r.requestedMip     = tex.requestedMip;
+			r.tailMip          = tex.tailMip;
+			r.vramBytes        = tex.vramBytes;
+			r.lastUsedFrame    = tex.lastUsedFrame;
+			r.streamed         = tex.streamed;
+			stats.emplace_back(r);
+		}
+		return stats;
+	}
+
 	UploadArena* RenderResourceManager::GetUploadArena() const {
 		return mArena;
 	}
@@ -656,7 +1125,9 @@ namespace Unnamed {
 
 		// アセットデータ取得
 		const auto* meshData = mAssetManager->Get<MeshAssetData>(meshAsset);
-		if (!meshData || meshData->positions.empty() || meshData->indices.empty()) {
+		// 焼いたメッシュはマップした領域を指しているので、ストリームはビュー経由で読む
+		const MeshStreamView streams = meshData ? meshData->Streams() : MeshStreamView{};
+		if (streams.positions.empty() || streams.indices.empty()) {
 			Warning(
 				kChannel,
 				"Failed to get mesh asset data. AssetID={}",
@@ -683,13 +1154,13 @@ namespace Unnamed {
 		gpuMesh.sourceAsset = meshAsset;
 
 		// 頂点データの構築
-		const auto vcount = meshData->positions.size();
+		const auto vcount = streams.positions.size();
 		std::vector<VertexPNUV> verts(vcount);
 
 		for (size_t i = 0; i < vcount; ++i) {
-			verts[i].position = meshData->positions[i];
-			verts[i].normal   = meshData->normals[i];
-			verts[i].uv       = meshData->uv0[i];
+			verts[i].position = streams.positions[i];
+			verts[i].normal   = streams.normals[i];
+			verts[i].uv       = streams.uv0[i];
 		}
 
 		// 頂点バッファ作成
@@ -707,9 +1178,9 @@ namespace Unnamed {
 		}
 
 		// インデックスバッファ作成
-		const size_t ibSize = meshData->indices.size() * sizeof(uint32_t);
+		const size_t ibSize = streams.indices.size_bytes();
 		if (!CreateStaticIndexBuffer(
-			meshData->indices.data(),
+			streams.indices.data(),
 			ibSize,
 			DXGI_FORMAT_R32_UINT,
 			gpuMesh.mesh.ib
@@ -720,11 +1191,26 @@ namespace Unnamed {
 			return {};
 		}
 
-		gpuMesh.mesh.indexCount = static_cast<uint32_t>(meshData->indices.size());
+		gpuMesh.mesh.indexCount = static_cast<uint32_t>(streams.indices.size());
 		gpuMesh.mesh.firstIndex = 0;
 		gpuMesh.mesh.baseVertex = 0;
 		gpuMesh.vramBytes       = vbSize + ibSize;
 
+		// 境界が入っていないメッシュ(ランタイムで作ったものなど)は頂点から求める
+		AABB bounds = meshData->meshBounds;
+		if (bounds.min.x > bounds.max.x) {
+			for (const Vec3& p : streams.positions) {
+				bounds.Expand(p);
+			}
+		}
+		if (bounds.min.x > bounds.max.x) {
+			bounds.min = bounds.max = Vec3::zero;
+		}
+		gpuMesh.mesh.boundsCenter = bounds.Center();
+		gpuMesh.mesh.boundsRadius = bounds.Size().Length() * 0.5f;
+		gpuMesh.mesh.boundsMin    = bounds.min;
+		gpuMesh.mesh.boundsMax    = bounds.max;
+
 		MeshHandle handle = {index, gpuMesh.gen};
 		mAssetToMesh[meshAsset] = handle;
 
@@ -3,6 +3,7 @@
 #include <d3d12.h>
 #include <deque>
 #include <unordered_map>
+#include <vector>
 
 #include <engine/urenderer/GraphicsDevice.h>
 
@@ -16,6 +17,7 @@ namespace Unnamed {
 	class GraphicsDevice;
 	class UAssetManager;
 	class UploadArena;
+	struct TextureAssetData;
 
 	struct TextureHandle {
 		uint32_t           id  = UINT32_MAX;
@@ -25,6 +27,29 @@ namespace Unnamed {
 
 	// MeshHandleはRenderTypes.hで定義済み
 
+	/// @brief テクスチャストリーミングの設定
+	struct TextureStreamingSettings {
+		bool     enabled  = false;
+		uint32_t tailSize = 64; // 取得時に常駐させる末尾ミップの最大辺(ピクセル)
+
+		size_t budgetBytes         = 256ull * 1024 * 1024; // ストリーミングするテクスチャのVRAM予算
+		size_t uploadBytesPerFrame = 16ull * 1024 * 1024;  // 1フレームで上げる量の上限
+	};
+
+	/// @brief テクスチャ1枚分の常駐状況
+	struct TextureResidency {
+		AssetID  asset         = kInvalidAssetID;
+		uint32_t width         = 0;
+		uint32_t height        = 0;
+		uint32_t mipCount      = 0;
+		uint32_t residentMip   = 0; // 常駐している一番詳細なミップ
+		uint32_t requestedMip  = 0; // 前のフレームで要求された一番詳細なミップ
+		uint32_t tailMip       = 0; // これより粗いミップは常に常駐
+		size_t   vramBytes     = 0;
+		uint64_t lastUsedFrame = 0;
+		bool     streamed      = false;
+	};
+
 	class RenderResourceManager {
 	public:
 		explicit RenderResourceManager(
@@ -38,6 +63,20 @@ namespace Unnamed {
 
 		void ProcessDeferredMipUploads(ID3D12GraphicsCommandList* commandList);
 
+		void SetStreamingSettings(const TextureStreamingSettings& settings);
+		[[nodiscard]] TextureStreamingSettings StreamingSettings() const;
+
+		/// @brief 描画するテクスチャの画面上の大きさを伝えます
+		/// @param screenPixels テクスチャを貼ったものの画面上の大きさ(長辺のピクセル数)
+		/// @details そのフレームで一番大きいものから必要なミップを決め、
+		/// 次の UpdateStreaming() で上位ミップを読み込みます
+		void RequestTextureMip(TextureHandle handle, float screenPixels);
+
+		/// @brief 要求に応じて上位ミップを読み込み、予算を超えたら使われていないものから捨てます
+		/// @details フレームの先頭で1回呼んでください。常駐ミップが変わるとリソースとSRVを
+		/// 作り直し、古いものは FlushUploads() で渡されたフェンスを待ってから解放します
+		void UpdateStreaming(ID3D12GraphicsCommandList* commandList);
+
 		void ReleaseTexture(TextureHandle handle, ID3D12Fence* fence,
 		                    uint64_t      value);
 
@@ -58,6 +97,7 @@ namespace Unnamed {
 
 		[[nodiscard]] uint32_t GpuRefCount(TextureHandle handle) const;
 		[[nodiscard]] size_t   VramUsageBytes() const;
+		[[nodiscard]] std::vector<TextureResidency> TextureResidencyStats() const;
 
 		UploadArena* GetUploadArena() const;
 
@@ -94,6 +134,14 @@ namespace Unnamed {
 			uint32_t    h           = 0;
 			DXGI_FORMAT format      = DXGI_FORMAT_R8G8B8A8_UNORM;
 			size_t      vramBytes   = 0;
+
+			// ストリーミング(ミップ番号は全体のチェーンでの番号)
+			bool     streamed      = false;
+			uint32_t mipCount      = 1;
+			uint32_t residentMip   = 0;
+			uint32_t requestedMip  = 0;
+			uint32_t tailMip       = 0;
+			uint64_t lastUsedFrame = 0;
 		};
 
 		struct GpuMesh {
@@ -109,6 +157,24 @@ namespace Unnamed {
 		};
 
 	private:
+		// 常駐ミップを [newResidentMip, mipCount) に作り直します
+		// @return 予算やアップロード領域が足りなければ何もせずfalse
+		bool RebuildResidency(
+			uint32_t                   index,
+			const TextureAssetData&    data,
+			uint32_t                   newResidentMip,
+			size_t&                    uploadBudget,
+			ID3D12GraphicsCommandList* commandList
+		);
+
+		// 常駐ミップを変えた時の見積もり
+		[[nodiscard]] size_t ResidencyBytes(
+			const GpuTexture& texture, const TextureAssetData& data,
+			uint32_t          residentMip
+		) const;
+
+		void ReleaseRetiredTextures();
+
 		bool UploadRGBA8_1Mip(
 			GpuTexture&                texture,
 			const void*                pixels,
@@ -138,6 +204,20 @@ namespace Unnamed {
 
 		std::vector<PendingUpload> mPendingUploads;
 
+		// ストリーミングで差し替えたリソースとSRV。フェンスを待ってから解放する
+		struct RetiredTexture {
+			Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+			uint32_t                               srvIndex = UINT32_MAX;
+			Microsoft::WRL::ComPtr<ID3D12Fence>    fence;
+			uint64_t                               value = 0;
+		};
+
+		std::vector<RetiredTexture> mRetiredThisFrame;
+		std::vector<RetiredTexture> mRetiredTextures;
+
+		TextureStreamingSettings mStreaming;
+		uint64_t                 mStreamingFrame = 0;
+
 		struct PendingMipUpload {
 			TextureHandle                         tex;
 			uint32_t                              mip = 0; // 上げるミップレベル
@@ -0,0 +1,294 @@
+﻿#include <pch.h>
+
+//-----------------------------------------------------------------------------
+
+#include "ShaderCache.h"
+
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+namespace Unnamed {
+	static constexpr std::string_view kChannel = "ShaderCache";
+
+	namespace {
+		constexpr uint32_t kMagic   = 0x44485355; // "USHD"
+		constexpr uint32_t kVersion = 1;
+
+		struct Header {
+			uint32_t magic;
+			uint32_t version;
+			uint64_t key;
+			uint32_t includeCount;
+			uint32_t reserved;
+			uint64_t bytecodeSize;
+		};
+
+		// ディスクのキーに使うので、実行ごとに変わらないハッシュ
+		uint64_t Fnv1a64(const void* data, const size_t size,
+		                 uint64_t    h = 0xcbf29ce484222325ULL) {
+			const auto* p = static_cast<const uint8_t*>(data);
+			for (size_t i = 0; i < size; ++i) {
+				h ^= p[i];
+				h *= 0x100000001b3ULL;
+			}
+			return h;
+		}
+
+		// 区切りが曖昧にならないよう長さも混ぜる
+		uint64_t Mix(const uint64_t h, const std::string_view s) {
+			const uint64_t size = s.size();
+			return Fnv1a64(s.data(), s.size(), Fnv1a64(&size, sizeof(size), h));
+		}
+	}
+
+	ShaderCache::ShaderCache(
+		IShaderCompiler&      compiler,
+		std::filesystem::path directory
+	) : mCompiler(compiler),
+	    mDirectory(std::move(directory)) {
+	}
+
+	ShaderCache::Bytecode ShaderCache::GetOrCompile(
+		const std::string&      source,
+		const ShaderVariantKey& key,
+		const std::string&      virtualName,
+		std::string*            outErrors
+	) {
+		const uint64_t cacheKey = KeyOf(source, key, virtualName);
+
+		std::promise<Bytecode> promise;
+		{
+			std::unique_lock lock(mMutex);
+			if (const auto it = mEntries.find(cacheKey); it != mEntries.end()) {
+				++mMemoryHits;
+				return it->second.bytecode;
+			}
+			// 別のスレッドがコンパイル中なら待つ
+			if (const auto it = mInFlight.find(cacheKey); it != mInFlight.end()) {
+				const auto future = it->second;
+				lock.unlock();
+				++mMemoryHits;
+				return future.get();
+			}
+			mInFlight.emplace(cacheKey, promise.get_future().share());
+		}
+
+		std::optional<Entry> entry;
+		try {
+			if (!mDirectory.empty()) {
+				entry = ReadEntry(cacheKey);
+				if (entry && !IncludesUpToDate(*entry)) {
+					entry.reset();
+				}
+				if (entry) {
+					++mDiskHits;
+				}
+			}
+
+			if (!entry) {
+				ShaderCompileResult result = mCompiler.Compile(source, key, virtualName);
+				if (outErrors) {
+					*outErrors = std::move(result.errors);
+				}
+				if (result.succeeded) {
+					++mCompiles;
+					entry.emplace();
+					entry->bytecode = std::make_shared<const std::vector<uint8_t>>(
+						std::move(result.bytecode)
+					);
+					for (auto& path : result.includes) {
+						const uint64_t hash = HashFile(path);
+						entry->includes.emplace_back(Include{std::move(path), hash});
+					}
+					if (!mDirectory.empty() && !WriteEntry(cacheKey, *entry)) {
+						Warning(kChannel, "Failed to write shader cache: {}",
+						        PathFor(cacheKey).string());
+					}
+				} else {
+					++mFailures;
+				}
+			}
+		} catch (...) {
+			// 待っている側に例外を渡し、次の要求でやり直せるよう登録を消す
+			{
+				std::lock_guard lock(mMutex);
+				mInFlight.erase(cacheKey);
+			}
+			promise.set_exception(std::current_exception());
+			throw;
+		}
+
+		Bytecode bytecode = entry ? entry->bytecode : nullptr;
+		{
+			std::lock_guard lock(mMutex);
+			if (entry) {
+				mEntries.emplace(cacheKey, std::move(*entry));
+			}
+			mInFlight.erase(cacheKey);
+		}
+		promise.set_value(bytecode);
+		return bytecode;
+	}
+
+	void ShaderCache::ClearMemory() {
+		std::lock_guard lock(mMutex);
+		mEntries.clear();
+	}
+
+	ShaderCache::Stats ShaderCache::GetStats() const {
+		return {
+			.memoryHits = mMemoryHits.load(),
+			.diskHits = mDiskHits.load(),
+			.compiles = mCompiles.load(),
+			.failures = mFailures.load()
+		};
+	}
+
+	uint64_t ShaderCache::KeyOf(
+		const std::string&      source,
+		const ShaderVariantKey& key,
+		const std::string&      virtualName
+	) const {
+		// アセットIDは実行ごとに変わるので混ぜない(中身はソースで決まる)
+		uint64_t h = Mix(0xcbf29ce484222325ULL, mCompiler.Identity());
+		h          = Mix(h, source);
+		h          = Mix(h, virtualName);
+		h          = Mix(h, key.entryPoint);
+		h          = Mix(h, key.target);
+		for (const auto& define : key.defines) {
+			h = Mix(h, define);
+		}
+		return h;
+	}
+
+	std::filesystem::path ShaderCache::PathFor(const uint64_t key) const {
+		return mDirectory / std::format("{:016x}.ushd", key);
+	}
+
+	std::optional<ShaderCache::Entry> ShaderCache::ReadEntry(
+		const uint64_t key
+	) const {
+		std::ifstream file(PathFor(key), std::ios::binary);
+		if (!file) {
+			return std::nullopt;
+		}
+
+		Header header = {};
+		if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+			header.magic != kMagic || header.version != kVersion ||
+			header.key != key) {
+			return std::nullopt;
+		}
+
+		// 数はファイルから読むので、確保する前に残りのサイズに収まるか確認する
+		std::error_code ec;
+		const uint64_t  fileSize = std::filesystem::file_size(PathFor(key), ec);
+		if (ec || fileSize < sizeof(header)) {
+			return std::nullopt;
+		}
+		uint64_t remaining = fileSize - sizeof(header);
+
+		constexpr uint64_t kIncludeHeaderSize = sizeof(uint64_t) + sizeof(uint32_t);
+		if (header.includeCount > remaining / kIncludeHeaderSize) {
+			return std::nullopt;
+		}
+
+		Entry entry;
+		entry.includes.resize(header.includeCount);
+		for (auto& include : entry.includes) {
+			uint32_t length = 0;
+			file.read(reinterpret_cast<char*>(&include.hash), sizeof(include.hash));
+			file.read(reinterpret_cast<char*>(&length), sizeof(length));
+			if (!file || remaining < kIncludeHeaderSize + length) {
+				return std::nullopt;
+			}
+			remaining -= kIncludeHeaderSize + length;
+			include.path.resize(length);
+			file.read(include.path.data(), length);
+		}
+
+		if (header.bytecodeSize > remaining) {
+			return std::nullopt;
+		}
+		std::vector<uint8_t> bytecode(header.bytecodeSize);
+		file.read(reinterpret_cast<char*>(bytecode.data()),
+		          static_cast<std::streamsize>(bytecode.size()));
+		if (!file) {
+			return std::nullopt;
+		}
+		entry.bytecode = std::make_shared<const std::vector<uint8_t>>(
+			std::move(bytecode)
+		);
+		return entry;
+	}
+
+	bool ShaderCache::WriteEntry(const uint64_t key, const Entry& entry) const {
+		std::error_code ec;
+		std::filesystem::create_directories(mDirectory, ec);
+
+		// 一時ファイルに書いてから置き換える(並列に書いても壊れたものを読まないように)
+		const auto path = PathFor(key);
+		auto       tmp  = path;
+		tmp += std::format(".{:x}.tmp",
+		                   std::hash<std::thread::id>{}(std::this_thread::get_id()));
+		{
+			std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+			if (!file) {
+				return false;
+			}
+
+			const Header header = {
+				.magic = kMagic,
+				.version = kVersion,
+				.key = key,
+				.includeCount = static_cast<uint32_t>(entry.includes.size()),
+				.reserved = 0,
+				.bytecodeSize = entry.bytecode->size()
+			};
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			for (const auto& include : entry.includes) {
+				const auto length = static_cast<uint32_t>(include.path.size());
+				file.write(reinterpret_cast<const char*>(&include.hash),
+				           sizeof(include.hash));
+				file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+				file.write(include.path.data(), length);
+			}
+			file.write(reinterpret_cast<const char*>(entry.bytecode->data()),
+			           static_cast<std::streamsize>(entry.bytecode->size()));
+			if (!file) {
+				file.close();
+				std::filesystem::remove(tmp, ec);
+				return false;
+			}
+		}
+
+		std::filesystem::rename(tmp, path, ec);
+		if (ec) {
+			std::filesystem::remove(tmp, ec);
+			return false;
+		}
+		return true;
+	}
+
+	uint64_t ShaderCache::HashFile(const std::string& path) {
+		std::ifstream file(path, std::ios::binary);
+		if (!file) {
+			return 0; // 無くなった(次に現れたら不一致になる)
+		}
+		const std::string bytes(
+			(std::istreambuf_iterator(file)), std::istreambuf_iterator<char>()
+		);
+		return Mix(0xcbf29ce484222325ULL, bytes);
+	}
+
+	bool ShaderCache::IncludesUpToDate(const Entry& entry) {
+		for (const auto& include : entry.includes) {
+			if (HashFile(include.path) != include.hash) {
+				return false;
+			}
+		}
+		return true;
+	}
+}
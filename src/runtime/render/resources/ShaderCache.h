@@ -0,0 +1,88 @@
+﻿#pragma once
+#include <atomic>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+#include <runtime/render/resources/interface/IShaderCompiler.h>
+
+namespace Unnamed {
+	/// @class ShaderCache
+	/// @brief コンパイル済みシェーダーのメモリ/ディスクキャッシュ
+	/// @details キーはソース、バリアント(定義・エントリポイント・ターゲット)、
+	/// 仮想ファイル名、コンパイラの識別子の内容ハッシュです。ディスクのエントリには
+	/// コンパイル時に開いたインクルードとその内容ハッシュも入れておき、
+	/// どれかが変わっていたらコンパイルし直します。スレッドセーフで、
+	/// 同じキーを同時に要求された時は1回だけコンパイルします
+	class ShaderCache {
+	public:
+		using Bytecode = std::shared_ptr<const std::vector<uint8_t>>;
+
+		struct Stats {
+			uint64_t memoryHits = 0;
+			uint64_t diskHits   = 0;
+			uint64_t compiles   = 0;
+			uint64_t failures   = 0;
+		};
+
+		/// @param directory 空ならディスクには書かずメモリだけで持ちます
+		explicit ShaderCache(
+			IShaderCompiler&      compiler,
+			std::filesystem::path directory = "./cache/shaders"
+		);
+
+		/// @return 失敗したらnull。outErrors にはコンパイラの出力が入ります
+		Bytecode GetOrCompile(
+			const std::string&      source,
+			const ShaderVariantKey& key,
+			const std::string&      virtualName,
+			std::string*            outErrors = nullptr
+		);
+
+		// メモリ上のものだけ捨てます(次はディスクから読み直す)
+		void ClearMemory();
+
+		[[nodiscard]] Stats GetStats() const;
+
+		[[nodiscard]] uint64_t KeyOf(
+			const std::string&      source,
+			const ShaderVariantKey& key,
+			const std::string&      virtualName
+		) const;
+
+		[[nodiscard]] std::filesystem::path PathFor(uint64_t key) const;
+
+	private:
+		struct Include {
+			std::string path;
+			uint64_t    hash = 0;
+		};
+
+		struct Entry {
+			Bytecode             bytecode;
+			std::vector<Include> includes;
+		};
+
+		[[nodiscard]] std::optional<Entry> ReadEntry(uint64_t key) const;
+		bool WriteEntry(uint64_t key, const Entry& entry) const;
+
+		static uint64_t HashFile(const std::string& path);
+		static bool     IncludesUpToDate(const Entry& entry);
+
+	private:
+		IShaderCompiler&      mCompiler;
+		std::filesystem::path mDirectory;
+
+		mutable std::mutex                                         mMutex;
+		std::unordered_map<uint64_t, Entry>                        mEntries;
+		std::unordered_map<uint64_t, std::shared_future<Bytecode>> mInFlight;
+
+		std::atomic<uint64_t> mMemoryHits = 0;
+		std::atomic<uint64_t> mDiskHits   = 0;
+		std::atomic<uint64_t> mCompiles   = 0;
+		std::atomic<uint64_t> mFailures   = 0;
+	};
+}
@@ -10,106 +10,23 @@
 #include <engine/subsystem/console/Log.h>
 #include <engine/uengine/UEngine.h>
 
-#include "runtime/assets/core/UAssetManager.h"
+#include <runtime/assets/core/UAssetManager.h>
+#include <runtime/assets/types/ShaderAsset.h>
+#include <runtime/render/resources/DxcShaderCompiler.h>
+#include <runtime/render/resources/ShaderCache.h>
 
 namespace Unnamed {
 	constexpr std::string_view kChannel = "ShaderLibrary";
 
 	using namespace Microsoft::WRL;
 
-	ComPtr<IDxcBlob> CompileHLSL(
-		const std::string&      src,
-		const ShaderVariantKey& key,
-		const char*             virtualName = nullptr
-	) {
-		std::vector<D3D_SHADER_MACRO> macros;
-		macros.reserve(key.defines.size() + 1);
-		for (auto& define : key.defines) {
-			const auto pos = define.find('=');
-			if (pos == std::string::npos) {
-				macros.emplace_back(define.c_str(), "1");
-			} else {
-				std::string name  = define.substr(0, pos);
-				std::string value = define.substr(pos + 1);
-				// TODO: ここで name/val の寿命を維持するなら別保管が必要。
-				// 最小実装では defines は呼び出しスコープのライフタイムに依存。
-				macros.emplace_back(name.c_str(), value.c_str());
-			}
-		}
-		macros.emplace_back(nullptr, nullptr);
-
-		ComPtr<IDxcUtils>          dxcUtils;
-		ComPtr<IDxcCompiler3>      dxcCompiler;
-		ComPtr<IDxcIncludeHandler> includeHandler;
-		THROW(DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&dxcUtils)));
-		THROW(DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&dxcCompiler)));
-		THROW(dxcUtils->CreateDefaultIncludeHandler(&includeHandler));
-
-		ComPtr<IDxcBlobEncoding> sourceBlob;
-		THROW(
-			dxcUtils->CreateBlobFromPinned(
-				src.c_str(), static_cast<UINT32>(src.size()),
-				DXC_CP_UTF8, &sourceBlob
-			)
-		);
-
-		DxcBuffer shaderSourceBuffer = {};
-		shaderSourceBuffer.Ptr       = sourceBlob->GetBufferPointer();
-		shaderSourceBuffer.Size      = sourceBlob->GetBufferSize();
-		shaderSourceBuffer.Encoding  = DXC_CP_UTF8;
-
-		const std::wstring wEntryPoint = StrUtil::ToWString(key.entryPoint);
-		const std::wstring wTarget     = StrUtil::ToWString(key.target);
-
-		bool         hasName = virtualName != nullptr;
-		std::wstring wVirtualName;
-		if (hasName) {
-			wVirtualName = StrUtil::ToWString(virtualName);
-		}
-
-		std::array arguments = {
-			hasName ? wVirtualName.c_str() : L"Generated.hlsl", // 仮想ファイル名
-			L"-E", wEntryPoint.c_str(), // エントリーポイントの指定。
-			L"-T", wTarget.c_str(), // ShaderProfileの設定
-			DXC_ARG_DEBUG, L"-Qembed_debug", // デバッグ用の情報を埋め込む
-			DXC_ARG_SKIP_OPTIMIZATIONS, // 最適化を外しておく
-			DXC_ARG_PACK_MATRIX_ROW_MAJOR, // 行列のメモリレイアウトは行優先
-		};
-
-		ComPtr<IDxcResult> shaderResult;
-		THROW(
-			dxcCompiler->Compile(
-				&shaderSourceBuffer,
-				arguments.data(),                      // 引数
-				static_cast<UINT32>(arguments.size()), // 引数の数
-				includeHandler.Get(),                  // includeが含まれた諸々
-				IID_PPV_ARGS(&shaderResult)            // コンパイル結果
-			)
-		);
-
-		// コンパイル時の
-		ComPtr<IDxcBlobUtf8> shaderError;
-		shaderResult->GetOutput(
-			DXC_OUT_ERRORS, IID_PPV_ARGS(&shaderError), nullptr
-		);
-		if (shaderError != nullptr && shaderError->GetStringLength() != 0) {
-			Fatal(kChannel, "{}", shaderError->GetStringPointer());
-			return nullptr;
+	static uint64_t ContentHash(const std::vector<uint8_t>& bytes) {
+		uint64_t h = 0xcbf29ce484222325ULL;
+		for (const uint8_t b : bytes) {
+			h ^= b;
+			h *= 0x100000001b3ULL;
 		}
-
-		ComPtr<IDxcBlob> shaderBlob;
-		THROW(
-			shaderResult->GetOutput(
-				DXC_OUT_OBJECT, IID_PPV_ARGS(&shaderBlob), nullptr
-			)
-		);
-		Msg(
-			kChannel,
-			"Shader compile success: entryPoint='{}', target='{}'",
-			key.entryPoint.c_str(), key.target.c_str()
-		);
-
-		return shaderBlob;
+		return h;
 	}
 
 	void HashCombine(size_t& h, const size_t v) {
@@ -117,12 +34,27 @@ namespace Unnamed {
 	}
 
 	ShaderLibrary::ShaderLibrary(
-		GraphicsDevice* graphicsDevice, UAssetManager* assetManager
-	) : mGraphicsDevice(graphicsDevice), mAssetManager(assetManager) {
+		GraphicsDevice*                  graphicsDevice,
+		UAssetManager*                   assetManager,
+		std::unique_ptr<IShaderCompiler> compiler,
+		std::filesystem::path            cacheDirectory
+	) : mGraphicsDevice(graphicsDevice),
+	    mAssetManager(assetManager),
+	    mCompiler(std::move(compiler)) {
 		UASSERT(graphicsDevice);
 		UASSERT(assetManager);
+
+		if (!mCompiler) {
+			mCompiler = std::make_unique<DxcShaderCompiler>();
+		}
+		mShaderCache = std::make_unique<ShaderCache>(
+			*mCompiler, std::move(cacheDirectory)
+		);
+		THROW(DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&mUtils)));
 	}
 
+	ShaderLibrary::~ShaderLibrary() = default;
+
 	const ShaderBlob* ShaderLibrary::GetOrCompile(
 		const ShaderVariantKey& key
 	) {
@@ -131,9 +63,12 @@ namespace Unnamed {
 		}
 
 		const size_t hash = Hash(key);
-		auto         it   = mCache.find(hash);
-		if (it != mCache.end() && it->second.shaderBlob.blob) {
-			return &it->second.shaderBlob;
+		{
+			std::lock_guard lock(mMutex);
+			auto            it = mCache.find(hash);
+			if (it != mCache.end() && it->second.shaderBlob.blob) {
+				return &it->second.shaderBlob;
+			}
 		}
 
 		const auto* s = mAssetManager->Get<ShaderAssetData>(key.asset);
@@ -141,16 +76,8 @@ namespace Unnamed {
 			return nullptr;
 		}
 
-		auto blob = CompileHLSL(s->hlsl, key);
-		if (!blob) {
-			return nullptr;
-		}
-
-		Entry entry;
-		entry.hash            = hash;
-		entry.shaderBlob.blob = std::move(blob);
-		mCache[hash]          = std::move(entry);
-		return &mCache[hash].shaderBlob;
+		// 相対インクルードがシェーダーの場所から解決されるように実際のパスを渡す
+		return Compile(hash, s->hlsl, key, s->sourcePath);
 	}
 
 	const ShaderBlob* ShaderLibrary::GetOrCompileFromString(
@@ -169,26 +96,23 @@ namespace Unnamed {
 		}
 
 		// キャッシュ検索
-		auto it = mCache.find(h);
-		if (it != mCache.end() && it->second.shaderBlob.blob) {
-			return &it->second.shaderBlob;
-		}
-
-		// コンパイル
-		auto blob = CompileHLSL(hlsl, key);
-		if (!blob) {
-			return nullptr;
+		{
+			std::lock_guard lock(mMutex);
+			auto            it = mCache.find(h);
+			if (it != mCache.end() && it->second.shaderBlob.blob) {
+				return &it->second.shaderBlob;
+			}
 		}
 
-		Entry entry;
-		entry.hash            = h;
-		entry.shaderBlob.blob = std::move(blob);
-		mCache[h]             = std::move(entry);
-		return &mCache[h].shaderBlob;
+		return Compile(h, hlsl, key, virtualName ? virtualName : "");
 	}
 
 	// TODO: 使わないなら消そう
 	void ShaderLibrary::InvalidateByAsset([[maybe_unused]] AssetID asset) {
+		// ディスクから読み直す時にインクルードの変更を確認させる
+		mShaderCache->ClearMemory();
+
+		std::lock_guard     lock(mMutex);
 		std::vector<size_t> toRemove;
 		toRemove.reserve(mCache.size());
 		for (const auto& h : mCache | std::views::keys) {
@@ -201,6 +125,46 @@ namespace Unnamed {
 		}
 	}
 
+	const ShaderBlob* ShaderLibrary::Compile(
+		const size_t            hash,
+		const std::string&      source,
+		const ShaderVariantKey& key,
+		const std::string&      virtualName
+	) {
+		std::string errors;
+		const auto  bytecode = mShaderCache->GetOrCompile(
+			source, key, virtualName, &errors
+		);
+		if (!bytecode) {
+			Fatal(kChannel, "{}", errors);
+			return nullptr;
+		}
+		if (!errors.empty()) {
+			Warning(kChannel, "{}", errors);
+		}
+
+		std::lock_guard lock(mMutex);
+		// 別のスレッドが先に入れていたらそちらを使う(返したポインタを無効にしない)
+		auto it = mCache.find(hash);
+		if (it != mCache.end() && it->second.shaderBlob.blob) {
+			return &it->second.shaderBlob;
+		}
+
+		ComPtr<IDxcBlobEncoding> blob;
+		THROW(
+			mUtils->CreateBlob(
+				bytecode->data(), static_cast<UINT32>(bytecode->size()),
+				DXC_CP_ACP, &blob
+			)
+		);
+
+		Entry& entry          = mCache[hash];
+		entry.hash            = hash;
+		entry.shaderBlob.blob = std::move(blob);
+		entry.shaderBlob.hash = ContentHash(*bytecode);
+		return &entry.shaderBlob;
+	}
+
 	size_t ShaderLibrary::Hash(const ShaderVariantKey& key) {
 		constexpr std::hash<std::string> hashString;
 		constexpr std::hash<uint64_t>    hashUint64;
@@ -1,33 +1,43 @@
 ﻿#pragma once
+#include <filesystem>
+#include <memory>
+#include <mutex>
 
 #include <dxcapi.h>
 
 #include <runtime/assets/core/UAssetID.h>
+#include <runtime/render/resources/interface/IShaderCompiler.h>
 
 #include <wrl/client.h>
 
 namespace Unnamed {
 	class UAssetManager;
 	class GraphicsDevice;
-
-	struct ShaderVariantKey {
-		AssetID                  asset;      // シェーダーアセット
-		std::vector<std::string> defines;    // コンパイル定義
-		std::string              entryPoint; // エントリポイント
-		std::string              target;     // SMのバージョンなど
-	};
+	class ShaderCache;
 
 	struct ShaderBlob {
 		Microsoft::WRL::ComPtr<IDxcBlob> blob;
 		uint32_t                         version = 0; // リロード時に増えます
+		uint64_t                         hash    = 0; // バイトコードの内容ハッシュ(実行をまたいで同じ)
 	};
 
+	/// @class ShaderLibrary
+	/// @brief シェーダーバリアントの取得
+	/// @details コンパイル結果は ShaderCache 経由でディスクにも残るので、
+	/// 2回目以降の起動ではインクルードが変わっていない限りコンパイルしません。
+	/// 複数のスレッドから同時に呼べます(コンパイルはロックの外で走ります)
 	class ShaderLibrary {
 	public:
+		/// @param compiler nullならDXCを使います
+		/// @param cacheDirectory 空ならディスクのキャッシュを使いません
 		ShaderLibrary(
-			GraphicsDevice* graphicsDevice,
-			UAssetManager*  assetManager
+			GraphicsDevice*                  graphicsDevice,
+			UAssetManager*                   assetManager,
+			std::unique_ptr<IShaderCompiler> compiler       = nullptr,
+			std::filesystem::path            cacheDirectory = "./cache/shaders"
 		);
+		~ShaderLibrary();
+
 		const ShaderBlob* GetOrCompile(const ShaderVariantKey& key);
 		const ShaderBlob* GetOrCompileFromString(
 			const std::string&      hlsl,
@@ -37,18 +47,32 @@ namespace Unnamed {
 
 		void InvalidateByAsset(AssetID asset);
 
+		[[nodiscard]] ShaderCache& Cache() const { return *mShaderCache; }
+
 	private:
 		static size_t Hash(const ShaderVariantKey& key);
 
+		const ShaderBlob* Compile(
+			size_t                  hash,
+			const std::string&      source,
+			const ShaderVariantKey& key,
+			const std::string&      virtualName
+		);
+
 	private:
 		GraphicsDevice* mGraphicsDevice = nullptr;
 		UAssetManager*  mAssetManager   = nullptr;
 
+		std::unique_ptr<IShaderCompiler>  mCompiler;
+		std::unique_ptr<ShaderCache>      mShaderCache;
+		Microsoft::WRL::ComPtr<IDxcUtils> mUtils; // バイトコードを IDxcBlob に包む用
+
 		struct Entry {
 			size_t     hash;
 			ShaderBlob shaderBlob;
 		};
 
-		std::unordered_map<size_t, Entry> mCache;
+		std::mutex                        mMutex;
+		std::unordered_map<size_t, Entry> mCache; // ノードなのでポインタは動かない
 	};
 }
@@ -0,0 +1,39 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <runtime/assets/core/UAssetID.h>
+
+namespace Unnamed {
+	struct ShaderVariantKey {
+		AssetID                  asset;      // シェーダーアセット
+		std::vector<std::string> defines;    // コンパイル定義
+		std::string              entryPoint; // エントリポイント
+		std::string              target;     // SMのバージョンなど
+	};
+
+	struct ShaderCompileResult {
+		bool                     succeeded = false;
+		std::vector<uint8_t>     bytecode;
+		std::vector<std::string> includes; // 開いたインクルードファイル(キャッシュの無効化に使う)
+		std::string              errors;
+	};
+
+	/// @brief HLSLのコンパイラ
+	/// @details 複数のスレッドから同時に Compile が呼ばれます
+	class IShaderCompiler {
+	public:
+		virtual ~IShaderCompiler() = default;
+
+		virtual ShaderCompileResult Compile(
+			const std::string&      source,
+			const ShaderVariantKey& key,
+			const std::string&      virtualName
+		) = 0;
+
+		// コンパイラと引数の識別子。変わったらキャッシュを使いません
+		[[nodiscard]] virtual std::string_view Identity() const = 0;
+	};
+}
@@ -40,6 +40,14 @@ namespace Unnamed {
 		uint32_t indexCount = 0;
 		uint32_t firstIndex = 0;
 		int32_t  baseVertex = 0;
+
+		// ローカル空間の境界球(画面上の大きさの見積もりに使う)
+		Vec3  boundsCenter = Vec3::zero;
+		float boundsRadius = 0.0f;
+
+		// ローカル空間のAABB(視錐台カリングに使う)
+		Vec3 boundsMin = Vec3::zero;
+		Vec3 boundsMax = Vec3::zero;
 	};
 
 }
\ No newline at end of file